@@ -1,6 +1,7 @@
 #ifndef AABB_h
 #define AABB_h
 
+#include <vector>
 #include "math/Vec3.h"
 
 namespace Cannon::Math {
@@ -13,56 +14,59 @@ namespace Cannon::Collision {
 class Ray;
 
 class AABB {
-private:
+public:
     /**
      * The lower bound of the bounding box.
      * @property lowerBound
      * @type {Vec3}
      */
-    Math::Vec3 lowerBound_;
+    Math::Vec3 lowerBound;
 
     /**
      * The upper bound of the bounding box.
      * @property upperBound
      * @type {Vec3}
      */
-    Math::Vec3 upperBound_;
+    Math::Vec3 upperBound;
 
-public:
     /**
      * Axis aligned bounding box class.
      * @class AABB
      * @constructor
      */
-    AABB();
-    
+    AABB() {};
+
     /**
      * Axis aligned bounding box class.
      * @class AABB
      * @constructor
-     * @param {Vec3} upperBound
      * @param {Vec3} lowerBound
+     * @param {Vec3} upperBound
      */
-    AABB(Math::Vec3 lowerBound, Math::Vec3 upperBound);
+    AABB(Math::Vec3 lowerBound, Math::Vec3 upperBound): lowerBound(lowerBound), upperBound(upperBound) {};
 
     /**
      * Set the AABB bounds from a set of points.
      * @method setFromPoints
      * @param {Array} points An array of Vec3's.
-     * @param {Vec3} position
-     * @param {Quaternion} quaternion
+     * @param {Vec3} position Optional.
+     * @param {Quaternion} quaternion Optional.
      * @param {number} skinSize
      * @return {AABB} The self object
      */
-    AABB setFromPoints(Math::Vec3* points, Math::Vec3 position, Math::Quaternion quaternion, float skinSize);
-    
+    AABB* setFromPoints(
+        std::vector<Math::Vec3>* points,
+        Math::Vec3* position,
+        Math::Quaternion* quaternion,
+        float skinSize);
+
     /**
      * Copy bounds from an AABB to this AABB
      * @method copy
      * @param  {AABB} aabb Source to copy from
      * @return {AABB} The this object, for chainability
      */
-    AABB copy(AABB aabb);
+    AABB* copy(AABB* aabb);
 
     /**
      * Clone an AABB
@@ -75,7 +79,7 @@ public:
      * @method extend
      * @param  {AABB} aabb
      */
-    void extend(AABB aabb);
+    void extend(AABB* aabb);
 
     /**
      * Returns true if the given AABB overlaps this AABB.
@@ -83,7 +87,7 @@ public:
      * @param  {AABB} aabb
      * @return {Boolean}
      */
-    bool overlaps(AABB aabb);
+    bool overlaps(AABB* aabb);
 
     // Mostly for debugging
     float volume();
@@ -94,7 +98,7 @@ public:
      * @param {AABB} aabb
      * @return {Boolean}
      */
-    bool contains(AABB aabb);
+    bool contains(AABB* aabb);
 
     /**
      * @method getCorners
@@ -108,8 +112,8 @@ public:
      * @param {Vec3} h
      */
     void getCorners(
-        Math::Vec3 a, Math::Vec3 b, Math::Vec3 c, Math::Vec3 d,
-        Math::Vec3 e, Math::Vec3 f, Math::Vec3 g, Math::Vec3 h);
+        Math::Vec3* a, Math::Vec3* b, Math::Vec3* c, Math::Vec3* d,
+        Math::Vec3* e, Math::Vec3* f, Math::Vec3* g, Math::Vec3* h);
 
     /**
      * Get the representation of an AABB in another frame.
@@ -118,7 +122,7 @@ public:
      * @param  {AABB} target
      * @return {AABB} The "target" AABB object.
      */
-    AABB toLocalFrame(Math::Transform frame, AABB target);
+    AABB* toLocalFrame(Math::Transform* frame, AABB* target);
 
     /**
      * Get the representation of an AABB in the global frame.
@@ -127,14 +131,23 @@ public:
      * @param  {AABB} target
      * @return {AABB} The "target" AABB object.
      */
-    AABB toWorldFrame(Math::Transform frame, AABB target);
+    AABB* toWorldFrame(Math::Transform* frame, AABB* target);
 
     /**
      * Check if the AABB is hit by a ray.
      * @param  {Ray} ray
-     * @return {number}
+     * @return {Boolean}
+     */
+    bool overlapsRay(Ray* ray);
+
+    /**
+     * Check if the AABB is hit by the line segment between from and to.
+     * @method overlapsSegment
+     * @param  {Vec3} from
+     * @param  {Vec3} to
+     * @return {Boolean}
      */
-    bool overlapsRay(Ray ray);
+    bool overlapsSegment(Math::Vec3* from, Math::Vec3* to);
 };
 
 } // end namespace Collision
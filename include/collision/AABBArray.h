@@ -0,0 +1,133 @@
+#ifndef AABBArray_h
+#define AABBArray_h
+
+#include <vector>
+
+namespace Cannon::Objects {
+    class Body;
+}
+
+namespace Cannon::Collision {
+
+class AABBArray {
+private:
+    int size_ = 0;
+
+public:
+    /**
+     * Number of boxes tested per kernel iteration. 8 when compiled with AVX, 4 with SSE2, else 1.
+     * @static
+     * @property {Number} BATCH_SIZE
+     */
+    static const int BATCH_SIZE;
+
+    /**
+     * Lower bounds of the boxes. All arrays are padded to a multiple of BATCH_SIZE with empty boxes.
+     * @property {Array} lowerX
+     */
+    std::vector<float> lowerX;
+    std::vector<float> lowerY;
+    std::vector<float> lowerZ;
+
+    /**
+     * @property {Array} upperX
+     */
+    std::vector<float> upperX;
+    std::vector<float> upperY;
+    std::vector<float> upperZ;
+
+    /**
+     * Body positions and bounding radii, for the bounding sphere kernel.
+     * @property {Array} positionX
+     */
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> positionZ;
+    std::vector<float> boundingRadius;
+
+    /**
+     * @property {Array} collisionFilterGroup
+     */
+    std::vector<int> collisionFilterGroup;
+
+    /**
+     * @property {Array} collisionFilterMask
+     */
+    std::vector<int> collisionFilterMask;
+
+    /**
+     * 1 for bodies that are static or sleeping, else 0.
+     * @property {Array} inactive
+     */
+    std::vector<int> inactive;
+
+    /**
+     * Packed structure-of-arrays copy of the body bounds and collision filters, for testing one body against many others with SIMD.
+     * @class AABBArray
+     * @constructor
+     */
+    AABBArray() {};
+
+    /**
+     * @method size
+     * @return {Number}
+     */
+    int size();
+
+    /**
+     * Set the number of boxes. New boxes are empty.
+     * @method resize
+     * @param {Number} size
+     */
+    void resize(int size);
+
+    /**
+     * Copy the bounds and filters of a body. Updates the body AABB first if needed.
+     * @method set
+     * @param {Number} index
+     * @param {Body} body
+     */
+    void set(int index, Objects::Body* body);
+
+    /**
+     * Resize to the number of bodies and copy all of them, in order.
+     * @method setFromBodies
+     * @param {Array} bodies
+     */
+    void setFromBodies(std::vector<Objects::Body*>* bodies);
+
+    /**
+     * Check if two entries pass the collision filter and are not both static or sleeping. Same as Broadphase.needBroadphaseCollision.
+     * @method needCollision
+     * @param {Number} i
+     * @param {Number} j
+     * @return {Boolean}
+     */
+    bool needCollision(int i, int j);
+
+    /**
+     * Find the boxes in [start, end) that overlap box i and need collision.
+     * @method overlapBatch
+     * @param {Number} index
+     * @param {Number} start
+     * @param {Number} end
+     * @param {Array} result Indices of the overlapping boxes are appended here
+     * @return {Number} The number of boxes found
+     */
+    int overlapBatch(int index, int start, int end, std::vector<int>* result);
+
+    /**
+     * Find the bodies in [start, end) whose bounding sphere overlaps the one of body i, and that need collision.
+     * @method sphereBatch
+     * @param {Number} index
+     * @param {Number} start
+     * @param {Number} end
+     * @param {Array} result Indices of the overlapping bodies are appended here
+     * @return {Number} The number of bodies found
+     */
+    int sphereBatch(int index, int start, int end, std::vector<int>* result);
+};
+
+}
+
+#endif
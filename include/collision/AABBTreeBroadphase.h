@@ -0,0 +1,179 @@
+#ifndef AABBTreeBroadphase_h
+#define AABBTreeBroadphase_h
+
+#include <vector>
+#include "collision/Broadphase.h"
+#include "utils/AABBTree.h"
+
+namespace Cannon::World {
+    class World;
+}
+
+namespace Cannon::Objects {
+    class Body;
+}
+
+namespace Cannon::Math {
+    class Vec3;
+}
+
+namespace Cannon::Collision {
+
+class AABBTreeBroadphase : public Collision::Broadphase {
+private:
+    /**
+     * Tree proxy of each body, in the same order as .bodies
+     * @private
+     * @property {Array} proxyIds_
+     */
+    std::vector<int> proxyIds_;
+
+    /**
+     * Set for the bodies that have their proxy in .staticTree
+     * @private
+     * @property {Array} inStaticTree_
+     */
+    std::vector<char> inStaticTree_;
+
+    /**
+     * Node pairs of the dynamic tree against itself and against the static tree, from AABBTree.splitQuery(). Each one is traversed by a single task.
+     * @private
+     * @property {Array} dynamicNodePairs_
+     */
+    std::vector<int> dynamicNodePairs_;
+    std::vector<int> staticNodePairs_;
+
+    std::vector<int> queryResult_;
+    std::vector<int> pairs1_;
+    std::vector<int> pairs2_;
+    std::vector<Objects::Body*> cachePairs1_;
+    std::vector<Objects::Body*> cachePairs2_;
+
+    void updateProxies_();
+    int splitQueries_();
+    void queryNodePairs_(int begin, int end, std::vector<int>* pairs1, std::vector<int>* pairs2, std::vector<int>* stack);
+    void reportPairs_(std::vector<int>* pairs1, std::vector<int>* pairs2, std::vector<Objects::Body*>* p1, std::vector<Objects::Body*>* p2);
+    void cachePairs_();
+    void sortPairs_(int begin, std::vector<Objects::Body*>* p1, std::vector<Objects::Body*>* p2);
+
+public:
+    /**
+     * The bodies in the broadphase. The user data of each tree leaf is the index of its body in this list.
+     * @property {Array} bodies
+     */
+    std::vector<Objects::Body*> bodies;
+
+    /**
+     * The tree holding the fat AABBs of the dynamic and kinematic bodies that are awake. Set dynamicTree.margin to change how far a body can move before it is reinserted.
+     * @property {AABBTree} dynamicTree
+     */
+    Utils::AABBTree dynamicTree;
+
+    /**
+     * The tree holding the static and sleeping bodies. It only changes when such bodies are added, removed, moved, or change type or sleep state. A static body that is moved needs .aabbNeedsUpdate to be set.
+     * @property {AABBTree} staticTree
+     */
+    Utils::AABBTree staticTree;
+
+    /**
+     * Check if a body belongs in the static tree.
+     * @static
+     * @method isStaticOrSleeping
+     * @param  {Body} body
+     * @return {Boolean}
+     */
+    static bool isStaticOrSleeping(Objects::Body* body);
+
+    /**
+     * Broadphase using dynamic AABB trees. Each body has a leaf with an enlarged AABB, and is only reinserted in its tree when its AABB leaves the enlarged one. Pairs are found by traversing the dynamic tree against itself and against the static tree, so static-static pairs are never enumerated. The traversals are split into node pairs, one task each on .threadPool. The pairs are then sorted by the ids of their bodies, with the lower id first, so their order depends neither on the pool nor on the shape of the trees.
+     * @class AABBTreeBroadphase
+     * @constructor
+     * @extends Broadphase
+     */
+    AABBTreeBroadphase() {};
+
+    /**
+     * @class AABBTreeBroadphase
+     * @constructor
+     * @param {World} [world]
+     * @extends Broadphase
+     */
+    AABBTreeBroadphase(World::World* world);
+
+    /**
+     * Change the world
+     * @method setWorld
+     * @param  {World} world
+     */
+    void setWorld(World::World* world);
+
+    /**
+     * Add a body to the tree.
+     * @method addBody
+     * @param {Body} body
+     */
+    void addBody(Objects::Body* body);
+
+    /**
+     * Add many bodies at once. The static and the dynamic ones are each bulk built into a subtree with AABBTree.createProxies().
+     * @method addBodies
+     * @param {Array} bodies
+     */
+    void addBodies(std::vector<Objects::Body*>* bodies);
+
+    /**
+     * Remove a body from the tree.
+     * @method removeBody
+     * @param {Body} body
+     */
+    void removeBody(Objects::Body* body);
+
+    /**
+     * Get all the collision pairs in the physics world
+     * @method collisionPairs
+     * @param {World} world
+     * @param {Array} p1
+     * @param {Array} p2
+     */
+    void collisionPairs(
+        World::World* world,
+        std::vector<Objects::Body*>* p1,
+        std::vector<Objects::Body*>* p2);
+
+    /**
+     * Update .pairCache. Without a .threadPool the pairs found in the trees are reported into the cache without going through .collisionPairs().
+     * @method updatePairs
+     * @param {World} world
+     */
+    void updatePairs(World::World* world);
+
+    /**
+     * Returns all the bodies within an AABB.
+     * @method aabbQuery
+     * @param  {World} world
+     * @param  {AABB} aabb
+     * @param {array} result An array to store resulting bodies in.
+     * @return {array}
+     */
+    std::vector<Objects::Body*>* aabbQuery(
+        World::World* world,
+        Collision::AABB* aabb,
+        std::vector<Objects::Body*>* result);
+
+    /**
+     * Returns all the bodies whose AABB is hit by the line segment between from and to.
+     * @method rayQuery
+     * @param  {Vec3} from
+     * @param  {Vec3} to
+     * @param {array} result An array to store resulting bodies in.
+     * @return {array}
+     */
+    std::vector<Objects::Body*>* rayQuery(
+        Math::Vec3* from,
+        Math::Vec3* to,
+        std::vector<Objects::Body*>* result);
+};
+
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef BoxBox_h
+#define BoxBox_h
+
+#include <array>
+#include <vector>
+#include "math/Vec3.h"
+
+namespace Cannon::Math {
+    class Quaternion;
+}
+
+namespace Cannon::Collision {
+
+/**
+ * A contact point between two boxes. All in world space.
+ * @class BoxBoxContact
+ */
+struct BoxBoxContact {
+    /**
+     * Point on the surface of box A.
+     * @property {Vec3} pointA
+     */
+    Math::Vec3 pointA;
+
+    /**
+     * Point on the surface of box B.
+     * @property {Vec3} pointB
+     */
+    Math::Vec3 pointB;
+
+    /**
+     * @property {Number} depth
+     */
+    float depth = 0;
+};
+
+/**
+ * @class BoxBoxResult
+ */
+struct BoxBoxResult {
+    /**
+     * Unit vector pointing from box A to box B.
+     * @property {Vec3} normal
+     */
+    Math::Vec3 normal;
+
+    /**
+     * Penetration depth along the normal.
+     * @property {Number} depth
+     */
+    float depth = 0;
+
+    /**
+     * The axis of least penetration: 0-2 for a face of A, 3-5 for a face of B, 6-14 for an edge of A crossed with an edge of B.
+     * @property {Number} axis
+     */
+    int axis = -1;
+
+    /**
+     * @property {Array} contacts
+     */
+    std::vector<BoxBoxContact> contacts;
+};
+
+class BoxBox {
+private:
+    std::array<Math::Vec3, 3> axesA_;
+    std::array<Math::Vec3, 3> axesB_;
+    std::array<Math::Vec3, 8> polygon_;
+    std::array<Math::Vec3, 8> clipped_;
+
+    int clipPolygon_(Math::Vec3* origin, Math::Vec3* normal, float offset, int count);
+
+public:
+    /**
+     * Edge axes are only picked over a face axis if they penetrate less by this factor, which keeps resting boxes on stable face contacts.
+     * @property {Number} edgeBias
+     * @default 1.05
+     */
+    float edgeBias = 1.05;
+
+    /**
+     * Contacts between two oriented boxes, like dBoxBox in ODE. A separating axis test on the 15 axes of the pair finds the axis of least penetration. Face axes clip the incident face of one box against the reference face of the other, and edge axes make one contact between the closest points of the edges. Scratch data is kept in the instance, so use one instance per thread.
+     * @class BoxBox
+     * @constructor
+     */
+    BoxBox() {};
+
+    /**
+     * @method collide
+     * @param {Vec3} halfExtentsA
+     * @param {Vec3} posA
+     * @param {Quaternion} quatA
+     * @param {Vec3} halfExtentsB
+     * @param {Vec3} posB
+     * @param {Quaternion} quatB
+     * @param {BoxBoxResult} result
+     * @param {Boolean} justTest Only run the separating axis test, and leave .contacts empty.
+     * @return {Boolean} True if the boxes overlap.
+     */
+    bool collide(
+        Math::Vec3* halfExtentsA,
+        Math::Vec3* posA,
+        Math::Quaternion* quatA,
+        Math::Vec3* halfExtentsB,
+        Math::Vec3* posB,
+        Math::Quaternion* quatB,
+        BoxBoxResult* result,
+        bool justTest);
+};
+
+}
+
+#endif
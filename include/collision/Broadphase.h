@@ -2,6 +2,9 @@
 #define Broadphase_h
 
 #include <vector>
+#include <functional>
+#include "collision/PairCache.h"
+#include "collision/BroadphaseQuery.h"
 
 namespace Cannon::World {
     class World;
@@ -11,12 +14,22 @@ namespace Cannon::Objects {
     class Body;
 }
 
+namespace Cannon::Utils {
+    class ThreadPool;
+}
+
 namespace Cannon::Collision {
 
 class AABB;
+class AABBArray;
 
 class Broadphase {
 private:
+    std::vector<std::vector<Objects::Body*>> taskPairs1_;
+    std::vector<std::vector<Objects::Body*>> taskPairs2_;
+    std::vector<std::pair<float, Objects::Body*>> nearest_;
+
+    void nearestQuery_(World::World* world, BroadphaseQuery* query, std::vector<Objects::Body*>* results);
 
 public:
     /**
@@ -39,6 +52,25 @@ public:
      */
     bool dirty = true;
 
+    /**
+     * Persistent set of the overlapping pairs, kept up to date by .updatePairs().
+     * @property {PairCache} pairCache
+     */
+    PairCache pairCache;
+
+    /**
+     * Thread pool to split .collisionPairs() over. Runs on the calling thread if not set.
+     * @property {ThreadPool} threadPool
+     */
+    Utils::ThreadPool* threadPool = nullptr;
+
+    /**
+     * Number of bodies per task when running on .threadPool. The pair order only depends on this, not on the number of threads.
+     * @property {Number} bodiesPerTask
+     * @default 64
+     */
+    int bodiesPerTask = 64;
+
     /**
      * Base class for broadphase implementations
      * @class Broadphase
@@ -47,6 +79,8 @@ public:
      */
     Broadphase() {};
 
+    virtual ~Broadphase() {};
+
     /**
      * Get the collision pairs from the world
      * @method collisionPairs
@@ -82,6 +116,58 @@ public:
         std::vector<Objects::Body*>* pairs1,
         std::vector<Objects::Body*>* pairs2);
 
+    /**
+     * Check if the bounding volumes of two bodies intersect. Same test as .intersectionTest(), without the pair arrays.
+     * @method boundingVolumeCheck
+     * @param {Body} bodyA
+     * @param {Body} bodyB
+     * @return {Boolean}
+     */
+    bool boundingVolumeCheck(Objects::Body* bodyA, Objects::Body* bodyB);
+
+    /**
+     * Batched version of .intersectionTest(). Tests body index against the bodies in [start, end) of a packed array, with SIMD kernels, and also applies the checks of .needBroadphaseCollision().
+     * @method intersectionTestBatch
+     * @param {AABBArray} aabbs Packed bounds, in the same order as bodies
+     * @param {Array} bodies
+     * @param {Number} index
+     * @param {Number} start
+     * @param {Number} end
+     * @param {Array} pairs1
+     * @param {Array} pairs2
+     */
+    void intersectionTestBatch(
+        AABBArray* aabbs,
+        std::vector<Objects::Body*>* bodies,
+        int index,
+        int start,
+        int end,
+        std::vector<Objects::Body*>* pairs1,
+        std::vector<Objects::Body*>* pairs2);
+
+    /**
+     * Split [0, count) into chunks of .bodiesPerTask and run collect(begin, end, pairs1, pairs2) for each chunk on .threadPool. Each chunk writes to its own pair buffers, which are then appended to pairs1 and pairs2 in chunk order, so the output is the same for any number of threads. collect must only report pairs that no other chunk reports.
+     * @method parallelCollect
+     * @param {Number} count
+     * @param {Function} collect
+     * @param {Array} pairs1
+     * @param {Array} pairs2
+     * @param {Number} [chunkSize] Items per chunk, .bodiesPerTask if 0
+     */
+    void parallelCollect(
+        int count,
+        std::function<void(int, int, std::vector<Objects::Body*>*, std::vector<Objects::Body*>*)> collect,
+        std::vector<Objects::Body*>* pairs1,
+        std::vector<Objects::Body*>* pairs2,
+        int chunkSize = 0);
+
+    /**
+     * Update .pairCache with the current collision pairs. Afterwards pairCache.added1/added2 and pairCache.removed1/removed2 hold the pairs that started and stopped overlapping since the last update, and pairCache.pairs1/pairs2 all current pairs without duplicates. Subclasses can override this to report pairs directly into the cache.
+     * @method updatePairs
+     * @param {World} world
+     */
+    virtual void updatePairs(World::World* world);
+
     /**
      * Check if the bounding spheres of two bodies are intersecting.
      * @method doBoundingSphereBroadphase
@@ -127,6 +213,27 @@ public:
      */
     virtual void setWorld(World::World* world);
 
+    /**
+     * Called by the world after a body has been added to it. To be implemented by subclasses that keep their own body lists.
+     * @method addBody
+     * @param {Body} body
+     */
+    virtual void addBody(Objects::Body* body) {};
+
+    /**
+     * Called by the world after many bodies have been added at once. Calls .addBody() for each of them unless a subclass can do better.
+     * @method addBodies
+     * @param {Array} bodies
+     */
+    virtual void addBodies(std::vector<Objects::Body*>* bodies);
+
+    /**
+     * Called by the world after a body has been removed from it. To be implemented by subclasses that keep their own body lists.
+     * @method removeBody
+     * @param {Body} body
+     */
+    virtual void removeBody(Objects::Body* body) {};
+
     /**
      * Check if the bounding spheres of two bodies overlap.
      * @method boundingSphereCheck
@@ -148,6 +255,20 @@ public:
         World::World* world,
         Collision::AABB* aabb,
         std::vector<Objects::Body*>* result);
+
+    /**
+     * Run many region queries at once. The bodies found by query i are stored in results, from offsets[i] to offsets[i + 1]. Both arrays are cleared first and keep their capacity, so reusing them across frames does not allocate. Uses .aabbQuery() on the bounds of each query, then checks the body AABBs against the exact query volume.
+     * @method queryBatch
+     * @param  {World} world
+     * @param  {Array} queries
+     * @param  {Array} results
+     * @param  {Array} offsets
+     */
+    void queryBatch(
+        World::World* world,
+        std::vector<BroadphaseQuery>* queries,
+        std::vector<Objects::Body*>* results,
+        std::vector<int>* offsets);
 };
 
 }
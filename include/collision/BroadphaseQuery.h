@@ -0,0 +1,141 @@
+#ifndef BroadphaseQuery_h
+#define BroadphaseQuery_h
+
+#include "collision/AABB.h"
+#include "math/Vec3.h"
+#include "math/Mat3.h"
+#include "math/Quaternion.h"
+
+namespace Cannon::Collision {
+
+/**
+ * Types of BroadphaseQuery.
+ * @static
+ * @property types
+ * @type {Object}
+ */
+enum BroadphaseQueryType {
+    AABB_QUERY = 1,
+    SPHERE_QUERY = 2,
+    BOX_QUERY = 4,
+    NEAREST_QUERY = 8
+};
+
+class BroadphaseQuery {
+private:
+    Math::Mat3 rotation_;
+
+public:
+    /**
+     * @property {Number} type
+     */
+    BroadphaseQueryType type = BroadphaseQueryType::AABB_QUERY;
+
+    /**
+     * The box of an AABB query. For the other types, the box around the query volume, set by .updateBounds().
+     * @property {AABB} aabb
+     */
+    AABB aabb;
+
+    /**
+     * Center of a sphere, box or nearest query.
+     * @property {Vec3} center
+     */
+    Math::Vec3 center;
+
+    /**
+     * Radius of a sphere query, or the max distance of a nearest query.
+     * @property {Number} radius
+     */
+    float radius = 0;
+
+    /**
+     * Half extents of a box query.
+     * @property {Vec3} halfExtents
+     */
+    Math::Vec3 halfExtents;
+
+    /**
+     * Orientation of a box query.
+     * @property {Quaternion} quaternion
+     */
+    Math::Quaternion quaternion;
+
+    /**
+     * Number of bodies to find in a nearest query.
+     * @property {Number} k
+     */
+    int k = 1;
+
+    /**
+     * A query volume for Broadphase.queryBatch().
+     * @class BroadphaseQuery
+     * @constructor
+     */
+    BroadphaseQuery() {};
+
+    /**
+     * Find the bodies whose AABB overlaps the given one.
+     * @method setAABB
+     * @param {AABB} aabb
+     * @return {BroadphaseQuery} The "this" object
+     */
+    BroadphaseQuery* setAABB(AABB* aabb);
+
+    /**
+     * Find the bodies whose AABB overlaps a sphere.
+     * @method setSphere
+     * @param {Vec3} center
+     * @param {Number} radius
+     * @return {BroadphaseQuery} The "this" object
+     */
+    BroadphaseQuery* setSphere(Math::Vec3* center, float radius);
+
+    /**
+     * Find the bodies whose AABB overlaps an oriented box.
+     * @method setBox
+     * @param {Vec3} center
+     * @param {Vec3} halfExtents
+     * @param {Quaternion} quaternion
+     * @return {BroadphaseQuery} The "this" object
+     */
+    BroadphaseQuery* setBox(Math::Vec3* center, Math::Vec3* halfExtents, Math::Quaternion* quaternion);
+
+    /**
+     * Find the k bodies whose AABB is closest to a point, and not further than maxDistance. The bodies are sorted by distance.
+     * @method setNearest
+     * @param {Vec3} center
+     * @param {Number} k
+     * @param {Number} maxDistance
+     * @return {BroadphaseQuery} The "this" object
+     */
+    BroadphaseQuery* setNearest(Math::Vec3* center, int k, float maxDistance);
+
+    /**
+     * Update .aabb to contain the query volume. Called by Broadphase.queryBatch().
+     * @method updateBounds
+     */
+    void updateBounds();
+
+    /**
+     * Check if the query volume overlaps a box. Must be called after .updateBounds().
+     * @method overlaps
+     * @param {AABB} aabb
+     * @return {Boolean}
+     */
+    bool overlaps(AABB* aabb);
+
+    /**
+     * Squared distance from a point to the closest point of a box. 0 if the point is inside.
+     * @static
+     * @method distanceSquared
+     * @param {Vec3} point
+     * @param {AABB} aabb
+     * @return {Number}
+     */
+    static float distanceSquared(Math::Vec3* point, AABB* aabb);
+};
+
+}
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef ContactManifoldCache_h
+#define ContactManifoldCache_h
+
+#include <vector>
+#include <unordered_map>
+#include "math/Vec3.h"
+
+namespace Cannon::Objects {
+    class Body;
+}
+
+namespace Cannon::Shapes {
+    class Shape;
+}
+
+namespace Cannon::Equations {
+    class ContactEquation;
+}
+
+namespace Cannon::Collision {
+
+/**
+ * @class ContactManifoldPoint
+ */
+struct ContactManifoldPoint {
+    /**
+     * The contact point relative to bodyA, in the local frame of bodyA.
+     * @property {Vec3} localPointA
+     */
+    Math::Vec3 localPointA;
+
+    /**
+     * The contact point relative to bodyB, in the local frame of bodyB.
+     * @property {Vec3} localPointB
+     */
+    Math::Vec3 localPointB;
+
+    /**
+     * The impulse the solver found for this point.
+     * @property {Number} lambda
+     */
+    double lambda = 0;
+
+    /**
+     * The last warm start in which the point was matched to an equation.
+     * @property {Number} stamp
+     */
+    int stamp = 0;
+};
+
+/**
+ * The contact points between two shapes of two bodies. bodyA always has the lower id.
+ * @class ContactManifold
+ */
+struct ContactManifold {
+    Objects::Body* bodyA = nullptr;
+    Objects::Body* bodyB = nullptr;
+    Shapes::Shape* shapeA = nullptr;
+    Shapes::Shape* shapeB = nullptr;
+
+    /**
+     * @property {Array} points
+     */
+    std::vector<ContactManifoldPoint> points;
+
+    /**
+     * The last update in which the manifold had contacts.
+     * @property {Number} stamp
+     */
+    int stamp = 0;
+};
+
+struct ContactManifoldKey {
+    long long bodies;
+    long long shapes;
+
+    bool operator==(const ContactManifoldKey& other) const {
+        return bodies == other.bodies && shapes == other.shapes;
+    }
+};
+
+struct ContactManifoldKeyHash {
+    size_t operator()(const ContactManifoldKey& key) const {
+        return std::hash<long long>()(key.bodies ^ (key.shapes * 0x9E3779B97F4A7C15LL));
+    }
+};
+
+class ContactManifoldCache {
+private:
+    std::unordered_map<ContactManifoldKey, int, ContactManifoldKeyHash> index_;
+    int stamp_ = 0;
+
+    int getManifoldIndex_(Equations::ContactEquation* c, bool create);
+
+public:
+    /**
+     * The manifolds of the shape pairs that were in contact in the last update.
+     * @property {Array} manifolds
+     */
+    std::vector<ContactManifold> manifolds;
+
+    /**
+     * How far, in the local frame of each body, a new contact can be from a cached point and still be matched to it.
+     * @property {Number} matchDistance
+     * @default 0.05
+     */
+    float matchDistance = 0.05;
+
+    /**
+     * Keeps the contact points of each shape pair across steps, so that the solver can start from the impulses of the last step. Call .warmStart() after the narrowphase and .update() after the solver.
+     * @class ContactManifoldCache
+     * @constructor
+     */
+    ContactManifoldCache() {};
+
+    /**
+     * Get the key of two shapes of two bodies, independent of their order.
+     * @static
+     * @method getKey
+     * @param {Body} bodyA
+     * @param {Shape} shapeA
+     * @param {Body} bodyB
+     * @param {Shape} shapeB
+     * @return {ContactManifoldKey}
+     */
+    static ContactManifoldKey getKey(Objects::Body* bodyA, Shapes::Shape* shapeA, Objects::Body* bodyB, Shapes::Shape* shapeB);
+
+    /**
+     * Set the lambda of each new contact equation to the impulse of the closest cached point of its shape pair, or to 0 if there is none within .matchDistance. Each cached point is used at most once.
+     * @method warmStart
+     * @param {Array} equations
+     */
+    void warmStart(std::vector<Equations::ContactEquation*>* equations);
+
+    /**
+     * Replace the cached points with the solved contact equations of this step, and drop the manifolds of shape pairs that are no longer in contact.
+     * @method update
+     * @param {Array} equations
+     */
+    void update(std::vector<Equations::ContactEquation*>* equations);
+
+    /**
+     * Get the manifold of two shapes of two bodies, in any order.
+     * @method getManifold
+     * @param {Body} bodyA
+     * @param {Shape} shapeA
+     * @param {Body} bodyB
+     * @param {Shape} shapeB
+     * @return {ContactManifold} The manifold, or null if the shapes were not in contact
+     */
+    ContactManifold* getManifold(Objects::Body* bodyA, Shapes::Shape* shapeA, Objects::Body* bodyB, Shapes::Shape* shapeB);
+
+    /**
+     * Remove all manifolds.
+     * @method reset
+     */
+    void reset();
+};
+
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef ContactReduction_h
+#define ContactReduction_h
+
+#include <vector>
+#include "math/Vec3.h"
+
+namespace Cannon::Collision {
+
+class ContactReduction {
+public:
+    /**
+     * The most contact points kept by .reduce().
+     * @static
+     * @property {Number} maxContacts
+     */
+    static constexpr int maxContacts = 4;
+
+    /**
+     * Pick at most 4 of the contact points of a shape pair. The deepest point is kept first, then the point furthest from it, then the point that makes the largest triangle with them, and last the point that adds the most area to that triangle. The area is measured in the contact plane.
+     * @static
+     * @method reduce
+     * @param {Array} points Contact points in world space.
+     * @param {Array} depths Penetration depth of each point, positive when penetrating.
+     * @param {Vec3} normal The contact normal.
+     * @param {Array} target The indices of the points to keep are written here.
+     */
+    static void reduce(
+        std::vector<Math::Vec3>* points,
+        std::vector<float>* depths,
+        Math::Vec3* normal,
+        std::vector<int>* target);
+};
+
+}
+
+#endif
@@ -0,0 +1,205 @@
+#ifndef GJK_h
+#define GJK_h
+
+#include <array>
+#include <vector>
+#include "math/Vec3.h"
+
+namespace Cannon::Math {
+    class Quaternion;
+}
+
+namespace Cannon::Shapes {
+    class Shape;
+}
+
+namespace Cannon::Collision {
+
+/**
+ * A point of the Minkowski difference A - B, and the points of A and B it was made from. All in world space.
+ * @class GJKVertex
+ */
+struct GJKVertex {
+    Math::Vec3 point;
+    Math::Vec3 pointA;
+    Math::Vec3 pointB;
+};
+
+/**
+ * @class GJKResult
+ */
+struct GJKResult {
+    /**
+     * Whether the shapes overlap.
+     * @property {Boolean} intersecting
+     */
+    bool intersecting = false;
+
+    /**
+     * Distance between the shapes, 0 if they overlap.
+     * @property {Number} distance
+     */
+    float distance = 0;
+
+    /**
+     * Penetration depth, set by .penetration() when the shapes overlap.
+     * @property {Number} depth
+     */
+    float depth = 0;
+
+    /**
+     * Unit vector pointing from shape A to shape B.
+     * @property {Vec3} normal
+     */
+    Math::Vec3 normal;
+
+    /**
+     * Closest point, or deepest point when overlapping, on shape A in world space.
+     * @property {Vec3} pointA
+     */
+    Math::Vec3 pointA;
+
+    /**
+     * Closest point, or deepest point when overlapping, on shape B in world space.
+     * @property {Vec3} pointB
+     */
+    Math::Vec3 pointB;
+
+    /**
+     * @property {Number} iterations
+     */
+    int iterations = 0;
+};
+
+/**
+ * A triangle of the EPA polytope, wound counter clockwise seen from outside.
+ * @class EPAFace
+ */
+struct EPAFace {
+    std::array<int, 3> vertices;
+    Math::Vec3 normal;
+    float distance;
+    bool removed;
+};
+
+class GJK {
+private:
+    Shapes::Shape* shapeA_;
+    Shapes::Shape* shapeB_;
+    Math::Vec3* posA_;
+    Math::Vec3* posB_;
+    Math::Quaternion* quatA_;
+    Math::Quaternion* quatB_;
+
+    // Last support vertex of each hull, to hill climb from on the next support query
+    int vertexHintA_ = 0;
+    int vertexHintB_ = 0;
+
+    std::array<GJKVertex, 4> simplex_;
+    std::array<float, 4> weights_;
+    int simplexSize_ = 0;
+
+    std::vector<GJKVertex> polytope_;
+    std::vector<EPAFace> faces_;
+    std::vector<std::array<int, 2>> horizon_;
+
+    void setShapes_(
+        Shapes::Shape* shapeA,
+        Math::Vec3* posA,
+        Math::Quaternion* quatA,
+        Shapes::Shape* shapeB,
+        Math::Vec3* posB,
+        Math::Quaternion* quatB);
+    void shapeSupport_(Shapes::Shape* shape, Math::Vec3* direction, Math::Vec3* target, int* vertexHint);
+    void support_(Math::Vec3* direction, GJKVertex* target);
+    bool closestPoint_(Math::Vec3* target);
+    void closestOnSegment_(int a, int b, std::array<float, 4>* weights);
+    void closestOnTriangle_(int a, int b, int c, std::array<float, 4>* weights);
+    bool closestOnTetrahedron_(std::array<float, 4>* weights);
+    void reduceSimplex_(std::array<float, 4>* weights, Math::Vec3* target);
+    bool runGJK_(GJKResult* result);
+    bool fillSimplex_();
+    void addFace_(int a, int b, int c);
+    void addHorizonEdge_(int a, int b);
+    bool runEPA_(GJKResult* result);
+
+public:
+    /**
+     * @property {Number} maxIterations
+     * @default 32
+     */
+    int maxIterations = 32;
+
+    /**
+     * Relative tolerance on the distance when GJK stops.
+     * @property {Number} tolerance
+     * @default 1e-5
+     */
+    float tolerance = 1e-5;
+
+    /**
+     * @property {Number} maxEPAIterations
+     * @default 64
+     */
+    int maxEPAIterations = 64;
+
+    /**
+     * Absolute tolerance on the penetration depth when EPA stops.
+     * @property {Number} epaTolerance
+     * @default 1e-4
+     */
+    float epaTolerance = 1e-4;
+
+    /**
+     * Distance and penetration queries between two convex shapes, using only their support points. GJK finds the closest points of separated shapes, and EPA the penetration depth and normal of overlapping ones. Scratch data is kept in the instance, so use one instance per thread.
+     * @class GJK
+     * @constructor
+     */
+    GJK() {};
+
+    /**
+     * Get the distance and closest points between two convex shapes.
+     * @method distance
+     * @param {Shape} shapeA
+     * @param {Vec3} posA
+     * @param {Quaternion} quatA
+     * @param {Shape} shapeB
+     * @param {Vec3} posB
+     * @param {Quaternion} quatB
+     * @param {GJKResult} result
+     * @return {Boolean} True if the shapes are separated. Only .intersecting is set otherwise.
+     */
+    bool distance(
+        Shapes::Shape* shapeA,
+        Math::Vec3* posA,
+        Math::Quaternion* quatA,
+        Shapes::Shape* shapeB,
+        Math::Vec3* posB,
+        Math::Quaternion* quatB,
+        GJKResult* result);
+
+    /**
+     * Get the penetration depth, normal and deepest points of two overlapping convex shapes.
+     * @method penetration
+     * @param {Shape} shapeA
+     * @param {Vec3} posA
+     * @param {Quaternion} quatA
+     * @param {Shape} shapeB
+     * @param {Vec3} posB
+     * @param {Quaternion} quatB
+     * @param {GJKResult} result
+     * @return {Boolean} True if the shapes overlap. If not, the result holds the distance and closest points instead.
+     */
+    bool penetration(
+        Shapes::Shape* shapeA,
+        Math::Vec3* posA,
+        Math::Quaternion* quatA,
+        Shapes::Shape* shapeB,
+        Math::Vec3* posB,
+        Math::Quaternion* quatB,
+        GJKResult* result);
+};
+
+}
+
+#endif
@@ -0,0 +1,255 @@
+#ifndef GridBroadphase_h
+#define GridBroadphase_h
+
+#include <vector>
+#include "collision/Broadphase.h"
+#include "math/Vec3.h"
+
+namespace Cannon::World {
+    class World;
+}
+
+namespace Cannon::Objects {
+    class Body;
+}
+
+namespace Cannon::Collision {
+
+/**
+ * One level of the hashed grid. Entries are sorted by hash bucket, so the entries of bucket b are entryBody[cellStart[b]] to entryBody[cellStart[b + 1] - 1].
+ * @class GridBroadphaseLevel
+ */
+struct GridBroadphaseLevel {
+    /**
+     * @property {Vec3} cellSize
+     */
+    Math::Vec3 cellSize;
+
+    /**
+     * Number of hash buckets, always a power of two.
+     * @property {Number} tableSize
+     */
+    int tableSize = 0;
+
+    std::vector<int> cellStart;
+    std::vector<int> entryBody;
+    std::vector<int> entryX;
+    std::vector<int> entryY;
+    std::vector<int> entryZ;
+
+    /**
+     * Lowest cell of each body on this level. A pair is only reported in the lowest cell that both bodies cover, so that it is reported once.
+     */
+    std::vector<int> bodyMinX;
+    std::vector<int> bodyMinY;
+    std::vector<int> bodyMinZ;
+};
+
+class GridBroadphase : public Collision::Broadphase {
+private:
+    /**
+     * Level of each body: 0 for the first level, 1 for the second level and -1 for the global list.
+     * @private
+     * @property {Array} bodyLevel_
+     */
+    std::vector<int> bodyLevel_;
+
+    /**
+     * Query stamp of each body, used to skip bodies already reported by aabbQuery.
+     * @private
+     * @property {Array} queryStamp_
+     */
+    std::vector<int> queryStamp_;
+    int queryCounter_ = 0;
+
+    std::vector<int> bucket_;
+    std::vector<int> cursor_;
+    std::vector<int> unsortedBody_;
+    std::vector<int> unsortedX_;
+    std::vector<int> unsortedY_;
+    std::vector<int> unsortedZ_;
+
+    void updateGrid_();
+    void buildLevel_(GridBroadphaseLevel* level, bool includeSmall, bool includeLarge);
+    void levelPairs_(
+        GridBroadphaseLevel* level,
+        bool requireLarge,
+        std::vector<Objects::Body*>* pairs1,
+        std::vector<Objects::Body*>* pairs2);
+    void queryLevel_(
+        GridBroadphaseLevel* level,
+        bool onlyLarge,
+        Collision::AABB* aabb,
+        std::vector<Objects::Body*>* result);
+
+public:
+    /**
+     * Lower corner of the world region that the grid is fitted to.
+     * @property {Vec3} aabbMin
+     */
+    Math::Vec3 aabbMin;
+
+    /**
+     * Upper corner of the world region that the grid is fitted to.
+     * @property {Vec3} aabbMax
+     */
+    Math::Vec3 aabbMax;
+
+    /**
+     * Number of cells along x. The cell size is (aabbMax - aabbMin) / n, bodies outside the region still go in hashed cells.
+     * @property {Number} nx
+     */
+    int nx;
+
+    /**
+     * @property {Number} ny
+     */
+    int ny;
+
+    /**
+     * @property {Number} nz
+     */
+    int nz;
+
+    /**
+     * Put bodies that are larger than a cell on a second level with larger cells, instead of adding them to every small cell that they cover.
+     * @property {Boolean} useSecondLevel
+     * @default true
+     */
+    bool useSecondLevel = true;
+
+    /**
+     * Size of the second level cells, relative to the first level ones.
+     * @property {Number} secondLevelScale
+     * @default 8
+     */
+    float secondLevelScale = 8;
+
+    /**
+     * Bodies that cover more cells than this on their level are tested against all other bodies instead of being put in cells.
+     * @property {Number} maxCellsPerBody
+     * @default 512
+     */
+    int maxCellsPerBody = 512;
+
+    /**
+     * The bodies in the broadphase.
+     * @property {Array} bodies
+     */
+    std::vector<Objects::Body*> bodies;
+
+    /**
+     * Indices of the bodies that are not put in cells, such as planes. They are tested against all other bodies.
+     * @property {Array} globalBodies
+     */
+    std::vector<int> globalBodies;
+
+    /**
+     * @property {GridBroadphaseLevel} level1
+     */
+    GridBroadphaseLevel level1;
+
+    /**
+     * @property {GridBroadphaseLevel} level2
+     */
+    GridBroadphaseLevel level2;
+
+    /**
+     * Axis aligned uniform grid broadphase. The cells are hashed, so the grid is not limited to the given region.
+     * @class GridBroadphase
+     * @constructor
+     * @param {Vec3} aabbMin
+     * @param {Vec3} aabbMax
+     * @param {Number} nx Number of boxes along x
+     * @param {Number} ny Number of boxes along y
+     * @param {Number} nz Number of boxes along z
+     * @extends Broadphase
+     */
+    GridBroadphase(
+        Math::Vec3* aabbMin = nullptr,
+        Math::Vec3* aabbMax = nullptr,
+        int nx = 10,
+        int ny = 10,
+        int nz = 10);
+
+    /**
+     * Get the cell coordinate of a position along one axis.
+     * @static
+     * @method cellCoord
+     * @param  {Number} x
+     * @param  {Number} origin
+     * @param  {Number} size
+     * @return {Number}
+     */
+    static int cellCoord(float x, float origin, float size);
+
+    /**
+     * Hash a cell. The result has to be masked with the table size.
+     * @static
+     * @method hash
+     * @param  {Number} x
+     * @param  {Number} y
+     * @param  {Number} z
+     * @return {Number}
+     */
+    static int hash(int x, int y, int z);
+
+    /**
+     * Fit the grid to a new region.
+     * @method setBounds
+     * @param {Vec3} aabbMin
+     * @param {Vec3} aabbMax
+     * @param {Number} nx
+     * @param {Number} ny
+     * @param {Number} nz
+     */
+    void setBounds(Math::Vec3* aabbMin, Math::Vec3* aabbMax, int nx, int ny, int nz);
+
+    /**
+     * Change the world
+     * @method setWorld
+     * @param  {World} world
+     */
+    void setWorld(World::World* world);
+
+    /**
+     * @method addBody
+     * @param {Body} body
+     */
+    void addBody(Objects::Body* body);
+
+    /**
+     * @method removeBody
+     * @param {Body} body
+     */
+    void removeBody(Objects::Body* body);
+
+    /**
+     * Get all the collision pairs in the physics world
+     * @method collisionPairs
+     * @param {World} world
+     * @param {Array} pairs1
+     * @param {Array} pairs2
+     */
+    void collisionPairs(
+        World::World* world,
+        std::vector<Objects::Body*>* pairs1,
+        std::vector<Objects::Body*>* pairs2);
+
+    /**
+     * Returns all the bodies within an AABB.
+     * @method aabbQuery
+     * @param  {World} world
+     * @param  {AABB} aabb
+     * @param {array} result An array to store resulting bodies in.
+     * @return {array}
+     */
+    std::vector<Objects::Body*>* aabbQuery(
+        World::World* world,
+        Collision::AABB* aabb,
+        std::vector<Objects::Body*>* result);
+};
+
+}
+
+#endif
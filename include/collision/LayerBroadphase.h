@@ -0,0 +1,185 @@
+#ifndef LayerBroadphase_h
+#define LayerBroadphase_h
+
+#include <vector>
+#include "collision/Broadphase.h"
+#include "utils/AABBTree.h"
+
+namespace Cannon::World {
+    class World;
+}
+
+namespace Cannon::Objects {
+    class Body;
+}
+
+namespace Cannon::Math {
+    class Vec3;
+}
+
+namespace Cannon::Collision {
+
+/**
+ * The bodies of a LayerBroadphase that share the same collision filter group and mask.
+ * @class BroadphaseLayer
+ */
+struct BroadphaseLayer {
+    /**
+     * @property {Number} collisionFilterGroup
+     */
+    int collisionFilterGroup = 1;
+
+    /**
+     * @property {Number} collisionFilterMask
+     */
+    int collisionFilterMask = -1;
+
+    /**
+     * Dynamic and kinematic bodies that are awake.
+     * @property {AABBTree} dynamicTree
+     */
+    Utils::AABBTree dynamicTree;
+
+    /**
+     * Static and sleeping bodies.
+     * @property {AABBTree} staticTree
+     */
+    Utils::AABBTree staticTree;
+
+    /**
+     * Number of bodies in the layer.
+     * @property {Number} bodyCount
+     */
+    int bodyCount = 0;
+};
+
+class LayerBroadphase : public Collision::Broadphase {
+private:
+    std::vector<int> proxyIds_;
+    std::vector<int> layerIds_;
+    std::vector<char> inStaticTree_;
+
+    /**
+     * The pairs of different layers that can collide, lower layer index first
+     * @private
+     * @property {Array} layerPairs1_
+     */
+    std::vector<int> layerPairs1_;
+    std::vector<int> layerPairs2_;
+    bool layersChanged_ = false;
+
+    std::vector<int> pairs1_;
+    std::vector<int> pairs2_;
+    std::vector<int> queryResult_;
+
+    int getLayer_(int collisionFilterGroup, int collisionFilterMask);
+    void updateLayerPairs_();
+    void updateProxies_();
+    void createProxy_(int index);
+    void destroyProxy_(int index);
+    void queryTrees_(Utils::AABBTree* a, Utils::AABBTree* b, std::vector<Objects::Body*>* p1, std::vector<Objects::Body*>* p2);
+
+public:
+    /**
+     * The bodies in the broadphase. The user data of each tree leaf is the index of its body in this list.
+     * @property {Array} bodies
+     */
+    std::vector<Objects::Body*> bodies;
+
+    /**
+     * One layer per distinct collision filter group and mask. Layers are created as needed and never removed.
+     * @property {Array} layers
+     */
+    std::vector<BroadphaseLayer*> layers;
+
+    /**
+     * Check if the bodies of two layers can collide, according to their collision filters.
+     * @static
+     * @method layersCollide
+     * @param  {BroadphaseLayer} layerA
+     * @param  {BroadphaseLayer} layerB
+     * @return {Boolean}
+     */
+    static bool layersCollide(BroadphaseLayer* layerA, BroadphaseLayer* layerB);
+
+    /**
+     * Broadphase that splits the bodies into layers by collision filter group and mask, with a dynamic and a static AABB tree per layer. Only the layers that can collide are traversed against each other, so the collision filters are never checked per pair.
+     * @class LayerBroadphase
+     * @constructor
+     * @extends Broadphase
+     */
+    LayerBroadphase() {};
+
+    /**
+     * @class LayerBroadphase
+     * @constructor
+     * @param {World} [world]
+     * @extends Broadphase
+     */
+    LayerBroadphase(World::World* world);
+
+    ~LayerBroadphase();
+
+    /**
+     * Change the world
+     * @method setWorld
+     * @param  {World} world
+     */
+    void setWorld(World::World* world);
+
+    /**
+     * Add a body to the tree of its layer.
+     * @method addBody
+     * @param {Body} body
+     */
+    void addBody(Objects::Body* body);
+
+    /**
+     * Remove a body from its layer.
+     * @method removeBody
+     * @param {Body} body
+     */
+    void removeBody(Objects::Body* body);
+
+    /**
+     * Get all the collision pairs in the physics world
+     * @method collisionPairs
+     * @param {World} world
+     * @param {Array} p1
+     * @param {Array} p2
+     */
+    void collisionPairs(
+        World::World* world,
+        std::vector<Objects::Body*>* p1,
+        std::vector<Objects::Body*>* p2);
+
+    /**
+     * Returns all the bodies within an AABB.
+     * @method aabbQuery
+     * @param  {World} world
+     * @param  {AABB} aabb
+     * @param {array} result An array to store resulting bodies in.
+     * @return {array}
+     */
+    std::vector<Objects::Body*>* aabbQuery(
+        World::World* world,
+        Collision::AABB* aabb,
+        std::vector<Objects::Body*>* result);
+
+    /**
+     * Returns all the bodies whose AABB is hit by the line segment between from and to.
+     * @method rayQuery
+     * @param  {Vec3} from
+     * @param  {Vec3} to
+     * @param {array} result An array to store resulting bodies in.
+     * @return {array}
+     */
+    std::vector<Objects::Body*>* rayQuery(
+        Math::Vec3* from,
+        Math::Vec3* to,
+        std::vector<Objects::Body*>* result);
+};
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef PairCache_h
+#define PairCache_h
+
+#include <vector>
+#include <unordered_map>
+
+namespace Cannon::Objects {
+    class Body;
+}
+
+namespace Cannon::Collision {
+
+class PairCache {
+private:
+    /**
+     * Index of each pair in .pairs1/.pairs2, by pair key.
+     * @private
+     * @property {Object} index_
+     */
+    std::unordered_map<long long, int> index_;
+
+    /**
+     * The update in which each pair was last reported.
+     * @private
+     * @property {Array} stamps_
+     */
+    std::vector<int> stamps_;
+
+    int stamp_ = 0;
+
+public:
+    /**
+     * The pairs that currently overlap. The body with the lowest id is always in pairs1.
+     * @property {Array} pairs1
+     */
+    std::vector<Objects::Body*> pairs1;
+
+    /**
+     * @property {Array} pairs2
+     */
+    std::vector<Objects::Body*> pairs2;
+
+    /**
+     * Pairs that started overlapping in the last update.
+     * @property {Array} added1
+     */
+    std::vector<Objects::Body*> added1;
+
+    /**
+     * @property {Array} added2
+     */
+    std::vector<Objects::Body*> added2;
+
+    /**
+     * Pairs that stopped overlapping in the last update.
+     * @property {Array} removed1
+     */
+    std::vector<Objects::Body*> removed1;
+
+    /**
+     * @property {Array} removed2
+     */
+    std::vector<Objects::Body*> removed2;
+
+    /**
+     * Persistent set of overlapping body pairs. Each update, the broadphase reports the pairs that overlap, and the cache works out which pairs were added and removed since the previous update.
+     * @class PairCache
+     * @constructor
+     */
+    PairCache() {};
+
+    /**
+     * Get the key of a pair, independent of the order of the bodies.
+     * @static
+     * @method getKey
+     * @param  {Body} bodyA
+     * @param  {Body} bodyB
+     * @return {Number}
+     */
+    static long long getKey(Objects::Body* bodyA, Objects::Body* bodyB);
+
+    /**
+     * Start a new update. Clears the added and removed lists.
+     * @method beginUpdate
+     */
+    void beginUpdate();
+
+    /**
+     * Report an overlapping pair. Reporting the same pair again in the same update does nothing.
+     * @method addPair
+     * @param  {Body} bodyA
+     * @param  {Body} bodyB
+     * @return {Boolean} True if the pair is new
+     */
+    bool addPair(Objects::Body* bodyA, Objects::Body* bodyB);
+
+    /**
+     * Finish the update. Pairs that were not reported since .beginUpdate() are moved to the removed lists.
+     * @method endUpdate
+     */
+    void endUpdate();
+
+    /**
+     * @method has
+     * @param  {Body} bodyA
+     * @param  {Body} bodyB
+     * @return {Boolean}
+     */
+    bool has(Objects::Body* bodyA, Objects::Body* bodyB);
+
+    /**
+     * Remove all pairs without reporting them as removed.
+     * @method reset
+     */
+    void reset();
+};
+
+}
+
+#endif
@@ -247,7 +247,7 @@ public:
      * @param  {Body} body
      * @param {object} [options]
      * @todo Optimize by transforming the world to local space first.
-     * @todo Use Octree lookup
+     * @todo Look the triangles up with Trimesh.trianglesOnSegment()
      */
     void intersectTrimesh(
         Shapes::Shape* mesh,
@@ -0,0 +1,164 @@
+#ifndef SAPBroadphase_h
+#define SAPBroadphase_h
+
+#include "collision/Broadphase.h"
+#include "collision/AABBArray.h"
+
+namespace Cannon::World {
+    class World;
+}
+
+namespace Cannon::Objects {
+    class Body;
+}
+
+namespace Cannon::Collision {
+
+class SAPBroadphase : public Collision::Broadphase {
+private:
+    /**
+     * Set when bodies were added or removed, so that the sort axis is detected again on the next sort.
+     * @private
+     * @property {Boolean} axisListChanged_
+     */
+    bool axisListChanged_ = false;
+
+public:
+    /**
+     * List of bodies currently in the broadphase, sorted along the current axis.
+     * @property axisList
+     * @type {Array}
+     */
+    std::vector<Objects::Body*> axisList;
+
+    /**
+     * Axis to sort the bodies along. Set to 0 for x axis, 1 for y axis and 2 for z axis. For best performance, choose an axis that the bodies are spread out more on.
+     * @property axisIndex
+     * @type {Number}
+     */
+    int axisIndex = 0;
+
+    /**
+     * Packed copy of the bounds of the bodies in .axisList, in the same order. Synced by .sortList().
+     * @property aabbs
+     * @type {AABBArray}
+     */
+    AABBArray aabbs;
+
+    /**
+     * Sweep and prune broadphase along one axis.
+     *
+     * The axis list is kept between steps and re-sorted with insertion sort, which is close to linear when the bodies only move a little per step.
+     *
+     * @class SAPBroadphase
+     * @constructor
+     * @extends Broadphase
+     */
+    SAPBroadphase() {};
+
+    /**
+     * @class SAPBroadphase
+     * @constructor
+     * @param {World} [world]
+     * @extends Broadphase
+     */
+    SAPBroadphase(World::World* world);
+
+    /**
+     * Change the world
+     * @method setWorld
+     * @param  {World} world
+     */
+    void setWorld(World::World* world);
+
+    /**
+     * Add a body to the axis list. The list is re-sorted on the next step.
+     * @method addBody
+     * @param {Body} body
+     */
+    void addBody(Objects::Body* body);
+
+    /**
+     * Remove a body from the axis list.
+     * @method removeBody
+     * @param {Body} body
+     */
+    void removeBody(Objects::Body* body);
+
+    /**
+     * @static
+     * @method insertionSortX
+     * @param  {Array} a
+     * @return {Array}
+     */
+    static std::vector<Objects::Body*>* insertionSortX(std::vector<Objects::Body*>* a);
+
+    /**
+     * @static
+     * @method insertionSortY
+     * @param  {Array} a
+     * @return {Array}
+     */
+    static std::vector<Objects::Body*>* insertionSortY(std::vector<Objects::Body*>* a);
+
+    /**
+     * @static
+     * @method insertionSortZ
+     * @param  {Array} a
+     * @return {Array}
+     */
+    static std::vector<Objects::Body*>* insertionSortZ(std::vector<Objects::Body*>* a);
+
+    /**
+     * Check if the bounds of two bodies overlap, along the given SAP axis. Assumes bi comes before bj in the sorted axis list.
+     * @static
+     * @method checkBounds
+     * @param  {Body} bi
+     * @param  {Body} bj
+     * @param  {Number} axisIndex
+     * @return {Boolean}
+     */
+    static bool checkBounds(Objects::Body* bi, Objects::Body* bj, int axisIndex);
+
+    /**
+     * Collect all collision pairs
+     * @method collisionPairs
+     * @param  {World} world
+     * @param  {Array} p1
+     * @param  {Array} p2
+     */
+    void collisionPairs(
+        World::World* world,
+        std::vector<Objects::Body*>* p1,
+        std::vector<Objects::Body*>* p2);
+
+    /**
+     * Update the AABBs of the bodies and sort the axis list. If bodies were added or removed since the last sort, the axis is detected again first. Then copies the sorted bounds to .aabbs.
+     * @method sortList
+     */
+    void sortList();
+
+    /**
+     * Computes the variance of the body positions and estimates the best
+     * axis to use. Will automatically set property .axisIndex.
+     * @method autoDetectAxis
+     */
+    void autoDetectAxis();
+
+    /**
+     * Returns all the bodies within an AABB.
+     * @method aabbQuery
+     * @param  {World} world
+     * @param  {AABB} aabb
+     * @param {array} result An array to store resulting bodies in.
+     * @return {array}
+     */
+    std::vector<Objects::Body*>* aabbQuery(
+        World::World* world,
+        Collision::AABB* aabb,
+        std::vector<Objects::Body*>* result);
+};
+
+}
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef SeparatingAxisCache_h
+#define SeparatingAxisCache_h
+
+#include <array>
+#include <unordered_map>
+#include <vector>
+#include "math/Vec3.h"
+
+namespace Cannon::Math {
+    class Quaternion;
+}
+
+namespace Cannon::Shapes {
+    class Shape;
+}
+
+namespace Cannon::Collision {
+
+/**
+ * @class SeparatingAxisCacheEntry
+ */
+struct SeparatingAxisCacheEntry {
+    /**
+     * The separating axis, in the local frame of the shape with the lower id.
+     * @property {Vec3} axis
+     */
+    Math::Vec3 axis;
+
+    /**
+     * The max and min vertex of each shape along the axis, first those of the shape with the lower id. Hill climbing hulls start from them the next time, see ConvexPolyhedron.getExtremeVertex().
+     * @property {Array} vertexHints
+     */
+    std::array<int, 4> vertexHints = {{ 0, 0, 0, 0 }};
+
+    /**
+     * The last update in which the entry was used.
+     * @property {Number} stamp
+     */
+    int stamp = 0;
+};
+
+class SeparatingAxisCache {
+private:
+    // A change recorded for .source_, the axis is in the same frame as in an entry
+    enum ChangeType { AXIS_USED, AXIS_SET, AXIS_REMOVED };
+    struct Change {
+        long long key;
+        ChangeType type;
+        Math::Vec3 axis;
+        std::array<int, 4> vertexHints;
+    };
+
+    std::unordered_map<long long, SeparatingAxisCacheEntry> entries_;
+    int stamp_ = 0;
+
+    SeparatingAxisCache* source_ = nullptr;
+    std::vector<Change> changes_;
+
+public:
+    /**
+     * Remembers the axis that last separated each pair of convex shapes, so that the next separating axis test can try it first. Pairs usually stay separated by the same axis for many steps.
+     * @class SeparatingAxisCache
+     * @constructor
+     */
+    SeparatingAxisCache() {};
+
+    /**
+     * Get the key of a shape pair, independent of the order of the shapes.
+     * @static
+     * @method getKey
+     * @param {Shape} shapeA
+     * @param {Shape} shapeB
+     * @return {Number}
+     */
+    static long long getKey(Shapes::Shape* shapeA, Shapes::Shape* shapeB);
+
+    /**
+     * Get the last separating axis of two shapes, in world space.
+     * @method getAxis
+     * @param {Shape} shapeA
+     * @param {Quaternion} quatA
+     * @param {Shape} shapeB
+     * @param {Quaternion} quatB
+     * @param {Vec3} target
+     * @param {Array} [vertexHints] Set to the vertex hints of the pair, those of shapeA first
+     * @return {Boolean} False if the pair has no cached axis
+     */
+    bool getAxis(
+        Shapes::Shape* shapeA,
+        Math::Quaternion* quatA,
+        Shapes::Shape* shapeB,
+        Math::Quaternion* quatB,
+        Math::Vec3* target,
+        std::array<int, 4>* vertexHints = nullptr);
+
+    /**
+     * Store the world space axis that separates two shapes.
+     * @method setAxis
+     * @param {Shape} shapeA
+     * @param {Quaternion} quatA
+     * @param {Shape} shapeB
+     * @param {Quaternion} quatB
+     * @param {Vec3} axis
+     * @param {Array} [vertexHints] The max and min vertex of shapeA and then shapeB along the axis
+     */
+    void setAxis(
+        Shapes::Shape* shapeA,
+        Math::Quaternion* quatA,
+        Shapes::Shape* shapeB,
+        Math::Quaternion* quatB,
+        Math::Vec3* axis,
+        std::array<int, 4>* vertexHints = nullptr);
+
+    /**
+     * Forget the axis of two shapes, e.g. when they overlap.
+     * @method removeAxis
+     * @param {Shape} shapeA
+     * @param {Shape} shapeB
+     */
+    void removeAxis(Shapes::Shape* shapeA, Shapes::Shape* shapeB);
+
+    /**
+     * Drop the entries that were not used since the last update. Call once per step.
+     * @method update
+     */
+    void update();
+
+    /**
+     * Read the axes from another cache, and record the changes instead of making them, until .flush(). Several threads can each use such a cache on the same source, as long as the source does not change meanwhile. Pass null to use this cache again.
+     * @method setSource
+     * @param {SeparatingAxisCache} source
+     */
+    void setSource(SeparatingAxisCache* source);
+
+    /**
+     * Make the recorded changes to the source, in the order they were recorded, and forget them.
+     * @method flush
+     */
+    void flush();
+
+    /**
+     * Get the number of cached pairs.
+     * @method size
+     * @return {Number}
+     */
+    int size();
+
+    /**
+     * @method reset
+     */
+    void reset();
+};
+
+}
+
+#endif
@@ -1,7 +1,8 @@
 #ifndef ContactEquation_h
 #define ContactEquation_h
 
-#include "Equation.h"
+#include "equations/Equation.h"
+#include "math/Vec3.h"
 
 namespace Cannon::Objects {
     class Body;
@@ -21,13 +22,13 @@ public:
      * @property si
      * @type {Shape}
      */
-    Shapes::Shape* si;
+    Shapes::Shape* si = nullptr;
 
     /**
      * @property sj
      * @type {Shape}
      */
-    Shapes::Shape* sj;
+    Shapes::Shape* sj = nullptr;
     
     /**
      * @property restitution
@@ -35,6 +36,14 @@ public:
      */
     double restitution = 0.0; // "bounciness": u1 = -e*u0
 
+    /**
+     * Set for contacts between shapes that are still apart, made by the Narrowphase for bodies with Body.ccd. Instead of the spook stabilization, the bias is the gap over the time step, so the shapes may close the gap within the step but no more. Restitution is not applied.
+     * @property speculative
+     * @type {Boolean}
+     * @default false
+     */
+    bool speculative = false;
+
     /**
      * World-oriented vector that goes from the center of bi to the contact point.
      * @property {Vec3} ri
@@ -60,13 +69,24 @@ public:
      * @author schteppe
      * @param {Body} bodyA
      * @param {Body} bodyB
+     * @param {Number} [maxForce]
      * @extends Equation
      */
-    ContactEquation(Objects::Body* bodyA, Objects::Body* bodyB, double maxForce)
+    ContactEquation(Objects::Body* bodyA, Objects::Body* bodyB, double maxForce = 1e6)
         : Equations::Equation(bodyA, bodyB, 0, maxForce) {};
 
-    double computeB(double h);
+    /**
+     * @method computeB
+     * @param  {Number} h
+     * @return {Number}
+     */
+    double computeB(double h) override;
 
+    /**
+     * Get the current relative velocity in the contact point.
+     * @method getImpactVelocityAlongNormal
+     * @return {number}
+     */
     double getImpactVelocityAlongNormal();
 };
 
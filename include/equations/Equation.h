@@ -1,6 +1,7 @@
 #ifndef Equation_h
 #define Equation_h
 
+#include <atomic>
 #include "math/JacobianElement.h"
 
 namespace Cannon::Objects {
@@ -11,7 +12,7 @@ namespace Cannon::Equations {
     
 class Equation {
 public:
-    static int idCounter;
+    static std::atomic<int> idCounter;
 
     /**
      * ContactMaterial id.
@@ -81,7 +82,13 @@ public:
      * @property {number} multiplier
      * @readonly
      */
-    int multiplier = 0;
+    double multiplier = 0;
+
+    /**
+     * The impulse found by the last solve. The solver starts from it when warm starting, so set it to 0 for new equations, or to the impulse of the matching equation of the last step.
+     * @property {number} lambda
+     */
+    double lambda = 0;
 
     /**
      * Equation base class
@@ -105,6 +112,8 @@ public:
      */
     Equation(Objects::Body* bi, Objects::Body* bj, double minForce, double maxForce);
 
+    virtual ~Equation() {};
+
     /**
      * Recalculates a,b,eps.
      * @method setSpookParams
@@ -118,6 +127,14 @@ public:
      */
     double computeB(double a, double b, double h);
 
+    /**
+     * Computes the RHS of the SPOOK equation with the a and b of this equation. To be implemented by subclasses.
+     * @method computeB
+     * @param  {Number} h
+     * @return {Number}
+     */
+    virtual double computeB(double h);
+
     /**
      * Computes G*q, where q are the generalized body coordinates
      * @method computeGq
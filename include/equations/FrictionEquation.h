@@ -30,6 +30,8 @@ public:
         : Equations::Equation(bodyA, bodyB, -slipForce, slipForce) {};
 
     double computeB(double h);
+};
+
 }
 
 #endif
@@ -70,8 +70,6 @@ public:
     ContactMaterial(Material* m1, Material* m2): materials({m1, m2}){ id = ContactMaterial::idCounter++; };
 };
 
-int ContactMaterial::idCounter = 0;
-
 }
 
 #endif
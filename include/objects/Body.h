@@ -7,6 +7,7 @@
 #include "math/Mat3.h"
 #include "math/Quaternion.h"
 #include "collision/AABB.h"
+#include "utils/AABBTree.h"
 #include "material/Material.h"
 #include "utils/EventTarget.h"
 
@@ -20,6 +21,8 @@ namespace Cannon::Shapes {
 
 namespace Cannon::Objects {
 
+class Body;
+
 struct BodyEvent : public Utils::Event {
     Body* body;
     BodyEvent(std::string type, Body* body) : Utils::Event(type), body(body) {}
@@ -304,6 +307,20 @@ public:
      */
     std::vector<Math::Quaternion> shapeOrientations;
 
+    /**
+     * Tree over the AABBs of the shapes, in local Body space. The Narrowphase uses it to only test the shapes of a body with many shapes that overlap the other body.
+     * @property shapeTree
+     * @type {AABBTree}
+     */
+    Utils::AABBTree shapeTree;
+
+    /**
+     * Indicates if the .shapeTree needs to be rebuilt before use.
+     * @property shapeTreeNeedsUpdate
+     * @type {Boolean}
+     */
+    bool shapeTreeNeedsUpdate;
+
     /**
      * @property inertia
      * @type {Vec3}
@@ -377,6 +394,22 @@ public:
      */
     bool aabbNeedsUpdate;
 
+    /**
+     * Fast body, kept from tunnelling through thin shapes. Its .aabb also covers the motion over the next .ccdTimeStep, and the Narrowphase makes speculative contacts between it and the shapes it is closing in on.
+     * @property ccd
+     * @type {Boolean}
+     * @default false
+     */
+    bool ccd;
+
+    /**
+     * The time step that the motion of a .ccd body is predicted over, usually World.dt.
+     * @property ccdTimeStep
+     * @type {Number}
+     * @default 1/60
+     */
+    float ccdTimeStep;
+
     /**
      * Total bounding radius of the Body including its shapes, relative to body.position.
      * @property boundingRadius
@@ -392,10 +425,22 @@ public:
     bool hasTrigger;
 
     /**
+     * Base class for all body types.
+     * @class Body
      * @constructor
+     * @extends EventTarget
      */
     Body();
 
+    /**
+     * Base class for all body types.
+     * @class Body
+     * @constructor
+     * @extends EventTarget
+     * @param {Number} mass Bodies with zero mass are static.
+     */
+    Body(float mass);
+
     /**
      * Wake the body up.
      * @method wakeUp
@@ -465,7 +510,7 @@ public:
      * @param {Quaternion} [_orientation]
      * @return {Body} The body object, for chainability.
      */
-    Body addShape(Shapes::Shape* shape, Math::Vec3 _offset, Math::Quaternion _orientation);
+    Body* addShape(Shapes::Shape* shape, Math::Vec3* _offset, Math::Quaternion* _orientation);
 
     /**
      * Remove a shape from the body
@@ -479,7 +524,13 @@ public:
     void updateBoundingRadius();
 
     /**
-     * Updates the .aabb
+     * Rebuild the .shapeTree from the shapes and their local offsets and orientations.
+     * @method updateShapeTree
+     */
+    void updateShapeTree();
+
+    /**
+     * Updates the .aabb. For a .ccd body, the box is stretched along .velocity over .ccdTimeStep.
      * @method computeAABB
      * @todo rename to updateAABB()
      */
@@ -58,7 +58,7 @@ public:
      */
     void calculateLocalInertia(float mass, Math::Vec3* target);
 
-    void calculateInertia(Math::Vec3* halfExtents, float mass, Math::Vec3* target);
+    static void calculateInertia(Math::Vec3* halfExtents, float mass, Math::Vec3* target);
 
     /**
      * Get the box 6 side normals
@@ -78,6 +78,9 @@ public:
     void forEachWorldCorner(Math::Vec3* pos, Math::Quaternion* quat, CornerCallback callback);
 
     void calculateWorldAABB(Math::Vec3* pos, Math::Quaternion* quat, Math::Vec3* min, Math::Vec3* max);
+    bool isConvex();
+
+    void supportPoint(Math::Vec3* direction, Math::Vec3* target);
 };
 
 }
@@ -0,0 +1,63 @@
+#ifndef Capsule_h
+#define Capsule_h
+
+#include "shapes/Shape.h"
+#include "math/Quaternion.h"
+
+namespace Cannon::Shapes {
+
+class Capsule : public Shape {
+public:
+    /**
+     * @property {Number} radius
+     */
+    float radius;
+
+    /**
+     * Distance between the centers of the two end caps.
+     * @property {Number} height
+     */
+    float height;
+
+    /**
+     * A cylinder with half spheres on its ends, around a segment along the local Z axis. Collides with spheres, planes, boxes and other capsules in closed form, and with other convex shapes through GJK.
+     * @class Capsule
+     * @constructor
+     * @extends Shape
+     * @param {Number} radius
+     * @param {Number} height
+     */
+    Capsule(float radius, float height);
+
+    ~Capsule();
+
+    /**
+     * Get the world positions of the centers of the end caps.
+     * @method getWorldEndpoints
+     * @param {Vec3} pos
+     * @param {Quaternion} quat
+     * @param {Vec3} a Center at -Z.
+     * @param {Vec3} b Center at +Z.
+     */
+    void getWorldEndpoints(Math::Vec3* pos, Math::Quaternion* quat, Math::Vec3* a, Math::Vec3* b);
+
+    void calculateLocalInertia(float mass, Math::Vec3* target);
+
+    double volume();
+
+    void updateBoundingSphereRadius();
+
+    void calculateWorldAABB(
+        Math::Vec3* pos,
+        Math::Quaternion* quat,
+        Math::Vec3* min,
+        Math::Vec3* max);
+
+    bool isConvex();
+
+    void supportPoint(Math::Vec3* direction, Math::Vec3* target);
+};
+
+}
+
+#endif
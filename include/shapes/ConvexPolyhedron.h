@@ -1,6 +1,7 @@
 #ifndef ConvexPolyhedron_h
 #define ConvexPolyhedron_h
 
+#include <array>
 #include <vector>
 #include "shapes/Shape.h"
 #include "math/Quaternion.h"
@@ -9,6 +10,10 @@
 #define MAX_FLOAT 3.40282e+38
 #endif
 
+namespace Cannon::Collision {
+    class SeparatingAxisCache;
+}
+
 namespace Cannon::Shapes {
 
 struct PointObject {
@@ -23,6 +28,24 @@ struct DepthOrBool {
 };
 
 class ConvexPolyhedron : public Shape {
+private:
+    bool findSeparatingAxis_(
+        ConvexPolyhedron* hullB,
+        Math::Vec3* posA,
+        Math::Quaternion* quatA,
+        Math::Vec3* posB,
+        Math::Quaternion* quatB,
+        Math::Vec3* target,
+        std::vector<int>* faceListA,
+        std::vector<int>* faceListB,
+        std::array<int, 4>* vertexHints);
+
+    bool edgesMakeMinkowskiFace_(
+        int edgeA,
+        ConvexPolyhedron* hullB,
+        int edgeB,
+        std::vector<Math::Vec3>* worldNormalsA,
+        std::vector<Math::Vec3>* worldNormalsB);
 
 public:
     /**
@@ -59,6 +82,27 @@ public:
      */
     std::vector<Math::Vec3> uniqueEdges;
 
+    /**
+     * For each of the uniqueEdges, the two faces on each side of every hull edge along it. The second face is -1 if the edge only has one.
+     * @property uniqueEdgeFaces
+     * @type {Array}
+     */
+    std::vector<std::vector<std::array<int, 2>>> uniqueEdgeFaces;
+
+    /**
+     * For each vertex, the indices of the vertices it shares an edge with
+     * @property vertexNeighbors
+     * @type {Array}
+     */
+    std::vector<std::vector<int>> vertexNeighbors;
+
+    /**
+     * Hulls with at least this many vertices find their extreme vertices by walking along the edges, instead of checking every vertex.
+     * @property {Number} hillClimbingThreshold
+     * @default 32
+     */
+    int hillClimbingThreshold = 32;
+
     /**
      * If given, these locally defined, normalized axes are the only ones being checked when doing separating axis check.
      * @property {Array} uniqueAxes
@@ -75,6 +119,19 @@ public:
      * @param {Vec3} target
      */
     static void computeNormal(Math::Vec3* va, Math::Vec3* vb, Math::Vec3* vc, Math::Vec3* target);
+
+    /**
+     * Check if two edges, given by the normals of the faces on each side of them, make a face of the Minkowski difference. This is the case if their arcs on the Gauss map cross. Normals c and d should already be negated. Only the cross product of such edges can be a separating axis.
+     * @static
+     * @method isMinkowskiFace
+     * @param {Vec3} a
+     * @param {Vec3} b
+     * @param {Vec3} c
+     * @param {Vec3} d
+     * @return {bool}
+     * @see http://media.steampowered.com/apps/valve/2013/DGregorius_GDC2013.zip
+     */
+    static bool isMinkowskiFace(Math::Vec3* a, Math::Vec3* b, Math::Vec3* c, Math::Vec3* d);
     
     /**
     * Get max and min dot product of a convex hull at position (pos,quat) projected onto an axis. Results are saved in the array maxmin.
@@ -85,13 +142,15 @@ public:
     * @param {Vec3} pos
     * @param {Quaternion} quat
     * @param {array} result result[0] and result[1] will be set to maximum and minimum, respectively.
+    * @param {array} [vertexHints] The max and min vertex to start hill climbing from, set to the ones found. Climbing starts from vertex 0 if not given.
     */
     static void project(
         ConvexPolyhedron* hull,
         Math::Vec3* axis,
         Math::Vec3* pos,
         Math::Quaternion* quat,
-        std::array<float, 2>* result);
+        std::array<float, 2>* result,
+        int* vertexHints = nullptr);
 
     /**
      * A set of polygons describing a convex shape.
@@ -101,6 +160,9 @@ public:
      * @description The shape MUST be convex for the code to work properly. No polygons may be coplanar (contained
      * in the same 3D plane), instead these should be merged into one polygon.
      *
+     * The scratch data of the collision methods (project, testSepAxis, findSeparatingAxis, clipAgainstHull,
+     * clipFaceAgainstHull) is thread local, so different pairs can be tested on different threads at the same time.
+     *
      * @param {array} points An array of Vec3's
      * @param {array} faces Array of integer arrays, describing which vertices that is included in each face.
      *
@@ -124,7 +186,16 @@ public:
     ~ConvexPolyhedron();
 
     /**
-     * Computes uniqueEdges
+     * Find the vertex furthest along a direction by walking from a start vertex to neighbors further along it, until there is none. On a convex hull this vertex is the furthest of all. Starting from the result of a similar direction takes few steps.
+     * @method getExtremeVertex
+     * @param {Vec3} direction In the local frame of the hull
+     * @param {Number} start Index of the vertex to start from
+     * @return {Number} Index of the vertex
+     */
+    int getExtremeVertex(Math::Vec3* direction, int start);
+
+    /**
+     * Computes uniqueEdges, uniqueEdgeFaces and vertexNeighbors
      * @method computeEdges
      */
     void computeEdges();
@@ -195,6 +266,31 @@ public:
         std::vector<int>* faceListA,
         std::vector<int>* faceListB);
 
+    /**
+     * Find the separating axis between this hull and another, trying the axis that separated them last time first.
+     * @method findSeparatingAxis
+     * @param {ConvexPolyhedron} hullB
+     * @param {Vec3} posA
+     * @param {Quaternion} quatA
+     * @param {Vec3} posB
+     * @param {Quaternion} quatB
+     * @param {Vec3} target The target vector to save the axis in. Holds the separating axis if a separation is found.
+     * @param {Array} faceListA
+     * @param {Array} faceListB
+     * @param {SeparatingAxisCache} cache
+     * @return {bool} Returns false if a separation is found, else true
+     */
+    bool findSeparatingAxis(
+        ConvexPolyhedron* hullB,
+        Math::Vec3* posA,
+        Math::Quaternion* quatA,
+        Math::Vec3* posB,
+        Math::Quaternion* quatB,
+        Math::Vec3* target,
+        std::vector<int>* faceListA,
+        std::vector<int>* faceListB,
+        Collision::SeparatingAxisCache* cache);
+
     /**
      * Test separating axis against two hulls. Both hulls are projected onto the axis and the overlap size is returned if there is one.
      * @method testSepAxis
@@ -204,6 +300,7 @@ public:
      * @param {Quaternion} quatA
      * @param {Vec3} posB
      * @param {Quaternion} quatB
+     * @param {Array} [vertexHints] The max and min vertex of this hull and then hullB, see .project()
      * @return {number} The overlap depth, or false if no penetration.
      */
     DepthOrBool testSepAxis(
@@ -212,7 +309,8 @@ public:
         Math::Vec3* posA,
         Math::Quaternion* quatA,
         Math::Vec3* posB,
-        Math::Quaternion* quatB);
+        Math::Quaternion* quatB,
+        std::array<int, 4>* vertexHints = nullptr);
 
     /**
      * @method calculateLocalInertia
@@ -322,6 +420,25 @@ public:
     * @return {Boolean}
     */
     bool pointIsInside(Math::Vec3* p);
+
+    bool isConvex();
+
+    /**
+    * Get the vertex that is furthest along a local direction.
+    * @method supportPoint
+    * @param  {Vec3} direction
+    * @param  {Vec3} target
+    */
+    void supportPoint(Math::Vec3* direction, Math::Vec3* target);
+
+    /**
+    * Get the vertex that is furthest along a local direction, hill climbing from a vertex found for a similar direction.
+    * @method supportPoint
+    * @param  {Vec3} direction
+    * @param  {Vec3} target
+    * @param  {Number} vertexHint Index of the vertex to start from, set to the one found
+    */
+    void supportPoint(Math::Vec3* direction, Math::Vec3* target, int* vertexHint);
 };
 
 }
@@ -0,0 +1,52 @@
+#ifndef Cylinder_h
+#define Cylinder_h
+
+#include "shapes/Shape.h"
+#include "math/Quaternion.h"
+
+namespace Cannon::Shapes {
+
+class Cylinder : public Shape {
+public:
+    /**
+     * @property {Number} radius
+     */
+    float radius;
+
+    /**
+     * @property {Number} height
+     */
+    float height;
+
+    /**
+     * A round cylinder along the local Z axis, centered at the origin. Unlike cannon.js, it is not a ConvexPolyhedron: spheres and planes collide with it in closed form, and other convex shapes through GJK.
+     * @class Cylinder
+     * @constructor
+     * @extends Shape
+     * @param {Number} radius
+     * @param {Number} height
+     */
+    Cylinder(float radius, float height);
+
+    ~Cylinder();
+
+    void calculateLocalInertia(float mass, Math::Vec3* target);
+
+    double volume();
+
+    void updateBoundingSphereRadius();
+
+    void calculateWorldAABB(
+        Math::Vec3* pos,
+        Math::Quaternion* quat,
+        Math::Vec3* min,
+        Math::Vec3* max);
+
+    bool isConvex();
+
+    void supportPoint(Math::Vec3* direction, Math::Vec3* target);
+};
+
+}
+
+#endif
@@ -27,8 +27,8 @@ public:
     double volume();
 
     void calculateWorldAABB(
-        Math::Vec3 pos,
-        Math::Quaternion quat,
+        Math::Vec3* pos,
+        Math::Quaternion* quat,
         Math::Vec3* min,
         Math::Vec3* max);
 
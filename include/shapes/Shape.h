@@ -5,6 +5,10 @@
 #include "material/Material.h"
 #include "utils/EventTarget.h"
 
+namespace Cannon::Math {
+    class Quaternion;
+}
+
 namespace Cannon::Objects {
     class Body;
 }
@@ -26,7 +30,8 @@ enum ShapeTypes {
     HEIGHTFIELD = 32,
     PARTICLE = 64,
     CYLINDER = 128,
-    TRIMESH = 256
+    TRIMESH = 256,
+    CAPSULE = 512
 };
 
 class Shape : public Utils::EventTarget {
@@ -84,7 +89,7 @@ public:
      */
     Shape(ShapeTypes type);
 
-    ~Shape();
+    virtual ~Shape();
 
     /**
      * Computes the bounding sphere radius. The result is stored in the property .boundingSphereRadius
@@ -107,6 +112,35 @@ public:
      * @see http://en.wikipedia.org/wiki/List_of_moments_of_inertia
      */
     virtual void calculateLocalInertia(float mass, Math::Vec3* target) = 0;
+
+    /**
+     * Computes the world space AABB of the shape at the given position and orientation.
+     * @method calculateWorldAABB
+     * @param {Vec3}        pos
+     * @param {Quaternion}  quat
+     * @param {Vec3}        min
+     * @param {Vec3}        max
+     */
+    virtual void calculateWorldAABB(
+        Math::Vec3* pos,
+        Math::Quaternion* quat,
+        Math::Vec3* min,
+        Math::Vec3* max) = 0;
+
+    /**
+     * Whether the shape is convex and implements .supportPoint(), so that it can collide through GJK.
+     * @method isConvex
+     * @return {Boolean}
+     */
+    virtual bool isConvex();
+
+    /**
+     * Get the point of the shape that is furthest along a direction, in the local frame of the shape. Only convex shapes implement it.
+     * @method supportPoint
+     * @param {Vec3} direction Local direction, does not have to be normalized.
+     * @param {Vec3} target
+     */
+    virtual void supportPoint(Math::Vec3* direction, Math::Vec3* target);
 };
 
 }
@@ -37,6 +37,9 @@ public:
         Math::Quaternion* quat,
         Math::Vec3* min,
         Math::Vec3* max);
+    bool isConvex();
+
+    void supportPoint(Math::Vec3* direction, Math::Vec3* target);
 };
 
 }
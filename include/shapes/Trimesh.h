@@ -1,13 +1,12 @@
 #ifndef Trimesh_h
 #define Trimesh_h
 
+#include <vector>
 #include "shapes/Shape.h"
 #include "math/Quaternion.h"
-#include "utils/Octree.h"
-
-namespace Cannon::Collision {
-    class AABB;
-}
+#include "collision/AABB.h"
+#include "utils/TriangleBVH.h"
+#include "utils/QuantizedTriangleBVH.h"
 
 namespace Cannon::Shapes {
 
@@ -23,6 +22,9 @@ private:
      */
     Math::Vec3* getUnscaledVertex_(int i, Math::Vec3* out);
 
+    // A local AABB in the unscaled space of .tree
+    void unscaleAABB_(Collision::AABB* aabb, Collision::AABB* target);
+
 public:
     /**
      * Create a Trimesh instance, shaped as a torus.
@@ -41,46 +43,59 @@ public:
      * @property vertices
      * @type {Array}
      */
-    float* vertices;
+    std::vector<float> vertices;
 
     /**
      * Array of integers, indicating which vertices each triangle consists of. The length of this array is thus 3 times the number of triangles.
      * @property indices
      * @type {Array}
      */
-    int* indices;
+    std::vector<int> indices;
 
     /**
      * The normals data.
      * @property normals
      * @type {Array}
      */
-    float* normals;
+    std::vector<float> normals;
 
     /**
      * The local AABB of the mesh.
      * @property aabb
      * @type {Array}
      */
-    Collision::AABB* aabb;
+    Collision::AABB aabb;
 
     /**
      * References to vertex pairs, making up all unique edges in the trimesh.
      * @property {array} edges
      */
-    int* edges;
+    std::vector<int> edges;
 
     /**
      * Local scaling of the mesh. Use .setScale() to set it.
      * @property {Vec3} scale
      */
-    Math::Vec3 scale = Vec3(1, 1, 1);
+    Math::Vec3 scale = Math::Vec3(1, 1, 1);
+
+    /**
+     * The indexed triangles, in unscaled local space. Use .updateTree() to update it.
+     * @property {TriangleBVH} tree
+     */
+    Utils::TriangleBVH tree;
+
+    /**
+     * Keep the triangles in .compressedTree instead of .tree, at about half the memory. Call .updateTree() after changing it.
+     * @property {Boolean} useCompressedTree
+     * @default false
+     */
+    bool useCompressedTree = false;
 
     /**
-     * The indexed triangles. Use .updateTree() to update it.
-     * @property {Octree} tree
+     * The indexed triangles with quantized bounds, when .useCompressedTree is set. .tree is empty then.
+     * @property {QuantizedTriangleBVH} compressedTree
      */
-    Utils::Octree<std::vector<float>>* tree;
+    Utils::QuantizedTriangleBVH compressedTree;
 
     /**
      * @class Trimesh
@@ -100,7 +115,9 @@ public:
      *     ];
      *     var trimeshShape = new Trimesh(vertices, indices);
      */
-    Trimesh(float* vertices, int* indices);
+    Trimesh(std::vector<float>* vertices, std::vector<int>* indices);
+
+    ~Trimesh();
 
     /**
      * @method updateTree
@@ -112,16 +129,50 @@ public:
      * @method getTrianglesInAABB
      * @param  {AABB} aabb
      * @param  {array} result An array of integers, referencing the queried triangles.
+     * @return {array} The "result" object
+     */
+    std::vector<int>* getTrianglesInAABB(Collision::AABB* aabb, std::vector<int>* result);
+
+    /**
+     * Call visitor(triangle) for the triangles in a local AABB. Like .getTrianglesInAABB(), without filling a list.
+     * @method trianglesInAABB
+     * @param  {AABB} aabb
+     * @param  {Function} visitor
+     */
+    template<class Visitor>
+    void trianglesInAABB(Collision::AABB* aabb, Visitor visitor) {
+        Collision::AABB unscaled;
+        this->unscaleAABB_(aabb, &unscaled);
+        if (!this->compressedTree.nodes.empty()) {
+            this->compressedTree.aabbQuery(&unscaled, visitor);
+        } else {
+            this->tree.aabbQuery(&unscaled, visitor);
+        }
+    }
+
+    /**
+     * Call visitor(triangle) for the triangles that may be hit by the local line segment between from and to.
+     * @method trianglesOnSegment
+     * @param  {Vec3} from
+     * @param  {Vec3} to
+     * @param  {Function} visitor
      */
-    std::vector<std::vector<float>>* getTrianglesInAABB(
-        Collision::AABB* aabb,
-        std::vector<std::vector<float>>* result);
+    template<class Visitor>
+    void trianglesOnSegment(Math::Vec3* from, Math::Vec3* to, Visitor visitor) {
+        Math::Vec3 unscaledFrom(from->x / this->scale.x, from->y / this->scale.y, from->z / this->scale.z);
+        Math::Vec3 unscaledTo(to->x / this->scale.x, to->y / this->scale.y, to->z / this->scale.z);
+        if (!this->compressedTree.nodes.empty()) {
+            this->compressedTree.rayQuery(&unscaledFrom, &unscaledTo, visitor);
+        } else {
+            this->tree.rayQuery(&unscaledFrom, &unscaledTo, visitor);
+        }
+    }
 
     /**
      * @method setScale
      * @param {Vec3} scale
      */
-    void setScale(Math::Vec3 scale);
+    void setScale(Math::Vec3* scale);
 
     /**
      * Compute the normals of the faces. Will save in the .normals array.
@@ -161,7 +212,7 @@ public:
      * @param {Vec3} vc
      * @param {Vec3} target
      */
-    void computeNormal(Math::Vec3 va, Math::Vec3 vb, Math::Vec3 vc, Math::Vec3* target);
+    static void computeNormal(Math::Vec3* va, Math::Vec3* vb, Math::Vec3* vc, Math::Vec3* target);
 
     /**
      * Get vertex i.
@@ -181,7 +232,7 @@ public:
      * @param  {Vec3} out
      * @return {Vec3} The "out" vector object
      */
-    Math::Vec3* getWorldVertex(int i, Math::Vec3 pos, Math::Quaternion quat, Math::Vec3* out);
+    Math::Vec3* getWorldVertex(int i, Math::Vec3* pos, Math::Quaternion* quat, Math::Vec3* out);
 
     /**
      * Get the three vertices for triangle i.
@@ -236,7 +287,7 @@ public:
      * @param {Vec3}        min
      * @param {Vec3}        max
      */
-    void calculateWorldAABB(Math::Vec3 pos, Math::Quaternion quat, Math::Vec3* min, Math::Vec3* max);
+    void calculateWorldAABB(Math::Vec3* pos, Math::Quaternion* quat, Math::Vec3* min, Math::Vec3* max);
 
     /**
      * Get approximate volume
@@ -1,12 +1,20 @@
 #ifndef GSSolver_h
 #define GSSolver_h
 
+#include <vector>
 #include "solver/Solver.h"
 
+namespace Cannon::Objects {
+    class Body;
+}
+
 namespace Cannon::Solver {
 
 class GSSolver : public Solver::Solver {
 private:
+    std::vector<double> invCs_;
+    std::vector<double> Bs_;
+    std::vector<double> lambda_;
 
 public:
     /**
@@ -24,6 +32,14 @@ public:
      */
     double tolerance = 1e-7;
 
+    /**
+     * How much of the impulse of the last step (Equation.lambda) each equation starts from. 0 starts every solve from zero. With persistent contacts (see ContactManifoldCache), 1 or a bit less lets resting contacts converge in a few iterations.
+     * @property warmStartFactor
+     * @type {Number}
+     * @default 0
+     */
+    double warmStartFactor = 0;
+
     /**
      * Constraint equation Gauss-Seidel solver.
      * @class GSSolver
@@ -40,7 +56,16 @@ public:
      * @param  {Number} dt
      * @param  {World} world
      */
-    int solve(int dt, World::World* world);
+    int solve(double dt, World::World* world);
+
+    /**
+     * Solve for the given bodies. Same as .solve(), without needing a world.
+     * @method solveBodies
+     * @param  {Number} dt
+     * @param  {Array} bodies
+     * @return {Number} The number of iterations done
+     */
+    int solveBodies(double dt, std::vector<Objects::Body*>* bodies);
 };
 
 
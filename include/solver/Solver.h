@@ -13,9 +13,14 @@ namespace Cannon::Solver {
 class Solver
 {
 private:
-    std::vector<Equations::Equation> equations_;
 
 public:
+    /**
+     * All equations to be solved
+     * @property {Array} equations
+     */
+    std::vector<Equations::Equation*> equations;
+
     /**
      * Constraint equation solver base class.
      * @class Solver
@@ -24,13 +29,15 @@ public:
      */
     Solver();
 
+    virtual ~Solver() {};
+
     /**
      * Should be implemented in subclasses!
      * @method solve
      * @param  {Number} dt
      * @param  {World} world
      */
-    virtual int solve(int dt, World::World* world) = 0;
+    virtual int solve(double dt, World::World* world) = 0;
 
     /**
      * Add an equation
@@ -0,0 +1,242 @@
+#ifndef AABBTree_h
+#define AABBTree_h
+
+#include <vector>
+#include "collision/AABB.h"
+#include "utils/LinearBVH.h"
+
+namespace Cannon::Utils {
+
+/**
+ * @class AABBTreeNode
+ */
+struct AABBTreeNode {
+    /**
+     * Enlarged bounding box of the node. For leaves this is the fat AABB of the proxy.
+     * @property {AABB} aabb
+     */
+    Collision::AABB aabb;
+
+    /**
+     * Parent node index, or the next free node when the node is in the free list.
+     * @property {Number} parent
+     */
+    int parent = -1;
+
+    /**
+     * @property {Number} child1
+     */
+    int child1 = -1;
+
+    /**
+     * @property {Number} child2
+     */
+    int child2 = -1;
+
+    /**
+     * Height of the node. Leaves have height 0 and free nodes -1.
+     * @property {Number} height
+     */
+    int height = -1;
+
+    /**
+     * User data of a leaf.
+     * @property {Number} userData
+     */
+    int userData = -1;
+
+    bool isLeaf() { return child1 == -1; }
+};
+
+class AABBTree {
+private:
+    std::vector<AABBTreeNode> nodes_;
+    int freeList_ = -1;
+    std::vector<int> stack_;
+    LinearBVH builder_;
+    std::vector<Collision::AABB> builderAABBs_;
+    std::vector<int> builderNodes_;
+
+    int allocateNode_();
+    void freeNode_(int nodeId);
+    void insertLeaf_(int leaf);
+    void removeLeaf_(int leaf);
+    int balance_(int iA);
+
+    // Visit the node pair (a, b) of this tree and other. Pushes the node pairs below it onto stack, or reports the pair if both are overlapping leaves. With other == this, a pair of a node with itself means all pairs within its subtree.
+    void visitPair_(AABBTree* other, int a, int b, std::vector<int>* stack, std::vector<int>* pairs1, std::vector<int>* pairs2);
+
+public:
+    /**
+     * Index of the root node, or -1 if the tree is empty.
+     * @property {Number} root
+     */
+    int root = -1;
+
+    /**
+     * How much the leaf AABBs are enlarged on each side. A proxy is only reinserted when its AABB leaves the enlarged box.
+     * @property {Number} margin
+     * @default 0.1
+     */
+    float margin = 0.1;
+
+    /**
+     * A dynamic bounding volume tree. Leaves store enlarged ("fat") AABBs so that small movements do not change the tree, and the tree is kept balanced with rotations on insertion and removal.
+     * @class AABBTree
+     * @constructor
+     * @see http://box2d.org/files/ErinCatto_DynamicBVH_GDC2019.pdf
+     */
+    AABBTree() {};
+
+    /**
+     * Surface area of an AABB, used as the insertion cost.
+     * @static
+     * @method surfaceArea
+     * @param  {AABB} aabb
+     * @return {Number}
+     */
+    static float surfaceArea(Collision::AABB* aabb);
+
+    /**
+     * Store the union of two AABBs in target.
+     * @static
+     * @method combine
+     * @param  {AABB} a
+     * @param  {AABB} b
+     * @param  {AABB} target
+     */
+    static void combine(Collision::AABB* a, Collision::AABB* b, Collision::AABB* target);
+
+    /**
+     * Create a proxy for a new AABB.
+     * @method createProxy
+     * @param  {AABB} aabb The tight AABB, the tree stores it enlarged by .margin
+     * @param  {Number} userData
+     * @return {Number} The proxy id
+     */
+    int createProxy(Collision::AABB* aabb, int userData);
+
+    /**
+     * Create proxies for many AABBs at once. The new leaves are arranged along a Morton curve with a LinearBVH and the resulting subtree is inserted as a whole, which is much faster than calling .createProxy() for each of them.
+     * @method createProxies
+     * @param  {Array} aabbs The tight AABBs
+     * @param  {Array} userData User data of each AABB
+     * @param  {Array} proxyIds The proxy id of each AABB is appended here
+     */
+    void createProxies(std::vector<Collision::AABB*>* aabbs, std::vector<int>* userData, std::vector<int>* proxyIds);
+
+    /**
+     * Remove a proxy from the tree.
+     * @method destroyProxy
+     * @param  {Number} proxyId
+     */
+    void destroyProxy(int proxyId);
+
+    /**
+     * Move a proxy. Nothing happens if the new AABB is still inside the fat AABB of the proxy, else the proxy is reinserted with a new fat AABB.
+     * @method moveProxy
+     * @param  {Number} proxyId
+     * @param  {AABB} aabb The new tight AABB
+     * @return {Boolean} True if the proxy was reinserted
+     */
+    bool moveProxy(int proxyId, Collision::AABB* aabb);
+
+    /**
+     * @method getFatAABB
+     * @param  {Number} proxyId
+     * @return {AABB}
+     */
+    Collision::AABB* getFatAABB(int proxyId);
+
+    /**
+     * @method getUserData
+     * @param  {Number} proxyId
+     * @return {Number}
+     */
+    int getUserData(int proxyId);
+
+    /**
+     * @method setUserData
+     * @param  {Number} proxyId
+     * @param  {Number} userData
+     */
+    void setUserData(int proxyId, int userData);
+
+    /**
+     * Get the height of the tree. An empty tree has height 0.
+     * @method getHeight
+     * @return {Number}
+     */
+    int getHeight();
+
+    /**
+     * Get the user data of all leaves whose fat AABB overlaps the given AABB.
+     * @method aabbQuery
+     * @param  {AABB} aabb
+     * @param  {array} result
+     * @return {array} The "result" object
+     */
+    std::vector<int>* aabbQuery(Collision::AABB* aabb, std::vector<int>* result);
+
+    /**
+     * Same as .aabbQuery(), using the given traversal stack instead of the one in the tree. Lets several threads query the tree at the same time.
+     * @method aabbQuery
+     * @param  {AABB} aabb
+     * @param  {array} result
+     * @param  {array} stack
+     * @return {array} The "result" object
+     */
+    std::vector<int>* aabbQuery(Collision::AABB* aabb, std::vector<int>* result, std::vector<int>* stack);
+
+    /**
+     * Get the user data of all leaves whose fat AABB is hit by the line segment between from and to.
+     * @method rayQuery
+     * @param  {Vec3} from
+     * @param  {Vec3} to
+     * @param  {array} result
+     * @return {array} The "result" object
+     */
+    std::vector<int>* rayQuery(Math::Vec3* from, Math::Vec3* to, std::vector<int>* result);
+
+    /**
+     * Get all pairs of leaves with overlapping fat AABBs, by traversing the tree against itself. Each pair is reported once.
+     * @method queryPairs
+     * @param  {array} pairs1 User data of the first leaf in each pair
+     * @param  {array} pairs2 User data of the second leaf in each pair
+     */
+    void queryPairs(std::vector<int>* pairs1, std::vector<int>* pairs2);
+
+    /**
+     * Get all pairs of a leaf in this tree and a leaf in another tree with overlapping fat AABBs, by traversing the two trees together.
+     * @method queryTree
+     * @param  {AABBTree} other
+     * @param  {array} pairs1 User data of the leaf in this tree
+     * @param  {array} pairs2 User data of the leaf in the other tree
+     */
+    void queryTree(AABBTree* other, std::vector<int>* pairs1, std::vector<int>* pairs2);
+
+    /**
+     * Split the traversal of .queryPairs() (when other is this tree) or .queryTree(other) into independent node pairs, breadth first, until there are at least count of them or none can be split further. Traversing each of them with .queryNodes() finds every pair once.
+     * @method splitQuery
+     * @param  {AABBTree} other
+     * @param  {Number} count
+     * @param  {array} nodePairs Node in this tree and node in the other tree of each pair, one after the other
+     */
+    void splitQuery(AABBTree* other, int count, std::vector<int>* nodePairs);
+
+    /**
+     * Get all pairs of leaves with overlapping fat AABBs below a node pair of .splitQuery(), using the given traversal stack. Lets several threads traverse the trees at the same time.
+     * @method queryNodes
+     * @param  {AABBTree} other
+     * @param  {Number} nodeA Node in this tree
+     * @param  {Number} nodeB Node in the other tree
+     * @param  {array} pairs1 User data of the leaf in this tree
+     * @param  {array} pairs2 User data of the leaf in the other tree
+     * @param  {array} stack
+     */
+    void queryNodes(AABBTree* other, int nodeA, int nodeB, std::vector<int>* pairs1, std::vector<int>* pairs2, std::vector<int>* stack);
+};
+
+}
+
+#endif
@@ -1,5 +1,5 @@
 #ifndef EventTarget_h
-#define Body_h
+#define EventTarget_h
 
 #include <map>
 #include <string>
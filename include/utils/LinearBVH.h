@@ -0,0 +1,174 @@
+#ifndef LinearBVH_h
+#define LinearBVH_h
+
+#include <vector>
+#include <functional>
+#include "collision/AABB.h"
+
+namespace Cannon::Math {
+    class Vec3;
+}
+
+namespace Cannon::Utils {
+
+class ThreadPool;
+
+/**
+ * A node of a LinearBVH, 32 bytes.
+ * @class LinearBVHNode
+ */
+struct LinearBVHNode {
+    /**
+     * @property {Array} lowerBound
+     */
+    float lowerBound[3];
+
+    /**
+     * @property {Array} upperBound
+     */
+    float upperBound[3];
+
+    /**
+     * For leaves, the first entry in LinearBVH.primitives. For inner nodes, the index of the second child. The first child is always the next node.
+     * @property {Number} offset
+     */
+    int offset;
+
+    /**
+     * Number of primitives in a leaf, 0 for inner nodes.
+     * @property {Number} count
+     */
+    int count;
+};
+
+class LinearBVH {
+private:
+    std::vector<unsigned long long> codes_;
+    std::vector<unsigned long long> tempCodes_;
+    std::vector<int> tempPrimitives_;
+    std::vector<int> histograms_;
+    std::vector<int> stack_;
+
+    void runTasks_(int taskCount, std::function<void(int)> task);
+    void computeCodes_(std::vector<Collision::AABB>* aabbs, int taskCount);
+    void sortCodes_(int taskCount);
+    int emitNode_(std::vector<Collision::AABB>* aabbs, int begin, int end);
+    int findSplit_(int begin, int end);
+
+public:
+    /**
+     * The nodes in depth first order. The root is node 0.
+     * @property {Array} nodes
+     */
+    std::vector<LinearBVHNode> nodes;
+
+    /**
+     * Primitive indices, sorted by Morton code. Each leaf covers a range of this list.
+     * @property {Array} primitives
+     */
+    std::vector<int> primitives;
+
+    /**
+     * Max number of primitives per leaf.
+     * @property {Number} maxLeafSize
+     * @default 4
+     */
+    int maxLeafSize = 4;
+
+    /**
+     * Use 63 bit Morton codes (21 bits per axis) instead of 30 bit ones (10 bits per axis). Better splits for very large sets, but twice as many sort passes.
+     * @property {Boolean} useLongCodes
+     * @default false
+     */
+    bool useLongCodes = false;
+
+    /**
+     * Thread pool for the Morton codes and the radix sort. Runs on the calling thread if not set. The result is the same for any number of threads.
+     * @property {ThreadPool} threadPool
+     */
+    ThreadPool* threadPool = nullptr;
+
+    /**
+     * A bounding volume hierarchy built in one go from a list of AABBs: the centroids are sorted along a Morton curve with a radix sort, and the sorted list is split at the highest differing bit of the codes. Much faster to build than inserting the boxes one by one, and stored as a flat array. Does not support updates, rebuild it instead.
+     * @class LinearBVH
+     * @constructor
+     * @see https://research.nvidia.com/publication/2012-06_maximizing-parallelism-construction-bvhs-octrees-and-k-d-trees
+     */
+    LinearBVH() {};
+
+    /**
+     * Spread the lower 10 bits of v so that there are two zero bits between each of them.
+     * @static
+     * @method expandBits10
+     * @param {Number} v
+     * @return {Number}
+     */
+    static unsigned long long expandBits10(unsigned int v);
+
+    /**
+     * Spread the lower 21 bits of v so that there are two zero bits between each of them.
+     * @static
+     * @method expandBits21
+     * @param {Number} v
+     * @return {Number}
+     */
+    static unsigned long long expandBits21(unsigned int v);
+
+    /**
+     * 30 bit Morton code of a point in the unit cube.
+     * @static
+     * @method mortonCode30
+     * @param {Number} x
+     * @param {Number} y
+     * @param {Number} z
+     * @return {Number}
+     */
+    static unsigned long long mortonCode30(float x, float y, float z);
+
+    /**
+     * 63 bit Morton code of a point in the unit cube.
+     * @static
+     * @method mortonCode63
+     * @param {Number} x
+     * @param {Number} y
+     * @param {Number} z
+     * @return {Number}
+     */
+    static unsigned long long mortonCode63(float x, float y, float z);
+
+    /**
+     * Build the hierarchy. The index of each box in the list is its primitive index.
+     * @method build
+     * @param {Array} aabbs
+     */
+    void build(std::vector<Collision::AABB>* aabbs);
+
+    /**
+     * Clear the hierarchy.
+     * @method reset
+     */
+    void reset();
+
+    /**
+     * Get the primitives in the leaves that overlap the given AABB. Leaves hold up to .maxLeafSize primitives, so the result may contain primitives whose own box does not overlap.
+     * @method aabbQuery
+     * @param  {AABB} aabb
+     * @param  {array} result
+     * @return {array} The "result" object
+     */
+    std::vector<int>* aabbQuery(Collision::AABB* aabb, std::vector<int>* result);
+
+    /**
+     * Get the primitives in the leaves hit by the line segment between from and to.
+     * @method rayQuery
+     * @param  {Vec3} from
+     * @param  {Vec3} to
+     * @param  {array} result
+     * @return {array} The "result" object
+     */
+    std::vector<int>* rayQuery(Math::Vec3* from, Math::Vec3* to, std::vector<int>* result);
+};
+
+}
+
+#endif
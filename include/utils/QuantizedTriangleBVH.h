@@ -0,0 +1,273 @@
+#ifndef QuantizedTriangleBVH_h
+#define QuantizedTriangleBVH_h
+
+#include <algorithm>
+#include <vector>
+#include "collision/AABB.h"
+#include "math/Vec3.h"
+#include "utils/TriangleBVH.h"
+
+namespace Cannon::Utils {
+
+/**
+ * A node of a QuantizedTriangleBVH, 16 bytes.
+ * @class QuantizedBVHNode
+ */
+struct QuantizedBVHNode {
+    /**
+     * Lower bound, in 65535ths of the box of the parent node.
+     * @property {Array} lowerBound
+     */
+    unsigned short lowerBound[3];
+
+    /**
+     * Upper bound, in 65535ths of the box of the parent node.
+     * @property {Array} upperBound
+     */
+    unsigned short upperBound[3];
+
+    /**
+     * For leaves, the first entry of the leaf in the triangle list. For inner nodes, the index of the second child. The first child is always the next node.
+     * @property {Number} offset
+     */
+    unsigned int offset : 27;
+
+    /**
+     * Number of triangles in a leaf, 0 for inner nodes.
+     * @property {Number} count
+     */
+    unsigned int count : 5;
+};
+
+class QuantizedTriangleBVH {
+private:
+    // A node of the traversal stack, with its box decoded
+    struct StackEntry {
+        int node;
+        float lowerBound[3];
+        float upperBound[3];
+    };
+
+    // The triangles of the source, sorted within each leaf while building
+    std::vector<int> sourceTriangles_;
+
+    int emitNode_(TriangleBVH* source, int sourceNode, float* parentLo, float* parentHi, int first, int count);
+    void emitLeaf_(QuantizedBVHNode* node, int first, int count);
+    void quantize_(float* lo, float* hi, float* parentLo, float* parentHi, QuantizedBVHNode* node);
+
+    // Call visitor(triangle) for the triangles of a leaf
+    template<class Visitor>
+    void visitLeaf_(QuantizedBVHNode* node, Visitor visitor) {
+        unsigned short* list = &this->triangles[node->offset];
+        int base = list[0] | (list[1] << 16);
+        for (int i = 0; i < node->count; i++) {
+            visitor(base + list[2 + i]);
+        }
+    }
+
+    // Box of the children of an inner node
+    void decodeChildren_(StackEntry* parent, StackEntry* first, StackEntry* second) {
+        QuantizedBVHNode* node = &this->nodes[parent->node];
+        first->node = parent->node + 1;
+        second->node = node->offset;
+        QuantizedBVHNode* child1 = &this->nodes[first->node];
+        QuantizedBVHNode* child2 = &this->nodes[second->node];
+        for (int k = 0; k < 3; k++) {
+            float lo = parent->lowerBound[k];
+            float hi = parent->upperBound[k];
+            first->lowerBound[k] = QuantizedTriangleBVH::dequantize(lo, hi, child1->lowerBound[k]);
+            first->upperBound[k] = QuantizedTriangleBVH::dequantize(lo, hi, child1->upperBound[k]);
+            second->lowerBound[k] = QuantizedTriangleBVH::dequantize(lo, hi, child2->lowerBound[k]);
+            second->upperBound[k] = QuantizedTriangleBVH::dequantize(lo, hi, child2->upperBound[k]);
+        }
+    }
+
+public:
+    /**
+     * Most triangles in a leaf. Bigger leaves of the source hierarchy are split in halves, which adds at most 27 levels to the traversal stack.
+     * @static
+     * @property {Number} maxLeafCount
+     */
+    static constexpr int maxLeafCount = 31;
+
+    /**
+     * Number of nodes, and of entries in the triangle list, that the 27 bit node offsets can address. Building a bigger hierarchy throws.
+     * @static
+     * @property {Number} maxOffset
+     */
+    static constexpr int maxOffset = 1 << 27;
+
+    /**
+     * The nodes in depth first order. The root is node 0, and its box is .lowerBound and .upperBound.
+     * @property {Array} nodes
+     */
+    std::vector<QuantizedBVHNode> nodes;
+
+    /**
+     * The triangles of the leaves. Each leaf starts with its lowest triangle index in two entries, low 16 bits first, followed by the offset of each of its triangles from it.
+     * @property {Array} triangles
+     */
+    std::vector<unsigned short> triangles;
+
+    /**
+     * Lower bound of the root node.
+     * @property {Vec3} lowerBound
+     */
+    Math::Vec3 lowerBound;
+
+    /**
+     * Upper bound of the root node.
+     * @property {Vec3} upperBound
+     */
+    Math::Vec3 upperBound;
+
+    /**
+     * A compressed copy of a TriangleBVH. Each node stores its box with 16 bits per coordinate, relative to the box of its parent, which halves the size of the nodes. The boxes are rounded outwards, so queries may visit a few more triangles than with the full precision hierarchy, but never miss one. The triangles of a leaf are stored as 16 bit offsets from a 32 bit base, so the list stays small for meshes of any size. Leaves whose triangles are too far apart in the mesh for that are split.
+     * @class QuantizedTriangleBVH
+     * @constructor
+     */
+    QuantizedTriangleBVH() {};
+
+    /**
+     * Decode a quantized coordinate in the range [lo, hi]. The ends are exact.
+     * @static
+     * @method dequantize
+     * @param {Number} lo
+     * @param {Number} hi
+     * @param {Number} q
+     * @return {Number}
+     */
+    static float dequantize(float lo, float hi, unsigned short q) {
+        if (q == 0) {
+            return lo;
+        }
+        if (q == 65535) {
+            return hi;
+        }
+        return lo + (hi - lo) * (q * (1.0f / 65535.0f));
+    }
+
+    /**
+     * Build from a full precision hierarchy.
+     * @method build
+     * @param {TriangleBVH} source
+     */
+    void build(TriangleBVH* source);
+
+    /**
+     * Clear the hierarchy.
+     * @method reset
+     */
+    void reset();
+
+    /**
+     * Call visitor(triangle) for the triangles in the leaves that overlap the given AABB.
+     * @method aabbQuery
+     * @param  {AABB} aabb
+     * @param  {Function} visitor
+     */
+    template<class Visitor>
+    void aabbQuery(Collision::AABB* aabb, Visitor visitor) {
+        if (this->nodes.empty()) {
+            return;
+        }
+
+        float lo[3] = { aabb->lowerBound.x, aabb->lowerBound.y, aabb->lowerBound.z };
+        float hi[3] = { aabb->upperBound.x, aabb->upperBound.y, aabb->upperBound.z };
+
+        StackEntry stack[TriangleBVH::maxDepth + 32];
+        int stackSize = 1;
+        stack[0] = { 0, { this->lowerBound.x, this->lowerBound.y, this->lowerBound.z }, { this->upperBound.x, this->upperBound.y, this->upperBound.z } };
+
+        while (stackSize > 0) {
+            StackEntry entry = stack[--stackSize];
+            if (entry.lowerBound[0] > hi[0] || entry.upperBound[0] < lo[0]
+                || entry.lowerBound[1] > hi[1] || entry.upperBound[1] < lo[1]
+                || entry.lowerBound[2] > hi[2] || entry.upperBound[2] < lo[2]) {
+                continue;
+            }
+
+            QuantizedBVHNode* node = &this->nodes[entry.node];
+            if (node->count > 0) {
+                this->visitLeaf_(node, visitor);
+            } else {
+                this->decodeChildren_(&entry, &stack[stackSize + 1], &stack[stackSize]);
+                stackSize += 2;
+            }
+        }
+    }
+
+    /**
+     * Get the triangles in the leaves that overlap the given AABB.
+     * @method aabbQuery
+     * @param  {AABB} aabb
+     * @param  {array} result
+     * @return {array} The "result" object
+     */
+    std::vector<int>* aabbQuery(Collision::AABB* aabb, std::vector<int>* result);
+
+    /**
+     * Call visitor(triangle) for the triangles in the leaves hit by the line segment between from and to.
+     * @method rayQuery
+     * @param  {Vec3} from
+     * @param  {Vec3} to
+     * @param  {Function} visitor
+     */
+    template<class Visitor>
+    void rayQuery(Math::Vec3* from, Math::Vec3* to, Visitor visitor) {
+        if (this->nodes.empty()) {
+            return;
+        }
+
+        // Slab test against the segment, parametrized as from + t * (to - from) with t in [0, 1]
+        float d[3] = { to->x - from->x, to->y - from->y, to->z - from->z };
+        float inv[3] = { 1.0f / d[0], 1.0f / d[1], 1.0f / d[2] };
+        float o[3] = { from->x, from->y, from->z };
+
+        StackEntry stack[TriangleBVH::maxDepth + 32];
+        int stackSize = 1;
+        stack[0] = { 0, { this->lowerBound.x, this->lowerBound.y, this->lowerBound.z }, { this->upperBound.x, this->upperBound.y, this->upperBound.z } };
+
+        while (stackSize > 0) {
+            StackEntry entry = stack[--stackSize];
+
+            float tmin = 0;
+            float tmax = 1;
+            bool hit = true;
+            for (int i = 0; i < 3; i++) {
+                if (d[i] == 0) {
+                    // Parallel to the slab, must start inside it
+                    if (o[i] < entry.lowerBound[i] || o[i] > entry.upperBound[i]) {
+                        hit = false;
+                        break;
+                    }
+                    continue;
+                }
+                float t1 = (entry.lowerBound[i] - o[i]) * inv[i];
+                float t2 = (entry.upperBound[i] - o[i]) * inv[i];
+                tmin = std::max(tmin, std::min(t1, t2));
+                tmax = std::min(tmax, std::max(t1, t2));
+                if (tmin > tmax) {
+                    hit = false;
+                    break;
+                }
+            }
+
+            if (!hit) {
+                continue;
+            }
+
+            QuantizedBVHNode* node = &this->nodes[entry.node];
+            if (node->count > 0) {
+                this->visitLeaf_(node, visitor);
+            } else {
+                this->decodeChildren_(&entry, &stack[stackSize + 1], &stack[stackSize]);
+                stackSize += 2;
+            }
+        }
+    }
+};
+
+}
+
+#endif
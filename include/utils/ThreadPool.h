@@ -0,0 +1,58 @@
+#ifndef ThreadPool_h
+#define ThreadPool_h
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace Cannon::Utils {
+
+class ThreadPool {
+private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wakeCondition_;
+    std::condition_variable doneCondition_;
+
+    std::function<void(int, int)> task_;
+    int taskCount_ = 0;
+    int nextTask_ = 0;
+    int pending_ = 0;
+    int generation_ = 0;
+    bool stop_ = false;
+
+    void workerLoop_(int threadIndex);
+    bool runNextTask_(int threadIndex);
+
+public:
+    /**
+     * A fixed set of worker threads that run the tasks of .run() in parallel. The calling thread takes part in the work, so a pool of size 1 has no workers and runs everything on the caller.
+     * @class ThreadPool
+     * @constructor
+     * @param {Number} numThreads Total number of threads, including the caller
+     */
+    ThreadPool(int numThreads);
+
+    ~ThreadPool();
+
+    /**
+     * Total number of threads, including the caller.
+     * @method size
+     * @return {Number}
+     */
+    int size();
+
+    /**
+     * Run task(taskIndex, threadIndex) for each taskIndex in [0, taskCount), and wait for all of them to finish. threadIndex is in [0, size()) and can be used to pick per-thread scratch data. The tasks may run in any order.
+     * @method run
+     * @param {Number} taskCount
+     * @param {Function} task
+     */
+    void run(int taskCount, std::function<void(int, int)> task);
+};
+
+}
+
+#endif
@@ -0,0 +1,206 @@
+#ifndef TriangleBVH_h
+#define TriangleBVH_h
+
+#include <algorithm>
+#include <vector>
+#include "collision/AABB.h"
+#include "math/Vec3.h"
+#include "utils/LinearBVH.h"
+
+namespace Cannon::Utils {
+
+class TriangleBVH {
+private:
+    // Bounds and centroid of each triangle, only kept while building
+    std::vector<Collision::AABB> triangleAABBs_;
+    std::vector<Math::Vec3> centroids_;
+
+    int buildNode_(int begin, int end, int depth);
+    int findSplit_(int begin, int end);
+
+public:
+    /**
+     * Leaves are made at this depth whatever their size, which bounds the traversal stack of the queries.
+     * @static
+     * @property {Number} maxDepth
+     */
+    static constexpr int maxDepth = 64;
+
+    /**
+     * Most SAH bins per axis.
+     * @static
+     * @property {Number} maxBins
+     */
+    static constexpr int maxBins = 32;
+
+    /**
+     * The nodes in depth first order, 32 bytes each. The root is node 0.
+     * @property {Array} nodes
+     */
+    std::vector<LinearBVHNode> nodes;
+
+    /**
+     * Triangle indices, ordered so that each leaf covers a range of this list.
+     * @property {Array} triangles
+     */
+    std::vector<int> triangles;
+
+    /**
+     * Nodes with at most this many triangles are not split.
+     * @property {Number} maxLeafSize
+     * @default 4
+     */
+    int maxLeafSize = 4;
+
+    /**
+     * Number of bins along each axis when looking for the split with the lowest surface area heuristic cost. At most .maxBins.
+     * @property {Number} binCount
+     * @default 16
+     */
+    int binCount = 16;
+
+    /**
+     * A bounding volume hierarchy over the triangles of a mesh, built top down with the binned surface area heuristic and stored as a flat array. The queries call a visitor for each triangle instead of filling a list, so they do not allocate. Does not support updates, rebuild it instead.
+     * @class TriangleBVH
+     * @constructor
+     * @see https://www.sci.utah.edu/~wald/Publications/2007/ParallelBVHBuild/fastbuild.pdf
+     */
+    TriangleBVH() {};
+
+    /**
+     * Build the hierarchy.
+     * @method build
+     * @param {Array} vertices Vertex coordinates, 3 per vertex.
+     * @param {Array} indices Vertex indices, 3 per triangle.
+     */
+    void build(std::vector<float>* vertices, std::vector<int>* indices);
+
+    /**
+     * Clear the hierarchy.
+     * @method reset
+     */
+    void reset();
+
+    /**
+     * Call visitor(triangle) for the triangles in the leaves that overlap the given AABB. Leaves hold up to .maxLeafSize triangles, so some of them may not overlap it themselves.
+     * @method aabbQuery
+     * @param  {AABB} aabb
+     * @param  {Function} visitor
+     */
+    template<class Visitor>
+    void aabbQuery(Collision::AABB* aabb, Visitor visitor) {
+        if (this->nodes.empty()) {
+            return;
+        }
+
+        float lo[3] = { aabb->lowerBound.x, aabb->lowerBound.y, aabb->lowerBound.z };
+        float hi[3] = { aabb->upperBound.x, aabb->upperBound.y, aabb->upperBound.z };
+
+        int stack[maxDepth + 1];
+        int stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0) {
+            int nodeId = stack[--stackSize];
+            LinearBVHNode* node = &this->nodes[nodeId];
+
+            if (node->lowerBound[0] > hi[0] || node->upperBound[0] < lo[0]
+                || node->lowerBound[1] > hi[1] || node->upperBound[1] < lo[1]
+                || node->lowerBound[2] > hi[2] || node->upperBound[2] < lo[2]) {
+                continue;
+            }
+
+            if (node->count > 0) {
+                for (int i = node->offset; i < node->offset + node->count; i++) {
+                    visitor(this->triangles[i]);
+                }
+            } else {
+                stack[stackSize++] = node->offset;
+                stack[stackSize++] = nodeId + 1;
+            }
+        }
+    }
+
+    /**
+     * Get the triangles in the leaves that overlap the given AABB.
+     * @method aabbQuery
+     * @param  {AABB} aabb
+     * @param  {array} result
+     * @return {array} The "result" object
+     */
+    std::vector<int>* aabbQuery(Collision::AABB* aabb, std::vector<int>* result);
+
+    /**
+     * Call visitor(triangle) for the triangles in the leaves hit by the line segment between from and to.
+     * @method rayQuery
+     * @param  {Vec3} from
+     * @param  {Vec3} to
+     * @param  {Function} visitor
+     */
+    template<class Visitor>
+    void rayQuery(Math::Vec3* from, Math::Vec3* to, Visitor visitor) {
+        if (this->nodes.empty()) {
+            return;
+        }
+
+        // Slab test against the segment, parametrized as from + t * (to - from) with t in [0, 1]
+        float d[3] = { to->x - from->x, to->y - from->y, to->z - from->z };
+        float inv[3] = { 1.0f / d[0], 1.0f / d[1], 1.0f / d[2] };
+        float o[3] = { from->x, from->y, from->z };
+
+        int stack[maxDepth + 1];
+        int stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0) {
+            int nodeId = stack[--stackSize];
+            LinearBVHNode* node = &this->nodes[nodeId];
+
+            float tmin = 0;
+            float tmax = 1;
+            bool hit = true;
+            for (int i = 0; i < 3; i++) {
+                if (d[i] == 0) {
+                    // Parallel to the slab, must start inside it
+                    if (o[i] < node->lowerBound[i] || o[i] > node->upperBound[i]) {
+                        hit = false;
+                        break;
+                    }
+                    continue;
+                }
+                float t1 = (node->lowerBound[i] - o[i]) * inv[i];
+                float t2 = (node->upperBound[i] - o[i]) * inv[i];
+                tmin = std::max(tmin, std::min(t1, t2));
+                tmax = std::min(tmax, std::max(t1, t2));
+                if (tmin > tmax) {
+                    hit = false;
+                    break;
+                }
+            }
+
+            if (!hit) {
+                continue;
+            }
+
+            if (node->count > 0) {
+                for (int i = node->offset; i < node->offset + node->count; i++) {
+                    visitor(this->triangles[i]);
+                }
+            } else {
+                stack[stackSize++] = node->offset;
+                stack[stackSize++] = nodeId + 1;
+            }
+        }
+    }
+
+    /**
+     * Get the depth of the hierarchy. A single leaf has depth 1, an empty hierarchy 0.
+     * @method getDepth
+     * @return {Number}
+     */
+    int getDepth();
+};
+
+}
+
+#endif
@@ -1,5 +1,5 @@
-#ifndef EventTarget_h
-#define Body_h
+#ifndef TupleDictionary_h
+#define TupleDictionary_h
 
 #include <map>
 
@@ -1,6 +1,7 @@
 #ifndef Narrowphase_h
 #define Narrowphase_h
 
+#include <mutex>
 #include <vector>
 #include "objects/Body.h"
 #include "shapes/Shape.h"
@@ -10,8 +11,15 @@
 #include "shapes/Trimesh.h"
 #include "shapes/Particle.h"
 #include "shapes/Heightfield.h"
+#include "shapes/Capsule.h"
+#include "shapes/Cylinder.h"
 #include "shapes/ConvexPolyhedron.h"
 #include "utils/Vec3Pool.h"
+#include "utils/ThreadPool.h"
+#include "collision/GJK.h"
+#include "collision/BoxBox.h"
+#include "collision/ContactReduction.h"
+#include "collision/SeparatingAxisCache.h"
 #include "material/ContactMaterial.h"
 #include "equations/ContactEquation.h"
 #include "equations/FrictionEquation.h"
@@ -24,16 +32,110 @@ class Narrowphase {
 private:
     World* world_;
 
+    // One Narrowphase per thread of .threadPool, with the pools and results of the task it runs, and the changes it makes to .separatingAxisCache
+    std::vector<Narrowphase*> workers_;
+    std::vector<std::vector<Equations::ContactEquation*>> threadContactPools_;
+    std::vector<std::vector<Equations::FrictionEquation*>> threadFrictionPools_;
+    std::vector<std::vector<Equations::ContactEquation*>> taskResults_;
+    std::vector<std::vector<Equations::FrictionEquation*>> taskFrictionResults_;
+    std::vector<Collision::SeparatingAxisCache> taskAxisCaches_;
+
+    // Workers refill their pools from the pools of the parent, a batch at a time
+    Narrowphase* parent_ = nullptr;
+    std::mutex poolMutex_;
+
+    template<class T>
+    void takeFromPool_(std::vector<T*>* shared, std::vector<T*>* target);
+
+    // The triangle that convexTrimesh collides with, around its centroid in the orientation of the trimesh
+    Shapes::ConvexPolyhedron triangleHull_{
+        new std::vector<Math::Vec3>(3),
+        new std::vector<std::vector<int>>({ { 0, 1, 2 } })};
+
+    // Fill .triangleHull_ with a triangle of the mesh, and set position to its centroid in world space
+    void updateTriangleHull_(Shapes::Trimesh* mesh, int triangle, Math::Vec3* xj, Math::Quaternion* qj, Math::Vec3* position);
+
+    // Contact points of the current sphereTrimesh call, so that triangles sharing the closest point make one contact
+    std::vector<Math::Vec3> trimeshContactPoints_;
+
+    // Contacts of the last boxBox call
+    Collision::BoxBoxResult boxBoxResult_;
+
+    // Candidate points of a pair and the ones kept, when .enableContactReduction is set
+    std::vector<Math::Vec3> reductionPoints_;
+    std::vector<float> reductionDepths_;
+    std::vector<int> reducedContacts_;
+
+    // The separating axis cache used by convexConvex
+    Collision::SeparatingAxisCache* axisCache_ = &this->separatingAxisCache;
+
+    // The time step a pair with a .ccd body is predicted over
+    float ccdTimeStep_(Objects::Body* bi, Objects::Body* bj);
+
+    // Contact between separated shapes that will touch within the time step, for bodies with .ccd set
+    bool speculativeContact_(
+        Shapes::Shape* si,
+        Shapes::Shape* sj,
+        Math::Vec3* xi,
+        Math::Vec3* xj,
+        Math::Quaternion* qi,
+        Math::Quaternion* qj,
+        Objects::Body* bi,
+        Objects::Body* bj);
+
+    // Contact between the sphere of radius radiusI around centerI and the one around centerJ. If the centers coincide, fallbackNormal is used.
+    bool sphereSphereContact_(
+        Math::Vec3* centerI,
+        float radiusI,
+        Math::Vec3* centerJ,
+        float radiusJ,
+        Math::Vec3* fallbackNormal,
+        Objects::Body* bi,
+        Objects::Body* bj,
+        Shapes::Shape* si,
+        Shapes::Shape* sj,
+        bool justTest);
+
+    // Rebuild the Body.shapeTree of the bodies that use it, before the pairs are split over threads
+    void updateShapeTrees_(std::vector<Objects::Body*>* p1, std::vector<Objects::Body*>* p2);
+
+    // Shapes of the tree body that overlap a shape of the other body, and the traversal stack of the query
+    std::vector<int> shapeTreeResult_;
+    std::vector<int> shapeTreeStack_;
+
+    // Contacts between shape si of bi and shape sj of bj, at the given world transforms. margin is how far apart speculative pairs may be.
+    void collideShapes_(
+        Shapes::Shape* si,
+        Shapes::Shape* sj,
+        Math::Vec3* xi,
+        Math::Vec3* xj,
+        Math::Quaternion* qi,
+        Math::Quaternion* qj,
+        Objects::Body* bi,
+        Objects::Body* bj,
+        World* world,
+        bool justTest,
+        bool speculative,
+        float margin);
+
+    // Generate the contacts of the pairs [begin, end) into .result
+    void collidePairs_(
+        std::vector<Objects::Body*>* p1,
+        std::vector<Objects::Body*>* p2,
+        World* world,
+        int begin,
+        int end);
+
 public:
     /**
      * Internal storage of pooled contact points.
      * @property {Array} contactPointPool
      */
-    std::vector<Equations::ContactEquation *> contactPointPool;
-    std::vector<Equations::FrictionEquation *> frictionEquationPool;
+    std::vector<Equations::ContactEquation*>* contactPointPool = nullptr;
+    std::vector<Equations::FrictionEquation*>* frictionEquationPool = nullptr;
 
-    std::vector<Equations::ContactEquation*> result;
-    std::vector<Equations::FrictionEquation*> frictionResult;
+    std::vector<Equations::ContactEquation*>* result = nullptr;
+    std::vector<Equations::FrictionEquation*>* frictionResult = nullptr;
 
     /**
      * Pooled vectors.
@@ -41,22 +143,68 @@ public:
      */
     Utils::Vec3Pool v3pool;
 
-    Material::ContactMaterial* currentContactMaterial;
+    Material::ContactMaterial* currentContactMaterial = nullptr;
+
+    /**
+     * Distance and penetration queries for the convex pairs that have no dedicated routine.
+     * @property {GJK} gjk
+     */
+    Collision::GJK gjk;
+
+    /**
+     * Analytic box-box contacts, used by boxBox instead of the convex polyhedron representations of the boxes.
+     * @property {BoxBox} boxBoxCollider
+     */
+    Collision::BoxBox boxBoxCollider;
+
+    /**
+     * The last separating axis of each pair of convex polyhedra, tried first by convexConvex. Entries of pairs that were not tested in a step are dropped at the start of the next getContacts(). With a .threadPool, the tasks only read it, and their changes are made after the step in task order.
+     * @property {SeparatingAxisCache} separatingAxisCache
+     */
+    Collision::SeparatingAxisCache separatingAxisCache;
 
     /**
      * @property {Boolean} enableFrictionReduction
      */
     bool enableFrictionReduction = false;
 
+    /**
+     * Keep at most ContactReduction.maxContacts of the clipped contact points of each face contact in boxBox and convexConvex, so that a face-face contact makes 4 equations instead of one per clipped vertex.
+     * @property {Boolean} enableContactReduction
+     * @default false
+     */
+    bool enableContactReduction = false;
+
+    /**
+     * Pairs with a body of at least this many shapes only test the shapes whose AABBs overlap, found with Body.shapeTree, instead of every shape against every shape.
+     * @property {Number} shapeTreeMinShapes
+     * @default 8
+     */
+    int shapeTreeMinShapes = 8;
+
+    /**
+     * Thread pool to split .getContacts() over. Runs on the calling thread if not set.
+     * @property {ThreadPool} threadPool
+     */
+    Utils::ThreadPool* threadPool = nullptr;
+
+    /**
+     * Number of body pairs per task when running on .threadPool.
+     * @property {Number} pairsPerTask
+     * @default 32
+     */
+    int pairsPerTask = 32;
+
     /**
      * Helper class for the World. Generates ContactEquations.
      * @class Narrowphase
      * @constructor
      * @todo Sphere-ConvexPolyhedron contacts
-     * @todo Contact reduction
      * @todo  should move methods to prototype
      */
     Narrowphase(World* world): world_(world) {};
+    Narrowphase(const Narrowphase&) = delete;
+    ~Narrowphase();
 
     /**
      * Make a contact object, by using the internal pool or creating a new one.
@@ -92,6 +240,7 @@ public:
      * @param {World} world
      * @param {array} result Array to store generated contacts
      * @param {array} oldcontacts Optional. Array of reusable contact objects
+     * @description With a .threadPool, the pairs are split into tasks of .pairsPerTask. Each thread takes reusable objects from oldcontacts and frictionPool in small batches, and gives back what it did not use. The results of the tasks are appended in pair order, so they are the same as on one thread. The equations added to result get consecutive ids in that order, on the calling thread.
      */
     void getContacts(
         std::vector<Objects::Body*>* p1,
@@ -102,6 +251,31 @@ public:
         std::vector<Equations::FrictionEquation*>* frictionResult,
         std::vector<Equations::FrictionEquation*>* frictionPool);
 
+    /**
+     * Contacts between any two convex shapes that implement Shape.supportPoint(), from the GJK/EPA penetration. Makes at most one contact per call.
+     * @method convexGJK
+     * @param  {Shape}      si
+     * @param  {Shape}      sj
+     * @param  {Vec3}       xi
+     * @param  {Vec3}       xj
+     * @param  {Quaternion} qi
+     * @param  {Quaternion} qj
+     * @param  {Body}       bi
+     * @param  {Body}       bj
+     */
+    bool convexGJK(
+        Shapes::Shape* si,
+        Shapes::Shape* sj,
+        Math::Vec3* xi,
+        Math::Vec3* xj,
+        Math::Quaternion* qi,
+        Math::Quaternion* qj,
+        Objects::Body* bi,
+        Objects::Body* bj,
+        Shapes::Shape* rsi,
+        Shapes::Shape* rsj,
+        bool justTest);
+
     // Narrowphase.prototype[Shape.types.BOX | Shape.types.BOX] =
     bool boxBox(
         Shapes::Box* si,
@@ -119,7 +293,7 @@ public:
     // Narrowphase.prototype[Shape.types.BOX | Shape.types.CONVEXPOLYHEDRON] =
     bool boxConvex(
         Shapes::Box* si,
-        Shapes::Box* sj,
+        Shapes::ConvexPolyhedron* sj,
         Math::Vec3* xi,
         Math::Vec3* xj,
         Math::Quaternion* qi,
@@ -333,7 +507,7 @@ public:
      */
     // Narrowphase.prototype[Shape.types.PLANE | Shape.types.CONVEXPOLYHEDRON] =
     bool planeConvex(
-        Shapes::Sphere* planeShape,
+        Shapes::Plane* planeShape,
         Shapes::ConvexPolyhedron* convexShape,
         Math::Vec3* planePosition,
         Math::Vec3* convexPosition,
@@ -345,6 +519,156 @@ public:
         Shapes::Shape* sj,
         bool justTest);
 
+    /**
+     * The sphere against the closest point of the capsule segment.
+     * @method sphereCapsule
+     * @param  {Shape}      si
+     * @param  {Shape}      sj
+     * @param  {Vec3}       xi
+     * @param  {Vec3}       xj
+     * @param  {Quaternion} qi
+     * @param  {Quaternion} qj
+     * @param  {Body}       bi
+     * @param  {Body}       bj
+     */
+    bool sphereCapsule(
+        Shapes::Sphere* si,
+        Shapes::Capsule* sj,
+        Math::Vec3* xi,
+        Math::Vec3* xj,
+        Math::Quaternion* qi,
+        Math::Quaternion* qj,
+        Objects::Body* bi,
+        Objects::Body* bj,
+        Shapes::Shape* rsi,
+        Shapes::Shape* rsj,
+        bool justTest);
+
+    /**
+     * One contact for each end cap behind the plane.
+     * @method planeCapsule
+     * @param  {Shape}      si
+     * @param  {Shape}      sj
+     * @param  {Vec3}       xi
+     * @param  {Vec3}       xj
+     * @param  {Quaternion} qi
+     * @param  {Quaternion} qj
+     * @param  {Body}       bi
+     * @param  {Body}       bj
+     */
+    bool planeCapsule(
+        Shapes::Plane* si,
+        Shapes::Capsule* sj,
+        Math::Vec3* xi,
+        Math::Vec3* xj,
+        Math::Quaternion* qi,
+        Math::Quaternion* qj,
+        Objects::Body* bi,
+        Objects::Body* bj,
+        Shapes::Shape* rsi,
+        Shapes::Shape* rsj,
+        bool justTest);
+
+    /**
+     * The closest points of the capsule segment and the box. A segment parallel to a box face gets a contact at each end of the part that lies over the face. If the segment enters the box, falls back to convexGJK.
+     * @method boxCapsule
+     * @param  {Shape}      si
+     * @param  {Shape}      sj
+     * @param  {Vec3}       xi
+     * @param  {Vec3}       xj
+     * @param  {Quaternion} qi
+     * @param  {Quaternion} qj
+     * @param  {Body}       bi
+     * @param  {Body}       bj
+     */
+    bool boxCapsule(
+        Shapes::Box* si,
+        Shapes::Capsule* sj,
+        Math::Vec3* xi,
+        Math::Vec3* xj,
+        Math::Quaternion* qi,
+        Math::Quaternion* qj,
+        Objects::Body* bi,
+        Objects::Body* bj,
+        Shapes::Shape* rsi,
+        Shapes::Shape* rsj,
+        bool justTest);
+
+    /**
+     * The closest points of the two segments, or the two ends of their overlap if they are parallel.
+     * @method capsuleCapsule
+     * @param  {Shape}      si
+     * @param  {Shape}      sj
+     * @param  {Vec3}       xi
+     * @param  {Vec3}       xj
+     * @param  {Quaternion} qi
+     * @param  {Quaternion} qj
+     * @param  {Body}       bi
+     * @param  {Body}       bj
+     */
+    bool capsuleCapsule(
+        Shapes::Capsule* si,
+        Shapes::Capsule* sj,
+        Math::Vec3* xi,
+        Math::Vec3* xj,
+        Math::Quaternion* qi,
+        Math::Quaternion* qj,
+        Objects::Body* bi,
+        Objects::Body* bj,
+        Shapes::Shape* rsi,
+        Shapes::Shape* rsj,
+        bool justTest);
+
+    /**
+     * The sphere against the closest point of the cylinder, or the closest face if the center is inside.
+     * @method sphereCylinder
+     * @param  {Shape}      si
+     * @param  {Shape}      sj
+     * @param  {Vec3}       xi
+     * @param  {Vec3}       xj
+     * @param  {Quaternion} qi
+     * @param  {Quaternion} qj
+     * @param  {Body}       bi
+     * @param  {Body}       bj
+     */
+    bool sphereCylinder(
+        Shapes::Sphere* si,
+        Shapes::Cylinder* sj,
+        Math::Vec3* xi,
+        Math::Vec3* xj,
+        Math::Quaternion* qi,
+        Math::Quaternion* qj,
+        Objects::Body* bi,
+        Objects::Body* bj,
+        Shapes::Shape* rsi,
+        Shapes::Shape* rsj,
+        bool justTest);
+
+    /**
+     * Up to four points on the rim of each cap, starting at the deepest one.
+     * @method planeCylinder
+     * @param  {Shape}      si
+     * @param  {Shape}      sj
+     * @param  {Vec3}       xi
+     * @param  {Vec3}       xj
+     * @param  {Quaternion} qi
+     * @param  {Quaternion} qj
+     * @param  {Body}       bi
+     * @param  {Body}       bj
+     */
+    bool planeCylinder(
+        Shapes::Plane* si,
+        Shapes::Cylinder* sj,
+        Math::Vec3* xi,
+        Math::Vec3* xj,
+        Math::Quaternion* qi,
+        Math::Quaternion* qj,
+        Objects::Body* bi,
+        Objects::Body* bj,
+        Shapes::Shape* rsi,
+        Shapes::Shape* rsj,
+        bool justTest);
+
     /**
      * @method convexConvex
      * @param  {Shape}      si
@@ -373,9 +697,9 @@ public:
         std::vector<int>* faceListB);
 
     /**
+     * Contacts between a convex shape and the triangles of a trimesh found in the Trimesh.tree. Boxes and convex polyhedra are clipped against each triangle like in convexConvex, which gives up to a contact per corner of the clipped face. Other shapes get one contact per overlapping triangle from GJK and EPA.
      * @method convexTrimesh
-     * @param  {Array}      result
-     * @param  {Shape}      si
+     * @param  {Shape}      si A shape with Shape.isConvex()
      * @param  {Shape}      sj
      * @param  {Vec3}       xi
      * @param  {Vec3}       xj
@@ -385,72 +709,18 @@ public:
      * @param  {Body}       bj
      */
     // Narrowphase.prototype[Shape.types.CONVEXPOLYHEDRON | Shape.types.TRIMESH] =
-    // Narrowphase.prototype.convexTrimesh = function(si,sj,xi,xj,qi,qj,bi,bj,rsi,rsj,faceListA,faceListB){
-    //     var sepAxis = convexConvex_sepAxis;
-
-    //     if(xi.distanceTo(xj) > si.boundingSphereRadius + sj.boundingSphereRadius){
-    //         return;
-    //     }
-
-    //     // Construct a temp hull for each triangle
-    //     var hullB = new ConvexPolyhedron();
-
-    //     hullB.faces = [[0,1,2]];
-    //     var va = new Vec3();
-    //     var vb = new Vec3();
-    //     var vc = new Vec3();
-    //     hullB.vertices = [
-    //         va,
-    //         vb,
-    //         vc
-    //     ];
-
-    //     for (var i = 0; i < sj.indices.length / 3; i++) {
-
-    //         var triangleNormal = new Vec3();
-    //         sj.getNormal(i, triangleNormal);
-    //         hullB.faceNormals = [triangleNormal];
-
-    //         sj.getTriangleVertices(i, va, vb, vc);
-
-    //         var d = si.testSepAxis(triangleNormal, hullB, xi, qi, xj, qj);
-    //         if(!d){
-    //             triangleNormal.scale(-1, triangleNormal);
-    //             d = si.testSepAxis(triangleNormal, hullB, xi, qi, xj, qj);
-
-    //             if(!d){
-    //                 continue;
-    //             }
-    //         }
-
-    //         var res = [];
-    //         var q = convexConvex_q;
-    //         si.clipAgainstHull(xi,qi,hullB,xj,qj,triangleNormal,-100,100,res);
-    //         for(var j = 0; j !== res.length; j++){
-    //             var r = this.createContactEquation(bi,bj,si,sj,rsi,rsj),
-    //                 ri = r.ri,
-    //                 rj = r.rj;
-    //             r.ni.copy(triangleNormal);
-    //             r.ni.negate(r.ni);
-    //             res[j].normal.negate(q);
-    //             q.mult(res[j].depth, q);
-    //             res[j].point.vadd(q, ri);
-    //             rj.copy(res[j].point);
-
-    //             // Contact points are in world coordinates. Transform back to relative
-    //             ri.vsub(xi,ri);
-    //             rj.vsub(xj,rj);
-
-    //             // Make relative to bodies
-    //             ri.vadd(xi, ri);
-    //             ri.vsub(bi.position, ri);
-    //             rj.vadd(xj, rj);
-    //             rj.vsub(bj.position, rj);
-
-    //             result.push(r);
-    //         }
-    //     }
-    // };
+    bool convexTrimesh(
+        Shapes::Shape* si,
+        Shapes::Trimesh* sj,
+        Math::Vec3* xi,
+        Math::Vec3* xj,
+        Math::Quaternion* qi,
+        Math::Quaternion* qj,
+        Objects::Body* bi,
+        Objects::Body* bj,
+        Shapes::Shape* rsi,
+        Shapes::Shape* rsj,
+        bool justTest);
 
     /**
      * @method particlePlane
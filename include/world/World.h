@@ -9,6 +9,7 @@
 #include "objects/Body.h"
 #include "collision/Ray.h"
 #include "collision/ObjectCollisionMatrix.h"
+#include "collision/Broadphase.h"
 #include "collision/NaiveBroadphase.h"
 #include "utils/EventTarget.h"
 #include "utils/TupleDictionary.h"
@@ -119,7 +120,7 @@ public:
      * @property broadphase
      * @type {Broadphase}
      */
-    Collision::NaiveBroadphase* broadphase;
+    Collision::Broadphase* broadphase;
 
     /**
      * @property bodies
@@ -154,6 +155,13 @@ public:
 
     Collision::ObjectCollisionMatrix triggerMatrix;
 
+    /**
+     * Get the collision pairs from broadphase.updatePairs() instead of broadphase.collisionPairs(). The collision bookkeeping is then only updated for the pairs in broadphase.pairCache.added1/2 and .removed1/2, instead of comparing the full collision matrices of this and the last step.
+     * @property {Boolean} usePairDeltas
+     * @default false
+     */
+    bool usePairDeltas = false;
+
     /**
      * All added materials
      * @property materials
@@ -242,6 +250,12 @@ public:
      */
     void collisionMatrixTick();
 
+    /**
+     * Update .collisionMatrix and .contactsDic from the pair deltas in broadphase.pairCache, and emit the "beginContact" and "endContact" events for them. Used in place of .collisionMatrixTick() and the full diff in .emitCollisionEvents() when .usePairDeltas is set.
+     * @method applyPairDeltas
+     */
+    void applyPairDeltas();
+
     /**
      * Add a rigid body to the simulation.
      * @method add
@@ -252,6 +266,13 @@ public:
      */
     void addBody(Objects::Body* body);
 
+    /**
+     * Add many rigid bodies at once. Same as calling .addBody() for each of them, but the broadphase gets them in one broadphase.addBodies() call so that it can bulk build its structures.
+     * @method addBodies
+     * @param {Array} bodies
+     */
+    void addBodies(std::vector<Objects::Body*>* bodies);
+
     /**
      * Add a constraint to the simulation.
      * @method addConstraint
@@ -1,317 +1,235 @@
-// /**
-//  * Axis aligned bounding box class.
-//  * @class AABB
-//  * @constructor
-//  * @param {Object} [options]
-//  * @param {Vec3}   [options.upperBound]
-//  * @param {Vec3}   [options.lowerBound]
-//  */
-// function AABB(options){
-//     options = options || {};
-
-//     /**
-//      * The lower bound of the bounding box.
-//      * @property lowerBound
-//      * @type {Vec3}
-//      */
-//     this.lowerBound = new Vec3();
-//     if(options.lowerBound){
-//         this.lowerBound.copy(options.lowerBound);
-//     }
-
-//     /**
-//      * The upper bound of the bounding box.
-//      * @property upperBound
-//      * @type {Vec3}
-//      */
-//     this.upperBound = new Vec3();
-//     if(options.upperBound){
-//         this.upperBound.copy(options.upperBound);
-//     }
-// }
-
-// var tmp = new Vec3();
-
-// /**
-//  * Set the AABB bounds from a set of points.
-//  * @method setFromPoints
-//  * @param {Array} points An array of Vec3's.
-//  * @param {Vec3} position
-//  * @param {Quaternion} quaternion
-//  * @param {number} skinSize
-//  * @return {AABB} The self object
-//  */
-// AABB.prototype.setFromPoints = function(points, position, quaternion, skinSize){
-//     var l = this.lowerBound,
-//         u = this.upperBound,
-//         q = quaternion;
-
-//     // Set to the first point
-//     l.copy(points[0]);
-//     if(q){
-//         q.vmult(l, l);
-//     }
-//     u.copy(l);
-
-//     for(var i = 1; i<points.length; i++){
-//         var p = points[i];
-
-//         if(q){
-//             q.vmult(p, tmp);
-//             p = tmp;
-//         }
-
-//         if(p.x > u.x){ u.x = p.x; }
-//         if(p.x < l.x){ l.x = p.x; }
-//         if(p.y > u.y){ u.y = p.y; }
-//         if(p.y < l.y){ l.y = p.y; }
-//         if(p.z > u.z){ u.z = p.z; }
-//         if(p.z < l.z){ l.z = p.z; }
-//     }
-
-//     // Add offset
-//     if (position) {
-//         position.vadd(l, l);
-//         position.vadd(u, u);
-//     }
-
-//     if(skinSize){
-//         l.x -= skinSize;
-//         l.y -= skinSize;
-//         l.z -= skinSize;
-//         u.x += skinSize;
-//         u.y += skinSize;
-//         u.z += skinSize;
-//     }
-
-//     return this;
-// };
-
-// /**
-//  * Copy bounds from an AABB to this AABB
-//  * @method copy
-//  * @param  {AABB} aabb Source to copy from
-//  * @return {AABB} The this object, for chainability
-//  */
-// AABB.prototype.copy = function(aabb){
-//     this.lowerBound.copy(aabb.lowerBound);
-//     this.upperBound.copy(aabb.upperBound);
-//     return this;
-// };
-
-// /**
-//  * Clone an AABB
-//  * @method clone
-//  */
-// AABB.prototype.clone = function(){
-//     return new AABB().copy(this);
-// };
-
-// /**
-//  * Extend this AABB so that it covers the given AABB too.
-//  * @method extend
-//  * @param  {AABB} aabb
-//  */
-// AABB.prototype.extend = function(aabb){
-//     this.lowerBound.x = Math.min(this.lowerBound.x, aabb.lowerBound.x);
-//     this.upperBound.x = Math.max(this.upperBound.x, aabb.upperBound.x);
-//     this.lowerBound.y = Math.min(this.lowerBound.y, aabb.lowerBound.y);
-//     this.upperBound.y = Math.max(this.upperBound.y, aabb.upperBound.y);
-//     this.lowerBound.z = Math.min(this.lowerBound.z, aabb.lowerBound.z);
-//     this.upperBound.z = Math.max(this.upperBound.z, aabb.upperBound.z);
-// };
-
-// /**
-//  * Returns true if the given AABB overlaps this AABB.
-//  * @method overlaps
-//  * @param  {AABB} aabb
-//  * @return {Boolean}
-//  */
-// AABB.prototype.overlaps = function(aabb){
-//     var l1 = this.lowerBound,
-//         u1 = this.upperBound,
-//         l2 = aabb.lowerBound,
-//         u2 = aabb.upperBound;
-
-//     //      l2        u2
-//     //      |---------|
-//     // |--------|
-//     // l1       u1
-
-//     var overlapsX = ((l2.x <= u1.x && u1.x <= u2.x) || (l1.x <= u2.x && u2.x <= u1.x));
-//     var overlapsY = ((l2.y <= u1.y && u1.y <= u2.y) || (l1.y <= u2.y && u2.y <= u1.y));
-//     var overlapsZ = ((l2.z <= u1.z && u1.z <= u2.z) || (l1.z <= u2.z && u2.z <= u1.z));
-
-//     return overlapsX && overlapsY && overlapsZ;
-// };
-
-// // Mostly for debugging
-// AABB.prototype.volume = function(){
-//     var l = this.lowerBound,
-//         u = this.upperBound;
-//     return (u.x - l.x) * (u.y - l.y) * (u.z - l.z);
-// };
-
-
-// /**
-//  * Returns true if the given AABB is fully contained in this AABB.
-//  * @method contains
-//  * @param {AABB} aabb
-//  * @return {Boolean}
-//  */
-// AABB.prototype.contains = function(aabb){
-//     var l1 = this.lowerBound,
-//         u1 = this.upperBound,
-//         l2 = aabb.lowerBound,
-//         u2 = aabb.upperBound;
-
-//     //      l2        u2
-//     //      |---------|
-//     // |---------------|
-//     // l1              u1
-
-//     return (
-//         (l1.x <= l2.x && u1.x >= u2.x) &&
-//         (l1.y <= l2.y && u1.y >= u2.y) &&
-//         (l1.z <= l2.z && u1.z >= u2.z)
-//     );
-// };
-
-// /**
-//  * @method getCorners
-//  * @param {Vec3} a
-//  * @param {Vec3} b
-//  * @param {Vec3} c
-//  * @param {Vec3} d
-//  * @param {Vec3} e
-//  * @param {Vec3} f
-//  * @param {Vec3} g
-//  * @param {Vec3} h
-//  */
-// AABB.prototype.getCorners = function(a, b, c, d, e, f, g, h){
-//     var l = this.lowerBound,
-//         u = this.upperBound;
-
-//     a.copy(l);
-//     b.set( u.x, l.y, l.z );
-//     c.set( u.x, u.y, l.z );
-//     d.set( l.x, u.y, u.z );
-//     e.set( u.x, l.y, u.z );
-//     f.set( l.x, u.y, l.z );
-//     g.set( l.x, l.y, u.z );
-//     h.copy(u);
-// };
-
-// var transformIntoFrame_corners = [
-//     new Vec3(),
-//     new Vec3(),
-//     new Vec3(),
-//     new Vec3(),
-//     new Vec3(),
-//     new Vec3(),
-//     new Vec3(),
-//     new Vec3()
-// ];
-
-// /**
-//  * Get the representation of an AABB in another frame.
-//  * @method toLocalFrame
-//  * @param  {Transform} frame
-//  * @param  {AABB} target
-//  * @return {AABB} The "target" AABB object.
-//  */
-// AABB.prototype.toLocalFrame = function(frame, target){
-
-//     var corners = transformIntoFrame_corners;
-//     var a = corners[0];
-//     var b = corners[1];
-//     var c = corners[2];
-//     var d = corners[3];
-//     var e = corners[4];
-//     var f = corners[5];
-//     var g = corners[6];
-//     var h = corners[7];
-
-//     // Get corners in current frame
-//     this.getCorners(a, b, c, d, e, f, g, h);
-
-//     // Transform them to new local frame
-//     for(var i=0; i !== 8; i++){
-//         var corner = corners[i];
-//         frame.pointToLocal(corner, corner);
-//     }
-
-//     return target.setFromPoints(corners);
-// };
-
-// /**
-//  * Get the representation of an AABB in the global frame.
-//  * @method toWorldFrame
-//  * @param  {Transform} frame
-//  * @param  {AABB} target
-//  * @return {AABB} The "target" AABB object.
-//  */
-// AABB.prototype.toWorldFrame = function(frame, target){
-
-//     var corners = transformIntoFrame_corners;
-//     var a = corners[0];
-//     var b = corners[1];
-//     var c = corners[2];
-//     var d = corners[3];
-//     var e = corners[4];
-//     var f = corners[5];
-//     var g = corners[6];
-//     var h = corners[7];
-
-//     // Get corners in current frame
-//     this.getCorners(a, b, c, d, e, f, g, h);
-
-//     // Transform them to new local frame
-//     for(var i=0; i !== 8; i++){
-//         var corner = corners[i];
-//         frame.pointToWorld(corner, corner);
-//     }
-
-//     return target.setFromPoints(corners);
-// };
-
-// /**
-//  * Check if the AABB is hit by a ray.
-//  * @param  {Ray} ray
-//  * @return {number}
-//  */
-// AABB.prototype.overlapsRay = function(ray){
-//     var t = 0;
-
-//     // ray.direction is unit direction vector of ray
-//     var dirFracX = 1 / ray._direction.x;
-//     var dirFracY = 1 / ray._direction.y;
-//     var dirFracZ = 1 / ray._direction.z;
-
-//     // this.lowerBound is the corner of AABB with minimal coordinates - left bottom, rt is maximal corner
-//     var t1 = (this.lowerBound.x - ray.from.x) * dirFracX;
-//     var t2 = (this.upperBound.x - ray.from.x) * dirFracX;
-//     var t3 = (this.lowerBound.y - ray.from.y) * dirFracY;
-//     var t4 = (this.upperBound.y - ray.from.y) * dirFracY;
-//     var t5 = (this.lowerBound.z - ray.from.z) * dirFracZ;
-//     var t6 = (this.upperBound.z - ray.from.z) * dirFracZ;
-
-//     // var tmin = Math.max(Math.max(Math.min(t1, t2), Math.min(t3, t4)));
-//     // var tmax = Math.min(Math.min(Math.max(t1, t2), Math.max(t3, t4)));
-//     var tmin = Math.max(Math.max(Math.min(t1, t2), Math.min(t3, t4)), Math.min(t5, t6));
-//     var tmax = Math.min(Math.min(Math.max(t1, t2), Math.max(t3, t4)), Math.max(t5, t6));
-
-//     // if tmax < 0, ray (line) is intersecting AABB, but whole AABB is behing us
-//     if (tmax < 0){
-//         //t = tmax;
-//         return false;
-//     }
-
-//     // if tmin > tmax, ray doesn't intersect AABB
-//     if (tmin > tmax){
-//         //t = tmax;
-//         return false;
-//     }
-
-//     return true;
-// };
\ No newline at end of file
+#include "collision/AABB.h"
+
+#include <algorithm>
+#include <array>
+#include "math/Quaternion.h"
+#include "math/Transform.h"
+#include "collision/Ray.h"
+
+using namespace Cannon::Collision;
+
+Cannon::Math::Vec3 setFromPoints_tmp;
+AABB* AABB::setFromPoints(
+    std::vector<Math::Vec3>* points,
+    Math::Vec3* position,
+    Math::Quaternion* quaternion,
+    float skinSize) {
+    Math::Vec3* l = &this->lowerBound;
+    Math::Vec3* u = &this->upperBound;
+    Math::Quaternion* q = quaternion;
+    Math::Vec3* tmp = &setFromPoints_tmp;
+
+    // Set to the first point
+    l->copy(&points->at(0));
+    if (q != nullptr) {
+        q->vmult(l, l);
+    }
+    u->copy(l);
+
+    for (int i = 1; i < points->size(); i++) {
+        Math::Vec3* p = &points->at(i);
+
+        if (q != nullptr) {
+            q->vmult(p, tmp);
+            p = tmp;
+        }
+
+        if (p->x > u->x) { u->x = p->x; }
+        if (p->x < l->x) { l->x = p->x; }
+        if (p->y > u->y) { u->y = p->y; }
+        if (p->y < l->y) { l->y = p->y; }
+        if (p->z > u->z) { u->z = p->z; }
+        if (p->z < l->z) { l->z = p->z; }
+    }
+
+    // Add offset
+    if (position != nullptr) {
+        position->vadd(l, l);
+        position->vadd(u, u);
+    }
+
+    if (skinSize != 0) {
+        l->x -= skinSize;
+        l->y -= skinSize;
+        l->z -= skinSize;
+        u->x += skinSize;
+        u->y += skinSize;
+        u->z += skinSize;
+    }
+
+    return this;
+}
+
+AABB* AABB::copy(AABB* aabb) {
+    this->lowerBound.copy(&aabb->lowerBound);
+    this->upperBound.copy(&aabb->upperBound);
+    return this;
+}
+
+AABB AABB::clone() {
+    return AABB(this->lowerBound, this->upperBound);
+}
+
+void AABB::extend(AABB* aabb) {
+    this->lowerBound.x = std::min(this->lowerBound.x, aabb->lowerBound.x);
+    this->upperBound.x = std::max(this->upperBound.x, aabb->upperBound.x);
+    this->lowerBound.y = std::min(this->lowerBound.y, aabb->lowerBound.y);
+    this->upperBound.y = std::max(this->upperBound.y, aabb->upperBound.y);
+    this->lowerBound.z = std::min(this->lowerBound.z, aabb->lowerBound.z);
+    this->upperBound.z = std::max(this->upperBound.z, aabb->upperBound.z);
+}
+
+bool AABB::overlaps(AABB* aabb) {
+    Math::Vec3* l1 = &this->lowerBound;
+    Math::Vec3* u1 = &this->upperBound;
+    Math::Vec3* l2 = &aabb->lowerBound;
+    Math::Vec3* u2 = &aabb->upperBound;
+
+    //      l2        u2
+    //      |---------|
+    // |--------|
+    // l1       u1
+
+    bool overlapsX = ((l2->x <= u1->x && u1->x <= u2->x) || (l1->x <= u2->x && u2->x <= u1->x));
+    bool overlapsY = ((l2->y <= u1->y && u1->y <= u2->y) || (l1->y <= u2->y && u2->y <= u1->y));
+    bool overlapsZ = ((l2->z <= u1->z && u1->z <= u2->z) || (l1->z <= u2->z && u2->z <= u1->z));
+
+    return overlapsX && overlapsY && overlapsZ;
+}
+
+float AABB::volume() {
+    Math::Vec3* l = &this->lowerBound;
+    Math::Vec3* u = &this->upperBound;
+    return (u->x - l->x) * (u->y - l->y) * (u->z - l->z);
+}
+
+bool AABB::contains(AABB* aabb) {
+    Math::Vec3* l1 = &this->lowerBound;
+    Math::Vec3* u1 = &this->upperBound;
+    Math::Vec3* l2 = &aabb->lowerBound;
+    Math::Vec3* u2 = &aabb->upperBound;
+
+    //      l2        u2
+    //      |---------|
+    // |---------------|
+    // l1              u1
+
+    return (
+        (l1->x <= l2->x && u1->x >= u2->x) &&
+        (l1->y <= l2->y && u1->y >= u2->y) &&
+        (l1->z <= l2->z && u1->z >= u2->z)
+    );
+}
+
+void AABB::getCorners(
+    Math::Vec3* a, Math::Vec3* b, Math::Vec3* c, Math::Vec3* d,
+    Math::Vec3* e, Math::Vec3* f, Math::Vec3* g, Math::Vec3* h) {
+    Math::Vec3* l = &this->lowerBound;
+    Math::Vec3* u = &this->upperBound;
+
+    a->copy(l);
+    b->set(u->x, l->y, l->z);
+    c->set(u->x, u->y, l->z);
+    d->set(l->x, u->y, u->z);
+    e->set(u->x, l->y, u->z);
+    f->set(l->x, u->y, l->z);
+    g->set(l->x, l->y, u->z);
+    h->copy(u);
+}
+
+std::vector<Cannon::Math::Vec3> transformIntoFrame_corners(8);
+AABB* AABB::toLocalFrame(Math::Transform* frame, AABB* target) {
+    std::vector<Math::Vec3>* corners = &transformIntoFrame_corners;
+
+    // Get corners in current frame
+    this->getCorners(
+        &corners->at(0), &corners->at(1), &corners->at(2), &corners->at(3),
+        &corners->at(4), &corners->at(5), &corners->at(6), &corners->at(7));
+
+    // Transform them to new local frame
+    for (int i = 0; i != 8; i++) {
+        frame->pointToLocal(&corners->at(i), &corners->at(i));
+    }
+
+    return target->setFromPoints(corners, nullptr, nullptr, 0);
+}
+
+AABB* AABB::toWorldFrame(Math::Transform* frame, AABB* target) {
+    std::vector<Math::Vec3>* corners = &transformIntoFrame_corners;
+
+    // Get corners in current frame
+    this->getCorners(
+        &corners->at(0), &corners->at(1), &corners->at(2), &corners->at(3),
+        &corners->at(4), &corners->at(5), &corners->at(6), &corners->at(7));
+
+    // Transform them to new local frame
+    for (int i = 0; i != 8; i++) {
+        frame->pointToWorld(&corners->at(i), &corners->at(i));
+    }
+
+    return target->setFromPoints(corners, nullptr, nullptr, 0);
+}
+
+Cannon::Math::Vec3 overlapsRay_direction;
+bool AABB::overlapsRay(Ray* ray) {
+    // Unit direction vector of the ray
+    Math::Vec3* direction = &overlapsRay_direction;
+    ray->to.vsub(&ray->from, direction);
+    direction->normalize();
+
+    float dirFracX = 1 / direction->x;
+    float dirFracY = 1 / direction->y;
+    float dirFracZ = 1 / direction->z;
+
+    // this.lowerBound is the corner of AABB with minimal coordinates - left bottom, rt is maximal corner
+    float t1 = (this->lowerBound.x - ray->from.x) * dirFracX;
+    float t2 = (this->upperBound.x - ray->from.x) * dirFracX;
+    float t3 = (this->lowerBound.y - ray->from.y) * dirFracY;
+    float t4 = (this->upperBound.y - ray->from.y) * dirFracY;
+    float t5 = (this->lowerBound.z - ray->from.z) * dirFracZ;
+    float t6 = (this->upperBound.z - ray->from.z) * dirFracZ;
+
+    float tmin = std::max(std::max(std::min(t1, t2), std::min(t3, t4)), std::min(t5, t6));
+    float tmax = std::min(std::min(std::max(t1, t2), std::max(t3, t4)), std::max(t5, t6));
+
+    // if tmax < 0, ray (line) is intersecting AABB, but whole AABB is behing us
+    if (tmax < 0) {
+        return false;
+    }
+
+    // if tmin > tmax, ray doesn't intersect AABB
+    if (tmin > tmax) {
+        return false;
+    }
+
+    return true;
+}
+
+bool AABB::overlapsSegment(Math::Vec3* from, Math::Vec3* to) {
+    // Slab test, parametrized as from + t * (to - from) with t in [0, 1]
+    float o[3] = { from->x, from->y, from->z };
+    float d[3] = { to->x - from->x, to->y - from->y, to->z - from->z };
+    float lo[3] = { this->lowerBound.x, this->lowerBound.y, this->lowerBound.z };
+    float hi[3] = { this->upperBound.x, this->upperBound.y, this->upperBound.z };
+
+    float tmin = 0;
+    float tmax = 1;
+    for (int i = 0; i < 3; i++) {
+        if (d[i] == 0) {
+            // Parallel to the slab, must start inside it
+            if (o[i] < lo[i] || o[i] > hi[i]) {
+                return false;
+            }
+            continue;
+        }
+        float t1 = (lo[i] - o[i]) / d[i];
+        float t2 = (hi[i] - o[i]) / d[i];
+        tmin = std::max(tmin, std::min(t1, t2));
+        tmax = std::min(tmax, std::max(t1, t2));
+        if (tmin > tmax) {
+            return false;
+        }
+    }
+
+    return true;
+}
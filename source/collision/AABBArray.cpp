@@ -0,0 +1,189 @@
+#include "collision/AABBArray.h"
+
+#include <limits>
+#include "objects/Body.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace Cannon::Collision;
+
+#if defined(__AVX__)
+const int AABBArray::BATCH_SIZE = 8;
+#elif defined(__SSE2__)
+const int AABBArray::BATCH_SIZE = 4;
+#else
+const int AABBArray::BATCH_SIZE = 1;
+#endif
+
+int AABBArray::size() {
+    return this->size_;
+}
+
+void AABBArray::resize(int size) {
+    // Pad so that a full batch can be loaded from any index below size
+    int padded = ((size + 7) / 8) * 8 + 8;
+
+    // Padding boxes are NaN, they never overlap anything
+    float nan = std::numeric_limits<float>::quiet_NaN();
+    this->lowerX.resize(padded, nan);
+    this->lowerY.resize(padded, nan);
+    this->lowerZ.resize(padded, nan);
+    this->upperX.resize(padded, nan);
+    this->upperY.resize(padded, nan);
+    this->upperZ.resize(padded, nan);
+    this->positionX.resize(padded, nan);
+    this->positionY.resize(padded, nan);
+    this->positionZ.resize(padded, nan);
+    this->boundingRadius.resize(padded, nan);
+    this->collisionFilterGroup.resize(padded, 0);
+    this->collisionFilterMask.resize(padded, 0);
+    this->inactive.resize(padded, 1);
+
+    // Clear the boxes that were dropped
+    for (int i = size; i < this->size_ && i < padded; i++) {
+        this->lowerX[i] = this->lowerY[i] = this->lowerZ[i] = nan;
+        this->upperX[i] = this->upperY[i] = this->upperZ[i] = nan;
+        this->positionX[i] = this->positionY[i] = this->positionZ[i] = nan;
+        this->boundingRadius[i] = nan;
+    }
+
+    this->size_ = size;
+}
+
+void AABBArray::set(int index, Objects::Body* body) {
+    if (body->aabbNeedsUpdate) {
+        body->computeAABB();
+    }
+
+    this->lowerX[index] = body->aabb.lowerBound.x;
+    this->lowerY[index] = body->aabb.lowerBound.y;
+    this->lowerZ[index] = body->aabb.lowerBound.z;
+    this->upperX[index] = body->aabb.upperBound.x;
+    this->upperY[index] = body->aabb.upperBound.y;
+    this->upperZ[index] = body->aabb.upperBound.z;
+    this->positionX[index] = body->position.x;
+    this->positionY[index] = body->position.y;
+    this->positionZ[index] = body->position.z;
+    this->boundingRadius[index] = body->boundingRadius;
+    this->collisionFilterGroup[index] = body->collisionFilterGroup;
+    this->collisionFilterMask[index] = body->collisionFilterMask;
+    this->inactive[index] = ((body->type & Objects::BodyType::STATIC) != 0 || body->sleepState == Objects::BodyState::SLEEPING) ? 1 : 0;
+}
+
+void AABBArray::setFromBodies(std::vector<Objects::Body*>* bodies) {
+    int N = bodies->size();
+    this->resize(N);
+    for (int i = 0; i != N; i++) {
+        this->set(i, bodies->at(i));
+    }
+}
+
+bool AABBArray::needCollision(int i, int j) {
+    return (this->collisionFilterGroup[i] & this->collisionFilterMask[j]) != 0
+        && (this->collisionFilterGroup[j] & this->collisionFilterMask[i]) != 0
+        && (this->inactive[i] & this->inactive[j]) == 0;
+}
+
+int AABBArray::overlapBatch(int index, int start, int end, std::vector<int>* result) {
+    int found = 0;
+    float lx = this->lowerX[index];
+    float ly = this->lowerY[index];
+    float lz = this->lowerZ[index];
+    float ux = this->upperX[index];
+    float uy = this->upperY[index];
+    float uz = this->upperZ[index];
+
+    for (int j = start; j < end; j += AABBArray::BATCH_SIZE) {
+#if defined(__AVX__)
+        __m256 m = _mm256_and_ps(
+            _mm256_cmp_ps(_mm256_loadu_ps(&this->lowerX[j]), _mm256_set1_ps(ux), _CMP_LE_OQ),
+            _mm256_cmp_ps(_mm256_set1_ps(lx), _mm256_loadu_ps(&this->upperX[j]), _CMP_LE_OQ));
+        m = _mm256_and_ps(m, _mm256_cmp_ps(_mm256_loadu_ps(&this->lowerY[j]), _mm256_set1_ps(uy), _CMP_LE_OQ));
+        m = _mm256_and_ps(m, _mm256_cmp_ps(_mm256_set1_ps(ly), _mm256_loadu_ps(&this->upperY[j]), _CMP_LE_OQ));
+        m = _mm256_and_ps(m, _mm256_cmp_ps(_mm256_loadu_ps(&this->lowerZ[j]), _mm256_set1_ps(uz), _CMP_LE_OQ));
+        m = _mm256_and_ps(m, _mm256_cmp_ps(_mm256_set1_ps(lz), _mm256_loadu_ps(&this->upperZ[j]), _CMP_LE_OQ));
+        int bits = _mm256_movemask_ps(m);
+#elif defined(__SSE2__)
+        __m128 m = _mm_and_ps(
+            _mm_cmple_ps(_mm_loadu_ps(&this->lowerX[j]), _mm_set1_ps(ux)),
+            _mm_cmple_ps(_mm_set1_ps(lx), _mm_loadu_ps(&this->upperX[j])));
+        m = _mm_and_ps(m, _mm_cmple_ps(_mm_loadu_ps(&this->lowerY[j]), _mm_set1_ps(uy)));
+        m = _mm_and_ps(m, _mm_cmple_ps(_mm_set1_ps(ly), _mm_loadu_ps(&this->upperY[j])));
+        m = _mm_and_ps(m, _mm_cmple_ps(_mm_loadu_ps(&this->lowerZ[j]), _mm_set1_ps(uz)));
+        m = _mm_and_ps(m, _mm_cmple_ps(_mm_set1_ps(lz), _mm_loadu_ps(&this->upperZ[j])));
+        int bits = _mm_movemask_ps(m);
+#else
+        int bits = (this->lowerX[j] <= ux && lx <= this->upperX[j]
+            && this->lowerY[j] <= uy && ly <= this->upperY[j]
+            && this->lowerZ[j] <= uz && lz <= this->upperZ[j]) ? 1 : 0;
+#endif
+
+        // Drop the lanes past the end
+        if (end - j < AABBArray::BATCH_SIZE) {
+            bits &= (1 << (end - j)) - 1;
+        }
+
+        // Hits are rare, so the collision filter is checked per hit
+        while (bits != 0) {
+            int k = __builtin_ctz(bits);
+            bits &= bits - 1;
+            if (this->needCollision(index, j + k)) {
+                result->push_back(j + k);
+                found++;
+            }
+        }
+    }
+
+    return found;
+}
+
+int AABBArray::sphereBatch(int index, int start, int end, std::vector<int>* result) {
+    int found = 0;
+    float px = this->positionX[index];
+    float py = this->positionY[index];
+    float pz = this->positionZ[index];
+    float r = this->boundingRadius[index];
+
+    for (int j = start; j < end; j += AABBArray::BATCH_SIZE) {
+#if defined(__AVX__)
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(&this->positionX[j]), _mm256_set1_ps(px));
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(&this->positionY[j]), _mm256_set1_ps(py));
+        __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(&this->positionZ[j]), _mm256_set1_ps(pz));
+        __m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+        __m256 rs = _mm256_add_ps(_mm256_loadu_ps(&this->boundingRadius[j]), _mm256_set1_ps(r));
+        int bits = _mm256_movemask_ps(_mm256_cmp_ps(d2, _mm256_mul_ps(rs, rs), _CMP_LT_OQ));
+#elif defined(__SSE2__)
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(&this->positionX[j]), _mm_set1_ps(px));
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(&this->positionY[j]), _mm_set1_ps(py));
+        __m128 dz = _mm_sub_ps(_mm_loadu_ps(&this->positionZ[j]), _mm_set1_ps(pz));
+        __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        __m128 rs = _mm_add_ps(_mm_loadu_ps(&this->boundingRadius[j]), _mm_set1_ps(r));
+        int bits = _mm_movemask_ps(_mm_cmplt_ps(d2, _mm_mul_ps(rs, rs)));
+#else
+        float dx = this->positionX[j] - px;
+        float dy = this->positionY[j] - py;
+        float dz = this->positionZ[j] - pz;
+        float rs = this->boundingRadius[j] + r;
+        int bits = (dx * dx + dy * dy + dz * dz < rs * rs) ? 1 : 0;
+#endif
+
+        if (end - j < AABBArray::BATCH_SIZE) {
+            bits &= (1 << (end - j)) - 1;
+        }
+
+        while (bits != 0) {
+            int k = __builtin_ctz(bits);
+            bits &= bits - 1;
+            if (this->needCollision(index, j + k)) {
+                result->push_back(j + k);
+                found++;
+            }
+        }
+    }
+
+    return found;
+}
@@ -0,0 +1,336 @@
+#include "collision/AABBTreeBroadphase.h"
+
+#include <algorithm>
+#include "collision/AABB.h"
+#include "math/Vec3.h"
+#include "objects/Body.h"
+#include "world/World.h"
+
+using namespace Cannon::Collision;
+
+AABBTreeBroadphase::AABBTreeBroadphase(World::World* world) {
+    if (world != nullptr) {
+        this->setWorld(world);
+    }
+}
+
+bool AABBTreeBroadphase::isStaticOrSleeping(Objects::Body* body) {
+    return (body->type & Objects::BodyType::STATIC) != 0 || body->sleepState == Objects::BodyState::SLEEPING;
+}
+
+void AABBTreeBroadphase::setWorld(World::World* world) {
+    // Remove the bodies of the old world
+    while (!this->bodies.empty()) {
+        this->removeBody(this->bodies.back());
+    }
+
+    for (int i = 0; i < world->bodies.size(); i++) {
+        this->addBody(world->bodies[i]);
+    }
+
+    this->world = world;
+}
+
+void AABBTreeBroadphase::addBody(Objects::Body* body) {
+    if (body->aabbNeedsUpdate) {
+        body->computeAABB();
+    }
+
+    bool isStatic = AABBTreeBroadphase::isStaticOrSleeping(body);
+    Utils::AABBTree* tree = isStatic ? &this->staticTree : &this->dynamicTree;
+    int proxyId = tree->createProxy(&body->aabb, this->bodies.size());
+    this->bodies.push_back(body);
+    this->proxyIds_.push_back(proxyId);
+    this->inStaticTree_.push_back(isStatic);
+    this->dirty = true;
+}
+
+std::vector<Cannon::Collision::AABB*> AABBTreeBroadphase_addBodies_aabbs;
+std::vector<int> AABBTreeBroadphase_addBodies_userData;
+std::vector<int> AABBTreeBroadphase_addBodies_proxyIds;
+void AABBTreeBroadphase::addBodies(std::vector<Objects::Body*>* bodies) {
+    std::vector<Collision::AABB*>* aabbs = &AABBTreeBroadphase_addBodies_aabbs;
+    std::vector<int>* userData = &AABBTreeBroadphase_addBodies_userData;
+    std::vector<int>* proxyIds = &AABBTreeBroadphase_addBodies_proxyIds;
+
+    int first = this->bodies.size();
+    int N = bodies->size();
+    this->proxyIds_.resize(first + N);
+    for (int i = 0; i != N; i++) {
+        Objects::Body* body = bodies->at(i);
+        if (body->aabbNeedsUpdate) {
+            body->computeAABB();
+        }
+        this->bodies.push_back(body);
+        this->inStaticTree_.push_back(AABBTreeBroadphase::isStaticOrSleeping(body));
+    }
+
+    // One subtree per tree
+    for (int pass = 0; pass < 2; pass++) {
+        bool isStatic = pass == 1;
+        aabbs->clear();
+        userData->clear();
+        proxyIds->clear();
+        for (int i = first; i != first + N; i++) {
+            if (this->inStaticTree_[i] == isStatic) {
+                aabbs->push_back(&this->bodies[i]->aabb);
+                userData->push_back(i);
+            }
+        }
+
+        Utils::AABBTree* tree = isStatic ? &this->staticTree : &this->dynamicTree;
+        tree->createProxies(aabbs, userData, proxyIds);
+        for (int k = 0; k != proxyIds->size(); k++) {
+            this->proxyIds_[userData->at(k)] = proxyIds->at(k);
+        }
+    }
+
+    this->dirty = true;
+}
+
+void AABBTreeBroadphase::removeBody(Objects::Body* body) {
+    auto it = std::find(this->bodies.begin(), this->bodies.end(), body);
+    if (it == this->bodies.end()) {
+        return;
+    }
+
+    int index = it - this->bodies.begin();
+    int last = this->bodies.size() - 1;
+    Utils::AABBTree* tree = this->inStaticTree_[index] ? &this->staticTree : &this->dynamicTree;
+    tree->destroyProxy(this->proxyIds_[index]);
+
+    // Move the last body into the hole
+    this->bodies[index] = this->bodies[last];
+    this->proxyIds_[index] = this->proxyIds_[last];
+    this->inStaticTree_[index] = this->inStaticTree_[last];
+    this->bodies.pop_back();
+    this->proxyIds_.pop_back();
+    this->inStaticTree_.pop_back();
+    if (index != last) {
+        tree = this->inStaticTree_[index] ? &this->staticTree : &this->dynamicTree;
+        tree->setUserData(this->proxyIds_[index], index);
+    }
+}
+
+void AABBTreeBroadphase::updateProxies_() {
+    for (int i = 0; i < this->bodies.size(); i++) {
+        Objects::Body* body = this->bodies[i];
+        bool isStatic = AABBTreeBroadphase::isStaticOrSleeping(body);
+
+        if (isStatic != (bool)this->inStaticTree_[i]) {
+            // Fell asleep, woke up or changed type. Move the proxy to the other tree.
+            Utils::AABBTree* from = isStatic ? &this->dynamicTree : &this->staticTree;
+            Utils::AABBTree* to = isStatic ? &this->staticTree : &this->dynamicTree;
+            from->destroyProxy(this->proxyIds_[i]);
+            if (body->aabbNeedsUpdate) {
+                body->computeAABB();
+            }
+            this->proxyIds_[i] = to->createProxy(&body->aabb, i);
+            this->inStaticTree_[i] = isStatic;
+            continue;
+        }
+
+        if (isStatic) {
+            // Static bodies are only touched when they were moved
+            if (body->aabbNeedsUpdate) {
+                body->computeAABB();
+                this->staticTree.moveProxy(this->proxyIds_[i], &body->aabb);
+            }
+            continue;
+        }
+
+        if (body->aabbNeedsUpdate) {
+            body->computeAABB();
+        }
+        this->dynamicTree.moveProxy(this->proxyIds_[i], &body->aabb);
+    }
+}
+
+int AABBTreeBroadphase::splitQueries_() {
+    // About one node pair per task and traversal
+    int chunkSize = this->bodiesPerTask > 0 ? this->bodiesPerTask : 1;
+    int count = (this->bodies.size() + chunkSize - 1) / chunkSize;
+    this->dynamicTree.splitQuery(&this->dynamicTree, count, &this->dynamicNodePairs_);
+    this->dynamicTree.splitQuery(&this->staticTree, count, &this->staticNodePairs_);
+    return (this->dynamicNodePairs_.size() + this->staticNodePairs_.size()) / 2;
+}
+
+void AABBTreeBroadphase::queryNodePairs_(int begin, int end, std::vector<int>* pairs1, std::vector<int>* pairs2, std::vector<int>* stack) {
+    std::vector<int>* dynamicNodePairs = &this->dynamicNodePairs_;
+    std::vector<int>* staticNodePairs = &this->staticNodePairs_;
+    int numDynamic = dynamicNodePairs->size() / 2;
+
+    for (int i = begin; i != end; i++) {
+        if (i < numDynamic) {
+            // Dynamic vs dynamic
+            this->dynamicTree.queryNodes(&this->dynamicTree, dynamicNodePairs->at(2 * i), dynamicNodePairs->at(2 * i + 1), pairs1, pairs2, stack);
+        } else {
+            // Dynamic vs static
+            int k = i - numDynamic;
+            this->dynamicTree.queryNodes(&this->staticTree, staticNodePairs->at(2 * k), staticNodePairs->at(2 * k + 1), pairs1, pairs2, stack);
+        }
+    }
+}
+
+void AABBTreeBroadphase::reportPairs_(std::vector<int>* pairs1, std::vector<int>* pairs2, std::vector<Objects::Body*>* p1, std::vector<Objects::Body*>* p2) {
+    for (int i = 0; i < pairs1->size(); i++) {
+        Objects::Body* bi = this->bodies[pairs1->at(i)];
+        Objects::Body* bj = this->bodies[pairs2->at(i)];
+
+        if (!this->needBroadphaseCollision(bi, bj)) {
+            continue;
+        }
+
+        // The fat AABBs overlap, check the real bounds
+        this->intersectionTest(bi, bj, p1, p2);
+    }
+}
+
+thread_local std::vector<int> AABBTreeBroadphase_collisionPairs_pairs1;
+thread_local std::vector<int> AABBTreeBroadphase_collisionPairs_pairs2;
+thread_local std::vector<int> AABBTreeBroadphase_collisionPairs_stack;
+void AABBTreeBroadphase::collisionPairs(
+    World::World* world,
+    std::vector<Objects::Body*>* p1,
+    std::vector<Objects::Body*>* p2) {
+    if (this->dirty) {
+        this->updateProxies_();
+        this->dirty = false;
+    }
+
+    // One task per node pair when there is a pool, all of them in order otherwise
+    int begin = p1->size();
+    int count = this->splitQueries_();
+    this->parallelCollect(count, [&](int begin, int end, std::vector<Objects::Body*>* pairs1, std::vector<Objects::Body*>* pairs2) {
+        std::vector<int>* treePairs1 = &AABBTreeBroadphase_collisionPairs_pairs1;
+        std::vector<int>* treePairs2 = &AABBTreeBroadphase_collisionPairs_pairs2;
+        treePairs1->clear();
+        treePairs2->clear();
+        this->queryNodePairs_(begin, end, treePairs1, treePairs2, &AABBTreeBroadphase_collisionPairs_stack);
+        this->reportPairs_(treePairs1, treePairs2, pairs1, pairs2);
+    }, p1, p2, 1);
+
+    this->sortPairs_(begin, p1, p2);
+}
+
+std::vector<std::pair<Cannon::Objects::Body*, Cannon::Objects::Body*>> AABBTreeBroadphase_sortPairs_pairs;
+void AABBTreeBroadphase::sortPairs_(int begin, std::vector<Objects::Body*>* p1, std::vector<Objects::Body*>* p2) {
+    std::vector<std::pair<Objects::Body*, Objects::Body*>>* pairs = &AABBTreeBroadphase_sortPairs_pairs;
+    pairs->clear();
+    for (int i = begin; i < p1->size(); i++) {
+        Objects::Body* bi = p1->at(i);
+        Objects::Body* bj = p2->at(i);
+        if (bj->id < bi->id) {
+            std::swap(bi, bj);
+        }
+        pairs->push_back(std::make_pair(bi, bj));
+    }
+
+    // By lower id, then higher id. Ids are unique, so the order is too.
+    std::sort(pairs->begin(), pairs->end(), [](const std::pair<Objects::Body*, Objects::Body*>& a, const std::pair<Objects::Body*, Objects::Body*>& b) {
+        if (a.first->id != b.first->id) {
+            return a.first->id < b.first->id;
+        }
+        return a.second->id < b.second->id;
+    });
+
+    for (int i = 0; i < pairs->size(); i++) {
+        p1->at(begin + i) = pairs->at(i).first;
+        p2->at(begin + i) = pairs->at(i).second;
+    }
+}
+
+void AABBTreeBroadphase::cachePairs_() {
+    std::vector<int>* pairs1 = &this->pairs1_;
+    std::vector<int>* pairs2 = &this->pairs2_;
+    std::vector<Objects::Body*>* p1 = &this->cachePairs1_;
+    std::vector<Objects::Body*>* p2 = &this->cachePairs2_;
+    p1->clear();
+    p2->clear();
+
+    for (int i = 0; i < pairs1->size(); i++) {
+        Objects::Body* bi = this->bodies[pairs1->at(i)];
+        Objects::Body* bj = this->bodies[pairs2->at(i)];
+
+        if (this->needBroadphaseCollision(bi, bj) && this->boundingVolumeCheck(bi, bj)) {
+            p1->push_back(bi);
+            p2->push_back(bj);
+        }
+    }
+
+    // Same order as .collisionPairs()
+    this->sortPairs_(0, p1, p2);
+    for (int i = 0; i < p1->size(); i++) {
+        this->pairCache.addPair(p1->at(i), p2->at(i));
+    }
+}
+
+void AABBTreeBroadphase::updatePairs(World::World* world) {
+    if (this->threadPool != nullptr) {
+        Broadphase::updatePairs(world);
+        return;
+    }
+
+    if (this->dirty) {
+        this->updateProxies_();
+        this->dirty = false;
+    }
+
+    // The pairs are sorted afterwards, so the whole trees can be traversed at once
+    this->pairs1_.clear();
+    this->pairs2_.clear();
+    this->dynamicTree.queryPairs(&this->pairs1_, &this->pairs2_);
+    this->dynamicTree.queryTree(&this->staticTree, &this->pairs1_, &this->pairs2_);
+
+    this->pairCache.beginUpdate();
+    this->cachePairs_();
+    this->pairCache.endUpdate();
+}
+
+std::vector<Cannon::Objects::Body*>* AABBTreeBroadphase::aabbQuery(
+    World::World* world,
+    Collision::AABB* aabb,
+    std::vector<Objects::Body*>* result) {
+    if (this->dirty) {
+        this->updateProxies_();
+        this->dirty = false;
+    }
+
+    std::vector<int>* candidates = &this->queryResult_;
+    candidates->clear();
+    this->dynamicTree.aabbQuery(aabb, candidates);
+    this->staticTree.aabbQuery(aabb, candidates);
+
+    for (int i = 0; i < candidates->size(); i++) {
+        Objects::Body* b = this->bodies[candidates->at(i)];
+        if (b->aabb.overlaps(aabb)) {
+            result->push_back(b);
+        }
+    }
+
+    return result;
+}
+
+std::vector<Cannon::Objects::Body*>* AABBTreeBroadphase::rayQuery(
+    Math::Vec3* from,
+    Math::Vec3* to,
+    std::vector<Objects::Body*>* result) {
+    if (this->dirty) {
+        this->updateProxies_();
+        this->dirty = false;
+    }
+
+    std::vector<int>* candidates = &this->queryResult_;
+    candidates->clear();
+    this->dynamicTree.rayQuery(from, to, candidates);
+    this->staticTree.rayQuery(from, to, candidates);
+
+    for (int i = 0; i < candidates->size(); i++) {
+        Objects::Body* b = this->bodies[candidates->at(i)];
+        if (b->aabb.overlapsSegment(from, to)) {
+            result->push_back(b);
+        }
+    }
+
+    return result;
+}
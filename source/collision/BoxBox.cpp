@@ -0,0 +1,266 @@
+#include "collision/BoxBox.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "math/Mat3.h"
+#include "math/Quaternion.h"
+
+using namespace Cannon::Collision;
+
+int BoxBox::clipPolygon_(Math::Vec3* origin, Math::Vec3* normal, float offset, int count) {
+    // Keep the part of .polygon_ where (point - origin) . normal <= offset, written back to .polygon_
+    int clippedCount = 0;
+    Math::Vec3 delta;
+    for (int i = 0; i < count; i++) {
+        Math::Vec3* a = &this->polygon_[i];
+        Math::Vec3* b = &this->polygon_[(i + 1) % count];
+        a->vsub(origin, &delta);
+        float da = normal->dot(&delta) - offset;
+        b->vsub(origin, &delta);
+        float db = normal->dot(&delta) - offset;
+
+        if (da <= 0) {
+            this->clipped_[clippedCount++].copy(a);
+        }
+        if ((da < 0 && db > 0) || (da > 0 && db < 0)) {
+            a->lerp(b, da / (da - db), &this->clipped_[clippedCount++]);
+        }
+        if (clippedCount == this->clipped_.size()) {
+            break;
+        }
+    }
+
+    for (int i = 0; i < clippedCount; i++) {
+        this->polygon_[i].copy(&this->clipped_[i]);
+    }
+    return clippedCount;
+}
+
+thread_local Cannon::Math::Mat3 BoxBox_collide_rotation;
+bool BoxBox::collide(
+    Math::Vec3* halfExtentsA,
+    Math::Vec3* posA,
+    Math::Quaternion* quatA,
+    Math::Vec3* halfExtentsB,
+    Math::Vec3* posB,
+    Math::Quaternion* quatB,
+    BoxBoxResult* result,
+    bool justTest) {
+    result->contacts.clear();
+
+    // Box axes in world space, the columns of the rotation matrices
+    Math::Mat3* rotation = &BoxBox_collide_rotation;
+    rotation->setRotationFromQuaternion(quatA);
+    for (int i = 0; i < 3; i++) {
+        this->axesA_[i].set(rotation->elements[i], rotation->elements[3 + i], rotation->elements[6 + i]);
+    }
+    rotation->setRotationFromQuaternion(quatB);
+    for (int i = 0; i < 3; i++) {
+        this->axesB_[i].set(rotation->elements[i], rotation->elements[3 + i], rotation->elements[6 + i]);
+    }
+
+    float a[3] = { halfExtentsA->x, halfExtentsA->y, halfExtentsA->z };
+    float b[3] = { halfExtentsB->x, halfExtentsB->y, halfExtentsB->z };
+
+    // Center of B relative to A, in both box frames
+    Math::Vec3 d;
+    posB->vsub(posA, &d);
+    float da[3];
+    float db[3];
+    for (int i = 0; i < 3; i++) {
+        da[i] = d.dot(&this->axesA_[i]);
+        db[i] = d.dot(&this->axesB_[i]);
+    }
+
+    // R[i][j] = Ai . Bj. The epsilon in Q keeps nearly parallel edges from passing the edge tests on round off.
+    float R[3][3];
+    float Q[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            R[i][j] = this->axesA_[i].dot(&this->axesB_[j]);
+            Q[i][j] = std::abs(R[i][j]) + 1e-6f;
+        }
+    }
+
+    // Separation along each axis, negative when overlapping. Keep the one closest to zero.
+    float best = -std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    Math::Vec3 normal;
+
+    for (int i = 0; i < 3; i++) {
+        float s = std::abs(da[i]) - (a[i] + b[0] * Q[i][0] + b[1] * Q[i][1] + b[2] * Q[i][2]);
+        if (s > 0) {
+            return false;
+        }
+        if (s > best) {
+            best = s;
+            bestAxis = i;
+            this->axesA_[i].scale(da[i] < 0 ? -1 : 1, &normal);
+        }
+    }
+
+    for (int j = 0; j < 3; j++) {
+        float s = std::abs(db[j]) - (b[j] + a[0] * Q[0][j] + a[1] * Q[1][j] + a[2] * Q[2][j]);
+        if (s > 0) {
+            return false;
+        }
+        if (s > best) {
+            best = s;
+            bestAxis = 3 + j;
+            this->axesB_[j].scale(db[j] < 0 ? -1 : 1, &normal);
+        }
+    }
+
+    for (int i = 0; i < 3; i++) {
+        int i1 = (i + 1) % 3;
+        int i2 = (i + 2) % 3;
+        for (int j = 0; j < 3; j++) {
+            int j1 = (j + 1) % 3;
+            int j2 = (j + 2) % 3;
+
+            // Ai x Bj = R[i1][j] * Ai2 - R[i2][j] * Ai1, with length sin(angle)
+            float length = std::sqrt(std::max(0.0f, 1 - R[i][j] * R[i][j]));
+            if (length < 1e-5f) {
+                // Parallel edges, already covered by the face axes
+                continue;
+            }
+
+            float dist = da[i2] * R[i1][j] - da[i1] * R[i2][j];
+            float radiusA = a[i1] * Q[i2][j] + a[i2] * Q[i1][j];
+            float radiusB = b[j1] * Q[i][j2] + b[j2] * Q[i][j1];
+            float s = (std::abs(dist) - (radiusA + radiusB)) / length;
+            if (s > 0) {
+                return false;
+            }
+            if (s * this->edgeBias > best) {
+                best = s;
+                bestAxis = 6 + i * 3 + j;
+                this->axesA_[i].cross(&this->axesB_[j], &normal);
+                normal.scale((dist < 0 ? -1 : 1) / length, &normal);
+            }
+        }
+    }
+
+    result->normal.copy(&normal);
+    result->depth = -best;
+    result->axis = bestAxis;
+    if (justTest) {
+        return true;
+    }
+
+    if (bestAxis >= 6) {
+        // Edge-edge: one contact between the closest points of the edges
+        int i = (bestAxis - 6) / 3;
+        int j = (bestAxis - 6) % 3;
+
+        // The edge of A furthest along the normal, and the edge of B furthest against it
+        Math::Vec3 pa;
+        Math::Vec3 pb;
+        pa.copy(posA);
+        pb.copy(posB);
+        for (int k = 0; k < 3; k++) {
+            if (k != i) {
+                pa.addScaledVector(this->axesA_[k].dot(&normal) > 0 ? a[k] : -a[k], &this->axesA_[k], &pa);
+            }
+            if (k != j) {
+                pb.addScaledVector(this->axesB_[k].dot(&normal) > 0 ? -b[k] : b[k], &this->axesB_[k], &pb);
+            }
+        }
+
+        // Closest points of the lines pa + t * Ai and pb + u * Bj
+        Math::Vec3 p;
+        pb.vsub(&pa, &p);
+        float uaub = R[i][j];
+        float q1 = this->axesA_[i].dot(&p);
+        float q2 = -this->axesB_[j].dot(&p);
+        float denominator = 1 - uaub * uaub;
+        float t = 0;
+        float u = 0;
+        if (denominator > 1e-4f) {
+            t = (q1 + uaub * q2) / denominator;
+            u = (uaub * q1 + q2) / denominator;
+        }
+        t = std::max(-a[i], std::min(a[i], t));
+        u = std::max(-b[j], std::min(b[j], u));
+
+        BoxBoxContact contact;
+        pa.addScaledVector(t, &this->axesA_[i], &contact.pointA);
+        pb.addScaledVector(u, &this->axesB_[j], &contact.pointB);
+        contact.depth = result->depth;
+        result->contacts.push_back(contact);
+        return true;
+    }
+
+    // Face contact. The box of the axis holds the reference face, the other the incident face.
+    bool referenceIsA = bestAxis < 3;
+    std::array<Math::Vec3, 3>* referenceAxes = referenceIsA ? &this->axesA_ : &this->axesB_;
+    std::array<Math::Vec3, 3>* incidentAxes = referenceIsA ? &this->axesB_ : &this->axesA_;
+    float* referenceExtents = referenceIsA ? a : b;
+    float* incidentExtents = referenceIsA ? b : a;
+    Math::Vec3* referencePos = referenceIsA ? posA : posB;
+    Math::Vec3* incidentPos = referenceIsA ? posB : posA;
+
+    // Normal of the reference face, pointing towards the incident box
+    Math::Vec3 referenceNormal;
+    normal.scale(referenceIsA ? 1 : -1, &referenceNormal);
+    int k = referenceIsA ? bestAxis : bestAxis - 3;
+    Math::Vec3 referenceCenter;
+    referencePos->addScaledVector(referenceExtents[k], &referenceNormal, &referenceCenter);
+
+    // The incident face is the one most anti-parallel to the reference normal
+    int m = 0;
+    float maxDot = -1;
+    for (int n = 0; n < 3; n++) {
+        float dot = std::abs((*incidentAxes)[n].dot(&referenceNormal));
+        if (dot > maxDot) {
+            maxDot = dot;
+            m = n;
+        }
+    }
+    float side = (*incidentAxes)[m].dot(&referenceNormal) > 0 ? -1 : 1;
+    Math::Vec3 incidentCenter;
+    incidentPos->addScaledVector(side * incidentExtents[m], &(*incidentAxes)[m], &incidentCenter);
+
+    // Corners of the incident face, in order around it
+    int m1 = (m + 1) % 3;
+    int m2 = (m + 2) % 3;
+    Math::Vec3 e1;
+    Math::Vec3 e2;
+    (*incidentAxes)[m1].scale(incidentExtents[m1], &e1);
+    (*incidentAxes)[m2].scale(incidentExtents[m2], &e2);
+    incidentCenter.vadd(&e1, &this->polygon_[0])->vadd(&e2, &this->polygon_[0]);
+    incidentCenter.vsub(&e1, &this->polygon_[1])->vadd(&e2, &this->polygon_[1]);
+    incidentCenter.vsub(&e1, &this->polygon_[2])->vsub(&e2, &this->polygon_[2]);
+    incidentCenter.vadd(&e1, &this->polygon_[3])->vsub(&e2, &this->polygon_[3]);
+
+    // Clip against the four side planes of the reference face
+    int count = 4;
+    Math::Vec3 sideNormal;
+    for (int n = 1; n < 3 && count > 0; n++) {
+        int axis = (k + n) % 3;
+        count = this->clipPolygon_(&referenceCenter, &(*referenceAxes)[axis], referenceExtents[axis], count);
+        (*referenceAxes)[axis].negate(&sideNormal);
+        count = this->clipPolygon_(&referenceCenter, &sideNormal, referenceExtents[axis], count);
+    }
+
+    // Keep the points below the reference face
+    Math::Vec3 delta;
+    for (int n = 0; n < count; n++) {
+        this->polygon_[n].vsub(&referenceCenter, &delta);
+        float depth = -referenceNormal.dot(&delta);
+        if (depth < 0) {
+            continue;
+        }
+
+        BoxBoxContact contact;
+        Math::Vec3* incidentPoint = referenceIsA ? &contact.pointB : &contact.pointA;
+        Math::Vec3* referencePoint = referenceIsA ? &contact.pointA : &contact.pointB;
+        incidentPoint->copy(&this->polygon_[n]);
+        this->polygon_[n].addScaledVector(depth, &referenceNormal, referencePoint);
+        contact.depth = depth;
+        result->contacts.push_back(contact);
+    }
+
+    return !result->contacts.empty();
+}
@@ -0,0 +1,300 @@
+#include "collision/Broadphase.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include "collision/AABB.h"
+#include "collision/AABBArray.h"
+#include "objects/Body.h"
+#include "utils/ThreadPool.h"
+
+using namespace Cannon::Collision;
+
+bool Broadphase::needBroadphaseCollision(Objects::Body* bodyA, Objects::Body* bodyB) {
+    // Check collision filter masks
+    if ((bodyA->collisionFilterGroup & bodyB->collisionFilterMask) == 0
+        || (bodyB->collisionFilterGroup & bodyA->collisionFilterMask) == 0) {
+        return false;
+    }
+
+    // Check types
+    if (((bodyA->type & Objects::BodyType::STATIC) != 0 || bodyA->sleepState == Objects::BodyState::SLEEPING)
+        && ((bodyB->type & Objects::BodyType::STATIC) != 0 || bodyB->sleepState == Objects::BodyState::SLEEPING)) {
+        // Both bodies are static or sleeping. Skip.
+        return false;
+    }
+
+    return true;
+}
+
+void Broadphase::intersectionTest(
+    Objects::Body* bodyA,
+    Objects::Body* bodyB,
+    std::vector<Objects::Body*>* pairs1,
+    std::vector<Objects::Body*>* pairs2) {
+    if (this->useBoundingBoxes) {
+        this->doBoundingBoxBroadphase(bodyA, bodyB, pairs1, pairs2);
+    } else {
+        this->doBoundingSphereBroadphase(bodyA, bodyB, pairs1, pairs2);
+    }
+}
+
+bool Broadphase::boundingVolumeCheck(Objects::Body* bodyA, Objects::Body* bodyB) {
+    if (!this->useBoundingBoxes) {
+        return this->boundingSphereCheck(bodyA, bodyB);
+    }
+
+    if (bodyA->aabbNeedsUpdate) {
+        bodyA->computeAABB();
+    }
+    if (bodyB->aabbNeedsUpdate) {
+        bodyB->computeAABB();
+    }
+    return bodyA->aabb.overlaps(&bodyB->aabb);
+}
+
+thread_local std::vector<int> Broadphase_intersectionTestBatch_hits;
+void Broadphase::intersectionTestBatch(
+    AABBArray* aabbs,
+    std::vector<Objects::Body*>* bodies,
+    int index,
+    int start,
+    int end,
+    std::vector<Objects::Body*>* pairs1,
+    std::vector<Objects::Body*>* pairs2) {
+    std::vector<int>* hits = &Broadphase_intersectionTestBatch_hits;
+    hits->clear();
+
+    if (this->useBoundingBoxes) {
+        aabbs->overlapBatch(index, start, end, hits);
+    } else {
+        aabbs->sphereBatch(index, start, end, hits);
+    }
+
+    Objects::Body* bodyA = bodies->at(index);
+    for (int i = 0; i != hits->size(); i++) {
+        pairs1->push_back(bodyA);
+        pairs2->push_back(bodies->at(hits->at(i)));
+    }
+}
+
+void Broadphase::parallelCollect(
+    int count,
+    std::function<void(int, int, std::vector<Objects::Body*>*, std::vector<Objects::Body*>*)> collect,
+    std::vector<Objects::Body*>* pairs1,
+    std::vector<Objects::Body*>* pairs2,
+    int chunkSize) {
+    if (chunkSize <= 0) {
+        chunkSize = this->bodiesPerTask > 0 ? this->bodiesPerTask : 1;
+    }
+    int taskCount = (count + chunkSize - 1) / chunkSize;
+
+    if (this->threadPool == nullptr) {
+        collect(0, count, pairs1, pairs2);
+        return;
+    }
+
+    std::vector<std::vector<Objects::Body*>>* taskPairs1 = &this->taskPairs1_;
+    std::vector<std::vector<Objects::Body*>>* taskPairs2 = &this->taskPairs2_;
+    if (taskPairs1->size() < taskCount) {
+        taskPairs1->resize(taskCount);
+        taskPairs2->resize(taskCount);
+    }
+
+    this->threadPool->run(taskCount, [&](int task, int thread) {
+        std::vector<Objects::Body*>* p1 = &taskPairs1->at(task);
+        std::vector<Objects::Body*>* p2 = &taskPairs2->at(task);
+        p1->clear();
+        p2->clear();
+        collect(task * chunkSize, std::min(count, (task + 1) * chunkSize), p1, p2);
+    });
+
+    // Merge in task order
+    for (int task = 0; task < taskCount; task++) {
+        pairs1->insert(pairs1->end(), taskPairs1->at(task).begin(), taskPairs1->at(task).end());
+        pairs2->insert(pairs2->end(), taskPairs2->at(task).begin(), taskPairs2->at(task).end());
+    }
+}
+
+void Broadphase::addBodies(std::vector<Objects::Body*>* bodies) {
+    for (int i = 0; i != bodies->size(); i++) {
+        this->addBody(bodies->at(i));
+    }
+}
+
+std::vector<Cannon::Objects::Body*> Broadphase_updatePairs_p1;
+std::vector<Cannon::Objects::Body*> Broadphase_updatePairs_p2;
+void Broadphase::updatePairs(World::World* world) {
+    std::vector<Objects::Body*>* p1 = &Broadphase_updatePairs_p1;
+    std::vector<Objects::Body*>* p2 = &Broadphase_updatePairs_p2;
+    p1->clear();
+    p2->clear();
+    this->collisionPairs(world, p1, p2);
+
+    // The cache ignores duplicates, so the pairs do not have to be unique
+    PairCache* cache = &this->pairCache;
+    cache->beginUpdate();
+    for (int i = 0; i != p1->size(); i++) {
+        cache->addPair(p1->at(i), p2->at(i));
+    }
+    cache->endUpdate();
+}
+
+thread_local Cannon::Math::Vec3 Broadphase_collisionPairs_r;
+void Broadphase::doBoundingSphereBroadphase(
+    Objects::Body* bodyA,
+    Objects::Body* bodyB,
+    std::vector<Objects::Body*>* pairs1,
+    std::vector<Objects::Body*>* pairs2) {
+    Math::Vec3* r = &Broadphase_collisionPairs_r;
+    bodyB->position.vsub(&bodyA->position, r);
+    float boundingRadiusSum = bodyA->boundingRadius + bodyB->boundingRadius;
+    float norm2 = r->lengthSquared();
+    if (norm2 < boundingRadiusSum * boundingRadiusSum) {
+        pairs1->push_back(bodyA);
+        pairs2->push_back(bodyB);
+    }
+}
+
+void Broadphase::doBoundingBoxBroadphase(
+    Objects::Body* bodyA,
+    Objects::Body* bodyB,
+    std::vector<Objects::Body*>* pairs1,
+    std::vector<Objects::Body*>* pairs2) {
+    if (bodyA->aabbNeedsUpdate) {
+        bodyA->computeAABB();
+    }
+    if (bodyB->aabbNeedsUpdate) {
+        bodyB->computeAABB();
+    }
+
+    // Check AABB / AABB
+    if (bodyA->aabb.overlaps(&bodyB->aabb)) {
+        pairs1->push_back(bodyA);
+        pairs2->push_back(bodyB);
+    }
+}
+
+std::vector<Cannon::Objects::Body*> Broadphase_makePairsUnique_p1;
+std::vector<Cannon::Objects::Body*> Broadphase_makePairsUnique_p2;
+std::map<std::pair<int, int>, int> Broadphase_makePairsUnique_temp;
+void Broadphase::makePairsUnique(
+    std::vector<Objects::Body*>* pairs1,
+    std::vector<Objects::Body*>* pairs2) {
+    std::map<std::pair<int, int>, int>* t = &Broadphase_makePairsUnique_temp;
+    std::vector<Objects::Body*>* p1 = &Broadphase_makePairsUnique_p1;
+    std::vector<Objects::Body*>* p2 = &Broadphase_makePairsUnique_p2;
+
+    p1->assign(pairs1->begin(), pairs1->end());
+    p2->assign(pairs2->begin(), pairs2->end());
+
+    pairs1->clear();
+    pairs2->clear();
+
+    // Keep the first occurrence of each pair, in the original order
+    for (int i = 0; i != p1->size(); i++) {
+        int id1 = p1->at(i)->id;
+        int id2 = p2->at(i)->id;
+        std::pair<int, int> key = id1 < id2 ? std::make_pair(id1, id2) : std::make_pair(id2, id1);
+        if (t->insert(std::make_pair(key, i)).second) {
+            pairs1->push_back(p1->at(i));
+            pairs2->push_back(p2->at(i));
+        }
+    }
+
+    t->clear();
+}
+
+void Broadphase::setWorld(World::World* world) {}
+
+thread_local Cannon::Math::Vec3 bsc_dist;
+bool Broadphase::boundingSphereCheck(Objects::Body* bodyA, Objects::Body* bodyB) {
+    Math::Vec3* dist = &bsc_dist;
+    bodyA->position.vsub(&bodyB->position, dist);
+    float radiusSum = bodyA->boundingRadius + bodyB->boundingRadius;
+    return radiusSum * radiusSum > dist->lengthSquared();
+}
+
+std::vector<Cannon::Objects::Body*>* Broadphase::aabbQuery(
+    World::World* world,
+    Collision::AABB* aabb,
+    std::vector<Objects::Body*>* result) {
+    // .aabbQuery is not implemented in this Broadphase subclass.
+    return result;
+}
+
+void Broadphase::queryBatch(
+    World::World* world,
+    std::vector<BroadphaseQuery>* queries,
+    std::vector<Objects::Body*>* results,
+    std::vector<int>* offsets) {
+    results->clear();
+    offsets->clear();
+    offsets->push_back(0);
+
+    for (int i = 0; i != queries->size(); i++) {
+        BroadphaseQuery* query = &queries->at(i);
+        query->updateBounds();
+
+        if (query->type == BroadphaseQueryType::NEAREST_QUERY) {
+            this->nearestQuery_(world, query, results);
+            offsets->push_back(results->size());
+            continue;
+        }
+
+        // Traverse with the bounds, then drop the bodies outside the query volume in place
+        int start = results->size();
+        this->aabbQuery(world, &query->aabb, results);
+        int end = start;
+        for (int j = start; j != results->size(); j++) {
+            Objects::Body* body = results->at(j);
+            if (query->overlaps(&body->aabb)) {
+                results->at(end++) = body;
+            }
+        }
+        results->resize(end);
+        offsets->push_back(end);
+    }
+}
+
+void Broadphase::nearestQuery_(World::World* world, BroadphaseQuery* query, std::vector<Objects::Body*>* results) {
+    std::vector<std::pair<float, Objects::Body*>>* nearest = &this->nearest_;
+    Math::Vec3* c = &query->center;
+    float maxDistance = query->radius;
+    int start = results->size();
+
+    // Search a growing box. All the bodies within distance r of the center overlap the box,
+    // so once there are k of them they are the k nearest.
+    float r = maxDistance / 8;
+    AABB box;
+    while (true) {
+        box.lowerBound.set(c->x - r, c->y - r, c->z - r);
+        box.upperBound.set(c->x + r, c->y + r, c->z + r);
+        this->aabbQuery(world, &box, results);
+
+        nearest->clear();
+        for (int j = start; j != results->size(); j++) {
+            Objects::Body* body = results->at(j);
+            float d2 = BroadphaseQuery::distanceSquared(c, &body->aabb);
+            if (d2 <= r * r) {
+                nearest->push_back(std::make_pair(d2, body));
+            }
+        }
+        results->resize(start);
+
+        if (nearest->size() >= query->k || r >= maxDistance) {
+            break;
+        }
+        r = std::min(2 * r, maxDistance);
+    }
+
+    // Ties are broken by id, so that the result does not depend on the traversal order
+    int k = std::min((int)nearest->size(), query->k);
+    std::partial_sort(nearest->begin(), nearest->begin() + k, nearest->end(),
+        [](const std::pair<float, Objects::Body*>& a, const std::pair<float, Objects::Body*>& b) {
+            return a.first < b.first || (a.first == b.first && a.second->id < b.second->id);
+        });
+    for (int j = 0; j < k; j++) {
+        results->push_back(nearest->at(j).second);
+    }
+}
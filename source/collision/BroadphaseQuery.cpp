@@ -0,0 +1,134 @@
+#include "collision/BroadphaseQuery.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Cannon::Collision;
+
+BroadphaseQuery* BroadphaseQuery::setAABB(AABB* aabb) {
+    this->type = BroadphaseQueryType::AABB_QUERY;
+    this->aabb.copy(aabb);
+    return this;
+}
+
+BroadphaseQuery* BroadphaseQuery::setSphere(Math::Vec3* center, float radius) {
+    this->type = BroadphaseQueryType::SPHERE_QUERY;
+    this->center.copy(center);
+    this->radius = radius;
+    return this;
+}
+
+BroadphaseQuery* BroadphaseQuery::setBox(Math::Vec3* center, Math::Vec3* halfExtents, Math::Quaternion* quaternion) {
+    this->type = BroadphaseQueryType::BOX_QUERY;
+    this->center.copy(center);
+    this->halfExtents.copy(halfExtents);
+    this->quaternion.copy(quaternion);
+    return this;
+}
+
+BroadphaseQuery* BroadphaseQuery::setNearest(Math::Vec3* center, int k, float maxDistance) {
+    this->type = BroadphaseQueryType::NEAREST_QUERY;
+    this->center.copy(center);
+    this->k = k;
+    this->radius = maxDistance;
+    return this;
+}
+
+void BroadphaseQuery::updateBounds() {
+    Math::Vec3* c = &this->center;
+
+    if (this->type == BroadphaseQueryType::SPHERE_QUERY || this->type == BroadphaseQueryType::NEAREST_QUERY) {
+        float r = this->radius;
+        this->aabb.lowerBound.set(c->x - r, c->y - r, c->z - r);
+        this->aabb.upperBound.set(c->x + r, c->y + r, c->z + r);
+    } else if (this->type == BroadphaseQueryType::BOX_QUERY) {
+        // The columns of the rotation are the box axes
+        Math::Mat3* R = &this->rotation_;
+        R->setRotationFromQuaternion(&this->quaternion);
+        float h[3] = { this->halfExtents.x, this->halfExtents.y, this->halfExtents.z };
+        float e[3];
+        for (int i = 0; i < 3; i++) {
+            e[i] = std::fabs(R->e(i, 0)) * h[0] + std::fabs(R->e(i, 1)) * h[1] + std::fabs(R->e(i, 2)) * h[2];
+        }
+        this->aabb.lowerBound.set(c->x - e[0], c->y - e[1], c->z - e[2]);
+        this->aabb.upperBound.set(c->x + e[0], c->y + e[1], c->z + e[2]);
+    }
+}
+
+float BroadphaseQuery::distanceSquared(Math::Vec3* point, AABB* aabb) {
+    float dx = std::max(std::max(aabb->lowerBound.x - point->x, point->x - aabb->upperBound.x), 0.0f);
+    float dy = std::max(std::max(aabb->lowerBound.y - point->y, point->y - aabb->upperBound.y), 0.0f);
+    float dz = std::max(std::max(aabb->lowerBound.z - point->z, point->z - aabb->upperBound.z), 0.0f);
+    return dx * dx + dy * dy + dz * dz;
+}
+
+bool BroadphaseQuery::overlaps(AABB* aabb) {
+    if (!this->aabb.overlaps(aabb)) {
+        return false;
+    }
+
+    if (this->type == BroadphaseQueryType::SPHERE_QUERY || this->type == BroadphaseQueryType::NEAREST_QUERY) {
+        return BroadphaseQuery::distanceSquared(&this->center, aabb) <= this->radius * this->radius;
+    }
+
+    if (this->type != BroadphaseQueryType::BOX_QUERY) {
+        return true;
+    }
+
+    // Separating axis test of the oriented box against the AABB, in the frame of the AABB
+    Math::Mat3* R = &this->rotation_;
+    float ea[3] = {
+        0.5f * (aabb->upperBound.x - aabb->lowerBound.x),
+        0.5f * (aabb->upperBound.y - aabb->lowerBound.y),
+        0.5f * (aabb->upperBound.z - aabb->lowerBound.z)
+    };
+    float eb[3] = { this->halfExtents.x, this->halfExtents.y, this->halfExtents.z };
+    float t[3] = {
+        this->center.x - 0.5f * (aabb->lowerBound.x + aabb->upperBound.x),
+        this->center.y - 0.5f * (aabb->lowerBound.y + aabb->upperBound.y),
+        this->center.z - 0.5f * (aabb->lowerBound.z + aabb->upperBound.z)
+    };
+
+    // Epsilon against parallel edges giving a zero cross product
+    float r[3][3];
+    float absR[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            r[i][j] = R->e(i, j);
+            absR[i][j] = std::fabs(r[i][j]) + 1e-6f;
+        }
+    }
+
+    // Axes of the AABB
+    for (int i = 0; i < 3; i++) {
+        if (std::fabs(t[i]) > ea[i] + eb[0] * absR[i][0] + eb[1] * absR[i][1] + eb[2] * absR[i][2]) {
+            return false;
+        }
+    }
+
+    // Axes of the box
+    for (int j = 0; j < 3; j++) {
+        float d = t[0] * r[0][j] + t[1] * r[1][j] + t[2] * r[2][j];
+        if (std::fabs(d) > ea[0] * absR[0][j] + ea[1] * absR[1][j] + ea[2] * absR[2][j] + eb[j]) {
+            return false;
+        }
+    }
+
+    // Cross products of the axes
+    for (int i = 0; i < 3; i++) {
+        int i1 = (i + 1) % 3;
+        int i2 = (i + 2) % 3;
+        for (int j = 0; j < 3; j++) {
+            int j1 = (j + 1) % 3;
+            int j2 = (j + 2) % 3;
+            float d = t[i2] * r[i1][j] - t[i1] * r[i2][j];
+            float ra = ea[i1] * absR[i2][j] + ea[i2] * absR[i1][j];
+            float rb = eb[j1] * absR[i][j2] + eb[j2] * absR[i][j1];
+            if (std::fabs(d) > ra + rb) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
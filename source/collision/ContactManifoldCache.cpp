@@ -0,0 +1,160 @@
+#include "collision/ContactManifoldCache.h"
+
+#include "collision/PairCache.h"
+#include "equations/ContactEquation.h"
+#include "math/Quaternion.h"
+#include "objects/Body.h"
+#include "shapes/Shape.h"
+
+using namespace Cannon::Collision;
+
+ContactManifoldKey ContactManifoldCache::getKey(
+    Objects::Body* bodyA,
+    Shapes::Shape* shapeA,
+    Objects::Body* bodyB,
+    Shapes::Shape* shapeB) {
+    if (bodyA->id > bodyB->id) {
+        return ContactManifoldCache::getKey(bodyB, shapeB, bodyA, shapeA);
+    }
+
+    ContactManifoldKey key;
+    key.bodies = PairCache::getKey(bodyA, bodyB);
+    key.shapes = ((long long)shapeA->id << 32) | ((long long)shapeB->id & 0xffffffff);
+    return key;
+}
+
+int ContactManifoldCache::getManifoldIndex_(Equations::ContactEquation* c, bool create) {
+    ContactManifoldKey key = ContactManifoldCache::getKey(c->bi, c->si, c->bj, c->sj);
+    auto it = this->index_.find(key);
+    if (it != this->index_.end()) {
+        return it->second;
+    }
+    if (!create) {
+        return -1;
+    }
+
+    // Order by body id, like the key
+    bool swapped = c->bi->id > c->bj->id;
+    ContactManifold manifold;
+    manifold.bodyA = swapped ? c->bj : c->bi;
+    manifold.bodyB = swapped ? c->bi : c->bj;
+    manifold.shapeA = swapped ? c->sj : c->si;
+    manifold.shapeB = swapped ? c->si : c->sj;
+    this->manifolds.push_back(manifold);
+    this->index_[key] = this->manifolds.size() - 1;
+    return this->manifolds.size() - 1;
+}
+
+Cannon::Math::Quaternion ContactManifoldCache_warmStart_q;
+Cannon::Math::Vec3 ContactManifoldCache_warmStart_localA;
+Cannon::Math::Vec3 ContactManifoldCache_warmStart_localB;
+void ContactManifoldCache::warmStart(std::vector<Equations::ContactEquation*>* equations) {
+    Math::Quaternion* q = &ContactManifoldCache_warmStart_q;
+    Math::Vec3* localA = &ContactManifoldCache_warmStart_localA;
+    Math::Vec3* localB = &ContactManifoldCache_warmStart_localB;
+    float maxDistanceSquared = this->matchDistance * this->matchDistance;
+    this->stamp_++;
+
+    for (int i = 0; i != equations->size(); i++) {
+        Equations::ContactEquation* c = equations->at(i);
+        c->lambda = 0;
+
+        int index = this->getManifoldIndex_(c, false);
+        if (index == -1) {
+            continue;
+        }
+        ContactManifold* manifold = &this->manifolds[index];
+
+        // Contact point in the local frames of the manifold bodies
+        bool swapped = manifold->bodyA != c->bi;
+        Math::Vec3* rA = swapped ? &c->rj : &c->ri;
+        Math::Vec3* rB = swapped ? &c->ri : &c->rj;
+        manifold->bodyA->quaternion.conjugate(q);
+        q->vmult(rA, localA);
+        manifold->bodyB->quaternion.conjugate(q);
+        q->vmult(rB, localB);
+
+        // Closest unused point, close enough on both bodies
+        ContactManifoldPoint* best = nullptr;
+        float bestDistance = 0;
+        for (int j = 0; j != manifold->points.size(); j++) {
+            ContactManifoldPoint* point = &manifold->points[j];
+            if (point->stamp == this->stamp_) {
+                continue;
+            }
+            float dA = point->localPointA.distanceSquared(localA);
+            float dB = point->localPointB.distanceSquared(localB);
+            if (dA > maxDistanceSquared || dB > maxDistanceSquared) {
+                continue;
+            }
+            if (best == nullptr || dA + dB < bestDistance) {
+                best = point;
+                bestDistance = dA + dB;
+            }
+        }
+
+        if (best != nullptr) {
+            best->stamp = this->stamp_;
+            c->lambda = best->lambda;
+        }
+    }
+}
+
+Cannon::Math::Quaternion ContactManifoldCache_update_q;
+void ContactManifoldCache::update(std::vector<Equations::ContactEquation*>* equations) {
+    Math::Quaternion* q = &ContactManifoldCache_update_q;
+    this->stamp_++;
+
+    for (int i = 0; i != equations->size(); i++) {
+        Equations::ContactEquation* c = equations->at(i);
+        ContactManifold* manifold = &this->manifolds[this->getManifoldIndex_(c, true)];
+
+        // The first contact of the manifold in this update replaces the old points
+        if (manifold->stamp != this->stamp_) {
+            manifold->points.clear();
+            manifold->stamp = this->stamp_;
+        }
+
+        bool swapped = manifold->bodyA != c->bi;
+        ContactManifoldPoint point;
+        manifold->bodyA->quaternion.conjugate(q);
+        q->vmult(swapped ? &c->rj : &c->ri, &point.localPointA);
+        manifold->bodyB->quaternion.conjugate(q);
+        q->vmult(swapped ? &c->ri : &c->rj, &point.localPointB);
+        point.lambda = c->lambda;
+        manifold->points.push_back(point);
+    }
+
+    // Drop the manifolds without contacts, moving the last one into the hole
+    for (int i = 0; i < this->manifolds.size();) {
+        if (this->manifolds[i].stamp == this->stamp_) {
+            i++;
+            continue;
+        }
+
+        ContactManifold* manifold = &this->manifolds[i];
+        this->index_.erase(ContactManifoldCache::getKey(manifold->bodyA, manifold->shapeA, manifold->bodyB, manifold->shapeB));
+
+        int last = this->manifolds.size() - 1;
+        if (i != last) {
+            this->manifolds[i] = this->manifolds[last];
+            manifold = &this->manifolds[i];
+            this->index_[ContactManifoldCache::getKey(manifold->bodyA, manifold->shapeA, manifold->bodyB, manifold->shapeB)] = i;
+        }
+        this->manifolds.pop_back();
+    }
+}
+
+ContactManifold* ContactManifoldCache::getManifold(
+    Objects::Body* bodyA,
+    Shapes::Shape* shapeA,
+    Objects::Body* bodyB,
+    Shapes::Shape* shapeB) {
+    auto it = this->index_.find(ContactManifoldCache::getKey(bodyA, shapeA, bodyB, shapeB));
+    return it == this->index_.end() ? nullptr : &this->manifolds[it->second];
+}
+
+void ContactManifoldCache::reset() {
+    this->manifolds.clear();
+    this->index_.clear();
+}
@@ -0,0 +1,97 @@
+#include "collision/ContactReduction.h"
+
+#include <algorithm>
+
+using namespace Cannon::Collision;
+
+constexpr int ContactReduction::maxContacts;
+
+thread_local Cannon::Math::Vec3 ContactReduction_edge;
+thread_local Cannon::Math::Vec3 ContactReduction_offset;
+thread_local Cannon::Math::Vec3 ContactReduction_cross;
+
+// Twice the signed area of the triangle abc, seen along the normal
+static float ContactReduction_signedArea(Cannon::Math::Vec3* a, Cannon::Math::Vec3* b, Cannon::Math::Vec3* c, Cannon::Math::Vec3* normal) {
+    b->vsub(a, &ContactReduction_edge);
+    c->vsub(a, &ContactReduction_offset);
+    ContactReduction_edge.cross(&ContactReduction_offset, &ContactReduction_cross);
+    return ContactReduction_cross.dot(normal);
+}
+
+void ContactReduction::reduce(
+    std::vector<Math::Vec3>* points,
+    std::vector<float>* depths,
+    Math::Vec3* normal,
+    std::vector<int>* target) {
+    target->clear();
+    int count = points->size();
+    if (count <= maxContacts) {
+        for (int i = 0; i < count; i++) {
+            target->push_back(i);
+        }
+        return;
+    }
+
+    // Deepest point
+    int i0 = 0;
+    for (int i = 1; i < count; i++) {
+        if (depths->at(i) > depths->at(i0)) {
+            i0 = i;
+        }
+    }
+    target->push_back(i0);
+    Math::Vec3* p0 = &points->at(i0);
+
+    // Furthest from the deepest point
+    int i1 = -1;
+    float maxDistance = 0;
+    for (int i = 0; i < count; i++) {
+        float distance = p0->distanceSquared(&points->at(i));
+        if (distance > maxDistance) {
+            maxDistance = distance;
+            i1 = i;
+        }
+    }
+    if (i1 == -1) {
+        return;
+    }
+    target->push_back(i1);
+    Math::Vec3* p1 = &points->at(i1);
+
+    // Largest triangle with the first two
+    int i2 = -1;
+    float maxArea = 0;
+    float winding = 1;
+    for (int i = 0; i < count; i++) {
+        float area = ContactReduction_signedArea(p0, p1, &points->at(i), normal);
+        float absArea = area < 0 ? -area : area;
+        if (absArea > maxArea) {
+            maxArea = absArea;
+            winding = area < 0 ? -1 : 1;
+            i2 = i;
+        }
+    }
+    if (i2 == -1) {
+        return;
+    }
+    target->push_back(i2);
+    Math::Vec3* p2 = &points->at(i2);
+
+    // The point furthest outside an edge of the triangle adds the most area
+    int i3 = -1;
+    float maxAdded = 0;
+    for (int i = 0; i < count; i++) {
+        Math::Vec3* p = &points->at(i);
+        float a01 = winding * ContactReduction_signedArea(p0, p1, p, normal);
+        float a12 = winding * ContactReduction_signedArea(p1, p2, p, normal);
+        float a20 = winding * ContactReduction_signedArea(p2, p0, p, normal);
+        float added = -std::min(a01, std::min(a12, a20));
+        if (added > maxAdded) {
+            maxAdded = added;
+            i3 = i;
+        }
+    }
+    if (i3 != -1) {
+        target->push_back(i3);
+    }
+}
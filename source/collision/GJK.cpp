@@ -0,0 +1,548 @@
+#include "collision/GJK.h"
+
+#include <cmath>
+#include "math/Quaternion.h"
+#include "shapes/ConvexPolyhedron.h"
+#include "shapes/Shape.h"
+
+using namespace Cannon::Collision;
+
+void GJK::setShapes_(
+    Shapes::Shape* shapeA,
+    Math::Vec3* posA,
+    Math::Quaternion* quatA,
+    Shapes::Shape* shapeB,
+    Math::Vec3* posB,
+    Math::Quaternion* quatB) {
+    this->shapeA_ = shapeA;
+    this->shapeB_ = shapeB;
+    this->posA_ = posA;
+    this->posB_ = posB;
+    this->quatA_ = quatA;
+    this->quatB_ = quatB;
+    this->vertexHintA_ = 0;
+    this->vertexHintB_ = 0;
+}
+
+void GJK::shapeSupport_(Shapes::Shape* shape, Math::Vec3* direction, Math::Vec3* target, int* vertexHint) {
+    if (shape->type == Shapes::ShapeTypes::CONVEXPOLYHEDRON) {
+        static_cast<Shapes::ConvexPolyhedron*>(shape)->supportPoint(direction, target, vertexHint);
+    } else {
+        shape->supportPoint(direction, target);
+    }
+}
+
+thread_local Cannon::Math::Quaternion GJK_support_conjugate;
+thread_local Cannon::Math::Vec3 GJK_support_direction;
+thread_local Cannon::Math::Vec3 GJK_support_localDirection;
+thread_local Cannon::Math::Vec3 GJK_support_localPoint;
+void GJK::support_(Math::Vec3* direction, GJKVertex* target) {
+    Math::Quaternion* conjugate = &GJK_support_conjugate;
+    Math::Vec3* negated = &GJK_support_direction;
+    Math::Vec3* localDirection = &GJK_support_localDirection;
+    Math::Vec3* localPoint = &GJK_support_localPoint;
+
+    // Furthest point of A along the direction
+    this->quatA_->conjugate(conjugate);
+    conjugate->vmult(direction, localDirection);
+    this->shapeSupport_(this->shapeA_, localDirection, localPoint, &this->vertexHintA_);
+    this->quatA_->vmult(localPoint, &target->pointA);
+    target->pointA.vadd(this->posA_, &target->pointA);
+
+    // Furthest point of B against it
+    direction->negate(negated);
+    this->quatB_->conjugate(conjugate);
+    conjugate->vmult(negated, localDirection);
+    this->shapeSupport_(this->shapeB_, localDirection, localPoint, &this->vertexHintB_);
+    this->quatB_->vmult(localPoint, &target->pointB);
+    target->pointB.vadd(this->posB_, &target->pointB);
+
+    target->pointA.vsub(&target->pointB, &target->point);
+}
+
+void GJK::closestOnSegment_(int a, int b, std::array<float, 4>* weights) {
+    Math::Vec3* A = &this->simplex_[a].point;
+    Math::Vec3* B = &this->simplex_[b].point;
+    Math::Vec3 ab;
+    B->vsub(A, &ab);
+
+    float denom = ab.dot(&ab);
+    float t = denom > 0 ? -A->dot(&ab) / denom : 0;
+    if (t <= 0) {
+        weights->at(a) = 1;
+    } else if (t >= 1) {
+        weights->at(b) = 1;
+    } else {
+        weights->at(a) = 1 - t;
+        weights->at(b) = t;
+    }
+}
+
+void GJK::closestOnTriangle_(int a, int b, int c, std::array<float, 4>* weights) {
+    // Voronoi regions of the triangle, see Ericson, Real-Time Collision Detection 5.1.5
+    Math::Vec3* A = &this->simplex_[a].point;
+    Math::Vec3* B = &this->simplex_[b].point;
+    Math::Vec3* C = &this->simplex_[c].point;
+    Math::Vec3 ab, ac;
+    B->vsub(A, &ab);
+    C->vsub(A, &ac);
+
+    float d1 = -ab.dot(A);
+    float d2 = -ac.dot(A);
+    if (d1 <= 0 && d2 <= 0) {
+        weights->at(a) = 1;
+        return;
+    }
+
+    float d3 = -ab.dot(B);
+    float d4 = -ac.dot(B);
+    if (d3 >= 0 && d4 <= d3) {
+        weights->at(b) = 1;
+        return;
+    }
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+        float v = d1 / (d1 - d3);
+        weights->at(a) = 1 - v;
+        weights->at(b) = v;
+        return;
+    }
+
+    float d5 = -ab.dot(C);
+    float d6 = -ac.dot(C);
+    if (d6 >= 0 && d5 <= d6) {
+        weights->at(c) = 1;
+        return;
+    }
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+        float w = d2 / (d2 - d6);
+        weights->at(a) = 1 - w;
+        weights->at(c) = w;
+        return;
+    }
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+        float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        weights->at(b) = 1 - w;
+        weights->at(c) = w;
+        return;
+    }
+
+    float denom = 1 / (va + vb + vc);
+    float v = vb * denom;
+    float w = vc * denom;
+    weights->at(a) = 1 - v - w;
+    weights->at(b) = v;
+    weights->at(c) = w;
+}
+
+bool GJK::closestOnTetrahedron_(std::array<float, 4>* weights) {
+    static const int faces[4][4] = {
+        {0, 1, 2, 3},
+        {0, 2, 3, 1},
+        {0, 3, 1, 2},
+        {1, 3, 2, 0}
+    };
+
+    bool outside = false;
+    float best = 0;
+    std::array<float, 4> faceWeights;
+    Math::Vec3 ab, ac, n, ad, p;
+    for (int i = 0; i < 4; i++) {
+        Math::Vec3* A = &this->simplex_[faces[i][0]].point;
+        this->simplex_[faces[i][1]].point.vsub(A, &ab);
+        this->simplex_[faces[i][2]].point.vsub(A, &ac);
+        this->simplex_[faces[i][3]].point.vsub(A, &ad);
+        ab.cross(&ac, &n);
+
+        // Skip the faces that have the origin on the same side as the fourth vertex. A flat tetrahedron contains nothing.
+        float sideOrigin = -n.dot(A);
+        float sideVertex = n.dot(&ad);
+        if (sideVertex != 0 && sideOrigin * sideVertex >= 0) {
+            continue;
+        }
+
+        faceWeights.fill(0);
+        this->closestOnTriangle_(faces[i][0], faces[i][1], faces[i][2], &faceWeights);
+        p.setZero();
+        for (int j = 0; j < 4; j++) {
+            p.addScaledVector(faceWeights[j], &this->simplex_[j].point, &p);
+        }
+
+        float d = p.lengthSquared();
+        if (!outside || d < best) {
+            outside = true;
+            best = d;
+            *weights = faceWeights;
+        }
+    }
+
+    return outside;
+}
+
+void GJK::reduceSimplex_(std::array<float, 4>* weights, Math::Vec3* target) {
+    // Keep the vertices that support the closest point
+    int n = 0;
+    target->setZero();
+    for (int i = 0; i < this->simplexSize_; i++) {
+        if (weights->at(i) <= 0) {
+            continue;
+        }
+        if (i != n) {
+            this->simplex_[n] = this->simplex_[i];
+        }
+        this->weights_[n] = weights->at(i);
+        target->addScaledVector(this->weights_[n], &this->simplex_[n].point, target);
+        n++;
+    }
+    this->simplexSize_ = n;
+}
+
+bool GJK::closestPoint_(Math::Vec3* target) {
+    std::array<float, 4> weights;
+    weights.fill(0);
+
+    switch (this->simplexSize_) {
+        case 1:
+            weights[0] = 1;
+            break;
+        case 2:
+            this->closestOnSegment_(0, 1, &weights);
+            break;
+        case 3:
+            this->closestOnTriangle_(0, 1, 2, &weights);
+            break;
+        default:
+            if (!this->closestOnTetrahedron_(&weights)) {
+                // The origin is inside
+                return false;
+            }
+    }
+
+    this->reduceSimplex_(&weights, target);
+    return true;
+}
+
+bool GJK::runGJK_(GJKResult* result) {
+    Math::Vec3 v, direction;
+
+    // Start from the support point along the line between the shape centers
+    this->posA_->vsub(this->posB_, &direction);
+    if (direction.isZero()) {
+        direction.set(1, 0, 0);
+    }
+    this->support_(&direction, &this->simplex_[0]);
+    this->weights_[0] = 1;
+    this->simplexSize_ = 1;
+    v.copy(&this->simplex_[0].point);
+
+    bool intersecting = false;
+    int iter = 0;
+    for (iter = 0; iter < this->maxIterations; iter++) {
+        float vv = v.dot(&v);
+        if (vv < 1e-12) {
+            // Touching, or the origin is on the simplex
+            intersecting = true;
+            break;
+        }
+
+        GJKVertex* w = &this->simplex_[this->simplexSize_];
+        v.negate(&direction);
+        this->support_(&direction, w);
+
+        // No more progress towards the origin
+        if (vv - v.dot(&w->point) <= this->tolerance * vv) {
+            break;
+        }
+
+        bool duplicate = false;
+        for (int i = 0; i < this->simplexSize_; i++) {
+            if (this->simplex_[i].point.distanceSquared(&w->point) < 1e-12) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (duplicate) {
+            break;
+        }
+
+        this->simplexSize_++;
+        if (!this->closestPoint_(&v)) {
+            intersecting = true;
+            break;
+        }
+    }
+
+    result->iterations = iter;
+    result->intersecting = intersecting;
+    if (intersecting) {
+        return true;
+    }
+
+    // Closest points from the weights of the simplex
+    result->pointA.setZero();
+    result->pointB.setZero();
+    for (int i = 0; i < this->simplexSize_; i++) {
+        result->pointA.addScaledVector(this->weights_[i], &this->simplex_[i].pointA, &result->pointA);
+        result->pointB.addScaledVector(this->weights_[i], &this->simplex_[i].pointB, &result->pointB);
+    }
+    result->distance = v.length();
+    result->depth = 0;
+    v.scale(-1 / result->distance, &result->normal);
+    return false;
+}
+
+bool GJK::fillSimplex_() {
+    static const float axes[6][3] = {
+        {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}
+    };
+    const float eps = 1e-10;
+    Math::Vec3 direction, d, e, n;
+
+    if (this->simplexSize_ == 1) {
+        for (int i = 0; i < 6 && this->simplexSize_ == 1; i++) {
+            direction.set(axes[i][0], axes[i][1], axes[i][2]);
+            this->support_(&direction, &this->simplex_[1]);
+            if (this->simplex_[1].point.distanceSquared(&this->simplex_[0].point) > eps) {
+                this->simplexSize_ = 2;
+            }
+        }
+        if (this->simplexSize_ == 1) {
+            return false;
+        }
+    }
+
+    if (this->simplexSize_ == 2) {
+        this->simplex_[1].point.vsub(&this->simplex_[0].point, &d);
+        for (int i = 0; i < 6 && this->simplexSize_ == 2; i++) {
+            e.set(axes[i][0], axes[i][1], axes[i][2]);
+            d.cross(&e, &direction);
+            if (direction.lengthSquared() < eps) {
+                continue;
+            }
+            this->support_(&direction, &this->simplex_[2]);
+            this->simplex_[2].point.vsub(&this->simplex_[0].point, &e);
+            e.cross(&d, &n);
+            if (n.lengthSquared() > eps) {
+                this->simplexSize_ = 3;
+            }
+        }
+        if (this->simplexSize_ == 2) {
+            return false;
+        }
+    }
+
+    if (this->simplexSize_ == 3) {
+        this->simplex_[1].point.vsub(&this->simplex_[0].point, &d);
+        this->simplex_[2].point.vsub(&this->simplex_[0].point, &e);
+        d.cross(&e, &n);
+        for (int i = 0; i < 2 && this->simplexSize_ == 3; i++) {
+            this->support_(&n, &this->simplex_[3]);
+            this->simplex_[3].point.vsub(&this->simplex_[0].point, &e);
+            if (std::abs(e.dot(&n)) > eps) {
+                this->simplexSize_ = 4;
+            }
+            n.negate(&n);
+        }
+        if (this->simplexSize_ == 3) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void GJK::addFace_(int a, int b, int c) {
+    EPAFace face;
+    face.vertices = {a, b, c};
+    face.removed = false;
+
+    Math::Vec3 ab, ac;
+    Math::Vec3* A = &this->polytope_[a].point;
+    this->polytope_[b].point.vsub(A, &ab);
+    this->polytope_[c].point.vsub(A, &ac);
+    ab.cross(&ac, &face.normal);
+    if (face.normal.lengthSquared() < 1e-20) {
+        // Degenerate, never the closest face
+        face.normal.setZero();
+        face.distance = 0;
+    } else {
+        face.normal.normalize();
+        face.distance = face.normal.dot(A);
+    }
+
+    this->faces_.push_back(face);
+}
+
+void GJK::addHorizonEdge_(int a, int b) {
+    // An edge shared by two removed faces is not on the horizon
+    for (int i = 0; i < this->horizon_.size(); i++) {
+        if (this->horizon_[i][0] == b && this->horizon_[i][1] == a) {
+            this->horizon_[i] = this->horizon_.back();
+            this->horizon_.pop_back();
+            return;
+        }
+    }
+    this->horizon_.push_back({a, b});
+}
+
+bool GJK::runEPA_(GJKResult* result) {
+    this->polytope_.clear();
+    this->faces_.clear();
+    for (int i = 0; i < 4; i++) {
+        this->polytope_.push_back(this->simplex_[i]);
+    }
+
+    // Wind the tetrahedron so that the face normals point out
+    Math::Vec3 ab, ac, ad, n;
+    this->polytope_[1].point.vsub(&this->polytope_[0].point, &ab);
+    this->polytope_[2].point.vsub(&this->polytope_[0].point, &ac);
+    this->polytope_[3].point.vsub(&this->polytope_[0].point, &ad);
+    ab.cross(&ac, &n);
+    if (n.dot(&ad) > 0) {
+        std::swap(this->polytope_[1], this->polytope_[2]);
+    }
+    this->addFace_(0, 1, 2);
+    this->addFace_(0, 3, 1);
+    this->addFace_(0, 2, 3);
+    this->addFace_(1, 3, 2);
+
+    EPAFace* closest = nullptr;
+    GJKVertex w;
+    for (int iter = 0; iter < this->maxEPAIterations; iter++) {
+        closest = nullptr;
+        for (int i = 0; i < this->faces_.size(); i++) {
+            EPAFace* face = &this->faces_[i];
+            if (!face->removed && !face->normal.isZero() && (closest == nullptr || face->distance < closest->distance)) {
+                closest = face;
+            }
+        }
+        if (closest == nullptr) {
+            return false;
+        }
+
+        this->support_(&closest->normal, &w);
+        if (closest->normal.dot(&w.point) - closest->distance < this->epaTolerance) {
+            break;
+        }
+
+        // Remove the faces that can see the new point, and close the hole with faces to it
+        int index = this->polytope_.size();
+        this->polytope_.push_back(w);
+        this->horizon_.clear();
+        for (int i = 0; i < this->faces_.size(); i++) {
+            EPAFace* face = &this->faces_[i];
+            if (face->removed) {
+                continue;
+            }
+            Math::Vec3 aw;
+            w.point.vsub(&this->polytope_[face->vertices[0]].point, &aw);
+            if (face->normal.dot(&aw) > 0) {
+                face->removed = true;
+                this->addHorizonEdge_(face->vertices[0], face->vertices[1]);
+                this->addHorizonEdge_(face->vertices[1], face->vertices[2]);
+                this->addHorizonEdge_(face->vertices[2], face->vertices[0]);
+            }
+        }
+        if (this->horizon_.empty()) {
+            // Numerical trouble, keep the current closest face
+            this->polytope_.pop_back();
+            break;
+        }
+        for (int i = 0; i < this->horizon_.size(); i++) {
+            this->addFace_(this->horizon_[i][0], this->horizon_[i][1], index);
+        }
+        closest = nullptr;
+    }
+
+    if (closest == nullptr) {
+        // Out of iterations, use the closest face found
+        for (int i = 0; i < this->faces_.size(); i++) {
+            EPAFace* face = &this->faces_[i];
+            if (!face->removed && !face->normal.isZero() && (closest == nullptr || face->distance < closest->distance)) {
+                closest = face;
+            }
+        }
+        if (closest == nullptr) {
+            return false;
+        }
+    }
+
+    // Barycentric coordinates of the origin projected on the closest face
+    GJKVertex* A = &this->polytope_[closest->vertices[0]];
+    GJKVertex* B = &this->polytope_[closest->vertices[1]];
+    GJKVertex* C = &this->polytope_[closest->vertices[2]];
+    Math::Vec3 p, ap;
+    closest->normal.scale(closest->distance, &p);
+    B->point.vsub(&A->point, &ab);
+    C->point.vsub(&A->point, &ac);
+    p.vsub(&A->point, &ap);
+    float d00 = ab.dot(&ab);
+    float d01 = ab.dot(&ac);
+    float d11 = ac.dot(&ac);
+    float d20 = ap.dot(&ab);
+    float d21 = ap.dot(&ac);
+    float denom = d00 * d11 - d01 * d01;
+    float v = denom != 0 ? (d11 * d20 - d01 * d21) / denom : 0;
+    float u = denom != 0 ? (d00 * d21 - d01 * d20) / denom : 0;
+    float t = 1 - v - u;
+
+    result->pointA.setZero();
+    result->pointA.addScaledVector(t, &A->pointA, &result->pointA);
+    result->pointA.addScaledVector(v, &B->pointA, &result->pointA);
+    result->pointA.addScaledVector(u, &C->pointA, &result->pointA);
+    result->pointB.setZero();
+    result->pointB.addScaledVector(t, &A->pointB, &result->pointB);
+    result->pointB.addScaledVector(v, &B->pointB, &result->pointB);
+    result->pointB.addScaledVector(u, &C->pointB, &result->pointB);
+    result->normal.copy(&closest->normal);
+    result->depth = closest->distance;
+    result->distance = 0;
+    return true;
+}
+
+bool GJK::distance(
+    Shapes::Shape* shapeA,
+    Math::Vec3* posA,
+    Math::Quaternion* quatA,
+    Shapes::Shape* shapeB,
+    Math::Vec3* posB,
+    Math::Quaternion* quatB,
+    GJKResult* result) {
+    this->setShapes_(shapeA, posA, quatA, shapeB, posB, quatB);
+    return !this->runGJK_(result);
+}
+
+bool GJK::penetration(
+    Shapes::Shape* shapeA,
+    Math::Vec3* posA,
+    Math::Quaternion* quatA,
+    Shapes::Shape* shapeB,
+    Math::Vec3* posB,
+    Math::Quaternion* quatB,
+    GJKResult* result) {
+    this->setShapes_(shapeA, posA, quatA, shapeB, posB, quatB);
+    if (!this->runGJK_(result)) {
+        return false;
+    }
+
+    if ((this->simplexSize_ == 4 || this->fillSimplex_()) && this->runEPA_(result)) {
+        return true;
+    }
+
+    // Flat overlap, e.g. touching faces. Report a zero depth contact between the centers.
+    posB->vsub(posA, &result->normal);
+    if (result->normal.isZero()) {
+        result->normal.set(1, 0, 0);
+    }
+    result->normal.normalize();
+    posA->lerp(posB, 0.5, &result->pointA);
+    result->pointB.copy(&result->pointA);
+    result->depth = 0;
+    result->distance = 0;
+    return true;
+}
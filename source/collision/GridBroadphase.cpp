@@ -0,0 +1,370 @@
+#include "collision/GridBroadphase.h"
+
+#include <algorithm>
+#include <cmath>
+#include "collision/AABB.h"
+#include "objects/Body.h"
+#include "shapes/Shape.h"
+#include "world/World.h"
+
+using namespace Cannon::Collision;
+
+int GridBroadphase::cellCoord(float x, float origin, float size) {
+    // Clamp so that bodies far outside the grid region do not overflow
+    float c = std::floor((x - origin) / size);
+    c = std::max(-1073741824.0f, std::min(1073741824.0f, c));
+    return (int)c;
+}
+
+int GridBroadphase::hash(int x, int y, int z) {
+    unsigned int h = ((unsigned int)x * 73856093u) ^ ((unsigned int)y * 19349663u) ^ ((unsigned int)z * 83492791u);
+    return (int)(h & 0x7fffffff);
+}
+
+GridBroadphase::GridBroadphase(
+    Math::Vec3* aabbMin,
+    Math::Vec3* aabbMax,
+    int nx,
+    int ny,
+    int nz) {
+    Math::Vec3 defaultMin(-100, -100, -100);
+    Math::Vec3 defaultMax(100, 100, 100);
+    this->setBounds(
+        aabbMin != nullptr ? aabbMin : &defaultMin,
+        aabbMax != nullptr ? aabbMax : &defaultMax,
+        nx,
+        ny,
+        nz);
+}
+
+void GridBroadphase::setBounds(Math::Vec3* aabbMin, Math::Vec3* aabbMax, int nx, int ny, int nz) {
+    this->aabbMin.copy(aabbMin);
+    this->aabbMax.copy(aabbMax);
+    this->nx = nx;
+    this->ny = ny;
+    this->nz = nz;
+    this->dirty = true;
+}
+
+void GridBroadphase::setWorld(World::World* world) {
+    this->bodies.clear();
+    for (int i = 0; i < world->bodies.size(); i++) {
+        this->bodies.push_back(world->bodies[i]);
+    }
+
+    this->world = world;
+    this->dirty = true;
+}
+
+void GridBroadphase::addBody(Objects::Body* body) {
+    this->bodies.push_back(body);
+    this->dirty = true;
+}
+
+void GridBroadphase::removeBody(Objects::Body* body) {
+    auto it = std::find(this->bodies.begin(), this->bodies.end(), body);
+    if (it != this->bodies.end()) {
+        this->bodies.erase(it);
+        this->dirty = true;
+    }
+}
+
+void GridBroadphase::updateGrid_() {
+    std::vector<Objects::Body*>* bodies = &this->bodies;
+    int N = bodies->size();
+
+    this->level1.cellSize.set(
+        (this->aabbMax.x - this->aabbMin.x) / this->nx,
+        (this->aabbMax.y - this->aabbMin.y) / this->ny,
+        (this->aabbMax.z - this->aabbMin.z) / this->nz);
+    this->level1.cellSize.scale(this->secondLevelScale, &this->level2.cellSize);
+
+    this->bodyLevel_.resize(N);
+    this->globalBodies.clear();
+
+    for (int i = 0; i != N; i++) {
+        Objects::Body* bi = bodies->at(i);
+        if (bi->aabbNeedsUpdate) {
+            bi->computeAABB();
+        }
+
+        // Planes would cover every cell
+        bool isPlane = false;
+        for (int j = 0; j < bi->shapes.size(); j++) {
+            if (bi->shapes[j]->type == Shapes::ShapeTypes::PLANE) {
+                isPlane = true;
+            }
+        }
+        if (isPlane) {
+            this->bodyLevel_[i] = -1;
+            this->globalBodies.push_back(i);
+            continue;
+        }
+
+        Math::Vec3* lower = &bi->aabb.lowerBound;
+        Math::Vec3* upper = &bi->aabb.upperBound;
+        Math::Vec3* cellSize = &this->level1.cellSize;
+        int level = 0;
+        if (this->useSecondLevel
+            && (upper->x - lower->x > cellSize->x
+                || upper->y - lower->y > cellSize->y
+                || upper->z - lower->z > cellSize->z)) {
+            level = 1;
+            cellSize = &this->level2.cellSize;
+        }
+
+        double cells = 1;
+        cells *= GridBroadphase::cellCoord(upper->x, this->aabbMin.x, cellSize->x) - GridBroadphase::cellCoord(lower->x, this->aabbMin.x, cellSize->x) + 1.0;
+        cells *= GridBroadphase::cellCoord(upper->y, this->aabbMin.y, cellSize->y) - GridBroadphase::cellCoord(lower->y, this->aabbMin.y, cellSize->y) + 1.0;
+        cells *= GridBroadphase::cellCoord(upper->z, this->aabbMin.z, cellSize->z) - GridBroadphase::cellCoord(lower->z, this->aabbMin.z, cellSize->z) + 1.0;
+        if (cells > this->maxCellsPerBody) {
+            level = -1;
+            this->globalBodies.push_back(i);
+        }
+
+        this->bodyLevel_[i] = level;
+    }
+
+    this->buildLevel_(&this->level1, true, false);
+    if (this->useSecondLevel) {
+        // Small bodies are added to the second level too, to find the pairs between small and large bodies
+        this->buildLevel_(&this->level2, true, true);
+    }
+}
+
+void GridBroadphase::buildLevel_(GridBroadphaseLevel* level, bool includeSmall, bool includeLarge) {
+    std::vector<Objects::Body*>* bodies = &this->bodies;
+    int N = bodies->size();
+    Math::Vec3* cellSize = &level->cellSize;
+
+    this->unsortedBody_.clear();
+    this->unsortedX_.clear();
+    this->unsortedY_.clear();
+    this->unsortedZ_.clear();
+    level->bodyMinX.resize(N);
+    level->bodyMinY.resize(N);
+    level->bodyMinZ.resize(N);
+
+    for (int i = 0; i != N; i++) {
+        int bodyLevel = this->bodyLevel_[i];
+        if (bodyLevel == -1 || (bodyLevel == 0 && !includeSmall) || (bodyLevel == 1 && !includeLarge)) {
+            continue;
+        }
+
+        Objects::Body* bi = bodies->at(i);
+        int x0 = GridBroadphase::cellCoord(bi->aabb.lowerBound.x, this->aabbMin.x, cellSize->x);
+        int y0 = GridBroadphase::cellCoord(bi->aabb.lowerBound.y, this->aabbMin.y, cellSize->y);
+        int z0 = GridBroadphase::cellCoord(bi->aabb.lowerBound.z, this->aabbMin.z, cellSize->z);
+        int x1 = GridBroadphase::cellCoord(bi->aabb.upperBound.x, this->aabbMin.x, cellSize->x);
+        int y1 = GridBroadphase::cellCoord(bi->aabb.upperBound.y, this->aabbMin.y, cellSize->y);
+        int z1 = GridBroadphase::cellCoord(bi->aabb.upperBound.z, this->aabbMin.z, cellSize->z);
+        level->bodyMinX[i] = x0;
+        level->bodyMinY[i] = y0;
+        level->bodyMinZ[i] = z0;
+
+        for (int x = x0; x <= x1; x++) {
+            for (int y = y0; y <= y1; y++) {
+                for (int z = z0; z <= z1; z++) {
+                    this->unsortedBody_.push_back(i);
+                    this->unsortedX_.push_back(x);
+                    this->unsortedY_.push_back(y);
+                    this->unsortedZ_.push_back(z);
+                }
+            }
+        }
+    }
+
+    int count = this->unsortedBody_.size();
+    int tableSize = 16;
+    while (tableSize < 2 * count) {
+        tableSize *= 2;
+    }
+    level->tableSize = tableSize;
+
+    // Counting sort of the entries by bucket
+    std::vector<int>* cellStart = &level->cellStart;
+    cellStart->assign(tableSize + 1, 0);
+    this->bucket_.resize(count);
+    for (int e = 0; e != count; e++) {
+        int h = GridBroadphase::hash(this->unsortedX_[e], this->unsortedY_[e], this->unsortedZ_[e]) & (tableSize - 1);
+        this->bucket_[e] = h;
+        cellStart->at(h + 1)++;
+    }
+    for (int b = 0; b != tableSize; b++) {
+        cellStart->at(b + 1) += cellStart->at(b);
+    }
+
+    this->cursor_.assign(cellStart->begin(), cellStart->end() - 1);
+    level->entryBody.resize(count);
+    level->entryX.resize(count);
+    level->entryY.resize(count);
+    level->entryZ.resize(count);
+    for (int e = 0; e != count; e++) {
+        int pos = this->cursor_[this->bucket_[e]]++;
+        level->entryBody[pos] = this->unsortedBody_[e];
+        level->entryX[pos] = this->unsortedX_[e];
+        level->entryY[pos] = this->unsortedY_[e];
+        level->entryZ[pos] = this->unsortedZ_[e];
+    }
+}
+
+void GridBroadphase::levelPairs_(
+    GridBroadphaseLevel* level,
+    bool requireLarge,
+    std::vector<Objects::Body*>* pairs1,
+    std::vector<Objects::Body*>* pairs2) {
+    std::vector<Objects::Body*>* bodies = &this->bodies;
+
+    for (int b = 0; b != level->tableSize; b++) {
+        int start = level->cellStart[b];
+        int end = level->cellStart[b + 1];
+
+        for (int i = start; i < end; i++) {
+            int x = level->entryX[i];
+            int y = level->entryY[i];
+            int z = level->entryZ[i];
+            int bi = level->entryBody[i];
+
+            for (int j = i + 1; j < end; j++) {
+                // Different cells can share a bucket
+                if (level->entryX[j] != x || level->entryY[j] != y || level->entryZ[j] != z) {
+                    continue;
+                }
+
+                int bj = level->entryBody[j];
+                if (requireLarge && this->bodyLevel_[bi] != 1 && this->bodyLevel_[bj] != 1) {
+                    continue;
+                }
+
+                // Only report the pair in the lowest cell that both bodies cover
+                if (std::max(level->bodyMinX[bi], level->bodyMinX[bj]) != x
+                    || std::max(level->bodyMinY[bi], level->bodyMinY[bj]) != y
+                    || std::max(level->bodyMinZ[bi], level->bodyMinZ[bj]) != z) {
+                    continue;
+                }
+
+                Objects::Body* bodyA = bodies->at(std::min(bi, bj));
+                Objects::Body* bodyB = bodies->at(std::max(bi, bj));
+                if (!this->needBroadphaseCollision(bodyA, bodyB)) {
+                    continue;
+                }
+
+                this->intersectionTest(bodyA, bodyB, pairs1, pairs2);
+            }
+        }
+    }
+}
+
+void GridBroadphase::collisionPairs(
+    World::World* world,
+    std::vector<Objects::Body*>* pairs1,
+    std::vector<Objects::Body*>* pairs2) {
+    std::vector<Objects::Body*>* bodies = &this->bodies;
+    int N = bodies->size();
+
+    // Bodies move every step, so the grid is always rebuilt
+    this->updateGrid_();
+    this->dirty = false;
+
+    this->levelPairs_(&this->level1, false, pairs1, pairs2);
+    if (this->useSecondLevel) {
+        this->levelPairs_(&this->level2, true, pairs1, pairs2);
+    }
+
+    // Global bodies against everything else
+    for (int k = 0; k < this->globalBodies.size(); k++) {
+        int g = this->globalBodies[k];
+        for (int i = 0; i != N; i++) {
+            if (i == g || (this->bodyLevel_[i] == -1 && i < g)) {
+                continue;
+            }
+
+            Objects::Body* bodyA = bodies->at(std::min(i, g));
+            Objects::Body* bodyB = bodies->at(std::max(i, g));
+            if (!this->needBroadphaseCollision(bodyA, bodyB)) {
+                continue;
+            }
+
+            this->intersectionTest(bodyA, bodyB, pairs1, pairs2);
+        }
+    }
+}
+
+void GridBroadphase::queryLevel_(
+    GridBroadphaseLevel* level,
+    bool onlyLarge,
+    Collision::AABB* aabb,
+    std::vector<Objects::Body*>* result) {
+    Math::Vec3* cellSize = &level->cellSize;
+    int x0 = GridBroadphase::cellCoord(aabb->lowerBound.x, this->aabbMin.x, cellSize->x);
+    int y0 = GridBroadphase::cellCoord(aabb->lowerBound.y, this->aabbMin.y, cellSize->y);
+    int z0 = GridBroadphase::cellCoord(aabb->lowerBound.z, this->aabbMin.z, cellSize->z);
+    int x1 = GridBroadphase::cellCoord(aabb->upperBound.x, this->aabbMin.x, cellSize->x);
+    int y1 = GridBroadphase::cellCoord(aabb->upperBound.y, this->aabbMin.y, cellSize->y);
+    int z1 = GridBroadphase::cellCoord(aabb->upperBound.z, this->aabbMin.z, cellSize->z);
+    double cells = (x1 - x0 + 1.0) * (y1 - y0 + 1.0) * (z1 - z0 + 1.0);
+    int count = level->entryBody.size();
+
+    // Scan all entries if the query covers more cells than there are entries
+    if (cells > count) {
+        for (int e = 0; e != count; e++) {
+            int bi = level->entryBody[e];
+            if ((onlyLarge && this->bodyLevel_[bi] != 1) || this->queryStamp_[bi] == this->queryCounter_) {
+                continue;
+            }
+            this->queryStamp_[bi] = this->queryCounter_;
+            if (this->bodies[bi]->aabb.overlaps(aabb)) {
+                result->push_back(this->bodies[bi]);
+            }
+        }
+        return;
+    }
+
+    for (int x = x0; x <= x1; x++) {
+        for (int y = y0; y <= y1; y++) {
+            for (int z = z0; z <= z1; z++) {
+                int b = GridBroadphase::hash(x, y, z) & (level->tableSize - 1);
+                for (int e = level->cellStart[b]; e < level->cellStart[b + 1]; e++) {
+                    if (level->entryX[e] != x || level->entryY[e] != y || level->entryZ[e] != z) {
+                        continue;
+                    }
+                    int bi = level->entryBody[e];
+                    if ((onlyLarge && this->bodyLevel_[bi] != 1) || this->queryStamp_[bi] == this->queryCounter_) {
+                        continue;
+                    }
+                    this->queryStamp_[bi] = this->queryCounter_;
+                    if (this->bodies[bi]->aabb.overlaps(aabb)) {
+                        result->push_back(this->bodies[bi]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+std::vector<Cannon::Objects::Body*>* GridBroadphase::aabbQuery(
+    World::World* world,
+    Collision::AABB* aabb,
+    std::vector<Objects::Body*>* result) {
+    if (this->dirty) {
+        this->updateGrid_();
+        this->dirty = false;
+    }
+
+    this->queryStamp_.resize(this->bodies.size(), 0);
+    this->queryCounter_++;
+
+    this->queryLevel_(&this->level1, false, aabb, result);
+    if (this->useSecondLevel) {
+        this->queryLevel_(&this->level2, true, aabb, result);
+    }
+
+    for (int k = 0; k < this->globalBodies.size(); k++) {
+        Objects::Body* b = this->bodies[this->globalBodies[k]];
+        if (b->aabb.overlaps(aabb)) {
+            result->push_back(b);
+        }
+    }
+
+    return result;
+}
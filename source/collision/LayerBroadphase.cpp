@@ -0,0 +1,272 @@
+#include "collision/LayerBroadphase.h"
+
+#include <algorithm>
+#include "collision/AABB.h"
+#include "collision/AABBTreeBroadphase.h"
+#include "math/Vec3.h"
+#include "objects/Body.h"
+#include "world/World.h"
+
+using namespace Cannon::Collision;
+
+LayerBroadphase::LayerBroadphase(World::World* world) {
+    if (world != nullptr) {
+        this->setWorld(world);
+    }
+}
+
+LayerBroadphase::~LayerBroadphase() {
+    for (int i = 0; i < this->layers.size(); i++) {
+        delete this->layers[i];
+    }
+}
+
+bool LayerBroadphase::layersCollide(BroadphaseLayer* layerA, BroadphaseLayer* layerB) {
+    return (layerA->collisionFilterGroup & layerB->collisionFilterMask) != 0
+        && (layerB->collisionFilterGroup & layerA->collisionFilterMask) != 0;
+}
+
+void LayerBroadphase::setWorld(World::World* world) {
+    // Remove the bodies of the old world
+    while (!this->bodies.empty()) {
+        this->removeBody(this->bodies.back());
+    }
+
+    for (int i = 0; i < world->bodies.size(); i++) {
+        this->addBody(world->bodies[i]);
+    }
+
+    this->world = world;
+}
+
+int LayerBroadphase::getLayer_(int collisionFilterGroup, int collisionFilterMask) {
+    for (int i = 0; i < this->layers.size(); i++) {
+        BroadphaseLayer* layer = this->layers[i];
+        if (layer->collisionFilterGroup == collisionFilterGroup && layer->collisionFilterMask == collisionFilterMask) {
+            return i;
+        }
+    }
+
+    BroadphaseLayer* layer = new BroadphaseLayer();
+    layer->collisionFilterGroup = collisionFilterGroup;
+    layer->collisionFilterMask = collisionFilterMask;
+    this->layers.push_back(layer);
+    this->layersChanged_ = true;
+    return this->layers.size() - 1;
+}
+
+void LayerBroadphase::updateLayerPairs_() {
+    this->layerPairs1_.clear();
+    this->layerPairs2_.clear();
+    for (int i = 0; i < this->layers.size(); i++) {
+        for (int j = i + 1; j < this->layers.size(); j++) {
+            if (LayerBroadphase::layersCollide(this->layers[i], this->layers[j])) {
+                this->layerPairs1_.push_back(i);
+                this->layerPairs2_.push_back(j);
+            }
+        }
+    }
+}
+
+void LayerBroadphase::createProxy_(int index) {
+    Objects::Body* body = this->bodies[index];
+    if (body->aabbNeedsUpdate) {
+        body->computeAABB();
+    }
+
+    bool isStatic = AABBTreeBroadphase::isStaticOrSleeping(body);
+    int layerId = this->getLayer_(body->collisionFilterGroup, body->collisionFilterMask);
+    BroadphaseLayer* layer = this->layers[layerId];
+    Utils::AABBTree* tree = isStatic ? &layer->staticTree : &layer->dynamicTree;
+    this->proxyIds_[index] = tree->createProxy(&body->aabb, index);
+    this->layerIds_[index] = layerId;
+    this->inStaticTree_[index] = isStatic;
+    layer->bodyCount++;
+}
+
+void LayerBroadphase::destroyProxy_(int index) {
+    BroadphaseLayer* layer = this->layers[this->layerIds_[index]];
+    Utils::AABBTree* tree = this->inStaticTree_[index] ? &layer->staticTree : &layer->dynamicTree;
+    tree->destroyProxy(this->proxyIds_[index]);
+    layer->bodyCount--;
+}
+
+void LayerBroadphase::addBody(Objects::Body* body) {
+    this->bodies.push_back(body);
+    this->proxyIds_.push_back(-1);
+    this->layerIds_.push_back(-1);
+    this->inStaticTree_.push_back(false);
+    this->createProxy_(this->bodies.size() - 1);
+    this->dirty = true;
+}
+
+void LayerBroadphase::removeBody(Objects::Body* body) {
+    auto it = std::find(this->bodies.begin(), this->bodies.end(), body);
+    if (it == this->bodies.end()) {
+        return;
+    }
+
+    int index = it - this->bodies.begin();
+    int last = this->bodies.size() - 1;
+    this->destroyProxy_(index);
+
+    // Move the last body into the hole
+    this->bodies[index] = this->bodies[last];
+    this->proxyIds_[index] = this->proxyIds_[last];
+    this->layerIds_[index] = this->layerIds_[last];
+    this->inStaticTree_[index] = this->inStaticTree_[last];
+    this->bodies.pop_back();
+    this->proxyIds_.pop_back();
+    this->layerIds_.pop_back();
+    this->inStaticTree_.pop_back();
+    if (index != last) {
+        BroadphaseLayer* layer = this->layers[this->layerIds_[index]];
+        Utils::AABBTree* tree = this->inStaticTree_[index] ? &layer->staticTree : &layer->dynamicTree;
+        tree->setUserData(this->proxyIds_[index], index);
+    }
+}
+
+void LayerBroadphase::updateProxies_() {
+    for (int i = 0; i < this->bodies.size(); i++) {
+        Objects::Body* body = this->bodies[i];
+        BroadphaseLayer* layer = this->layers[this->layerIds_[i]];
+        bool isStatic = AABBTreeBroadphase::isStaticOrSleeping(body);
+
+        if (isStatic != (bool)this->inStaticTree_[i]
+            || body->collisionFilterGroup != layer->collisionFilterGroup
+            || body->collisionFilterMask != layer->collisionFilterMask) {
+            // Changed type, sleep state or collision filter. Move the proxy to the right tree.
+            this->destroyProxy_(i);
+            this->createProxy_(i);
+            continue;
+        }
+
+        if (isStatic) {
+            // Static bodies are only touched when they were moved
+            if (body->aabbNeedsUpdate) {
+                body->computeAABB();
+                layer->staticTree.moveProxy(this->proxyIds_[i], &body->aabb);
+            }
+            continue;
+        }
+
+        if (body->aabbNeedsUpdate) {
+            body->computeAABB();
+        }
+        layer->dynamicTree.moveProxy(this->proxyIds_[i], &body->aabb);
+    }
+}
+
+void LayerBroadphase::queryTrees_(
+    Utils::AABBTree* a,
+    Utils::AABBTree* b,
+    std::vector<Objects::Body*>* p1,
+    std::vector<Objects::Body*>* p2) {
+    if (a->root == -1 || b->root == -1) {
+        return;
+    }
+
+    std::vector<int>* pairs1 = &this->pairs1_;
+    std::vector<int>* pairs2 = &this->pairs2_;
+    pairs1->clear();
+    pairs2->clear();
+    if (a == b) {
+        a->queryPairs(pairs1, pairs2);
+    } else {
+        a->queryTree(b, pairs1, pairs2);
+    }
+
+    // The layers and trees already rule out the pairs that do not need collision, only the real bounds are left to check
+    for (int i = 0; i < pairs1->size(); i++) {
+        this->intersectionTest(this->bodies[pairs1->at(i)], this->bodies[pairs2->at(i)], p1, p2);
+    }
+}
+
+void LayerBroadphase::collisionPairs(
+    World::World* world,
+    std::vector<Objects::Body*>* p1,
+    std::vector<Objects::Body*>* p2) {
+    if (this->dirty) {
+        this->updateProxies_();
+        this->dirty = false;
+    }
+
+    if (this->layersChanged_) {
+        this->updateLayerPairs_();
+        this->layersChanged_ = false;
+    }
+
+    // Within each layer
+    for (int i = 0; i < this->layers.size(); i++) {
+        BroadphaseLayer* layer = this->layers[i];
+        if (layer->bodyCount == 0 || !LayerBroadphase::layersCollide(layer, layer)) {
+            continue;
+        }
+        this->queryTrees_(&layer->dynamicTree, &layer->dynamicTree, p1, p2);
+        this->queryTrees_(&layer->dynamicTree, &layer->staticTree, p1, p2);
+    }
+
+    // Between the layers that can collide
+    for (int k = 0; k < this->layerPairs1_.size(); k++) {
+        BroadphaseLayer* layerA = this->layers[this->layerPairs1_[k]];
+        BroadphaseLayer* layerB = this->layers[this->layerPairs2_[k]];
+        if (layerA->bodyCount == 0 || layerB->bodyCount == 0) {
+            continue;
+        }
+        this->queryTrees_(&layerA->dynamicTree, &layerB->dynamicTree, p1, p2);
+        this->queryTrees_(&layerA->dynamicTree, &layerB->staticTree, p1, p2);
+        this->queryTrees_(&layerB->dynamicTree, &layerA->staticTree, p1, p2);
+    }
+}
+
+std::vector<Cannon::Objects::Body*>* LayerBroadphase::aabbQuery(
+    World::World* world,
+    Collision::AABB* aabb,
+    std::vector<Objects::Body*>* result) {
+    if (this->dirty) {
+        this->updateProxies_();
+        this->dirty = false;
+    }
+
+    std::vector<int>* candidates = &this->queryResult_;
+    candidates->clear();
+    for (int i = 0; i < this->layers.size(); i++) {
+        this->layers[i]->dynamicTree.aabbQuery(aabb, candidates);
+        this->layers[i]->staticTree.aabbQuery(aabb, candidates);
+    }
+
+    for (int i = 0; i < candidates->size(); i++) {
+        Objects::Body* b = this->bodies[candidates->at(i)];
+        if (b->aabb.overlaps(aabb)) {
+            result->push_back(b);
+        }
+    }
+
+    return result;
+}
+
+std::vector<Cannon::Objects::Body*>* LayerBroadphase::rayQuery(
+    Math::Vec3* from,
+    Math::Vec3* to,
+    std::vector<Objects::Body*>* result) {
+    if (this->dirty) {
+        this->updateProxies_();
+        this->dirty = false;
+    }
+
+    std::vector<int>* candidates = &this->queryResult_;
+    candidates->clear();
+    for (int i = 0; i < this->layers.size(); i++) {
+        this->layers[i]->dynamicTree.rayQuery(from, to, candidates);
+        this->layers[i]->staticTree.rayQuery(from, to, candidates);
+    }
+
+    for (int i = 0; i < candidates->size(); i++) {
+        Objects::Body* b = this->bodies[candidates->at(i)];
+        if (b->aabb.overlapsSegment(from, to)) {
+            result->push_back(b);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,90 @@
+#include "collision/PairCache.h"
+
+#include "objects/Body.h"
+
+using namespace Cannon::Collision;
+
+long long PairCache::getKey(Objects::Body* bodyA, Objects::Body* bodyB) {
+    long long idA = bodyA->id;
+    long long idB = bodyB->id;
+    if (idA > idB) {
+        long long t = idA;
+        idA = idB;
+        idB = t;
+    }
+    return (idA << 32) | (idB & 0xffffffff);
+}
+
+void PairCache::beginUpdate() {
+    this->added1.clear();
+    this->added2.clear();
+    this->removed1.clear();
+    this->removed2.clear();
+    this->stamp_++;
+}
+
+bool PairCache::addPair(Objects::Body* bodyA, Objects::Body* bodyB) {
+    long long key = PairCache::getKey(bodyA, bodyB);
+    auto it = this->index_.find(key);
+    if (it != this->index_.end()) {
+        this->stamps_[it->second] = this->stamp_;
+        return false;
+    }
+
+    if (bodyA->id > bodyB->id) {
+        Objects::Body* t = bodyA;
+        bodyA = bodyB;
+        bodyB = t;
+    }
+
+    this->index_[key] = this->pairs1.size();
+    this->pairs1.push_back(bodyA);
+    this->pairs2.push_back(bodyB);
+    this->stamps_.push_back(this->stamp_);
+    this->added1.push_back(bodyA);
+    this->added2.push_back(bodyB);
+    return true;
+}
+
+void PairCache::endUpdate() {
+    int i = 0;
+    while (i < this->pairs1.size()) {
+        if (this->stamps_[i] == this->stamp_) {
+            i++;
+            continue;
+        }
+
+        Objects::Body* bodyA = this->pairs1[i];
+        Objects::Body* bodyB = this->pairs2[i];
+        this->removed1.push_back(bodyA);
+        this->removed2.push_back(bodyB);
+        this->index_.erase(PairCache::getKey(bodyA, bodyB));
+
+        // Move the last pair into the hole, and check it in the next iteration
+        int last = this->pairs1.size() - 1;
+        if (i != last) {
+            this->pairs1[i] = this->pairs1[last];
+            this->pairs2[i] = this->pairs2[last];
+            this->stamps_[i] = this->stamps_[last];
+            this->index_[PairCache::getKey(this->pairs1[i], this->pairs2[i])] = i;
+        }
+        this->pairs1.pop_back();
+        this->pairs2.pop_back();
+        this->stamps_.pop_back();
+    }
+}
+
+bool PairCache::has(Objects::Body* bodyA, Objects::Body* bodyB) {
+    return this->index_.find(PairCache::getKey(bodyA, bodyB)) != this->index_.end();
+}
+
+void PairCache::reset() {
+    this->index_.clear();
+    this->stamps_.clear();
+    this->pairs1.clear();
+    this->pairs2.clear();
+    this->added1.clear();
+    this->added2.clear();
+    this->removed1.clear();
+    this->removed2.clear();
+}
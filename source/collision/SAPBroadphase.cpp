@@ -0,0 +1,251 @@
+#include "collision/SAPBroadphase.h"
+
+#include <algorithm>
+#include "collision/AABB.h"
+#include "objects/Body.h"
+#include "world/World.h"
+
+using namespace Cannon::Collision;
+
+SAPBroadphase::SAPBroadphase(World::World* world) {
+    if (world != nullptr) {
+        this->setWorld(world);
+    }
+}
+
+void SAPBroadphase::setWorld(World::World* world) {
+    // Clear the old axis array
+    this->axisList.clear();
+
+    // Add all bodies from the new world
+    for (int i = 0; i < world->bodies.size(); i++) {
+        this->axisList.push_back(world->bodies[i]);
+    }
+
+    this->world = world;
+    this->dirty = true;
+    this->axisListChanged_ = true;
+}
+
+void SAPBroadphase::addBody(Objects::Body* body) {
+    this->axisList.push_back(body);
+    this->dirty = true;
+    this->axisListChanged_ = true;
+}
+
+void SAPBroadphase::removeBody(Objects::Body* body) {
+    auto it = std::find(this->axisList.begin(), this->axisList.end(), body);
+    if (it != this->axisList.end()) {
+        this->axisList.erase(it);
+        this->dirty = true;
+        this->axisListChanged_ = true;
+    }
+}
+
+std::vector<Cannon::Objects::Body*>* SAPBroadphase::insertionSortX(std::vector<Objects::Body*>* a) {
+    for (int i = 1, l = a->size(); i < l; i++) {
+        Objects::Body* v = a->at(i);
+        int j;
+        for (j = i - 1; j >= 0; j--) {
+            if (a->at(j)->aabb.lowerBound.x <= v->aabb.lowerBound.x) {
+                break;
+            }
+            a->at(j + 1) = a->at(j);
+        }
+        a->at(j + 1) = v;
+    }
+    return a;
+}
+
+std::vector<Cannon::Objects::Body*>* SAPBroadphase::insertionSortY(std::vector<Objects::Body*>* a) {
+    for (int i = 1, l = a->size(); i < l; i++) {
+        Objects::Body* v = a->at(i);
+        int j;
+        for (j = i - 1; j >= 0; j--) {
+            if (a->at(j)->aabb.lowerBound.y <= v->aabb.lowerBound.y) {
+                break;
+            }
+            a->at(j + 1) = a->at(j);
+        }
+        a->at(j + 1) = v;
+    }
+    return a;
+}
+
+std::vector<Cannon::Objects::Body*>* SAPBroadphase::insertionSortZ(std::vector<Objects::Body*>* a) {
+    for (int i = 1, l = a->size(); i < l; i++) {
+        Objects::Body* v = a->at(i);
+        int j;
+        for (j = i - 1; j >= 0; j--) {
+            if (a->at(j)->aabb.lowerBound.z <= v->aabb.lowerBound.z) {
+                break;
+            }
+            a->at(j + 1) = a->at(j);
+        }
+        a->at(j + 1) = v;
+    }
+    return a;
+}
+
+bool SAPBroadphase::checkBounds(Objects::Body* bi, Objects::Body* bj, int axisIndex) {
+    // The axis list is sorted on the lower bound, so use the AABB on both sides
+    float upperA;
+    float lowerB;
+
+    if (axisIndex == 0) {
+        upperA = bi->aabb.upperBound.x;
+        lowerB = bj->aabb.lowerBound.x;
+    } else if (axisIndex == 1) {
+        upperA = bi->aabb.upperBound.y;
+        lowerB = bj->aabb.lowerBound.y;
+    } else {
+        upperA = bi->aabb.upperBound.z;
+        lowerB = bj->aabb.lowerBound.z;
+    }
+
+    return lowerB <= upperA;
+}
+
+void SAPBroadphase::collisionPairs(
+    World::World* world,
+    std::vector<Objects::Body*>* p1,
+    std::vector<Objects::Body*>* p2) {
+    std::vector<Objects::Body*>* bodies = &this->axisList;
+    int N = bodies->size();
+
+    if (this->dirty) {
+        this->sortList();
+        this->dirty = false;
+    }
+
+    // Lower bounds along the axis, in sorted order
+    AABBArray* aabbs = &this->aabbs;
+    std::vector<float>* lower = this->axisIndex == 0 ? &aabbs->lowerX : (this->axisIndex == 1 ? &aabbs->lowerY : &aabbs->lowerZ);
+    std::vector<float>* upper = this->axisIndex == 0 ? &aabbs->upperX : (this->axisIndex == 1 ? &aabbs->upperY : &aabbs->upperZ);
+
+    // Look through the list. Each pair is reported by its first body only, so the chunks never overlap.
+    this->parallelCollect(N, [&](int begin, int stop, std::vector<Objects::Body*>* pairs1, std::vector<Objects::Body*>* pairs2) {
+        for (int i = begin; i != stop; i++) {
+            // Everything after end starts even further along the axis
+            float upperI = upper->at(i);
+            int end = i + 1;
+            while (end < N && lower->at(end) <= upperI) {
+                end++;
+            }
+
+            this->intersectionTestBatch(aabbs, bodies, i, i + 1, end, pairs1, pairs2);
+        }
+    }, p1, p2);
+}
+
+void SAPBroadphase::sortList() {
+    std::vector<Objects::Body*>* axisList = &this->axisList;
+    int N = axisList->size();
+
+    // Update AABBs
+    for (int i = 0; i != N; i++) {
+        Objects::Body* bi = axisList->at(i);
+        if (bi->aabbNeedsUpdate) {
+            bi->computeAABB();
+        }
+    }
+
+    if (this->axisListChanged_) {
+        this->autoDetectAxis();
+        this->axisListChanged_ = false;
+    }
+
+    // Sort the list
+    if (this->axisIndex == 0) {
+        SAPBroadphase::insertionSortX(axisList);
+    } else if (this->axisIndex == 1) {
+        SAPBroadphase::insertionSortY(axisList);
+    } else if (this->axisIndex == 2) {
+        SAPBroadphase::insertionSortZ(axisList);
+    }
+
+    this->aabbs.setFromBodies(axisList);
+}
+
+void SAPBroadphase::autoDetectAxis() {
+    float sumX = 0;
+    float sumX2 = 0;
+    float sumY = 0;
+    float sumY2 = 0;
+    float sumZ = 0;
+    float sumZ2 = 0;
+    std::vector<Objects::Body*>* bodies = &this->axisList;
+    int N = bodies->size();
+
+    if (N == 0) {
+        return;
+    }
+
+    float invN = 1.0f / N;
+
+    for (int i = 0; i != N; i++) {
+        Objects::Body* b = bodies->at(i);
+
+        float centerX = b->position.x;
+        sumX += centerX;
+        sumX2 += centerX * centerX;
+
+        float centerY = b->position.y;
+        sumY += centerY;
+        sumY2 += centerY * centerY;
+
+        float centerZ = b->position.z;
+        sumZ += centerZ;
+        sumZ2 += centerZ * centerZ;
+    }
+
+    float varianceX = sumX2 - sumX * sumX * invN;
+    float varianceY = sumY2 - sumY * sumY * invN;
+    float varianceZ = sumZ2 - sumZ * sumZ * invN;
+
+    if (varianceX > varianceY) {
+        if (varianceX > varianceZ) {
+            this->axisIndex = 0;
+        } else {
+            this->axisIndex = 2;
+        }
+    } else if (varianceY > varianceZ) {
+        this->axisIndex = 1;
+    } else {
+        this->axisIndex = 2;
+    }
+}
+
+std::vector<Cannon::Objects::Body*>* SAPBroadphase::aabbQuery(
+    World::World* world,
+    Collision::AABB* aabb,
+    std::vector<Objects::Body*>* result) {
+    if (this->dirty) {
+        this->sortList();
+        this->dirty = false;
+    }
+
+    int axisIndex = this->axisIndex;
+    float upper = axisIndex == 0 ? aabb->upperBound.x : (axisIndex == 1 ? aabb->upperBound.y : aabb->upperBound.z);
+
+    std::vector<Objects::Body*>* axisList = &this->axisList;
+    for (int i = 0; i < axisList->size(); i++) {
+        Objects::Body* b = axisList->at(i);
+
+        if (b->aabbNeedsUpdate) {
+            b->computeAABB();
+        }
+
+        // The rest of the list starts beyond the query box
+        float lower = axisIndex == 0 ? b->aabb.lowerBound.x : (axisIndex == 1 ? b->aabb.lowerBound.y : b->aabb.lowerBound.z);
+        if (lower > upper) {
+            break;
+        }
+
+        if (b->aabb.overlaps(aabb)) {
+            result->push_back(b);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,147 @@
+#include "collision/SeparatingAxisCache.h"
+
+#include <utility>
+#include "math/Quaternion.h"
+#include "shapes/Shape.h"
+
+using namespace Cannon::Collision;
+
+long long SeparatingAxisCache::getKey(Shapes::Shape* shapeA, Shapes::Shape* shapeB) {
+    long long idA = shapeA->id;
+    long long idB = shapeB->id;
+    if (idA > idB) {
+        long long t = idA;
+        idA = idB;
+        idB = t;
+    }
+    return (idA << 32) | (idB & 0xffffffff);
+}
+
+// Swap the hints of the two shapes if shapeA is not the one with the lower id
+static void orderVertexHints(Cannon::Shapes::Shape* shapeA, Cannon::Shapes::Shape* shapeB, std::array<int, 4>* vertexHints) {
+    if (shapeA->id > shapeB->id) {
+        std::swap(vertexHints->at(0), vertexHints->at(2));
+        std::swap(vertexHints->at(1), vertexHints->at(3));
+    }
+}
+
+bool SeparatingAxisCache::getAxis(
+    Shapes::Shape* shapeA,
+    Math::Quaternion* quatA,
+    Shapes::Shape* shapeB,
+    Math::Quaternion* quatB,
+    Math::Vec3* target,
+    std::array<int, 4>* vertexHints) {
+    long long key = SeparatingAxisCache::getKey(shapeA, shapeB);
+    SeparatingAxisCache* cache = this->source_ != nullptr ? this->source_ : this;
+    auto it = cache->entries_.find(key);
+    if (it == cache->entries_.end()) {
+        return false;
+    }
+
+    if (this->source_ != nullptr) {
+        this->changes_.push_back({ key, AXIS_USED, Math::Vec3(), {} });
+    } else {
+        it->second.stamp = this->stamp_;
+    }
+    Math::Quaternion* quat = shapeA->id < shapeB->id ? quatA : quatB;
+    quat->vmult(&it->second.axis, target);
+    if (vertexHints != nullptr) {
+        *vertexHints = it->second.vertexHints;
+        orderVertexHints(shapeA, shapeB, vertexHints);
+    }
+    return true;
+}
+
+void SeparatingAxisCache::setAxis(
+    Shapes::Shape* shapeA,
+    Math::Quaternion* quatA,
+    Shapes::Shape* shapeB,
+    Math::Quaternion* quatB,
+    Math::Vec3* axis,
+    std::array<int, 4>* vertexHints) {
+    // Keep the axis in the local frame of the first shape, so that it follows the rotation of the pair
+    Math::Quaternion conjugate;
+    Math::Vec3 localAxis;
+    Math::Quaternion* quat = shapeA->id < shapeB->id ? quatA : quatB;
+    quat->conjugate(&conjugate);
+    conjugate.vmult(axis, &localAxis);
+
+    std::array<int, 4> hints = {{ 0, 0, 0, 0 }};
+    if (vertexHints != nullptr) {
+        hints = *vertexHints;
+        orderVertexHints(shapeA, shapeB, &hints);
+    }
+
+    long long key = SeparatingAxisCache::getKey(shapeA, shapeB);
+    if (this->source_ != nullptr) {
+        this->changes_.push_back({ key, AXIS_SET, localAxis, hints });
+        return;
+    }
+
+    SeparatingAxisCacheEntry* entry = &this->entries_[key];
+    entry->stamp = this->stamp_;
+    entry->axis.copy(&localAxis);
+    entry->vertexHints = hints;
+}
+
+void SeparatingAxisCache::removeAxis(Shapes::Shape* shapeA, Shapes::Shape* shapeB) {
+    long long key = SeparatingAxisCache::getKey(shapeA, shapeB);
+    if (this->source_ != nullptr) {
+        this->changes_.push_back({ key, AXIS_REMOVED, Math::Vec3(), {} });
+        return;
+    }
+
+    this->entries_.erase(key);
+}
+
+void SeparatingAxisCache::update() {
+    for (auto it = this->entries_.begin(); it != this->entries_.end();) {
+        if (it->second.stamp != this->stamp_) {
+            it = this->entries_.erase(it);
+        } else {
+            it++;
+        }
+    }
+    this->stamp_++;
+}
+
+void SeparatingAxisCache::setSource(SeparatingAxisCache* source) {
+    this->source_ = source;
+    this->changes_.clear();
+}
+
+void SeparatingAxisCache::flush() {
+    SeparatingAxisCache* source = this->source_;
+    if (source == nullptr) {
+        return;
+    }
+
+    for (int i = 0; i < this->changes_.size(); i++) {
+        Change* change = &this->changes_[i];
+        if (change->type == AXIS_REMOVED) {
+            source->entries_.erase(change->key);
+            continue;
+        }
+        if (change->type == AXIS_USED) {
+            auto it = source->entries_.find(change->key);
+            if (it != source->entries_.end()) {
+                it->second.stamp = source->stamp_;
+            }
+            continue;
+        }
+        SeparatingAxisCacheEntry* entry = &source->entries_[change->key];
+        entry->stamp = source->stamp_;
+        entry->axis.copy(&change->axis);
+        entry->vertexHints = change->vertexHints;
+    }
+    this->changes_.clear();
+}
+
+int SeparatingAxisCache::size() {
+    return this->entries_.size();
+}
+
+void SeparatingAxisCache::reset() {
+    this->entries_.clear();
+}
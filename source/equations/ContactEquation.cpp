@@ -0,0 +1,73 @@
+#include "equations/ContactEquation.h"
+
+#include "objects/Body.h"
+
+using namespace Cannon::Equations;
+
+Cannon::Math::Vec3 ContactEquation_computeB_temp1; // Temp vectors
+Cannon::Math::Vec3 ContactEquation_computeB_temp2;
+Cannon::Math::Vec3 ContactEquation_computeB_temp3;
+double ContactEquation::computeB(double h) {
+    double a = this->a;
+    double b = this->b;
+    Objects::Body* bi = this->bi;
+    Objects::Body* bj = this->bj;
+    Math::Vec3* ri = &this->ri;
+    Math::Vec3* rj = &this->rj;
+    Math::Vec3* rixn = &ContactEquation_computeB_temp1;
+    Math::Vec3* rjxn = &ContactEquation_computeB_temp2;
+    Math::Vec3* penetrationVec = &ContactEquation_computeB_temp3;
+    Math::JacobianElement* GA = &this->jacobianElementA;
+    Math::JacobianElement* GB = &this->jacobianElementB;
+    Math::Vec3* n = &this->ni;
+
+    // Caluclate cross products
+    ri->cross(n, rixn);
+    rj->cross(n, rjxn);
+
+    // g = xj+rj -(xi+ri)
+    // G = [ -ni  -rixn  ni  rjxn ]
+    n->negate(&GA->spatial);
+    rixn->negate(&GA->rotational);
+    GB->spatial.copy(n);
+    GB->rotational.copy(rjxn);
+
+    // Calculate the penetration vector
+    penetrationVec->copy(&bj->position);
+    penetrationVec->vadd(rj, penetrationVec);
+    penetrationVec->vsub(&bi->position, penetrationVec);
+    penetrationVec->vsub(ri, penetrationVec);
+
+    double g = n->dot(penetrationVec);
+
+    // Compute iteration
+    double ePlusOne = this->speculative ? 1 : this->restitution + 1;
+    double GW = ePlusOne * bj->velocity.dot(n) - ePlusOne * bi->velocity.dot(n) + bj->angularVelocity.dot(rjxn) - bi->angularVelocity.dot(rixn);
+    double GiMf = this->computeGiMf();
+
+    // The gap g may close within the step, the solver only removes the velocity beyond -g/h
+    if (this->speculative) {
+        return -g / h - GW - h * GiMf;
+    }
+
+    return -g * a - GW * b - h * GiMf;
+}
+
+Cannon::Math::Vec3 ContactEquation_getImpactVelocityAlongNormal_vi;
+Cannon::Math::Vec3 ContactEquation_getImpactVelocityAlongNormal_vj;
+Cannon::Math::Vec3 ContactEquation_getImpactVelocityAlongNormal_relVel;
+double ContactEquation::getImpactVelocityAlongNormal() {
+    Math::Vec3* vi = &ContactEquation_getImpactVelocityAlongNormal_vi;
+    Math::Vec3* vj = &ContactEquation_getImpactVelocityAlongNormal_vj;
+    Math::Vec3* relVel = &ContactEquation_getImpactVelocityAlongNormal_relVel;
+
+    // Velocity of the contact point on each body: v + w x r
+    this->bi->angularVelocity.cross(&this->ri, vi);
+    vi->vadd(&this->bi->velocity, vi);
+    this->bj->angularVelocity.cross(&this->rj, vj);
+    vj->vadd(&this->bj->velocity, vj);
+
+    vi->vsub(vj, relVel);
+
+    return this->ni.dot(relVel);
+}
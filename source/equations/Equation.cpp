@@ -0,0 +1,130 @@
+#include "equations/Equation.h"
+
+#include "math/Vec3.h"
+#include "math/Mat3.h"
+#include "objects/Body.h"
+
+using namespace Cannon::Equations;
+
+std::atomic<int> Equation::idCounter(0);
+
+Equation::Equation(Objects::Body* bi, Objects::Body* bj) : Equation(bi, bj, -1e6, 1e6) {}
+
+Equation::Equation(Objects::Body* bi, Objects::Body* bj, double minForce, double maxForce) {
+    this->id = Equation::idCounter++;
+    this->minForce = minForce;
+    this->maxForce = maxForce;
+    this->bi = bi;
+    this->bj = bj;
+
+    // Set typical spook params
+    this->setSpookParams(1e7, 4, 1.0 / 60);
+}
+
+void Equation::setSpookParams(double stiffness, double relaxation, float timeStep) {
+    double d = relaxation;
+    double k = stiffness;
+    double h = timeStep;
+    this->a = 4.0 / (h * (1 + 4 * d));
+    this->b = (4.0 * d) / (1 + 4 * d);
+    this->eps = 4.0 / (h * h * k * (1 + 4 * d));
+}
+
+double Equation::computeB(double a, double b, double h) {
+    double GW = this->computeGW();
+    double Gq = this->computeGq();
+    double GiMf = this->computeGiMf();
+    return -Gq * a - GW * b - GiMf * h;
+}
+
+double Equation::computeB(double h) {
+    return this->computeB(this->a, this->b, h);
+}
+
+double Equation::computeGq() {
+    Math::JacobianElement* GA = &this->jacobianElementA;
+    Math::JacobianElement* GB = &this->jacobianElementB;
+    return GA->spatial.dot(&this->bi->position) + GB->spatial.dot(&this->bj->position);
+}
+
+double Equation::computeGW() {
+    Math::JacobianElement* GA = &this->jacobianElementA;
+    Math::JacobianElement* GB = &this->jacobianElementB;
+    Objects::Body* bi = this->bi;
+    Objects::Body* bj = this->bj;
+    return GA->multiplyVectors(bi->velocity, bi->angularVelocity) + GB->multiplyVectors(bj->velocity, bj->angularVelocity);
+}
+
+double Equation::computeGWlambda() {
+    Math::JacobianElement* GA = &this->jacobianElementA;
+    Math::JacobianElement* GB = &this->jacobianElementB;
+    Objects::Body* bi = this->bi;
+    Objects::Body* bj = this->bj;
+    return GA->multiplyVectors(bi->vlambda, bi->wlambda) + GB->multiplyVectors(bj->vlambda, bj->wlambda);
+}
+
+Cannon::Math::Vec3 Equation_computeGiMf_iMfi;
+Cannon::Math::Vec3 Equation_computeGiMf_iMfj;
+Cannon::Math::Vec3 Equation_computeGiMf_invIi_vmult_taui;
+Cannon::Math::Vec3 Equation_computeGiMf_invIj_vmult_tauj;
+double Equation::computeGiMf() {
+    Math::JacobianElement* GA = &this->jacobianElementA;
+    Math::JacobianElement* GB = &this->jacobianElementB;
+    Objects::Body* bi = this->bi;
+    Objects::Body* bj = this->bj;
+    Math::Vec3* iMfi = &Equation_computeGiMf_iMfi;
+    Math::Vec3* iMfj = &Equation_computeGiMf_iMfj;
+    Math::Vec3* invIi_vmult_taui = &Equation_computeGiMf_invIi_vmult_taui;
+    Math::Vec3* invIj_vmult_tauj = &Equation_computeGiMf_invIj_vmult_tauj;
+
+    bi->force.scale(bi->invMassSolve, iMfi);
+    bj->force.scale(bj->invMassSolve, iMfj);
+
+    bi->invInertiaWorldSolve.vmult(&bi->torque, invIi_vmult_taui);
+    bj->invInertiaWorldSolve.vmult(&bj->torque, invIj_vmult_tauj);
+
+    return GA->multiplyVectors(*iMfi, *invIi_vmult_taui) + GB->multiplyVectors(*iMfj, *invIj_vmult_tauj);
+}
+
+Cannon::Math::Vec3 Equation_computeGiMGt_tmp;
+double Equation::computeGiMGt() {
+    Math::JacobianElement* GA = &this->jacobianElementA;
+    Math::JacobianElement* GB = &this->jacobianElementB;
+    Objects::Body* bi = this->bi;
+    Objects::Body* bj = this->bj;
+    Math::Vec3* tmp = &Equation_computeGiMGt_tmp;
+    double result = bi->invMassSolve + bj->invMassSolve;
+
+    bi->invInertiaWorldSolve.vmult(&GA->rotational, tmp);
+    result += tmp->dot(&GA->rotational);
+
+    bj->invInertiaWorldSolve.vmult(&GB->rotational, tmp);
+    result += tmp->dot(&GB->rotational);
+
+    return result;
+}
+
+Cannon::Math::Vec3 Equation_addToWlambda_temp;
+void Equation::addToWlambda(double deltalambda) {
+    Math::JacobianElement* GA = &this->jacobianElementA;
+    Math::JacobianElement* GB = &this->jacobianElementB;
+    Objects::Body* bi = this->bi;
+    Objects::Body* bj = this->bj;
+    Math::Vec3* temp = &Equation_addToWlambda_temp;
+
+    // Add to linear velocity
+    // v_lambda += inv(M) * delta_lamba * G
+    bi->vlambda.addScaledVector(bi->invMassSolve * deltalambda, &GA->spatial, &bi->vlambda);
+    bj->vlambda.addScaledVector(bj->invMassSolve * deltalambda, &GB->spatial, &bj->vlambda);
+
+    // Add to angular velocity
+    bi->invInertiaWorldSolve.vmult(&GA->rotational, temp);
+    bi->wlambda.addScaledVector(deltalambda, temp, &bi->wlambda);
+
+    bj->invInertiaWorldSolve.vmult(&GB->rotational, temp);
+    bj->wlambda.addScaledVector(deltalambda, temp, &bj->wlambda);
+}
+
+double Equation::computeC() {
+    return this->computeGiMGt() + this->eps;
+}
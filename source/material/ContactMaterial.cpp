@@ -0,0 +1,5 @@
+#include "material/ContactMaterial.h"
+
+using namespace Cannon;
+
+int Material::ContactMaterial::idCounter = 0;
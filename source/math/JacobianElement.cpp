@@ -0,0 +1,11 @@
+#include "math/JacobianElement.h"
+
+using namespace Cannon::Math;
+
+double JacobianElement::multiplyElement(JacobianElement element) {
+    return element.spatial.dot(&this->spatial) + element.rotational.dot(&this->rotational);
+}
+
+double JacobianElement::multiplyVectors(Vec3 spatial, Vec3 rotational) {
+    return spatial.dot(&this->spatial) + rotational.dot(&this->rotational);
+}
@@ -2,7 +2,7 @@
 
 using namespace Cannon::Math;
 
-Quaternion tmpQuat;
+thread_local Quaternion tmpQuat;
 Vec3* Transform::pointToLocalFrame(Vec3* position, Quaternion* quaternion, Vec3* worldPoint, Vec3* result) {
     worldPoint->vsub(position, result);
     quaternion->conjugate(&tmpQuat);
@@ -22,9 +22,8 @@ Vec3* Transform::vectorToWorldFrame(Quaternion* quaternion, Vec3* localVector, V
 }
 
 Vec3* Transform::vectorToLocalFrame(Vec3* position, Quaternion* quaternion, Vec3* worldVector, Vec3* result) {
-    quaternion->w *= -1;
-    quaternion->vmult(worldVector, result);
-    quaternion->w *= -1;
+    quaternion->conjugate(&tmpQuat);
+    tmpQuat.vmult(worldVector, result);
     return result;
 }
 
@@ -1,5 +1,9 @@
 #include "objects/Body.h"
 
+#include <algorithm>
+#include "shapes/Shape.h"
+#include "shapes/Box.h"
+
 using namespace Cannon;
 
 int Objects::Body::idCounter = 0;
@@ -18,3 +22,205 @@ const Utils::Event wakeupEvent("wakeup");
 const Utils::Event sleepyEvent("sleepy");
 
 const Utils::Event sleepEvent("sleep");
+
+Objects::Body::Body() : Body(0) {}
+
+Objects::Body::Body(float mass) {
+    this->id = idCounter++;
+    this->world = nullptr;
+
+    this->collisionFilterGroup = 1;
+    this->collisionFilterMask = -1;
+    this->collisionResponse = true;
+
+    this->mass = mass;
+    this->invMass = mass > 0 ? 1.0f / mass : 0;
+    this->material = nullptr;
+    this->linearDamping = 0.01;
+    this->type = mass <= 0.0 ? BodyType::STATIC : BodyType::DYNAMIC;
+
+    this->allowSleep = true;
+    this->sleepState = BodyState::AWAKE;
+    this->sleepSpeedLimit = 0.1;
+    this->sleepTimeLimit = 1;
+    this->timeLastSleepy = 0;
+    this->_wakeUpAfterNarrowphase = false;
+
+    this->invMassSolve = 0;
+    this->fixedRotation = false;
+    this->angularDamping = 0.01;
+    this->linearFactor.set(1, 1, 1);
+    this->angularFactor.set(1, 1, 1);
+
+    this->aabbNeedsUpdate = true;
+    this->shapeTreeNeedsUpdate = true;
+    this->ccd = false;
+    this->ccdTimeStep = 1.0f / 60;
+    this->boundingRadius = 0;
+    this->hasTrigger = false;
+}
+
+Objects::Body* Objects::Body::addShape(
+    Shapes::Shape* shape,
+    Math::Vec3* _offset,
+    Math::Quaternion* _orientation) {
+    Math::Vec3 offset;
+    Math::Quaternion orientation;
+
+    if (_offset != nullptr) {
+        offset.copy(_offset);
+    }
+    if (_orientation != nullptr) {
+        orientation.copy(_orientation);
+    }
+
+    this->shapes.push_back(shape);
+    this->shapeOffsets.push_back(offset);
+    this->shapeOrientations.push_back(orientation);
+    this->updateMassProperties();
+    this->updateBoundingRadius();
+
+    this->aabbNeedsUpdate = true;
+
+    shape->body = this;
+
+    return this;
+}
+
+void Objects::Body::updateBoundingRadius() {
+    float radius = 0;
+
+    for (int i = 0; i != this->shapes.size(); i++) {
+        Shapes::Shape* shape = this->shapes[i];
+        shape->updateBoundingSphereRadius();
+        float offset = this->shapeOffsets[i].length();
+        float r = shape->boundingSphereRadius;
+        if (offset + r > radius) {
+            radius = offset + r;
+        }
+    }
+
+    this->boundingRadius = radius;
+    this->shapeTreeNeedsUpdate = true;
+}
+
+void Objects::Body::updateShapeTree() {
+    int count = this->shapes.size();
+    std::vector<Collision::AABB> shapeAABBs(count);
+    std::vector<Collision::AABB*> aabbs;
+    std::vector<int> userData;
+    std::vector<int> proxyIds;
+    for (int i = 0; i != count; i++) {
+        this->shapes[i]->calculateWorldAABB(
+            &this->shapeOffsets[i],
+            &this->shapeOrientations[i],
+            &shapeAABBs[i].lowerBound,
+            &shapeAABBs[i].upperBound);
+        aabbs.push_back(&shapeAABBs[i]);
+        userData.push_back(i);
+    }
+
+    // The local AABBs do not move with the body, so the tree is only built when the shapes change
+    this->shapeTree = Utils::AABBTree();
+    this->shapeTree.margin = 0;
+    this->shapeTree.createProxies(&aabbs, &userData, &proxyIds);
+    this->shapeTreeNeedsUpdate = false;
+}
+
+Math::Vec3 computeAABB_tmpVec;
+Math::Quaternion computeAABB_tmpQuat;
+Collision::AABB computeAABB_shapeAABB;
+void Objects::Body::computeAABB() {
+    Math::Vec3* offset = &computeAABB_tmpVec;
+    Math::Quaternion* orientation = &computeAABB_tmpQuat;
+    Collision::AABB* shapeAABB = &computeAABB_shapeAABB;
+
+    for (int i = 0; i != this->shapes.size(); i++) {
+        Shapes::Shape* shape = this->shapes[i];
+
+        // Get shape world position
+        this->quaternion.vmult(&this->shapeOffsets[i], offset);
+        offset->vadd(&this->position, offset);
+
+        // Get shape world quaternion
+        this->quaternion.mult(&this->shapeOrientations[i], orientation);
+
+        // Get shape AABB
+        shape->calculateWorldAABB(offset, orientation, &shapeAABB->lowerBound, &shapeAABB->upperBound);
+
+        if (i == 0) {
+            this->aabb.copy(shapeAABB);
+        } else {
+            this->aabb.extend(shapeAABB);
+        }
+    }
+
+    // Cover where the body is heading over the next step
+    if (this->ccd) {
+        Math::Vec3* motion = offset;
+        this->velocity.scale(this->ccdTimeStep, motion);
+        Math::Vec3* lower = &this->aabb.lowerBound;
+        Math::Vec3* upper = &this->aabb.upperBound;
+        lower->set(lower->x + std::min(motion->x, 0.0f), lower->y + std::min(motion->y, 0.0f), lower->z + std::min(motion->z, 0.0f));
+        upper->set(upper->x + std::max(motion->x, 0.0f), upper->y + std::max(motion->y, 0.0f), upper->z + std::max(motion->z, 0.0f));
+    }
+
+    this->aabbNeedsUpdate = false;
+}
+
+Math::Mat3 uiw_m1;
+Math::Mat3 uiw_m2;
+void Objects::Body::updateInertiaWorld(bool force) {
+    Math::Vec3* I = &this->invInertia;
+    if (I->x == I->y && I->y == I->z && !force) {
+        // If inertia M = s*I, where I is identity and s a scalar, then
+        //    R*M*R' = R*(s*I)*R' = s*R*I*R' = s*R*R' = s*I = M
+        // where R is the rotation matrix.
+        // In other words, we don't have to transform the inertia if all
+        // inertia diagonal entries are equal.
+    } else {
+        Math::Mat3* m1 = &uiw_m1;
+        Math::Mat3* m2 = &uiw_m2;
+        m1->setRotationFromQuaternion(&this->quaternion);
+        m1->transpose(m2);
+        m1->scale(I, m1);
+        m1->mmult(m2, &this->invInertiaWorld);
+    }
+}
+
+Math::Vec3 Body_updateMassProperties_halfExtents;
+void Objects::Body::updateMassProperties() {
+    Math::Vec3* halfExtents = &Body_updateMassProperties_halfExtents;
+
+    this->invMass = this->mass > 0 ? 1.0f / this->mass : 0;
+    Math::Vec3* I = &this->inertia;
+    bool fixed = this->fixedRotation;
+
+    // Approximate with AABB box
+    this->computeAABB();
+    halfExtents->set(
+        (this->aabb.upperBound.x - this->aabb.lowerBound.x) / 2,
+        (this->aabb.upperBound.y - this->aabb.lowerBound.y) / 2,
+        (this->aabb.upperBound.z - this->aabb.lowerBound.z) / 2
+    );
+    Shapes::Box::calculateInertia(halfExtents, this->mass, I);
+
+    this->invInertia.set(
+        I->x > 0 && !fixed ? 1.0f / I->x : 0,
+        I->y > 0 && !fixed ? 1.0f / I->y : 0,
+        I->z > 0 && !fixed ? 1.0f / I->z : 0
+    );
+    this->updateInertiaWorld(true);
+}
+
+void Objects::Body::updateSolveMassProperties() {
+    if (this->sleepState == BodyState::SLEEPING || this->type == BodyType::KINEMATIC) {
+        this->invMassSolve = 0;
+        this->invInertiaSolve.setZero();
+        this->invInertiaWorldSolve.setZero();
+    } else {
+        this->invMassSolve = this->invMass;
+        this->invInertiaSolve.copy(&this->invInertia);
+        this->invInertiaWorldSolve.copy(&this->invInertiaWorld);
+    }
+}
@@ -92,7 +92,7 @@ void Box::updateBoundingSphereRadius() {
     this->boundingSphereRadius = this->halfExtents->length();
 }
 
-Cannon::Math::Vec3 worldCornerTempPos;
+thread_local Cannon::Math::Vec3 worldCornerTempPos;
 void Box::forEachWorldCorner(
     Math::Vec3* pos,
     Math::Quaternion* quat,
@@ -118,7 +118,7 @@ void Box::forEachWorldCorner(
     }
 }
 
-std::array<Cannon::Math::Vec3, 8> worldCornersTemp;
+thread_local std::array<Cannon::Math::Vec3, 8> worldCornersTemp;
 void Box::calculateWorldAABB(
     Math::Vec3* pos,
     Math::Quaternion* quat,
@@ -159,3 +159,16 @@ void Box::calculateWorldAABB(
         min->z = std::min(min->z, z);
     }
 }
+
+bool Box::isConvex() {
+    return true;
+}
+
+void Box::supportPoint(Math::Vec3* direction, Math::Vec3* target) {
+    Math::Vec3* e = this->halfExtents;
+    target->set(
+        direction->x < 0 ? -e->x : e->x,
+        direction->y < 0 ? -e->y : e->y,
+        direction->z < 0 ? -e->z : e->z
+    );
+}
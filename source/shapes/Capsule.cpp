@@ -0,0 +1,80 @@
+#include "shapes/Capsule.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+using namespace Cannon::Shapes;
+
+Capsule::Capsule(float radius, float height) : Shape(ShapeTypes::CAPSULE) {
+    this->radius = radius;
+    this->height = height;
+
+    if (radius < 0 || height < 0) {
+        throw std::runtime_error("The capsule radius and height cannot be negative.");
+    }
+
+    this->updateBoundingSphereRadius();
+}
+
+Capsule::~Capsule() {}
+
+void Capsule::getWorldEndpoints(Math::Vec3* pos, Math::Quaternion* quat, Math::Vec3* a, Math::Vec3* b) {
+    b->set(0, 0, this->height / 2);
+    quat->vmult(b, b);
+    pos->vsub(b, a);
+    pos->vadd(b, b);
+}
+
+void Capsule::calculateLocalInertia(float mass, Math::Vec3* target) {
+    // Split the mass between the cylinder and the two half spheres by volume
+    float r = this->radius;
+    float h = this->height;
+    double cylinderVolume = M_PI * r * r * h;
+    double sphereVolume = 4.0 / 3.0 * M_PI * r * r * r;
+    double total = cylinderVolume + sphereVolume;
+    float cylinderMass = total > 0 ? mass * cylinderVolume / total : 0;
+    float sphereMass = total > 0 ? mass * sphereVolume / total : 0;
+
+    float Ixy = cylinderMass * (h * h / 12 + r * r / 4) + sphereMass * (2.0 / 5.0 * r * r + h * h / 4 + 3.0 / 8.0 * h * r);
+    float Iz = cylinderMass * r * r / 2 + sphereMass * 2.0 / 5.0 * r * r;
+    target->set(Ixy, Ixy, Iz);
+}
+
+double Capsule::volume() {
+    return M_PI * this->radius * this->radius * this->height + 4.0 / 3.0 * M_PI * this->radius * this->radius * this->radius;
+}
+
+void Capsule::updateBoundingSphereRadius() {
+    this->boundingSphereRadius = this->radius + this->height / 2;
+}
+
+thread_local Cannon::Math::Vec3 Capsule_calculateWorldAABB_a;
+thread_local Cannon::Math::Vec3 Capsule_calculateWorldAABB_b;
+void Capsule::calculateWorldAABB(
+    Math::Vec3* pos,
+    Math::Quaternion* quat,
+    Math::Vec3* min,
+    Math::Vec3* max) {
+    Math::Vec3* a = &Capsule_calculateWorldAABB_a;
+    Math::Vec3* b = &Capsule_calculateWorldAABB_b;
+    this->getWorldEndpoints(pos, quat, a, b);
+    float r = this->radius;
+
+    min->set(std::min(a->x, b->x) - r, std::min(a->y, b->y) - r, std::min(a->z, b->z) - r);
+    max->set(std::max(a->x, b->x) + r, std::max(a->y, b->y) + r, std::max(a->z, b->z) + r);
+}
+
+bool Capsule::isConvex() {
+    return true;
+}
+
+void Capsule::supportPoint(Math::Vec3* direction, Math::Vec3* target) {
+    float length = direction->length();
+    if (length == 0) {
+        target->set(this->radius, 0, this->height / 2);
+        return;
+    }
+    direction->scale(this->radius / length, target);
+    target->z += direction->z < 0 ? -this->height / 2 : this->height / 2;
+}
@@ -6,11 +6,12 @@
 #include <algorithm>
 #include "math/Vec3.h"
 #include "math/Transform.h"
+#include "collision/SeparatingAxisCache.h"
 
 using namespace Cannon::Shapes;
 
-Cannon::Math::Vec3 cb;
-Cannon::Math::Vec3 ab;
+thread_local Cannon::Math::Vec3 cb;
+thread_local Cannon::Math::Vec3 ab;
 void ConvexPolyhedron::computeNormal(
     Cannon::Math::Vec3* va,
     Cannon::Math::Vec3* vb,
@@ -25,15 +26,17 @@ void ConvexPolyhedron::computeNormal(
     }
 }
 
-Cannon::Math::Vec3 project_worldVertex;
-Cannon::Math::Vec3 project_localAxis;
-Cannon::Math::Vec3 project_localOrigin;
+thread_local Cannon::Math::Vec3 project_worldVertex;
+thread_local Cannon::Math::Vec3 project_localAxis;
+thread_local Cannon::Math::Vec3 project_localOrigin;
+thread_local Cannon::Math::Vec3 project_negatedAxis;
 void ConvexPolyhedron::project(
     ConvexPolyhedron* hull,
     Math::Vec3* axis,
     Math::Vec3* pos,
     Math::Quaternion* quat,
-    std::array<float, 2>* result) {
+    std::array<float, 2>* result,
+    int* vertexHints) {
     int n = hull->vertices->size();
     Cannon::Math::Vec3* worldVertex = &project_worldVertex;
     Cannon::Math::Vec3* localAxis = &project_localAxis;
@@ -49,17 +52,33 @@ void ConvexPolyhedron::project(
     Math::Transform::pointToLocalFrame(pos, quat, localOrigin, localOrigin);
     float add = localOrigin->dot(localAxis);
 
-    min = max = vs->at(0).dot(localAxis);
+    if (n >= hull->hillClimbingThreshold && hull->vertexNeighbors.size() == n) {
+        // Walk from the vertices found for the last axis of the caller, which are usually close
+        Cannon::Math::Vec3* negatedAxis = &project_negatedAxis;
+        localAxis->negate(negatedAxis);
+        int maxStart = vertexHints != nullptr && vertexHints[0] < n ? vertexHints[0] : 0;
+        int minStart = vertexHints != nullptr && vertexHints[1] < n ? vertexHints[1] : 0;
+        int maxVertex = hull->getExtremeVertex(localAxis, maxStart);
+        int minVertex = hull->getExtremeVertex(negatedAxis, minStart);
+        if (vertexHints != nullptr) {
+            vertexHints[0] = maxVertex;
+            vertexHints[1] = minVertex;
+        }
+        max = vs->at(maxVertex).dot(localAxis);
+        min = vs->at(minVertex).dot(localAxis);
+    } else {
+        min = max = vs->at(0).dot(localAxis);
 
-    for (int i = 1; i < n; i++) {
-        float val = vs->at(i).dot(localAxis);
+        for (int i = 1; i < n; i++) {
+            float val = vs->at(i).dot(localAxis);
 
-        if (val > max) {
-            max = val;
-        }
+            if (val > max) {
+                max = val;
+            }
 
-        if (val < min) {
-            min = val;
+            if (val < min) {
+                min = val;
+            }
         }
     }
 
@@ -111,40 +130,109 @@ ConvexPolyhedron::~ConvexPolyhedron() {
     }
 }
 
-Cannon::Math::Vec3 computeEdges_tmpEdge;
+thread_local Cannon::Math::Vec3 computeEdges_tmpEdge;
+thread_local Cannon::Math::Vec3 computeEdges_negatedEdge;
 void ConvexPolyhedron::computeEdges() {
-    auto faces = *this->faces;
-    auto vertices = *this->vertices;
-    int nv = vertices.size();
+    std::vector<std::vector<int>>* faces = this->faces;
+    std::vector<Math::Vec3>* vertices = this->vertices;
 
     this->uniqueEdges.clear();
+    this->uniqueEdgeFaces.clear();
+    this->vertexNeighbors.clear();
+    this->vertexNeighbors.resize(vertices->size());
 
     Math::Vec3* edge = &computeEdges_tmpEdge;
+    Math::Vec3* negatedEdge = &computeEdges_negatedEdge;
 
-    for (int i = 0; i != faces.size(); i++) {
-        auto face = faces[i];
-        int numVertices = face.size();
+    // Collect the hull edges and the faces on each side of them
+    std::vector<std::array<int, 2>> edgeVertices;
+    std::vector<std::array<int, 2>> edgeFaces;
+    for (int i = 0; i != faces->size(); i++) {
+        std::vector<int>* face = &faces->at(i);
+        int numVertices = face->size();
 
         for (int j = 0; j != numVertices; j++) {
-            int k = (j + 1) % numVertices;
-            vertices[face[j]].vsub(&vertices[face[k]], edge);
-            edge->normalize();
+            int a = face->at(j);
+            int b = face->at((j + 1) % numVertices);
 
             bool found = false;
-            for (int p = 0; p != this->uniqueEdges.size(); p++) {
-                if (this->uniqueEdges[p].almostEquals(edge, 0.00001)) {
+            for (int p = 0; p != edgeVertices.size(); p++) {
+                std::array<int, 2>* ev = &edgeVertices[p];
+                if (edgeFaces[p][1] == -1 && ((ev->at(0) == b && ev->at(1) == a) || (ev->at(0) == a && ev->at(1) == b))) {
+                    edgeFaces[p][1] = i;
                     found = true;
                     break;
                 }
             }
 
             if (!found) {
-                this->uniqueEdges.push_back(edge->clone());
+                edgeVertices.push_back({a, b});
+                edgeFaces.push_back({i, -1});
+                this->vertexNeighbors[a].push_back(b);
+                this->vertexNeighbors[b].push_back(a);
+            }
+        }
+    }
+
+    // Edges along the same line, in either direction, share a unique edge
+    for (int i = 0; i != edgeVertices.size(); i++) {
+        vertices->at(edgeVertices[i][0]).vsub(&vertices->at(edgeVertices[i][1]), edge);
+        edge->normalize();
+        edge->negate(negatedEdge);
+
+        int found = -1;
+        for (int p = 0; p != this->uniqueEdges.size(); p++) {
+            if (this->uniqueEdges[p].almostEquals(edge, 0.00001) || this->uniqueEdges[p].almostEquals(negatedEdge, 0.00001)) {
+                found = p;
+                break;
             }
         }
+
+        if (found == -1) {
+            found = this->uniqueEdges.size();
+            this->uniqueEdges.push_back(edge->clone());
+            this->uniqueEdgeFaces.push_back({});
+        }
+        this->uniqueEdgeFaces[found].push_back(edgeFaces[i]);
     }
 }
 
+int ConvexPolyhedron::getExtremeVertex(Math::Vec3* direction, int start) {
+    std::vector<Math::Vec3>* vs = this->vertices;
+    int best = start < vs->size() ? start : 0;
+    float max = vs->at(best).dot(direction);
+
+    bool improved = true;
+    while (improved) {
+        improved = false;
+        std::vector<int>* neighbors = &this->vertexNeighbors[best];
+        for (int i = 0; i != neighbors->size(); i++) {
+            float d = vs->at(neighbors->at(i)).dot(direction);
+            if (d > max) {
+                max = d;
+                best = neighbors->at(i);
+                improved = true;
+            }
+        }
+    }
+
+    return best;
+}
+
+bool ConvexPolyhedron::isMinkowskiFace(Math::Vec3* a, Math::Vec3* b, Math::Vec3* c, Math::Vec3* d) {
+    Math::Vec3 bxa;
+    Math::Vec3 dxc;
+    b->cross(a, &bxa);
+    d->cross(c, &dxc);
+
+    // The arcs cross if c and d are on each side of the plane of arc ab, a and b on each side of the plane of arc cd, and both arcs are in the same hemisphere
+    float cba = c->dot(&bxa);
+    float dba = d->dot(&bxa);
+    float adc = a->dot(&dxc);
+    float bdc = b->dot(&dxc);
+    return cba * dba < 0 && adc * bdc < 0 && cba * bdc > 0;
+}
+
 void ConvexPolyhedron::computeNormals() {
     this->faceNormals.resize(this->faces->size());
 
@@ -185,14 +273,14 @@ void ConvexPolyhedron::computeNormals() {
 }
 
 void ConvexPolyhedron::getFaceNormal(int i, Math::Vec3* target) {
-    auto f = this->faces->at(i);
-    auto va = &this->vertices->at(f[0]);
-    auto vb = &this->vertices->at(f[1]);
-    auto vc = &this->vertices->at(f[2]);
+    std::vector<int>* f = &this->faces->at(i);
+    auto va = &this->vertices->at(f->at(0));
+    auto vb = &this->vertices->at(f->at(1));
+    auto vc = &this->vertices->at(f->at(2));
     return ConvexPolyhedron::computeNormal(va, vb, vc, target);
 }
 
-Cannon::Math::Vec3 cah_WorldNormal;
+thread_local Cannon::Math::Vec3 cah_WorldNormal;
 void ConvexPolyhedron::clipAgainstHull(
     Math::Vec3* posA,
     Math::Quaternion* quatA,
@@ -219,10 +307,13 @@ void ConvexPolyhedron::clipAgainstHull(
         }
     }
     std::vector<Math::Vec3> worldVertsB1;
-    std::vector<int> polyB = hullB->faces->at(closestFaceB);
-    int numVertices = polyB.size();
+    if (closestFaceB < 0) {
+        return;
+    }
+    std::vector<int>* polyB = &hullB->faces->at(closestFaceB);
+    int numVertices = polyB->size();
     for (int e0 = 0; e0 < numVertices; e0++) {
-        Math::Vec3* b = &hullB->vertices->at(polyB[e0]);
+        Math::Vec3* b = &hullB->vertices->at(polyB->at(e0));
         Math::Vec3 worldb;
         worldb.copy(b);
         quatB->vmult(&worldb, &worldb);
@@ -230,25 +321,25 @@ void ConvexPolyhedron::clipAgainstHull(
         worldVertsB1.push_back(worldb);
     }
 
-    if (closestFaceB >= 0) {
-        this->clipFaceAgainstHull(
-            separatingNormal,
-            posA,
-            quatA,
-            &worldVertsB1,
-            minDist,
-            maxDist,
-            result
-        );
-    }
+    this->clipFaceAgainstHull(
+        separatingNormal,
+        posA,
+        quatA,
+        &worldVertsB1,
+        minDist,
+        maxDist,
+        result
+    );
 }
 
-Cannon::Math::Vec3 fsa_faceANormalWS3;
-Cannon::Math::Vec3 fsa_Worldnormal1;
-Cannon::Math::Vec3 fsa_deltaC;
-Cannon::Math::Vec3 fsa_worldEdge0;
-Cannon::Math::Vec3 fsa_worldEdge1;
-Cannon::Math::Vec3 fsa_Cross;
+thread_local Cannon::Math::Vec3 fsa_faceANormalWS3;
+thread_local Cannon::Math::Vec3 fsa_Worldnormal1;
+thread_local Cannon::Math::Vec3 fsa_deltaC;
+thread_local Cannon::Math::Vec3 fsa_worldEdge0;
+thread_local Cannon::Math::Vec3 fsa_worldEdge1;
+thread_local Cannon::Math::Vec3 fsa_Cross;
+thread_local std::vector<Cannon::Math::Vec3> fsa_worldNormalsA;
+thread_local std::vector<Cannon::Math::Vec3> fsa_worldNormalsB;
 bool ConvexPolyhedron::findSeparatingAxis(
     ConvexPolyhedron* hullB,
     Math::Vec3* posA,
@@ -258,12 +349,28 @@ bool ConvexPolyhedron::findSeparatingAxis(
     Math::Vec3* target,
     std::vector<int>* faceListA,
     std::vector<int>* faceListB) {
+    std::array<int, 4> vertexHints = {{ 0, 0, 0, 0 }};
+    return this->findSeparatingAxis_(hullB, posA, quatA, posB, quatB, target, faceListA, faceListB, &vertexHints);
+}
+
+bool ConvexPolyhedron::findSeparatingAxis_(
+    ConvexPolyhedron* hullB,
+    Math::Vec3* posA,
+    Math::Quaternion* quatA,
+    Math::Vec3* posB,
+    Math::Quaternion* quatB,
+    Math::Vec3* target,
+    std::vector<int>* faceListA,
+    std::vector<int>* faceListB,
+    std::array<int, 4>* vertexHints) {
     Cannon::Math::Vec3* faceANormalWS3 = &fsa_faceANormalWS3;
     Cannon::Math::Vec3* Worldnormal1 = &fsa_Worldnormal1;
     Cannon::Math::Vec3* deltaC = &fsa_deltaC;
     Cannon::Math::Vec3* worldEdge0 = &fsa_worldEdge0;
     Cannon::Math::Vec3* worldEdge1 = &fsa_worldEdge1;
     Cannon::Math::Vec3* Cross = &fsa_Cross;
+    std::vector<Cannon::Math::Vec3>* worldNormalsA = &fsa_worldNormalsA;
+    std::vector<Cannon::Math::Vec3>* worldNormalsB = &fsa_worldNormalsB;
 
     float dmin = MAX_FLOAT;
     ConvexPolyhedron* hullA = this;
@@ -280,8 +387,9 @@ bool ConvexPolyhedron::findSeparatingAxis(
             faceANormalWS3->copy(&hullA->faceNormals[fi]);
             quatA->vmult(faceANormalWS3, faceANormalWS3);
 
-            DepthOrBool d = hullA->testSepAxis(faceANormalWS3, hullB, posA, quatA, posB, quatB);
+            DepthOrBool d = hullA->testSepAxis(faceANormalWS3, hullB, posA, quatA, posB, quatB, vertexHints);
             if (!d.boolean){
+                target->copy(faceANormalWS3);
                 return false;
             }
 
@@ -296,8 +404,9 @@ bool ConvexPolyhedron::findSeparatingAxis(
             // Get world axis
             quatA->vmult(&hullA->uniqueAxes->at(i), faceANormalWS3);
 
-            DepthOrBool d = hullA->testSepAxis(faceANormalWS3, hullB, posA, quatA, posB, quatB);
+            DepthOrBool d = hullA->testSepAxis(faceANormalWS3, hullB, posA, quatA, posB, quatB, vertexHints);
             if (!d.boolean){
+                target->copy(faceANormalWS3);
                 return false;
             }
 
@@ -317,8 +426,9 @@ bool ConvexPolyhedron::findSeparatingAxis(
             Worldnormal1->copy(&hullB->faceNormals[fi]);
             quatB->vmult(Worldnormal1, Worldnormal1);
             curPlaneTests++;
-            DepthOrBool d = hullA->testSepAxis(Worldnormal1, hullB, posA, quatA, posB, quatB);
+            DepthOrBool d = hullA->testSepAxis(Worldnormal1, hullB, posA, quatA, posB, quatB, vertexHints);
             if (!d.boolean) {
+                target->copy(Worldnormal1);
                 return false;
             }
 
@@ -333,8 +443,9 @@ bool ConvexPolyhedron::findSeparatingAxis(
             quatB->vmult(&hullB->uniqueAxes->at(i), Worldnormal1);
 
             curPlaneTests++;
-            DepthOrBool d = hullA->testSepAxis(Worldnormal1, hullB, posA, quatA, posB, quatB);
+            DepthOrBool d = hullA->testSepAxis(Worldnormal1, hullB, posA, quatA, posB, quatB, vertexHints);
             if (!d.boolean) {
+                target->copy(Worldnormal1);
                 return false;
             }
 
@@ -345,20 +456,37 @@ bool ConvexPolyhedron::findSeparatingAxis(
         }
     }
 
+    // World face normals for the Gauss map, negated for hullB since we look at A - B
+    worldNormalsA->resize(hullA->faceNormals.size());
+    for (int i = 0; i != hullA->faceNormals.size(); i++) {
+        quatA->vmult(&hullA->faceNormals[i], &worldNormalsA->at(i));
+    }
+    worldNormalsB->resize(hullB->faceNormals.size());
+    for (int i = 0; i != hullB->faceNormals.size(); i++) {
+        quatB->vmult(&hullB->faceNormals[i], &worldNormalsB->at(i));
+        worldNormalsB->at(i).negate(&worldNormalsB->at(i));
+    }
+
     // Test edges
     for (int e0 = 0; e0 != hullA->uniqueEdges.size(); e0++) {
         // Get world edge
         quatA->vmult(&hullA->uniqueEdges[e0], worldEdge0);
 
         for (int e1 = 0; e1 != hullB->uniqueEdges.size(); e1++) {
+            // Edge pairs that make no face of the Minkowski difference can not give a separating axis
+            if (!hullA->edgesMakeMinkowskiFace_(e0, hullB, e1, worldNormalsA, worldNormalsB)) {
+                continue;
+            }
+
             // Get world edge 2
             quatB->vmult(&hullB->uniqueEdges[e1], worldEdge1);
             worldEdge0->cross(worldEdge1, Cross);
 
             if (!Cross->almostZero(0.00001)) {
                 Cross->normalize();
-                DepthOrBool dist = hullA->testSepAxis(Cross, hullB, posA, quatA, posB, quatB);
+                DepthOrBool dist = hullA->testSepAxis(Cross, hullB, posA, quatA, posB, quatB, vertexHints);
                 if (!dist.boolean) {
+                    target->copy(Cross);
                     return false;
                 }
                 if (dist.depth < dmin) {
@@ -377,6 +505,38 @@ bool ConvexPolyhedron::findSeparatingAxis(
     return true;
 }
 
+bool ConvexPolyhedron::edgesMakeMinkowskiFace_(
+    int edgeA,
+    ConvexPolyhedron* hullB,
+    int edgeB,
+    std::vector<Math::Vec3>* worldNormalsA,
+    std::vector<Math::Vec3>* worldNormalsB) {
+    std::vector<std::array<int, 2>>* facesA = &this->uniqueEdgeFaces[edgeA];
+    std::vector<std::array<int, 2>>* facesB = &hullB->uniqueEdgeFaces[edgeB];
+
+    for (int i = 0; i != facesA->size(); i++) {
+        std::array<int, 2>* fa = &facesA->at(i);
+        for (int j = 0; j != facesB->size(); j++) {
+            std::array<int, 2>* fb = &facesB->at(j);
+
+            // Open edges have no arc on the Gauss map, so always test them
+            if (fa->at(1) == -1 || fb->at(1) == -1) {
+                return true;
+            }
+
+            if (ConvexPolyhedron::isMinkowskiFace(
+                &worldNormalsA->at(fa->at(0)),
+                &worldNormalsA->at(fa->at(1)),
+                &worldNormalsB->at(fb->at(0)),
+                &worldNormalsB->at(fb->at(1)))) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
 bool ConvexPolyhedron::findSeparatingAxis(
     ConvexPolyhedron* hullB,
     Math::Vec3* posA,
@@ -387,18 +547,53 @@ bool ConvexPolyhedron::findSeparatingAxis(
     return this->findSeparatingAxis(hullB, posA, quatA, posB, quatB, target, nullptr, nullptr);
 }
 
-std::array<float, 2> maxminA;
-std::array<float, 2> maxminB;
+bool ConvexPolyhedron::findSeparatingAxis(
+    ConvexPolyhedron* hullB,
+    Math::Vec3* posA,
+    Math::Quaternion* quatA,
+    Math::Vec3* posB,
+    Math::Quaternion* quatB,
+    Math::Vec3* target,
+    std::vector<int>* faceListA,
+    std::vector<int>* faceListB,
+    Collision::SeparatingAxisCache* cache) {
+    if (cache == nullptr) {
+        return this->findSeparatingAxis(hullB, posA, quatA, posB, quatB, target, faceListA, faceListB);
+    }
+
+    // Try the axis that separated the pair last time, hill climbing from the vertices found when it was stored
+    std::array<int, 4> vertexHints = {{ 0, 0, 0, 0 }};
+    if (cache->getAxis(this, quatA, hullB, quatB, target, &vertexHints)) {
+        DepthOrBool d = this->testSepAxis(target, hullB, posA, quatA, posB, quatB, &vertexHints);
+        if (!d.boolean) {
+            return false;
+        }
+    }
+
+    if (this->findSeparatingAxis_(hullB, posA, quatA, posB, quatB, target, faceListA, faceListB, &vertexHints)) {
+        cache->removeAxis(this, hullB);
+        return true;
+    }
+
+    cache->setAxis(this, quatA, hullB, quatB, target, &vertexHints);
+    return false;
+}
+
+thread_local std::array<float, 2> maxminA;
+thread_local std::array<float, 2> maxminB;
 DepthOrBool ConvexPolyhedron::testSepAxis(
     Math::Vec3* axis,
     ConvexPolyhedron* hullB,
     Math::Vec3* posA,
     Math::Quaternion* quatA,
     Math::Vec3* posB,
-    Math::Quaternion* quatB) {
+    Math::Quaternion* quatB,
+    std::array<int, 4>* vertexHints) {
     ConvexPolyhedron* hullA = this;
-    ConvexPolyhedron::project(hullA, axis, posA, quatA, &maxminA);
-    ConvexPolyhedron::project(hullB, axis, posB, quatB, &maxminB);
+    int* hintsA = vertexHints != nullptr ? &vertexHints->at(0) : nullptr;
+    int* hintsB = vertexHints != nullptr ? &vertexHints->at(2) : nullptr;
+    ConvexPolyhedron::project(hullA, axis, posA, quatA, &maxminA, hintsA);
+    ConvexPolyhedron::project(hullB, axis, posB, quatB, &maxminB, hintsB);
     float maxA = maxminA[0];
     float minA = maxminA[1];
     float maxB = maxminB[0];
@@ -417,8 +612,8 @@ DepthOrBool ConvexPolyhedron::testSepAxis(
     };
 }
 
-Cannon::Math::Vec3 cli_aabbmin;
-Cannon::Math::Vec3 cli_aabbmax;
+thread_local Cannon::Math::Vec3 cli_aabbmin;
+thread_local Cannon::Math::Vec3 cli_aabbmax;
 void ConvexPolyhedron::calculateLocalInertia(float mass, Math::Vec3* target) {
     // Approximate with box inertia
     // Exact inertia calculation is overkill, but see http://geometrictools.com/Documentation/PolyhedralMassProperties.pdf for the correct way to do it
@@ -432,21 +627,21 @@ void ConvexPolyhedron::calculateLocalInertia(float mass, Math::Vec3* target) {
 }
 
 float ConvexPolyhedron::getPlaneConstantOfFace(int face_i) {
-    std::vector<int> f = this->faces->at(face_i);
+    std::vector<int>* f = &this->faces->at(face_i);
     Math::Vec3* n = &this->faceNormals[face_i];
-    Math::Vec3* v = &this->vertices->at(f[0]);
+    Math::Vec3* v = &this->vertices->at(f->at(0));
     float c = -n->dot(v);
     return c;
 }
 
-Cannon::Math::Vec3 cfah_faceANormalWS;
-Cannon::Math::Vec3 cfah_edge0;
-Cannon::Math::Vec3 cfah_WorldEdge0;
-Cannon::Math::Vec3 cfah_worldPlaneAnormal1;
-Cannon::Math::Vec3 cfah_planeNormalWS1;
-Cannon::Math::Vec3 cfah_worldA1;
-Cannon::Math::Vec3 cfah_localPlaneNormal;
-Cannon::Math::Vec3 cfah_planeNormalWS;
+thread_local Cannon::Math::Vec3 cfah_faceANormalWS;
+thread_local Cannon::Math::Vec3 cfah_edge0;
+thread_local Cannon::Math::Vec3 cfah_WorldEdge0;
+thread_local Cannon::Math::Vec3 cfah_worldPlaneAnormal1;
+thread_local Cannon::Math::Vec3 cfah_planeNormalWS1;
+thread_local Cannon::Math::Vec3 cfah_worldA1;
+thread_local Cannon::Math::Vec3 cfah_localPlaneNormal;
+thread_local Cannon::Math::Vec3 cfah_planeNormalWS;
 void ConvexPolyhedron::clipFaceAgainstHull(
     Math::Vec3* separatingNormal,
     Math::Vec3* posA,
@@ -526,7 +721,7 @@ void ConvexPolyhedron::clipFaceAgainstHull(
             planeNormalWS->copy(localPlaneNormal);
             quatA->vmult(planeNormalWS, planeNormalWS);
             //posA.vadd(planeNormalWS,planeNormalWS);
-            float planeEqWS = localPlaneEq - planeNormalWS->dot(posA);
+            planeEqWS = localPlaneEq - planeNormalWS->dot(posA);
         } else  {
             planeNormalWS->copy(planeNormalWS1);
             planeEqWS = planeEqWS1;
@@ -649,7 +844,7 @@ void ConvexPolyhedron::computeWorldVertices(Math::Vec3* position, Math::Quaterni
     this->worldVerticesNeedsUpdate = false;
 }
 
-Cannon::Math::Vec3 computeLocalAABB_worldVert;
+thread_local Cannon::Math::Vec3 computeLocalAABB_worldVert;
 void ConvexPolyhedron::computeLocalAABB(Math::Vec3* aabbmin, Math::Vec3* aabbmax) {
     int n = this->vertices->size();
     std::vector<Math::Vec3>* vertices = this->vertices;
@@ -707,7 +902,7 @@ void ConvexPolyhedron::updateBoundingSphereRadius() {
     this->boundingSphereRadius = std::sqrt(maxRadiusSq);
 }
 
-Cannon::Math::Vec3 tempWorldVertex;
+thread_local Cannon::Math::Vec3 tempWorldVertex;
 void ConvexPolyhedron::calculateWorldAABB(
     Math::Vec3* pos,
     Math::Quaternion* quat,
@@ -802,9 +997,9 @@ void ConvexPolyhedron::transformAllPoints(Math::Vec3* offset, Math::Quaternion*
     }
 }
 
-Cannon::Math::Vec3 ConvexPolyhedron_pointIsInside;
-Cannon::Math::Vec3 ConvexPolyhedron_vToP;
-Cannon::Math::Vec3 ConvexPolyhedron_vToPointInside;
+thread_local Cannon::Math::Vec3 ConvexPolyhedron_pointIsInside;
+thread_local Cannon::Math::Vec3 ConvexPolyhedron_vToP;
+thread_local Cannon::Math::Vec3 ConvexPolyhedron_vToPointInside;
 bool ConvexPolyhedron::pointIsInside(Math::Vec3* p) {
     std::vector<Math::Vec3>* verts = this->vertices;
     std::vector<std::vector<int>>* faces = this->faces;
@@ -836,3 +1031,33 @@ bool ConvexPolyhedron::pointIsInside(Math::Vec3* p) {
     // return positiveResult ? 1 : -1;
     return true;
 }
+
+bool ConvexPolyhedron::isConvex() {
+    return true;
+}
+
+void ConvexPolyhedron::supportPoint(Math::Vec3* direction, Math::Vec3* target) {
+    int vertexHint = 0;
+    this->supportPoint(direction, target, &vertexHint);
+}
+
+void ConvexPolyhedron::supportPoint(Math::Vec3* direction, Math::Vec3* target, int* vertexHint) {
+    std::vector<Math::Vec3>* verts = this->vertices;
+    if (verts->size() >= this->hillClimbingThreshold && this->vertexNeighbors.size() == verts->size()) {
+        int start = *vertexHint < verts->size() ? *vertexHint : 0;
+        *vertexHint = this->getExtremeVertex(direction, start);
+        target->copy(&verts->at(*vertexHint));
+        return;
+    }
+
+    int best = 0;
+    float max = verts->at(0).dot(direction);
+    for (int i = 1; i < verts->size(); i++) {
+        float d = verts->at(i).dot(direction);
+        if (d > max) {
+            max = d;
+            best = i;
+        }
+    }
+    target->copy(&verts->at(best));
+}
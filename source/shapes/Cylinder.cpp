@@ -0,0 +1,70 @@
+#include "shapes/Cylinder.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+using namespace Cannon::Shapes;
+
+Cylinder::Cylinder(float radius, float height) : Shape(ShapeTypes::CYLINDER) {
+    this->radius = radius;
+    this->height = height;
+
+    if (radius < 0 || height < 0) {
+        throw std::runtime_error("The cylinder radius and height cannot be negative.");
+    }
+
+    this->updateBoundingSphereRadius();
+}
+
+Cylinder::~Cylinder() {}
+
+void Cylinder::calculateLocalInertia(float mass, Math::Vec3* target) {
+    float r = this->radius;
+    float h = this->height;
+    float Ixy = mass * (3 * r * r + h * h) / 12;
+    target->set(Ixy, Ixy, mass * r * r / 2);
+}
+
+double Cylinder::volume() {
+    return M_PI * this->radius * this->radius * this->height;
+}
+
+void Cylinder::updateBoundingSphereRadius() {
+    float halfHeight = this->height / 2;
+    this->boundingSphereRadius = std::sqrt(this->radius * this->radius + halfHeight * halfHeight);
+}
+
+thread_local Cannon::Math::Vec3 Cylinder_calculateWorldAABB_axis;
+void Cylinder::calculateWorldAABB(
+    Math::Vec3* pos,
+    Math::Quaternion* quat,
+    Math::Vec3* min,
+    Math::Vec3* max) {
+    // The caps reach half the height along the axis, and the radius in the directions perpendicular to it
+    Math::Vec3* axis = &Cylinder_calculateWorldAABB_axis;
+    axis->set(0, 0, 1);
+    quat->vmult(axis, axis);
+    float halfHeight = this->height / 2;
+    float r = this->radius;
+    float ex = std::abs(axis->x) * halfHeight + r * std::sqrt(std::max(0.0f, 1 - axis->x * axis->x));
+    float ey = std::abs(axis->y) * halfHeight + r * std::sqrt(std::max(0.0f, 1 - axis->y * axis->y));
+    float ez = std::abs(axis->z) * halfHeight + r * std::sqrt(std::max(0.0f, 1 - axis->z * axis->z));
+
+    min->set(pos->x - ex, pos->y - ey, pos->z - ez);
+    max->set(pos->x + ex, pos->y + ey, pos->z + ez);
+}
+
+bool Cylinder::isConvex() {
+    return true;
+}
+
+void Cylinder::supportPoint(Math::Vec3* direction, Math::Vec3* target) {
+    float radial = std::sqrt(direction->x * direction->x + direction->y * direction->y);
+    float z = direction->z < 0 ? -this->height / 2 : this->height / 2;
+    if (radial == 0) {
+        target->set(0, 0, z);
+        return;
+    }
+    target->set(direction->x * this->radius / radial, direction->y * this->radius / radial, z);
+}
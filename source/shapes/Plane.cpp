@@ -23,7 +23,7 @@ double Plane::volume() {
     return MAX_FLOAT; // The plane is infinite...
 }
 
-Cannon::Math::Vec3 tempNormal;
+thread_local Cannon::Math::Vec3 tempNormal;
 void Plane::calculateWorldAABB(
     Math::Vec3* pos,
     Math::Quaternion* quat,
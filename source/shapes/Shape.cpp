@@ -1,5 +1,7 @@
 #include "shapes/Shape.h"
 
+#include <stdexcept>
+
 using namespace Cannon::Shapes;
 
 int Shape::idCounter = 0;
@@ -7,3 +9,11 @@ int Shape::idCounter = 0;
 Shape::Shape(ShapeTypes type) : type(type), id(idCounter++) {}
 
 Shape::~Shape() {}
+
+bool Shape::isConvex() {
+    return false;
+}
+
+void Shape::supportPoint(Math::Vec3* direction, Math::Vec3* target) {
+    throw std::runtime_error("Shape type " + std::to_string(this->type) + " has no support point.");
+}
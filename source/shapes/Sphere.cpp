@@ -44,3 +44,16 @@ void Sphere::calculateWorldAABB(
     min->set(pos->x - r, pos->y - r, pos->z - r);
     max->set(pos->x + r, pos->y + r, pos->z + r);     
 }
+
+bool Sphere::isConvex() {
+    return true;
+}
+
+void Sphere::supportPoint(Math::Vec3* direction, Math::Vec3* target) {
+    float length = direction->length();
+    if (length == 0) {
+        target->set(this->radius, 0, 0);
+        return;
+    }
+    direction->scale(this->radius / length, target);
+}
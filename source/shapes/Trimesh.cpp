@@ -0,0 +1,277 @@
+#include "shapes/Trimesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include "math/Mat3.h"
+
+using namespace Cannon::Shapes;
+
+Trimesh::Trimesh(std::vector<float>* vertices, std::vector<int>* indices) : Shape(ShapeTypes::TRIMESH) {
+    this->vertices = *vertices;
+    this->indices = *indices;
+    this->normals.resize(indices->size());
+
+    this->updateEdges();
+    this->updateNormals();
+    this->updateAABB();
+    this->updateBoundingSphereRadius();
+    this->updateTree();
+}
+
+Trimesh::~Trimesh() {}
+
+Trimesh* Trimesh::createTorus(float radius, float tube, int radialSegments, int tubularSegments, double arc) {
+    std::vector<float> vertices;
+    std::vector<int> indices;
+
+    for (int j = 0; j <= radialSegments; j++) {
+        for (int i = 0; i <= tubularSegments; i++) {
+            double u = (double)i / tubularSegments * arc;
+            double v = (double)j / radialSegments * M_PI * 2;
+
+            vertices.push_back((radius + tube * std::cos(v)) * std::cos(u));
+            vertices.push_back((radius + tube * std::cos(v)) * std::sin(u));
+            vertices.push_back(tube * std::sin(v));
+        }
+    }
+
+    for (int j = 1; j <= radialSegments; j++) {
+        for (int i = 1; i <= tubularSegments; i++) {
+            int a = (tubularSegments + 1) * j + i - 1;
+            int b = (tubularSegments + 1) * (j - 1) + i - 1;
+            int c = (tubularSegments + 1) * (j - 1) + i;
+            int d = (tubularSegments + 1) * j + i;
+
+            indices.insert(indices.end(), { a, b, d });
+            indices.insert(indices.end(), { b, c, d });
+        }
+    }
+
+    return new Trimesh(&vertices, &indices);
+}
+
+void Trimesh::updateTree() {
+    this->tree.build(&this->vertices, &this->indices);
+    if (!this->useCompressedTree) {
+        this->compressedTree.reset();
+        return;
+    }
+
+    // Only the compressed copy is kept
+    this->compressedTree.build(&this->tree);
+    std::vector<Utils::LinearBVHNode>().swap(this->tree.nodes);
+    std::vector<int>().swap(this->tree.triangles);
+}
+
+void Trimesh::unscaleAABB_(Collision::AABB* aabb, Collision::AABB* target) {
+    // A negative scale swaps the bounds
+    float sx = this->scale.x;
+    float sy = this->scale.y;
+    float sz = this->scale.z;
+    float lx = aabb->lowerBound.x / sx;
+    float ly = aabb->lowerBound.y / sy;
+    float lz = aabb->lowerBound.z / sz;
+    float ux = aabb->upperBound.x / sx;
+    float uy = aabb->upperBound.y / sy;
+    float uz = aabb->upperBound.z / sz;
+    target->lowerBound.set(std::min(lx, ux), std::min(ly, uy), std::min(lz, uz));
+    target->upperBound.set(std::max(lx, ux), std::max(ly, uy), std::max(lz, uz));
+}
+
+std::vector<int>* Trimesh::getTrianglesInAABB(Collision::AABB* aabb, std::vector<int>* result) {
+    this->trianglesInAABB(aabb, [result](int triangle) {
+        result->push_back(triangle);
+    });
+    return result;
+}
+
+void Trimesh::setScale(Math::Vec3* scale) {
+    bool wasUniform = this->scale.x == this->scale.y && this->scale.y == this->scale.z;
+    bool isUniform = scale->x == scale->y && scale->y == scale->z;
+
+    this->scale.copy(scale);
+    if (!(wasUniform && isUniform)) {
+        // Non uniform scaling changes the directions of the normals
+        this->updateNormals();
+    }
+    this->updateAABB();
+    this->updateBoundingSphereRadius();
+}
+
+void Trimesh::updateNormals() {
+    Math::Vec3 va;
+    Math::Vec3 vb;
+    Math::Vec3 vc;
+    Math::Vec3 n;
+
+    int triangleCount = this->indices.size() / 3;
+    for (int i = 0; i < triangleCount; i++) {
+        this->getTriangleVertices(i, &va, &vb, &vc);
+        Trimesh::computeNormal(&va, &vb, &vc, &n);
+
+        this->normals[i * 3] = n.x;
+        this->normals[i * 3 + 1] = n.y;
+        this->normals[i * 3 + 2] = n.z;
+    }
+}
+
+void Trimesh::updateEdges() {
+    // Each edge once, with the lower vertex index first
+    std::vector<std::pair<int, int>> edges;
+    int triangleCount = this->indices.size() / 3;
+    for (int i = 0; i < triangleCount; i++) {
+        for (int k = 0; k < 3; k++) {
+            int a = this->indices[i * 3 + k];
+            int b = this->indices[i * 3 + (k + 1) % 3];
+            edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    this->edges.clear();
+    for (int i = 0; i < edges.size(); i++) {
+        this->edges.push_back(edges[i].first);
+        this->edges.push_back(edges[i].second);
+    }
+}
+
+void Trimesh::getEdgeVertex(int edgeIndex, int firstOrSecond, Math::Vec3* vertexStore) {
+    int vertexIndex = this->edges[edgeIndex * 2 + (firstOrSecond ? 1 : 0)];
+    this->getVertex(vertexIndex, vertexStore);
+}
+
+void Trimesh::getEdgeVector(int edgeIndex, Math::Vec3* vectorStore) {
+    Math::Vec3 va;
+    Math::Vec3 vb;
+    this->getEdgeVertex(edgeIndex, 0, &va);
+    this->getEdgeVertex(edgeIndex, 1, &vb);
+    vb.vsub(&va, vectorStore);
+}
+
+void Trimesh::computeNormal(Math::Vec3* va, Math::Vec3* vb, Math::Vec3* vc, Math::Vec3* target) {
+    Math::Vec3 ab;
+    Math::Vec3 cb;
+    vb->vsub(va, &ab);
+    vc->vsub(vb, &cb);
+    cb.cross(&ab, target);
+
+    if (!target->isZero()) {
+        target->normalize();
+    }
+}
+
+Cannon::Math::Vec3* Trimesh::getUnscaledVertex_(int i, Math::Vec3* out) {
+    int i3 = i * 3;
+    out->set(this->vertices[i3], this->vertices[i3 + 1], this->vertices[i3 + 2]);
+    return out;
+}
+
+Cannon::Math::Vec3* Trimesh::getVertex(int i, Math::Vec3* out) {
+    this->getUnscaledVertex_(i, out);
+    out->set(out->x * this->scale.x, out->y * this->scale.y, out->z * this->scale.z);
+    return out;
+}
+
+Cannon::Math::Vec3* Trimesh::getWorldVertex(int i, Math::Vec3* pos, Math::Quaternion* quat, Math::Vec3* out) {
+    this->getVertex(i, out);
+    quat->vmult(out, out);
+    return out->vadd(pos, out);
+}
+
+void Trimesh::getTriangleVertices(int i, Math::Vec3* a, Math::Vec3* b, Math::Vec3* c) {
+    int i3 = i * 3;
+    this->getVertex(this->indices[i3], a);
+    this->getVertex(this->indices[i3 + 1], b);
+    this->getVertex(this->indices[i3 + 2], c);
+}
+
+Cannon::Math::Vec3* Trimesh::getNormal(int i, Math::Vec3* target) {
+    int i3 = i * 3;
+    target->set(this->normals[i3], this->normals[i3 + 1], this->normals[i3 + 2]);
+    return target;
+}
+
+void Trimesh::calculateLocalInertia(float mass, Math::Vec3* target) {
+    // Approximate with the inertia of the bounding box
+    Collision::AABB aabb;
+    this->computeLocalAABB(&aabb);
+    float x = aabb.upperBound.x - aabb.lowerBound.x;
+    float y = aabb.upperBound.y - aabb.lowerBound.y;
+    float z = aabb.upperBound.z - aabb.lowerBound.z;
+    target->set(
+        1.0f / 12.0f * mass * (2 * y * 2 * y + 2 * z * 2 * z),
+        1.0f / 12.0f * mass * (2 * x * 2 * x + 2 * z * 2 * z),
+        1.0f / 12.0f * mass * (2 * y * 2 * y + 2 * x * 2 * x));
+}
+
+void Trimesh::computeLocalAABB(Collision::AABB* aabb) {
+    Math::Vec3* l = &aabb->lowerBound;
+    Math::Vec3* u = &aabb->upperBound;
+    int n = this->vertices.size() / 3;
+    if (n == 0) {
+        l->set(0, 0, 0);
+        u->set(0, 0, 0);
+        return;
+    }
+
+    Math::Vec3 v;
+    this->getVertex(0, &v);
+    l->copy(&v);
+    u->copy(&v);
+
+    for (int i = 1; i < n; i++) {
+        this->getVertex(i, &v);
+        l->set(std::min(l->x, v.x), std::min(l->y, v.y), std::min(l->z, v.z));
+        u->set(std::max(u->x, v.x), std::max(u->y, v.y), std::max(u->z, v.z));
+    }
+}
+
+void Trimesh::updateAABB() {
+    this->computeLocalAABB(&this->aabb);
+}
+
+void Trimesh::updateBoundingSphereRadius() {
+    // Assume points are distributed with local (0,0,0) as center
+    float max2 = 0;
+    Math::Vec3 v;
+    int n = this->vertices.size() / 3;
+    for (int i = 0; i < n; i++) {
+        this->getVertex(i, &v);
+        float norm2 = v.lengthSquared();
+        if (norm2 > max2) {
+            max2 = norm2;
+        }
+    }
+    this->boundingSphereRadius = std::sqrt(max2);
+}
+
+void Trimesh::calculateWorldAABB(Math::Vec3* pos, Math::Quaternion* quat, Math::Vec3* min, Math::Vec3* max) {
+    // Rotate the local box around its center, the extents become the absolute rotation matrix times the half extents
+    Math::Mat3 rotation;
+    rotation.setRotationFromQuaternion(quat);
+    Math::Vec3 center;
+    this->aabb.lowerBound.vadd(&this->aabb.upperBound, &center);
+    center.scale(0.5, &center);
+    Math::Vec3 halfExtents;
+    this->aabb.upperBound.vsub(&center, &halfExtents);
+    quat->vmult(&center, &center);
+    center.vadd(pos, &center);
+
+    float e[3] = { halfExtents.x, halfExtents.y, halfExtents.z };
+    float worldExtents[3];
+    for (int i = 0; i < 3; i++) {
+        worldExtents[i] = 0;
+        for (int j = 0; j < 3; j++) {
+            worldExtents[i] += std::abs(rotation.elements[i * 3 + j]) * e[j];
+        }
+    }
+
+    min->set(center.x - worldExtents[0], center.y - worldExtents[1], center.z - worldExtents[2]);
+    max->set(center.x + worldExtents[0], center.y + worldExtents[1], center.z + worldExtents[2]);
+}
+
+double Trimesh::volume() {
+    return 4.0 * M_PI * this->boundingSphereRadius / 3.0;
+}
@@ -0,0 +1,115 @@
+#include "solver/GSSolver.h"
+
+#include <algorithm>
+#include "objects/Body.h"
+#include "world/World.h"
+
+using namespace Cannon::Solver;
+
+GSSolver::GSSolver() {}
+
+int GSSolver::solve(double dt, World::World* world) {
+    return this->solveBodies(dt, &world->bodies);
+}
+
+int GSSolver::solveBodies(double dt, std::vector<Objects::Body*>* bodies) {
+    int iter = 0;
+    int maxIter = this->iterations;
+    double tolSquared = this->tolerance * this->tolerance;
+    std::vector<Equations::Equation*>* equations = &this->equations;
+    int Neq = equations->size();
+    int Nbodies = bodies->size();
+    double h = dt;
+
+    if (Neq == 0) {
+        return iter;
+    }
+
+    // Update solve mass
+    for (int i = 0; i != Nbodies; i++) {
+        bodies->at(i)->updateSolveMassProperties();
+    }
+
+    // Things that does not change during iteration can be computed once
+    std::vector<double>* invCs = &this->invCs_;
+    std::vector<double>* Bs = &this->Bs_;
+    std::vector<double>* lambda = &this->lambda_;
+    invCs->resize(Neq);
+    Bs->resize(Neq);
+    lambda->resize(Neq);
+    for (int i = 0; i != Neq; i++) {
+        Equations::Equation* c = equations->at(i);
+        Bs->at(i) = c->computeB(h);
+        invCs->at(i) = 1.0 / c->computeC();
+
+        // Start from the impulse of the last step, if any
+        double lambdaStart = c->lambda * this->warmStartFactor;
+        lambda->at(i) = std::min(std::max(lambdaStart, c->minForce), c->maxForce);
+    }
+
+    // Reset vlambda
+    for (int i = 0; i != Nbodies; i++) {
+        Objects::Body* b = bodies->at(i);
+        b->vlambda.set(0, 0, 0);
+        b->wlambda.set(0, 0, 0);
+    }
+
+    // Apply the warm start impulses
+    for (int i = 0; i != Neq; i++) {
+        if (lambda->at(i) != 0) {
+            equations->at(i)->addToWlambda(lambda->at(i));
+        }
+    }
+
+    // Iterate over equations
+    for (iter = 0; iter != maxIter; iter++) {
+        // Accumulate the total error for each iteration.
+        double deltalambdaTot = 0.0;
+
+        for (int j = 0; j != Neq; j++) {
+            Equations::Equation* c = equations->at(j);
+
+            // Compute iteration
+            double B = Bs->at(j);
+            double invC = invCs->at(j);
+            double lambdaj = lambda->at(j);
+            double GWlambda = c->computeGWlambda();
+            double deltalambda = invC * (B - GWlambda - c->eps * lambdaj);
+
+            // Clamp if we are not within the min/max interval
+            if (lambdaj + deltalambda < c->minForce) {
+                deltalambda = c->minForce - lambdaj;
+            } else if (lambdaj + deltalambda > c->maxForce) {
+                deltalambda = c->maxForce - lambdaj;
+            }
+            lambda->at(j) += deltalambda;
+
+            deltalambdaTot += deltalambda > 0.0 ? deltalambda : -deltalambda; // abs(deltalambda)
+
+            c->addToWlambda(deltalambda);
+        }
+
+        // If the total error is small enough - stop iterate
+        if (deltalambdaTot * deltalambdaTot < tolSquared) {
+            break;
+        }
+    }
+
+    // Add result to velocity
+    for (int i = 0; i != Nbodies; i++) {
+        Objects::Body* b = bodies->at(i);
+        b->vlambda.vmul(&b->linearFactor, &b->vlambda);
+        b->velocity.vadd(&b->vlambda, &b->velocity);
+        b->wlambda.vmul(&b->angularFactor, &b->wlambda);
+        b->angularVelocity.vadd(&b->wlambda, &b->angularVelocity);
+    }
+
+    // Set the .multiplier property of each equation, and keep the impulse for warm starting
+    double invDt = 1 / h;
+    for (int l = 0; l != Neq; l++) {
+        equations->at(l)->multiplier = lambda->at(l) * invDt;
+        equations->at(l)->lambda = lambda->at(l);
+    }
+
+    return iter;
+}
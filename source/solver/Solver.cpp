@@ -0,0 +1,24 @@
+#include "solver/Solver.h"
+
+#include <algorithm>
+
+using namespace Cannon::Solver;
+
+Solver::Solver() {}
+
+void Solver::addEquation(Equations::Equation* eq) {
+    if (eq->enabled) {
+        this->equations.push_back(eq);
+    }
+}
+
+void Solver::removeEquation(Equations::Equation* eq) {
+    auto it = std::find(this->equations.begin(), this->equations.end(), eq);
+    if (it != this->equations.end()) {
+        this->equations.erase(it);
+    }
+}
+
+void Solver::removeAllEquations() {
+    this->equations.clear();
+}
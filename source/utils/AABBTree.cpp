@@ -0,0 +1,582 @@
+#include "utils/AABBTree.h"
+
+#include <algorithm>
+#include <cmath>
+#include "math/Vec3.h"
+
+using namespace Cannon::Utils;
+
+Cannon::Collision::AABB insertLeaf_combined;
+
+float AABBTree::surfaceArea(Collision::AABB* aabb) {
+    float dx = aabb->upperBound.x - aabb->lowerBound.x;
+    float dy = aabb->upperBound.y - aabb->lowerBound.y;
+    float dz = aabb->upperBound.z - aabb->lowerBound.z;
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+void AABBTree::combine(Collision::AABB* a, Collision::AABB* b, Collision::AABB* target) {
+    target->lowerBound.set(
+        std::min(a->lowerBound.x, b->lowerBound.x),
+        std::min(a->lowerBound.y, b->lowerBound.y),
+        std::min(a->lowerBound.z, b->lowerBound.z));
+    target->upperBound.set(
+        std::max(a->upperBound.x, b->upperBound.x),
+        std::max(a->upperBound.y, b->upperBound.y),
+        std::max(a->upperBound.z, b->upperBound.z));
+}
+
+int AABBTree::allocateNode_() {
+    if (this->freeList_ == -1) {
+        this->nodes_.push_back(AABBTreeNode());
+        return this->nodes_.size() - 1;
+    }
+
+    int nodeId = this->freeList_;
+    this->freeList_ = this->nodes_[nodeId].parent;
+    this->nodes_[nodeId] = AABBTreeNode();
+    return nodeId;
+}
+
+void AABBTree::freeNode_(int nodeId) {
+    this->nodes_[nodeId].parent = this->freeList_;
+    this->nodes_[nodeId].height = -1;
+    this->freeList_ = nodeId;
+}
+
+int AABBTree::createProxy(Collision::AABB* aabb, int userData) {
+    int proxyId = this->allocateNode_();
+    AABBTreeNode* node = &this->nodes_[proxyId];
+
+    float m = this->margin;
+    node->aabb.lowerBound.set(aabb->lowerBound.x - m, aabb->lowerBound.y - m, aabb->lowerBound.z - m);
+    node->aabb.upperBound.set(aabb->upperBound.x + m, aabb->upperBound.y + m, aabb->upperBound.z + m);
+    node->userData = userData;
+    node->height = 0;
+
+    this->insertLeaf_(proxyId);
+
+    return proxyId;
+}
+
+void AABBTree::createProxies(std::vector<Collision::AABB*>* aabbs, std::vector<int>* userData, std::vector<int>* proxyIds) {
+    int N = aabbs->size();
+    if (N == 0) {
+        return;
+    }
+
+    std::vector<Collision::AABB>* fatAABBs = &this->builderAABBs_;
+    fatAABBs->resize(N);
+    float m = this->margin;
+    for (int i = 0; i < N; i++) {
+        Collision::AABB* aabb = aabbs->at(i);
+        fatAABBs->at(i).lowerBound.set(aabb->lowerBound.x - m, aabb->lowerBound.y - m, aabb->lowerBound.z - m);
+        fatAABBs->at(i).upperBound.set(aabb->upperBound.x + m, aabb->upperBound.y + m, aabb->upperBound.z + m);
+    }
+
+    LinearBVH* builder = &this->builder_;
+    builder->maxLeafSize = 1;
+    builder->build(fatAABBs);
+
+    // Copy the hierarchy. Children come after their parent, so go backwards to have them ready.
+    int first = proxyIds->size();
+    proxyIds->resize(first + N);
+    std::vector<int>* nodeIds = &this->builderNodes_;
+    nodeIds->resize(builder->nodes.size());
+    for (int i = builder->nodes.size() - 1; i >= 0; i--) {
+        LinearBVHNode* source = &builder->nodes[i];
+        int nodeId = this->allocateNode_();
+        nodeIds->at(i) = nodeId;
+
+        if (source->count > 0) {
+            int primitive = builder->primitives[source->offset];
+            this->nodes_[nodeId].aabb = fatAABBs->at(primitive);
+            this->nodes_[nodeId].userData = userData->at(primitive);
+            this->nodes_[nodeId].height = 0;
+            proxyIds->at(first + primitive) = nodeId;
+            continue;
+        }
+
+        int child1 = nodeIds->at(i + 1);
+        int child2 = nodeIds->at(source->offset);
+        AABBTreeNode* node = &this->nodes_[nodeId];
+        node->child1 = child1;
+        node->child2 = child2;
+        node->height = 1 + std::max(this->nodes_[child1].height, this->nodes_[child2].height);
+        AABBTree::combine(&this->nodes_[child1].aabb, &this->nodes_[child2].aabb, &node->aabb);
+        this->nodes_[child1].parent = nodeId;
+        this->nodes_[child2].parent = nodeId;
+    }
+
+    // insertLeaf_ only looks at the bounds and height of what it inserts, so it works for a subtree too
+    this->insertLeaf_(nodeIds->at(0));
+}
+
+void AABBTree::destroyProxy(int proxyId) {
+    this->removeLeaf_(proxyId);
+    this->freeNode_(proxyId);
+}
+
+bool AABBTree::moveProxy(int proxyId, Collision::AABB* aabb) {
+    if (this->nodes_[proxyId].aabb.contains(aabb)) {
+        return false;
+    }
+
+    this->removeLeaf_(proxyId);
+
+    float m = this->margin;
+    AABBTreeNode* node = &this->nodes_[proxyId];
+    node->aabb.lowerBound.set(aabb->lowerBound.x - m, aabb->lowerBound.y - m, aabb->lowerBound.z - m);
+    node->aabb.upperBound.set(aabb->upperBound.x + m, aabb->upperBound.y + m, aabb->upperBound.z + m);
+
+    this->insertLeaf_(proxyId);
+
+    return true;
+}
+
+Cannon::Collision::AABB* AABBTree::getFatAABB(int proxyId) {
+    return &this->nodes_[proxyId].aabb;
+}
+
+int AABBTree::getUserData(int proxyId) {
+    return this->nodes_[proxyId].userData;
+}
+
+void AABBTree::setUserData(int proxyId, int userData) {
+    this->nodes_[proxyId].userData = userData;
+}
+
+int AABBTree::getHeight() {
+    if (this->root == -1) {
+        return 0;
+    }
+    return this->nodes_[this->root].height;
+}
+
+void AABBTree::insertLeaf_(int leaf) {
+    if (this->root == -1) {
+        this->root = leaf;
+        this->nodes_[leaf].parent = -1;
+        return;
+    }
+
+    // Find the best sibling, descending into the child with the lowest cost increase
+    Collision::AABB* combined = &insertLeaf_combined;
+    Collision::AABB leafAABB = this->nodes_[leaf].aabb;
+    int index = this->root;
+    while (!this->nodes_[index].isLeaf()) {
+        int child1 = this->nodes_[index].child1;
+        int child2 = this->nodes_[index].child2;
+
+        float area = AABBTree::surfaceArea(&this->nodes_[index].aabb);
+        AABBTree::combine(&this->nodes_[index].aabb, &leafAABB, combined);
+        float combinedArea = AABBTree::surfaceArea(combined);
+
+        // Cost of creating a new parent for this node and the new leaf
+        float cost = 2.0f * combinedArea;
+
+        // Minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        AABBTree::combine(&leafAABB, &this->nodes_[child1].aabb, combined);
+        float cost1 = AABBTree::surfaceArea(combined) + inheritanceCost;
+        if (!this->nodes_[child1].isLeaf()) {
+            cost1 -= AABBTree::surfaceArea(&this->nodes_[child1].aabb);
+        }
+
+        AABBTree::combine(&leafAABB, &this->nodes_[child2].aabb, combined);
+        float cost2 = AABBTree::surfaceArea(combined) + inheritanceCost;
+        if (!this->nodes_[child2].isLeaf()) {
+            cost2 -= AABBTree::surfaceArea(&this->nodes_[child2].aabb);
+        }
+
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+
+        index = cost1 < cost2 ? child1 : child2;
+    }
+
+    int sibling = index;
+
+    // Create a new parent
+    int oldParent = this->nodes_[sibling].parent;
+    int newParent = this->allocateNode_();
+    this->nodes_[newParent].parent = oldParent;
+    this->nodes_[newParent].userData = -1;
+    AABBTree::combine(&leafAABB, &this->nodes_[sibling].aabb, &this->nodes_[newParent].aabb);
+    this->nodes_[newParent].height = this->nodes_[sibling].height + 1;
+
+    if (oldParent != -1) {
+        if (this->nodes_[oldParent].child1 == sibling) {
+            this->nodes_[oldParent].child1 = newParent;
+        } else {
+            this->nodes_[oldParent].child2 = newParent;
+        }
+    } else {
+        this->root = newParent;
+    }
+    this->nodes_[newParent].child1 = sibling;
+    this->nodes_[newParent].child2 = leaf;
+    this->nodes_[sibling].parent = newParent;
+    this->nodes_[leaf].parent = newParent;
+
+    // Walk back up the tree fixing heights and AABBs
+    index = this->nodes_[leaf].parent;
+    while (index != -1) {
+        index = this->balance_(index);
+
+        int child1 = this->nodes_[index].child1;
+        int child2 = this->nodes_[index].child2;
+        this->nodes_[index].height = 1 + std::max(this->nodes_[child1].height, this->nodes_[child2].height);
+        AABBTree::combine(&this->nodes_[child1].aabb, &this->nodes_[child2].aabb, &this->nodes_[index].aabb);
+
+        index = this->nodes_[index].parent;
+    }
+}
+
+void AABBTree::removeLeaf_(int leaf) {
+    if (leaf == this->root) {
+        this->root = -1;
+        return;
+    }
+
+    int parent = this->nodes_[leaf].parent;
+    int grandParent = this->nodes_[parent].parent;
+    int sibling = this->nodes_[parent].child1 == leaf ? this->nodes_[parent].child2 : this->nodes_[parent].child1;
+
+    if (grandParent != -1) {
+        // Destroy the parent and connect the sibling to the grand parent
+        if (this->nodes_[grandParent].child1 == parent) {
+            this->nodes_[grandParent].child1 = sibling;
+        } else {
+            this->nodes_[grandParent].child2 = sibling;
+        }
+        this->nodes_[sibling].parent = grandParent;
+        this->freeNode_(parent);
+
+        // Adjust the ancestor bounds
+        int index = grandParent;
+        while (index != -1) {
+            index = this->balance_(index);
+
+            int child1 = this->nodes_[index].child1;
+            int child2 = this->nodes_[index].child2;
+            AABBTree::combine(&this->nodes_[child1].aabb, &this->nodes_[child2].aabb, &this->nodes_[index].aabb);
+            this->nodes_[index].height = 1 + std::max(this->nodes_[child1].height, this->nodes_[child2].height);
+
+            index = this->nodes_[index].parent;
+        }
+    } else {
+        this->root = sibling;
+        this->nodes_[sibling].parent = -1;
+        this->freeNode_(parent);
+    }
+}
+
+int AABBTree::balance_(int iA) {
+    AABBTreeNode* A = &this->nodes_[iA];
+    if (A->isLeaf() || A->height < 2) {
+        return iA;
+    }
+
+    int iB = A->child1;
+    int iC = A->child2;
+    AABBTreeNode* B = &this->nodes_[iB];
+    AABBTreeNode* C = &this->nodes_[iC];
+
+    int balance = C->height - B->height;
+
+    // Rotate C up
+    if (balance > 1) {
+        int iF = C->child1;
+        int iG = C->child2;
+        AABBTreeNode* F = &this->nodes_[iF];
+        AABBTreeNode* G = &this->nodes_[iG];
+
+        // Swap A and C
+        C->child1 = iA;
+        C->parent = A->parent;
+        A->parent = iC;
+
+        // A's old parent should point to C
+        if (C->parent != -1) {
+            if (this->nodes_[C->parent].child1 == iA) {
+                this->nodes_[C->parent].child1 = iC;
+            } else {
+                this->nodes_[C->parent].child2 = iC;
+            }
+        } else {
+            this->root = iC;
+        }
+
+        // Rotate
+        if (F->height > G->height) {
+            C->child2 = iF;
+            A->child2 = iG;
+            G->parent = iA;
+            AABBTree::combine(&B->aabb, &G->aabb, &A->aabb);
+            AABBTree::combine(&A->aabb, &F->aabb, &C->aabb);
+
+            A->height = 1 + std::max(B->height, G->height);
+            C->height = 1 + std::max(A->height, F->height);
+        } else {
+            C->child2 = iG;
+            A->child2 = iF;
+            F->parent = iA;
+            AABBTree::combine(&B->aabb, &F->aabb, &A->aabb);
+            AABBTree::combine(&A->aabb, &G->aabb, &C->aabb);
+
+            A->height = 1 + std::max(B->height, F->height);
+            C->height = 1 + std::max(A->height, G->height);
+        }
+
+        return iC;
+    }
+
+    // Rotate B up
+    if (balance < -1) {
+        int iD = B->child1;
+        int iE = B->child2;
+        AABBTreeNode* D = &this->nodes_[iD];
+        AABBTreeNode* E = &this->nodes_[iE];
+
+        // Swap A and B
+        B->child1 = iA;
+        B->parent = A->parent;
+        A->parent = iB;
+
+        // A's old parent should point to B
+        if (B->parent != -1) {
+            if (this->nodes_[B->parent].child1 == iA) {
+                this->nodes_[B->parent].child1 = iB;
+            } else {
+                this->nodes_[B->parent].child2 = iB;
+            }
+        } else {
+            this->root = iB;
+        }
+
+        // Rotate
+        if (D->height > E->height) {
+            B->child2 = iD;
+            A->child1 = iE;
+            E->parent = iA;
+            AABBTree::combine(&C->aabb, &E->aabb, &A->aabb);
+            AABBTree::combine(&A->aabb, &D->aabb, &B->aabb);
+
+            A->height = 1 + std::max(C->height, E->height);
+            B->height = 1 + std::max(A->height, D->height);
+        } else {
+            B->child2 = iE;
+            A->child1 = iD;
+            D->parent = iA;
+            AABBTree::combine(&C->aabb, &D->aabb, &A->aabb);
+            AABBTree::combine(&A->aabb, &E->aabb, &B->aabb);
+
+            A->height = 1 + std::max(C->height, D->height);
+            B->height = 1 + std::max(A->height, E->height);
+        }
+
+        return iB;
+    }
+
+    return iA;
+}
+
+std::vector<int>* AABBTree::aabbQuery(Collision::AABB* aabb, std::vector<int>* result) {
+    return this->aabbQuery(aabb, result, &this->stack_);
+}
+
+std::vector<int>* AABBTree::aabbQuery(Collision::AABB* aabb, std::vector<int>* result, std::vector<int>* stack) {
+    if (this->root == -1) {
+        return result;
+    }
+
+    stack->clear();
+    stack->push_back(this->root);
+
+    while (!stack->empty()) {
+        int nodeId = stack->back();
+        stack->pop_back();
+
+        AABBTreeNode* node = &this->nodes_[nodeId];
+        if (!node->aabb.overlaps(aabb)) {
+            continue;
+        }
+
+        if (node->isLeaf()) {
+            result->push_back(node->userData);
+        } else {
+            stack->push_back(node->child1);
+            stack->push_back(node->child2);
+        }
+    }
+
+    return result;
+}
+
+std::vector<int>* AABBTree::rayQuery(Math::Vec3* from, Math::Vec3* to, std::vector<int>* result) {
+    if (this->root == -1) {
+        return result;
+    }
+
+    // Slab test against the segment, parametrized as from + t * (to - from) with t in [0, 1]
+    float dx = to->x - from->x;
+    float dy = to->y - from->y;
+    float dz = to->z - from->z;
+    float d[3] = { dx, dy, dz };
+    float inv[3] = { 1.0f / dx, 1.0f / dy, 1.0f / dz };
+    float o[3] = { from->x, from->y, from->z };
+
+    std::vector<int>* stack = &this->stack_;
+    stack->clear();
+    stack->push_back(this->root);
+
+    while (!stack->empty()) {
+        int nodeId = stack->back();
+        stack->pop_back();
+
+        AABBTreeNode* node = &this->nodes_[nodeId];
+        Collision::AABB* aabb = &node->aabb;
+
+        float tmin = 0;
+        float tmax = 1;
+        bool hit = true;
+        float lo[3] = { aabb->lowerBound.x, aabb->lowerBound.y, aabb->lowerBound.z };
+        float hi[3] = { aabb->upperBound.x, aabb->upperBound.y, aabb->upperBound.z };
+        for (int i = 0; i < 3; i++) {
+            if (d[i] == 0) {
+                // Parallel to the slab, must start inside it
+                if (o[i] < lo[i] || o[i] > hi[i]) {
+                    hit = false;
+                    break;
+                }
+                continue;
+            }
+            float t1 = (lo[i] - o[i]) * inv[i];
+            float t2 = (hi[i] - o[i]) * inv[i];
+            tmin = std::max(tmin, std::min(t1, t2));
+            tmax = std::min(tmax, std::max(t1, t2));
+            if (tmin > tmax) {
+                hit = false;
+                break;
+            }
+        }
+
+        if (!hit) {
+            continue;
+        }
+
+        if (node->isLeaf()) {
+            result->push_back(node->userData);
+        } else {
+            stack->push_back(node->child1);
+            stack->push_back(node->child2);
+        }
+    }
+
+    return result;
+}
+
+void AABBTree::visitPair_(AABBTree* other, int a, int b, std::vector<int>* stack, std::vector<int>* pairs1, std::vector<int>* pairs2) {
+    AABBTreeNode* A = &this->nodes_[a];
+    AABBTreeNode* B = &other->nodes_[b];
+
+    if (other == this && a == b) {
+        if (A->isLeaf()) {
+            return;
+        }
+        int c1 = A->child1;
+        int c2 = A->child2;
+        stack->push_back(c1);
+        stack->push_back(c1);
+        stack->push_back(c2);
+        stack->push_back(c2);
+        stack->push_back(c1);
+        stack->push_back(c2);
+        return;
+    }
+
+    if (!A->aabb.overlaps(&B->aabb)) {
+        return;
+    }
+
+    if (A->isLeaf() && B->isLeaf()) {
+        pairs1->push_back(A->userData);
+        pairs2->push_back(B->userData);
+    } else if (B->isLeaf() || (!A->isLeaf() && A->height >= B->height)) {
+        // Descend into the larger subtree
+        stack->push_back(A->child1);
+        stack->push_back(b);
+        stack->push_back(A->child2);
+        stack->push_back(b);
+    } else {
+        stack->push_back(a);
+        stack->push_back(B->child1);
+        stack->push_back(a);
+        stack->push_back(B->child2);
+    }
+}
+
+void AABBTree::queryPairs(std::vector<int>* pairs1, std::vector<int>* pairs2) {
+    if (this->root == -1) {
+        return;
+    }
+
+    // The root paired with itself means "all pairs within the tree"
+    this->queryNodes(this, this->root, this->root, pairs1, pairs2, &this->stack_);
+}
+
+void AABBTree::queryTree(AABBTree* other, std::vector<int>* pairs1, std::vector<int>* pairs2) {
+    if (this->root == -1 || other->root == -1) {
+        return;
+    }
+
+    this->queryNodes(other, this->root, other->root, pairs1, pairs2, &this->stack_);
+}
+
+void AABBTree::queryNodes(AABBTree* other, int nodeA, int nodeB, std::vector<int>* pairs1, std::vector<int>* pairs2, std::vector<int>* stack) {
+    // Stack of (node in this tree, node in the other tree)
+    stack->clear();
+    stack->push_back(nodeA);
+    stack->push_back(nodeB);
+
+    while (!stack->empty()) {
+        int b = stack->back();
+        stack->pop_back();
+        int a = stack->back();
+        stack->pop_back();
+        this->visitPair_(other, a, b, stack, pairs1, pairs2);
+    }
+}
+
+void AABBTree::splitQuery(AABBTree* other, int count, std::vector<int>* nodePairs) {
+    nodePairs->clear();
+    if (this->root == -1 || other->root == -1) {
+        return;
+    }
+    nodePairs->push_back(this->root);
+    nodePairs->push_back(other->root);
+
+    // Split every pair of the last level, in order, so the pairs do not depend on when the splitting stops within a level
+    std::vector<int>* next = &this->stack_;
+    bool split = true;
+    while (split && nodePairs->size() / 2 < count) {
+        split = false;
+        next->clear();
+        for (int i = 0; i < nodePairs->size(); i += 2) {
+            int a = nodePairs->at(i);
+            int b = nodePairs->at(i + 1);
+            bool self = other == this && a == b;
+            if (!self && this->nodes_[a].isLeaf() && other->nodes_[b].isLeaf()) {
+                next->push_back(a);
+                next->push_back(b);
+                continue;
+            }
+            this->visitPair_(other, a, b, next, nullptr, nullptr);
+            split = true;
+        }
+        nodePairs->swap(*next);
+    }
+}
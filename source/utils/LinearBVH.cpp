@@ -0,0 +1,340 @@
+#include "utils/LinearBVH.h"
+
+#include <algorithm>
+#include "math/Vec3.h"
+#include "utils/ThreadPool.h"
+
+using namespace Cannon::Utils;
+
+// Number of primitives per task when running on a thread pool
+const int LinearBVH_taskSize = 4096;
+
+unsigned long long LinearBVH::expandBits10(unsigned int v) {
+    unsigned long long x = v & 0x3ff;
+    x = (x | (x << 16)) & 0x30000ff;
+    x = (x | (x << 8)) & 0x300f00f;
+    x = (x | (x << 4)) & 0x30c30c3;
+    x = (x | (x << 2)) & 0x9249249;
+    return x;
+}
+
+unsigned long long LinearBVH::expandBits21(unsigned int v) {
+    unsigned long long x = v & 0x1fffff;
+    x = (x | (x << 32)) & 0x1f00000000ffffULL;
+    x = (x | (x << 16)) & 0x1f0000ff0000ffULL;
+    x = (x | (x << 8)) & 0x100f00f00f00f00fULL;
+    x = (x | (x << 4)) & 0x10c30c30c30c30c3ULL;
+    x = (x | (x << 2)) & 0x1249249249249249ULL;
+    return x;
+}
+
+unsigned long long LinearBVH::mortonCode30(float x, float y, float z) {
+    x = std::min(std::max(x * 1024.0f, 0.0f), 1023.0f);
+    y = std::min(std::max(y * 1024.0f, 0.0f), 1023.0f);
+    z = std::min(std::max(z * 1024.0f, 0.0f), 1023.0f);
+    return (LinearBVH::expandBits10((unsigned int)x) << 2)
+        | (LinearBVH::expandBits10((unsigned int)y) << 1)
+        | LinearBVH::expandBits10((unsigned int)z);
+}
+
+unsigned long long LinearBVH::mortonCode63(float x, float y, float z) {
+    x = std::min(std::max(x * 2097152.0f, 0.0f), 2097151.0f);
+    y = std::min(std::max(y * 2097152.0f, 0.0f), 2097151.0f);
+    z = std::min(std::max(z * 2097152.0f, 0.0f), 2097151.0f);
+    return (LinearBVH::expandBits21((unsigned int)x) << 2)
+        | (LinearBVH::expandBits21((unsigned int)y) << 1)
+        | LinearBVH::expandBits21((unsigned int)z);
+}
+
+void LinearBVH::runTasks_(int taskCount, std::function<void(int)> task) {
+    if (this->threadPool == nullptr) {
+        for (int i = 0; i < taskCount; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    this->threadPool->run(taskCount, [&](int taskIndex, int threadIndex) {
+        task(taskIndex);
+    });
+}
+
+void LinearBVH::computeCodes_(std::vector<Collision::AABB>* aabbs, int taskCount) {
+    int N = aabbs->size();
+
+    // Bounds of the centroids (times two, the halving cancels out)
+    float lo[3] = { 0, 0, 0 };
+    float hi[3] = { 0, 0, 0 };
+    for (int i = 0; i < N; i++) {
+        Collision::AABB* aabb = &aabbs->at(i);
+        float c[3] = {
+            aabb->lowerBound.x + aabb->upperBound.x,
+            aabb->lowerBound.y + aabb->upperBound.y,
+            aabb->lowerBound.z + aabb->upperBound.z
+        };
+        for (int k = 0; k < 3; k++) {
+            lo[k] = i == 0 ? c[k] : std::min(lo[k], c[k]);
+            hi[k] = i == 0 ? c[k] : std::max(hi[k], c[k]);
+        }
+    }
+
+    float scale[3];
+    for (int k = 0; k < 3; k++) {
+        scale[k] = hi[k] > lo[k] ? 1.0f / (hi[k] - lo[k]) : 0.0f;
+    }
+
+    this->codes_.resize(N);
+    this->primitives.resize(N);
+    bool useLongCodes = this->useLongCodes;
+    this->runTasks_(taskCount, [&](int task) {
+        int end = std::min(N, (task + 1) * LinearBVH_taskSize);
+        for (int i = task * LinearBVH_taskSize; i < end; i++) {
+            Collision::AABB* aabb = &aabbs->at(i);
+            float x = (aabb->lowerBound.x + aabb->upperBound.x - lo[0]) * scale[0];
+            float y = (aabb->lowerBound.y + aabb->upperBound.y - lo[1]) * scale[1];
+            float z = (aabb->lowerBound.z + aabb->upperBound.z - lo[2]) * scale[2];
+            this->codes_[i] = useLongCodes ? LinearBVH::mortonCode63(x, y, z) : LinearBVH::mortonCode30(x, y, z);
+            this->primitives[i] = i;
+        }
+    });
+}
+
+void LinearBVH::sortCodes_(int taskCount) {
+    int N = this->codes_.size();
+    int passes = this->useLongCodes ? 8 : 4;
+
+    std::vector<unsigned long long>* codes = &this->codes_;
+    std::vector<unsigned long long>* tempCodes = &this->tempCodes_;
+    std::vector<int>* primitives = &this->primitives;
+    std::vector<int>* tempPrimitives = &this->tempPrimitives_;
+    std::vector<int>* histograms = &this->histograms_;
+    tempCodes->resize(N);
+    tempPrimitives->resize(N);
+    histograms->resize(taskCount * 256);
+
+    // LSD radix sort, 8 bits per pass. Each task counts and scatters its own range, and the ranges are
+    // placed in task order, so the sort is stable and does not depend on the number of threads.
+    for (int pass = 0; pass < passes; pass++) {
+        int shift = pass * 8;
+
+        this->runTasks_(taskCount, [&](int task) {
+            int* histogram = &histograms->at(task * 256);
+            std::fill(histogram, histogram + 256, 0);
+            int end = std::min(N, (task + 1) * LinearBVH_taskSize);
+            for (int i = task * LinearBVH_taskSize; i < end; i++) {
+                histogram[(codes->at(i) >> shift) & 0xff]++;
+            }
+        });
+
+        // Turn the counts into start offsets
+        int offset = 0;
+        bool sorted = false;
+        for (int digit = 0; digit < 256; digit++) {
+            int start = offset;
+            for (int task = 0; task < taskCount; task++) {
+                int count = histograms->at(task * 256 + digit);
+                histograms->at(task * 256 + digit) = offset;
+                offset += count;
+            }
+
+            // All codes have the same digit, nothing to do in this pass
+            if (offset - start == N) {
+                sorted = true;
+            }
+        }
+        if (sorted) {
+            continue;
+        }
+
+        this->runTasks_(taskCount, [&](int task) {
+            int* histogram = &histograms->at(task * 256);
+            int end = std::min(N, (task + 1) * LinearBVH_taskSize);
+            for (int i = task * LinearBVH_taskSize; i < end; i++) {
+                int j = histogram[(codes->at(i) >> shift) & 0xff]++;
+                tempCodes->at(j) = codes->at(i);
+                tempPrimitives->at(j) = primitives->at(i);
+            }
+        });
+
+        codes->swap(*tempCodes);
+        primitives->swap(*tempPrimitives);
+    }
+}
+
+int LinearBVH::findSplit_(int begin, int end) {
+    unsigned long long first = this->codes_[begin];
+    unsigned long long last = this->codes_[end - 1];
+
+    // Same code for all, split in the middle
+    if (first == last) {
+        return (begin + end) / 2;
+    }
+
+    // Binary search for the last code that shares more than the common prefix with the first one
+    int prefix = __builtin_clzll(first ^ last);
+    int split = begin;
+    int step = end - 1 - begin;
+    do {
+        step = (step + 1) >> 1;
+        int newSplit = split + step;
+        if (newSplit < end - 1 && __builtin_clzll(first ^ this->codes_[newSplit]) > prefix) {
+            split = newSplit;
+        }
+    } while (step > 1);
+
+    return split + 1;
+}
+
+int LinearBVH::emitNode_(std::vector<Collision::AABB>* aabbs, int begin, int end) {
+    int index = this->nodes.size();
+    this->nodes.push_back(LinearBVHNode());
+
+    if (end - begin <= this->maxLeafSize) {
+        LinearBVHNode* node = &this->nodes[index];
+        node->offset = begin;
+        node->count = end - begin;
+        for (int i = begin; i < end; i++) {
+            Collision::AABB* aabb = &aabbs->at(this->primitives[i]);
+            float lo[3] = { aabb->lowerBound.x, aabb->lowerBound.y, aabb->lowerBound.z };
+            float hi[3] = { aabb->upperBound.x, aabb->upperBound.y, aabb->upperBound.z };
+            for (int k = 0; k < 3; k++) {
+                node->lowerBound[k] = i == begin ? lo[k] : std::min(node->lowerBound[k], lo[k]);
+                node->upperBound[k] = i == begin ? hi[k] : std::max(node->upperBound[k], hi[k]);
+            }
+        }
+        return index;
+    }
+
+    int split = this->findSplit_(begin, end);
+    this->emitNode_(aabbs, begin, split);
+    int second = this->emitNode_(aabbs, split, end);
+
+    // The node list may have grown, so look the nodes up again
+    LinearBVHNode* node = &this->nodes[index];
+    LinearBVHNode* child1 = &this->nodes[index + 1];
+    LinearBVHNode* child2 = &this->nodes[second];
+    node->offset = second;
+    node->count = 0;
+    for (int k = 0; k < 3; k++) {
+        node->lowerBound[k] = std::min(child1->lowerBound[k], child2->lowerBound[k]);
+        node->upperBound[k] = std::max(child1->upperBound[k], child2->upperBound[k]);
+    }
+    return index;
+}
+
+void LinearBVH::build(std::vector<Collision::AABB>* aabbs) {
+    this->reset();
+
+    int N = aabbs->size();
+    if (N == 0) {
+        return;
+    }
+
+    int taskCount = (N + LinearBVH_taskSize - 1) / LinearBVH_taskSize;
+    this->computeCodes_(aabbs, taskCount);
+    this->sortCodes_(taskCount);
+
+    // At most 2N - 1 nodes
+    this->nodes.reserve(2 * N);
+    this->emitNode_(aabbs, 0, N);
+}
+
+void LinearBVH::reset() {
+    this->nodes.clear();
+    this->primitives.clear();
+    this->codes_.clear();
+}
+
+std::vector<int>* LinearBVH::aabbQuery(Collision::AABB* aabb, std::vector<int>* result) {
+    if (this->nodes.empty()) {
+        return result;
+    }
+
+    float lo[3] = { aabb->lowerBound.x, aabb->lowerBound.y, aabb->lowerBound.z };
+    float hi[3] = { aabb->upperBound.x, aabb->upperBound.y, aabb->upperBound.z };
+
+    std::vector<int>* stack = &this->stack_;
+    stack->clear();
+    stack->push_back(0);
+
+    while (!stack->empty()) {
+        int nodeId = stack->back();
+        stack->pop_back();
+        LinearBVHNode* node = &this->nodes[nodeId];
+
+        if (node->lowerBound[0] > hi[0] || node->upperBound[0] < lo[0]
+            || node->lowerBound[1] > hi[1] || node->upperBound[1] < lo[1]
+            || node->lowerBound[2] > hi[2] || node->upperBound[2] < lo[2]) {
+            continue;
+        }
+
+        if (node->count > 0) {
+            for (int i = node->offset; i < node->offset + node->count; i++) {
+                result->push_back(this->primitives[i]);
+            }
+        } else {
+            stack->push_back(node->offset);
+            stack->push_back(nodeId + 1);
+        }
+    }
+
+    return result;
+}
+
+std::vector<int>* LinearBVH::rayQuery(Math::Vec3* from, Math::Vec3* to, std::vector<int>* result) {
+    if (this->nodes.empty()) {
+        return result;
+    }
+
+    // Slab test against the segment, parametrized as from + t * (to - from) with t in [0, 1]
+    float d[3] = { to->x - from->x, to->y - from->y, to->z - from->z };
+    float inv[3] = { 1.0f / d[0], 1.0f / d[1], 1.0f / d[2] };
+    float o[3] = { from->x, from->y, from->z };
+
+    std::vector<int>* stack = &this->stack_;
+    stack->clear();
+    stack->push_back(0);
+
+    while (!stack->empty()) {
+        int nodeId = stack->back();
+        stack->pop_back();
+        LinearBVHNode* node = &this->nodes[nodeId];
+
+        float tmin = 0;
+        float tmax = 1;
+        bool hit = true;
+        for (int i = 0; i < 3; i++) {
+            if (d[i] == 0) {
+                // Parallel to the slab, must start inside it
+                if (o[i] < node->lowerBound[i] || o[i] > node->upperBound[i]) {
+                    hit = false;
+                    break;
+                }
+                continue;
+            }
+            float t1 = (node->lowerBound[i] - o[i]) * inv[i];
+            float t2 = (node->upperBound[i] - o[i]) * inv[i];
+            tmin = std::max(tmin, std::min(t1, t2));
+            tmax = std::min(tmax, std::max(t1, t2));
+            if (tmin > tmax) {
+                hit = false;
+                break;
+            }
+        }
+
+        if (!hit) {
+            continue;
+        }
+
+        if (node->count > 0) {
+            for (int i = node->offset; i < node->offset + node->count; i++) {
+                result->push_back(this->primitives[i]);
+            }
+        } else {
+            stack->push_back(node->offset);
+            stack->push_back(nodeId + 1);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,141 @@
+#include "utils/QuantizedTriangleBVH.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace Cannon::Utils;
+
+constexpr int QuantizedTriangleBVH::maxLeafCount;
+constexpr int QuantizedTriangleBVH::maxOffset;
+
+static_assert(sizeof(QuantizedBVHNode) == 16, "Quantized BVH nodes should be 16 bytes");
+
+void QuantizedTriangleBVH::quantize_(float* lo, float* hi, float* parentLo, float* parentHi, QuantizedBVHNode* node) {
+    for (int k = 0; k < 3; k++) {
+        float pl = parentLo[k];
+        float ph = parentHi[k];
+        float extent = ph - pl;
+        if (!(extent > 0)) {
+            node->lowerBound[k] = 0;
+            node->upperBound[k] = 65535;
+            continue;
+        }
+
+        // Round outwards by one more step, then until the decoded box holds the node by a few float steps. A query may decode with slightly different rounding.
+        float margin = (std::abs(pl) + std::abs(ph)) * 5e-7f;
+        int qlo = (int)std::floor((lo[k] - pl) / extent * 65535.0f) - 1;
+        int qhi = (int)std::ceil((hi[k] - pl) / extent * 65535.0f) + 1;
+        qlo = std::max(0, std::min(65535, qlo));
+        qhi = std::max(0, std::min(65535, qhi));
+        while (qlo > 0 && QuantizedTriangleBVH::dequantize(pl, ph, qlo) > lo[k] - margin) {
+            qlo--;
+        }
+        while (qhi < 65535 && QuantizedTriangleBVH::dequantize(pl, ph, qhi) < hi[k] + margin) {
+            qhi++;
+        }
+        node->lowerBound[k] = qlo;
+        node->upperBound[k] = qhi;
+    }
+}
+
+void QuantizedTriangleBVH::emitLeaf_(QuantizedBVHNode* node, int first, int count) {
+    int entry = this->triangles.size();
+    if (entry + 2 + count > maxOffset) {
+        throw std::length_error("Too many triangles for the 27 bit offsets of a QuantizedTriangleBVH");
+    }
+
+    // The range is sorted, so the first triangle is the base
+    int base = this->sourceTriangles_[first];
+    this->triangles.push_back(base & 0xffff);
+    this->triangles.push_back(base >> 16);
+    for (int i = first; i < first + count; i++) {
+        this->triangles.push_back(this->sourceTriangles_[i] - base);
+    }
+    node->offset = entry;
+    node->count = count;
+}
+
+int QuantizedTriangleBVH::emitNode_(TriangleBVH* source, int sourceNode, float* parentLo, float* parentHi, int first, int count) {
+    int index = this->nodes.size();
+    if (index >= maxOffset) {
+        throw std::length_error("Too many nodes for the 27 bit offsets of a QuantizedTriangleBVH");
+    }
+    this->nodes.push_back(QuantizedBVHNode());
+
+    // Box of the node, and the box a query decodes for it
+    float lo[3];
+    float hi[3];
+    LinearBVHNode* from = &source->nodes[sourceNode];
+    std::vector<int>* sorted = &this->sourceTriangles_;
+    if (from->count > 0 && count == from->count) {
+        std::sort(sorted->begin() + first, sorted->begin() + first + count);
+    }
+    bool splitLeaf = from->count > 0 && (count > maxLeafCount || sorted->at(first + count - 1) - sorted->at(first) > 65535);
+    if (count < from->count) {
+        // Half of a split leaf, which keeps the box of the leaf
+        this->nodes[index].lowerBound[0] = this->nodes[index].lowerBound[1] = this->nodes[index].lowerBound[2] = 0;
+        this->nodes[index].upperBound[0] = this->nodes[index].upperBound[1] = this->nodes[index].upperBound[2] = 65535;
+        for (int k = 0; k < 3; k++) {
+            lo[k] = parentLo[k];
+            hi[k] = parentHi[k];
+        }
+    } else {
+        this->quantize_(from->lowerBound, from->upperBound, parentLo, parentHi, &this->nodes[index]);
+        for (int k = 0; k < 3; k++) {
+            lo[k] = QuantizedTriangleBVH::dequantize(parentLo[k], parentHi[k], this->nodes[index].lowerBound[k]);
+            hi[k] = QuantizedTriangleBVH::dequantize(parentLo[k], parentHi[k], this->nodes[index].upperBound[k]);
+        }
+    }
+
+    if (from->count > 0 && !splitLeaf) {
+        this->emitLeaf_(&this->nodes[index], first, count);
+        return index;
+    }
+
+    int second;
+    if (splitLeaf) {
+        int half = count / 2;
+        this->emitNode_(source, sourceNode, lo, hi, first, half);
+        second = this->emitNode_(source, sourceNode, lo, hi, first + half, count - half);
+    } else {
+        this->emitNode_(source, sourceNode + 1, lo, hi, source->nodes[sourceNode + 1].offset, source->nodes[sourceNode + 1].count);
+        second = this->emitNode_(source, from->offset, lo, hi, source->nodes[from->offset].offset, source->nodes[from->offset].count);
+    }
+
+    // The node list may have grown, so look the node up again
+    this->nodes[index].offset = second;
+    this->nodes[index].count = 0;
+    return index;
+}
+
+void QuantizedTriangleBVH::build(TriangleBVH* source) {
+    this->reset();
+    if (source->nodes.empty()) {
+        return;
+    }
+
+    this->sourceTriangles_ = source->triangles;
+
+    LinearBVHNode* root = &source->nodes[0];
+    this->lowerBound.set(root->lowerBound[0], root->lowerBound[1], root->lowerBound[2]);
+    this->upperBound.set(root->upperBound[0], root->upperBound[1], root->upperBound[2]);
+
+    // The root is decoded against its own box, so all its bounds come out exact
+    this->nodes.reserve(source->nodes.size());
+    this->emitNode_(source, 0, root->lowerBound, root->upperBound, root->offset, root->count);
+    this->sourceTriangles_.clear();
+    this->sourceTriangles_.shrink_to_fit();
+}
+
+void QuantizedTriangleBVH::reset() {
+    this->nodes.clear();
+    this->triangles.clear();
+}
+
+std::vector<int>* QuantizedTriangleBVH::aabbQuery(Collision::AABB* aabb, std::vector<int>* result) {
+    this->aabbQuery(aabb, [result](int triangle) {
+        result->push_back(triangle);
+    });
+    return result;
+}
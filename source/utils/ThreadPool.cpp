@@ -0,0 +1,98 @@
+#include "utils/ThreadPool.h"
+
+using namespace Cannon::Utils;
+
+ThreadPool::ThreadPool(int numThreads) {
+    // The caller is thread 0
+    for (int i = 1; i < numThreads; i++) {
+        this->workers_.push_back(std::thread(&ThreadPool::workerLoop_, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->stop_ = true;
+    }
+    this->wakeCondition_.notify_all();
+
+    for (int i = 0; i < this->workers_.size(); i++) {
+        this->workers_[i].join();
+    }
+}
+
+int ThreadPool::size() {
+    return this->workers_.size() + 1;
+}
+
+bool ThreadPool::runNextTask_(int threadIndex) {
+    std::function<void(int, int)> task;
+    int taskIndex;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        if (this->nextTask_ >= this->taskCount_) {
+            return false;
+        }
+        taskIndex = this->nextTask_++;
+        task = this->task_;
+    }
+
+    task(taskIndex, threadIndex);
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->pending_--;
+        if (this->pending_ == 0) {
+            this->doneCondition_.notify_all();
+        }
+    }
+    return true;
+}
+
+void ThreadPool::workerLoop_(int threadIndex) {
+    int generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex_);
+            this->wakeCondition_.wait(lock, [&] {
+                return this->stop_ || this->generation_ != generation;
+            });
+            if (this->stop_) {
+                return;
+            }
+            generation = this->generation_;
+        }
+
+        while (this->runNextTask_(threadIndex)) {}
+    }
+}
+
+void ThreadPool::run(int taskCount, std::function<void(int, int)> task) {
+    if (taskCount <= 0) {
+        return;
+    }
+
+    if (this->workers_.empty()) {
+        for (int i = 0; i < taskCount; i++) {
+            task(i, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->task_ = task;
+        this->taskCount_ = taskCount;
+        this->nextTask_ = 0;
+        this->pending_ = taskCount;
+        this->generation_++;
+    }
+    this->wakeCondition_.notify_all();
+
+    while (this->runNextTask_(0)) {}
+
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    this->doneCondition_.wait(lock, [&] {
+        return this->pending_ == 0;
+    });
+}
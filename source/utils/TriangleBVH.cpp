@@ -0,0 +1,247 @@
+#include "utils/TriangleBVH.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace Cannon::Utils;
+
+constexpr int TriangleBVH::maxDepth;
+constexpr int TriangleBVH::maxBins;
+
+static_assert(sizeof(LinearBVHNode) == 32, "BVH nodes should be 32 bytes");
+
+// Half the surface area of a box, which is enough to compare costs
+static float TriangleBVH_halfArea(float* lo, float* hi) {
+    float dx = hi[0] - lo[0];
+    float dy = hi[1] - lo[1];
+    float dz = hi[2] - lo[2];
+    return dx * dy + dy * dz + dz * dx;
+}
+
+int TriangleBVH::findSplit_(int begin, int end) {
+    // Bounds of the centroids, the bins divide them evenly
+    float centerLo[3];
+    float centerHi[3];
+    for (int k = 0; k < 3; k++) {
+        centerLo[k] = std::numeric_limits<float>::max();
+        centerHi[k] = -std::numeric_limits<float>::max();
+    }
+    for (int i = begin; i < end; i++) {
+        Math::Vec3* c = &this->centroids_[this->triangles[i]];
+        float p[3] = { c->x, c->y, c->z };
+        for (int k = 0; k < 3; k++) {
+            centerLo[k] = std::min(centerLo[k], p[k]);
+            centerHi[k] = std::max(centerHi[k], p[k]);
+        }
+    }
+
+    int bins = std::max(2, std::min(this->binCount, maxBins));
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    int bestBin = 0;
+
+    int counts[maxBins];
+    float binLo[maxBins][3];
+    float binHi[maxBins][3];
+    float rightCosts[maxBins];
+
+    for (int axis = 0; axis < 3; axis++) {
+        float extent = centerHi[axis] - centerLo[axis];
+        if (extent <= 0) {
+            continue;
+        }
+        float scale = bins / extent;
+
+        for (int b = 0; b < bins; b++) {
+            counts[b] = 0;
+            for (int k = 0; k < 3; k++) {
+                binLo[b][k] = std::numeric_limits<float>::max();
+                binHi[b][k] = -std::numeric_limits<float>::max();
+            }
+        }
+
+        for (int i = begin; i < end; i++) {
+            int t = this->triangles[i];
+            Math::Vec3* c = &this->centroids_[t];
+            float p[3] = { c->x, c->y, c->z };
+            int b = std::min(bins - 1, (int)((p[axis] - centerLo[axis]) * scale));
+            Collision::AABB* aabb = &this->triangleAABBs_[t];
+            float lo[3] = { aabb->lowerBound.x, aabb->lowerBound.y, aabb->lowerBound.z };
+            float hi[3] = { aabb->upperBound.x, aabb->upperBound.y, aabb->upperBound.z };
+            counts[b]++;
+            for (int k = 0; k < 3; k++) {
+                binLo[b][k] = std::min(binLo[b][k], lo[k]);
+                binHi[b][k] = std::max(binHi[b][k], hi[k]);
+            }
+        }
+
+        // Cost of everything right of each split, swept from the right
+        float lo[3];
+        float hi[3];
+        int count = 0;
+        for (int k = 0; k < 3; k++) {
+            lo[k] = std::numeric_limits<float>::max();
+            hi[k] = -std::numeric_limits<float>::max();
+        }
+        for (int b = bins - 1; b > 0; b--) {
+            count += counts[b];
+            for (int k = 0; k < 3; k++) {
+                lo[k] = std::min(lo[k], binLo[b][k]);
+                hi[k] = std::max(hi[k], binHi[b][k]);
+            }
+            rightCosts[b] = count > 0 ? count * TriangleBVH_halfArea(lo, hi) : -1;
+        }
+
+        // Add the cost of the left side, split between bin b - 1 and b
+        count = 0;
+        for (int k = 0; k < 3; k++) {
+            lo[k] = std::numeric_limits<float>::max();
+            hi[k] = -std::numeric_limits<float>::max();
+        }
+        for (int b = 1; b < bins; b++) {
+            count += counts[b - 1];
+            for (int k = 0; k < 3; k++) {
+                lo[k] = std::min(lo[k], binLo[b - 1][k]);
+                hi[k] = std::max(hi[k], binHi[b - 1][k]);
+            }
+            if (count == 0 || rightCosts[b] < 0) {
+                continue;
+            }
+            float cost = count * TriangleBVH_halfArea(lo, hi) + rightCosts[b];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = b;
+            }
+        }
+    }
+
+    // All centroids in one point, split the range in the middle
+    if (bestAxis == -1) {
+        return (begin + end) / 2;
+    }
+
+    float scale = bins / (centerHi[bestAxis] - centerLo[bestAxis]);
+    float origin = centerLo[bestAxis];
+    int* first = this->triangles.data() + begin;
+    int* last = this->triangles.data() + end;
+    int* middle = std::partition(first, last, [&](int t) {
+        Math::Vec3* c = &this->centroids_[t];
+        float p = bestAxis == 0 ? c->x : bestAxis == 1 ? c->y : c->z;
+        return std::min(bins - 1, (int)((p - origin) * scale)) < bestBin;
+    });
+    return begin + (middle - first);
+}
+
+int TriangleBVH::buildNode_(int begin, int end, int depth) {
+    int index = this->nodes.size();
+    this->nodes.push_back(LinearBVHNode());
+
+    if (end - begin <= this->maxLeafSize || depth + 1 >= maxDepth) {
+        LinearBVHNode* node = &this->nodes[index];
+        node->offset = begin;
+        node->count = end - begin;
+        for (int i = begin; i < end; i++) {
+            Collision::AABB* aabb = &this->triangleAABBs_[this->triangles[i]];
+            float lo[3] = { aabb->lowerBound.x, aabb->lowerBound.y, aabb->lowerBound.z };
+            float hi[3] = { aabb->upperBound.x, aabb->upperBound.y, aabb->upperBound.z };
+            for (int k = 0; k < 3; k++) {
+                node->lowerBound[k] = i == begin ? lo[k] : std::min(node->lowerBound[k], lo[k]);
+                node->upperBound[k] = i == begin ? hi[k] : std::max(node->upperBound[k], hi[k]);
+            }
+        }
+        return index;
+    }
+
+    int split = this->findSplit_(begin, end);
+    this->buildNode_(begin, split, depth + 1);
+    int second = this->buildNode_(split, end, depth + 1);
+
+    // The node list may have grown, so look the nodes up again
+    LinearBVHNode* node = &this->nodes[index];
+    LinearBVHNode* child1 = &this->nodes[index + 1];
+    LinearBVHNode* child2 = &this->nodes[second];
+    node->offset = second;
+    node->count = 0;
+    for (int k = 0; k < 3; k++) {
+        node->lowerBound[k] = std::min(child1->lowerBound[k], child2->lowerBound[k]);
+        node->upperBound[k] = std::max(child1->upperBound[k], child2->upperBound[k]);
+    }
+    return index;
+}
+
+void TriangleBVH::build(std::vector<float>* vertices, std::vector<int>* indices) {
+    this->reset();
+
+    int N = indices->size() / 3;
+    if (N == 0) {
+        return;
+    }
+
+    this->triangleAABBs_.resize(N);
+    this->centroids_.resize(N);
+    this->triangles.resize(N);
+    for (int t = 0; t < N; t++) {
+        Collision::AABB* aabb = &this->triangleAABBs_[t];
+        for (int v = 0; v < 3; v++) {
+            int i = indices->at(t * 3 + v) * 3;
+            float x = vertices->at(i);
+            float y = vertices->at(i + 1);
+            float z = vertices->at(i + 2);
+            if (v == 0) {
+                aabb->lowerBound.set(x, y, z);
+                aabb->upperBound.set(x, y, z);
+            } else {
+                aabb->lowerBound.set(std::min(aabb->lowerBound.x, x), std::min(aabb->lowerBound.y, y), std::min(aabb->lowerBound.z, z));
+                aabb->upperBound.set(std::max(aabb->upperBound.x, x), std::max(aabb->upperBound.y, y), std::max(aabb->upperBound.z, z));
+            }
+        }
+        aabb->lowerBound.vadd(&aabb->upperBound, &this->centroids_[t]);
+        this->centroids_[t].scale(0.5, &this->centroids_[t]);
+        this->triangles[t] = t;
+    }
+
+    this->nodes.reserve(2 * N / std::max(1, this->maxLeafSize) + 1);
+    this->buildNode_(0, N, 0);
+
+    // The build data is as large as the mesh, so give it back
+    std::vector<Collision::AABB>().swap(this->triangleAABBs_);
+    std::vector<Math::Vec3>().swap(this->centroids_);
+}
+
+void TriangleBVH::reset() {
+    this->nodes.clear();
+    this->triangles.clear();
+}
+
+std::vector<int>* TriangleBVH::aabbQuery(Collision::AABB* aabb, std::vector<int>* result) {
+    this->aabbQuery(aabb, [result](int triangle) {
+        result->push_back(triangle);
+    });
+    return result;
+}
+
+int TriangleBVH::getDepth() {
+    if (this->nodes.empty()) {
+        return 0;
+    }
+
+    // Node and depth pairs
+    std::vector<int> stack = { 0, 1 };
+    int depth = 0;
+    while (!stack.empty()) {
+        int nodeDepth = stack.back();
+        stack.pop_back();
+        int nodeId = stack.back();
+        stack.pop_back();
+        depth = std::max(depth, nodeDepth);
+        LinearBVHNode* node = &this->nodes[nodeId];
+        if (node->count == 0) {
+            stack.push_back(node->offset);
+            stack.push_back(nodeDepth + 1);
+            stack.push_back(nodeId + 1);
+            stack.push_back(nodeDepth + 1);
+        }
+    }
+    return depth;
+}
@@ -0,0 +1,1656 @@
+#include "world/Narrowphase.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+#include "world/World.h"
+
+using namespace Cannon::World;
+
+template<class T>
+void Narrowphase::takeFromPool_(std::vector<T*>* shared, std::vector<T*>* target) {
+    if (shared == nullptr) {
+        return;
+    }
+
+    // Take a few at a time, so the lock is rarely needed
+    std::lock_guard<std::mutex> lock(this->poolMutex_);
+    for (int i = 0; i < 16 && !shared->empty(); i++) {
+        target->push_back(shared->back());
+        shared->pop_back();
+    }
+}
+
+Cannon::Equations::ContactEquation* Narrowphase::createContactEquation(
+    Objects::Body* bi,
+    Objects::Body* bj,
+    Shapes::Shape* si,
+    Shapes::Shape* sj,
+    Shapes::Shape* overrideShapeA,
+    Shapes::Shape* overrideShapeB) {
+    Equations::ContactEquation* c;
+    if (this->parent_ != nullptr && this->contactPointPool->empty()) {
+        this->parent_->takeFromPool_(this->parent_->contactPointPool, this->contactPointPool);
+    }
+    if (this->contactPointPool != nullptr && !this->contactPointPool->empty()) {
+        c = this->contactPointPool->back();
+        this->contactPointPool->pop_back();
+        c->bi = bi;
+        c->bj = bj;
+    } else {
+        c = new Equations::ContactEquation(bi, bj);
+    }
+
+    c->enabled = bi->collisionResponse && bj->collisionResponse && si->collisionResponse && sj->collisionResponse;
+    c->speculative = false;
+
+    Material::ContactMaterial* cm = this->currentContactMaterial;
+    if (cm != nullptr) {
+        c->restitution = cm->restitution;
+        if (this->world_ != nullptr) {
+            c->setSpookParams(cm->contactEquationStiffness, cm->contactEquationRelaxation, this->world_->dt);
+        }
+    }
+
+    Material::Material* matA = si->material != nullptr ? si->material : bi->material;
+    Material::Material* matB = sj->material != nullptr ? sj->material : bj->material;
+    if (matA != nullptr && matB != nullptr && matA->restitution >= 0 && matB->restitution >= 0) {
+        c->restitution = matA->restitution * matB->restitution;
+    }
+
+    c->si = overrideShapeA != nullptr ? overrideShapeA : si;
+    c->sj = overrideShapeB != nullptr ? overrideShapeB : sj;
+
+    return c;
+}
+
+namespace {
+
+using Cannon::Math::Vec3;
+using Cannon::Math::Quaternion;
+using Cannon::Objects::Body;
+using Cannon::Shapes::Shape;
+using Cannon::Shapes::ShapeTypes;
+
+typedef bool (*Collider)(Narrowphase*, Shape*, Shape*, Vec3*, Vec3*, Quaternion*, Quaternion*, Body*, Body*, bool);
+
+// Number of shape types, and the bit position of a type
+constexpr int numShapeTypes = 10;
+constexpr int typeIndex(int type) {
+    return type <= 1 ? 0 : 1 + typeIndex(type >> 1);
+}
+
+inline int shapeTypeIndex(Shape* shape) {
+#if defined(__GNUC__)
+    return __builtin_ctz(shape->type);
+#else
+    return typeIndex(shape->type);
+#endif
+}
+
+// Shape types that implement supportPoint() and can fall back to GJK
+template<int I> struct IsConvex { static constexpr bool value = false; };
+template<> struct IsConvex<typeIndex(ShapeTypes::SPHERE)> { static constexpr bool value = true; };
+template<> struct IsConvex<typeIndex(ShapeTypes::BOX)> { static constexpr bool value = true; };
+template<> struct IsConvex<typeIndex(ShapeTypes::CONVEXPOLYHEDRON)> { static constexpr bool value = true; };
+template<> struct IsConvex<typeIndex(ShapeTypes::CYLINDER)> { static constexpr bool value = true; };
+template<> struct IsConvex<typeIndex(ShapeTypes::CAPSULE)> { static constexpr bool value = true; };
+
+// The routine for shape type indices I <= J, called with si of type I and sj of type J
+template<int I, int J>
+struct Route {
+    static constexpr bool exists = IsConvex<I>::value && IsConvex<J>::value;
+    static bool call(Narrowphase* np, Shape* si, Shape* sj, Vec3* xi, Vec3* xj, Quaternion* qi, Quaternion* qj, Body* bi, Body* bj, bool justTest) {
+        return np->convexGJK(si, sj, xi, xj, qi, qj, bi, bj, si, sj, justTest);
+    }
+};
+
+#define NARROWPHASE_ROUTE(TYPE_I, TYPE_J, CLASS_I, CLASS_J, ROUTINE) \
+    template<> \
+    struct Route<typeIndex(ShapeTypes::TYPE_I), typeIndex(ShapeTypes::TYPE_J)> { \
+        static constexpr bool exists = true; \
+        static bool call(Narrowphase* np, Shape* si, Shape* sj, Vec3* xi, Vec3* xj, Quaternion* qi, Quaternion* qj, Body* bi, Body* bj, bool justTest) { \
+            return np->ROUTINE((Cannon::Shapes::CLASS_I*)si, (Cannon::Shapes::CLASS_J*)sj, xi, xj, qi, qj, bi, bj, si, sj, justTest); \
+        } \
+    };
+
+NARROWPHASE_ROUTE(SPHERE, SPHERE, Sphere, Sphere, sphereSphere)
+NARROWPHASE_ROUTE(SPHERE, PLANE, Sphere, Plane, spherePlane)
+NARROWPHASE_ROUTE(PLANE, BOX, Plane, Box, planeBox)
+NARROWPHASE_ROUTE(PLANE, CONVEXPOLYHEDRON, Plane, ConvexPolyhedron, planeConvex)
+NARROWPHASE_ROUTE(BOX, BOX, Box, Box, boxBox)
+NARROWPHASE_ROUTE(BOX, CONVEXPOLYHEDRON, Box, ConvexPolyhedron, boxConvex)
+NARROWPHASE_ROUTE(SPHERE, CYLINDER, Sphere, Cylinder, sphereCylinder)
+NARROWPHASE_ROUTE(PLANE, CYLINDER, Plane, Cylinder, planeCylinder)
+NARROWPHASE_ROUTE(SPHERE, CAPSULE, Sphere, Capsule, sphereCapsule)
+NARROWPHASE_ROUTE(PLANE, CAPSULE, Plane, Capsule, planeCapsule)
+NARROWPHASE_ROUTE(BOX, CAPSULE, Box, Capsule, boxCapsule)
+NARROWPHASE_ROUTE(CAPSULE, CAPSULE, Capsule, Capsule, capsuleCapsule)
+NARROWPHASE_ROUTE(SPHERE, TRIMESH, Sphere, Trimesh, sphereTrimesh)
+NARROWPHASE_ROUTE(BOX, TRIMESH, Shape, Trimesh, convexTrimesh)
+NARROWPHASE_ROUTE(CONVEXPOLYHEDRON, TRIMESH, Shape, Trimesh, convexTrimesh)
+NARROWPHASE_ROUTE(CYLINDER, TRIMESH, Shape, Trimesh, convexTrimesh)
+
+#undef NARROWPHASE_ROUTE
+
+template<>
+struct Route<typeIndex(ShapeTypes::CONVEXPOLYHEDRON), typeIndex(ShapeTypes::CONVEXPOLYHEDRON)> {
+    static constexpr bool exists = true;
+    static bool call(Narrowphase* np, Shape* si, Shape* sj, Vec3* xi, Vec3* xj, Quaternion* qi, Quaternion* qj, Body* bi, Body* bj, bool justTest) {
+        return np->convexConvex((Cannon::Shapes::ConvexPolyhedron*)si, (Cannon::Shapes::ConvexPolyhedron*)sj, xi, xj, qi, qj, bi, bj, si, sj, justTest, nullptr, nullptr);
+    }
+};
+
+// Capsules have a higher type than trimeshes, but convexTrimesh takes the convex shape first
+template<>
+struct Route<typeIndex(ShapeTypes::TRIMESH), typeIndex(ShapeTypes::CAPSULE)> {
+    static constexpr bool exists = true;
+    static bool call(Narrowphase* np, Shape* si, Shape* sj, Vec3* xi, Vec3* xj, Quaternion* qi, Quaternion* qj, Body* bi, Body* bj, bool justTest) {
+        return np->convexTrimesh(sj, (Cannon::Shapes::Trimesh*)si, xj, xi, qj, qi, bj, bi, sj, si, justTest);
+    }
+};
+
+// Like cannon.js, the pair is passed on in its own order only if the type of si is lower, so bi is the body of the lower type
+template<int I, int J>
+bool collide(Narrowphase* np, Shape* si, Shape* sj, Vec3* xi, Vec3* xj, Quaternion* qi, Quaternion* qj, Body* bi, Body* bj, bool justTest) {
+    if (I < J) {
+        return Route<(I < J ? I : J), (I < J ? J : I)>::call(np, si, sj, xi, xj, qi, qj, bi, bj, justTest);
+    }
+    return Route<(I < J ? I : J), (I < J ? J : I)>::call(np, sj, si, xj, xi, qj, qi, bj, bi, justTest);
+}
+
+template<int I, int J>
+constexpr Collider colliderFor() {
+    return Route<(I < J ? I : J), (I < J ? J : I)>::exists ? &collide<I, J> : nullptr;
+}
+
+template<int I, int... J>
+constexpr std::array<Collider, numShapeTypes> dispatchRow(std::integer_sequence<int, J...>) {
+    return {{ colliderFor<I, J>()... }};
+}
+
+template<int... I>
+constexpr std::array<std::array<Collider, numShapeTypes>, numShapeTypes> dispatchTable(std::integer_sequence<int, I...> indices) {
+    return {{ dispatchRow<I>(indices)... }};
+}
+
+// Collider of each pair of shape type indices, or nullptr if the pair does not collide
+constexpr std::array<std::array<Collider, numShapeTypes>, numShapeTypes> colliders =
+    dispatchTable(std::make_integer_sequence<int, numShapeTypes>());
+
+}
+
+// Give the equations from index begin on consecutive ids, starting at nextId
+template<class T>
+static void Narrowphase_numberEquations(std::vector<T*>* equations, int begin, int* nextId) {
+    if (equations == nullptr) {
+        return;
+    }
+    for (int i = begin; i < equations->size(); i++) {
+        equations->at(i)->id = (*nextId)++;
+    }
+}
+
+Narrowphase::~Narrowphase() {
+    for (int i = 0; i != this->workers_.size(); i++) {
+        delete this->workers_[i];
+    }
+}
+
+void Narrowphase::getContacts(
+    std::vector<Objects::Body*>* p1,
+    std::vector<Objects::Body*>* p2,
+    World* world,
+    std::vector<Equations::ContactEquation*>* result,
+    std::vector<Equations::ContactEquation*>* oldcontacts,
+    std::vector<Equations::FrictionEquation*>* frictionResult,
+    std::vector<Equations::FrictionEquation*>* frictionPool) {
+    // Save old contact objects
+    this->contactPointPool = oldcontacts;
+    this->frictionEquationPool = frictionPool;
+    this->result = result;
+    this->frictionResult = frictionResult;
+
+    // The equations are numbered here in result order, so that their ids do not depend on the threads or on which pooled equations they reuse
+    int nextId = Equations::Equation::idCounter;
+    int firstContact = result->size();
+    int firstFriction = frictionResult != nullptr ? frictionResult->size() : 0;
+
+    int count = p1->size();
+    this->updateShapeTrees_(p1, p2);
+    this->separatingAxisCache.update();
+    if (this->threadPool == nullptr) {
+        this->axisCache_ = &this->separatingAxisCache;
+        this->collidePairs_(p1, p2, world, 0, count);
+        Narrowphase_numberEquations(result, firstContact, &nextId);
+        Narrowphase_numberEquations(frictionResult, firstFriction, &nextId);
+        Equations::Equation::idCounter = nextId;
+        return;
+    }
+
+    int chunkSize = this->pairsPerTask > 0 ? this->pairsPerTask : 1;
+    int taskCount = (count + chunkSize - 1) / chunkSize;
+    int threadCount = this->threadPool->size();
+
+    // Each worker has its own pools, which it fills from the shared ones when empty
+    while (this->workers_.size() < threadCount) {
+        this->workers_.push_back(new Narrowphase(this->world_));
+    }
+    if (this->threadContactPools_.size() < threadCount) {
+        this->threadContactPools_.resize(threadCount);
+        this->threadFrictionPools_.resize(threadCount);
+    }
+    if (this->taskResults_.size() < taskCount) {
+        this->taskResults_.resize(taskCount);
+        this->taskFrictionResults_.resize(taskCount);
+        this->taskAxisCaches_.resize(taskCount);
+    }
+
+    for (int t = 0; t < threadCount; t++) {
+        Narrowphase* worker = this->workers_[t];
+        worker->parent_ = this;
+        worker->contactPointPool = &this->threadContactPools_[t];
+        worker->frictionEquationPool = &this->threadFrictionPools_[t];
+        worker->enableFrictionReduction = this->enableFrictionReduction;
+        worker->enableContactReduction = this->enableContactReduction;
+        worker->gjk.maxIterations = this->gjk.maxIterations;
+        worker->gjk.tolerance = this->gjk.tolerance;
+        worker->gjk.maxEPAIterations = this->gjk.maxEPAIterations;
+        worker->gjk.epaTolerance = this->gjk.epaTolerance;
+        worker->boxBoxCollider.edgeBias = this->boxBoxCollider.edgeBias;
+        worker->shapeTreeMinShapes = this->shapeTreeMinShapes;
+    }
+
+    this->threadPool->run(taskCount, [&](int task, int thread) {
+        Narrowphase* worker = this->workers_[thread];
+        worker->result = &this->taskResults_[task];
+        worker->frictionResult = &this->taskFrictionResults_[task];
+        worker->result->clear();
+        worker->frictionResult->clear();
+        worker->axisCache_ = &this->taskAxisCaches_[task];
+        worker->axisCache_->setSource(&this->separatingAxisCache);
+        worker->collidePairs_(p1, p2, world, task * chunkSize, std::min(count, (task + 1) * chunkSize));
+    });
+
+    // Merge in task order
+    for (int task = 0; task < taskCount; task++) {
+        this->taskAxisCaches_[task].flush();
+        result->insert(result->end(), this->taskResults_[task].begin(), this->taskResults_[task].end());
+        if (frictionResult != nullptr) {
+            frictionResult->insert(frictionResult->end(), this->taskFrictionResults_[task].begin(), this->taskFrictionResults_[task].end());
+        }
+    }
+    Narrowphase_numberEquations(result, firstContact, &nextId);
+    Narrowphase_numberEquations(frictionResult, firstFriction, &nextId);
+    Equations::Equation::idCounter = nextId;
+
+    // Give back what the threads did not use
+    for (int t = 0; t < threadCount; t++) {
+        if (oldcontacts != nullptr) {
+            oldcontacts->insert(oldcontacts->end(), this->threadContactPools_[t].begin(), this->threadContactPools_[t].end());
+        }
+        if (frictionPool != nullptr) {
+            frictionPool->insert(frictionPool->end(), this->threadFrictionPools_[t].begin(), this->threadFrictionPools_[t].end());
+        }
+        this->threadContactPools_[t].clear();
+        this->threadFrictionPools_[t].clear();
+    }
+}
+
+void Narrowphase::updateShapeTrees_(std::vector<Objects::Body*>* p1, std::vector<Objects::Body*>* p2) {
+    for (int k = 0; k != p1->size(); k++) {
+        Objects::Body* bi = p1->at(k);
+        Objects::Body* bj = p2->at(k);
+        if (bi->shapeTreeNeedsUpdate && bi->shapes.size() >= this->shapeTreeMinShapes) {
+            bi->updateShapeTree();
+        }
+        if (bj->shapeTreeNeedsUpdate && bj->shapes.size() >= this->shapeTreeMinShapes) {
+            bj->updateShapeTree();
+        }
+    }
+}
+
+thread_local Cannon::Math::Quaternion Narrowphase_collidePairs_qi;
+thread_local Cannon::Math::Quaternion Narrowphase_collidePairs_qj;
+thread_local Cannon::Math::Vec3 Narrowphase_collidePairs_xi;
+thread_local Cannon::Math::Vec3 Narrowphase_collidePairs_xj;
+thread_local Cannon::Math::Quaternion Narrowphase_collidePairs_treeQuatInv;
+thread_local Cannon::Math::Quaternion Narrowphase_collidePairs_localQuat;
+thread_local Cannon::Math::Vec3 Narrowphase_collidePairs_localPos;
+thread_local Cannon::Collision::AABB Narrowphase_collidePairs_localAABB;
+void Narrowphase::collidePairs_(
+    std::vector<Objects::Body*>* p1,
+    std::vector<Objects::Body*>* p2,
+    World* world,
+    int begin,
+    int end) {
+    Math::Quaternion* qi = &Narrowphase_collidePairs_qi;
+    Math::Quaternion* qj = &Narrowphase_collidePairs_qj;
+    Math::Vec3* xi = &Narrowphase_collidePairs_xi;
+    Math::Vec3* xj = &Narrowphase_collidePairs_xj;
+
+    for (int k = begin; k != end; k++) {
+        // Get current collision bodies
+        Objects::Body* bi = p1->at(k);
+        Objects::Body* bj = p2->at(k);
+
+        bool justTest =
+            ((bi->type & Objects::BodyType::KINEMATIC) && (bj->type & Objects::BodyType::STATIC)) ||
+            ((bi->type & Objects::BodyType::STATIC) && (bj->type & Objects::BodyType::KINEMATIC)) ||
+            ((bi->type & Objects::BodyType::KINEMATIC) && (bj->type & Objects::BodyType::KINEMATIC));
+
+        // Fast bodies also collide with what they reach within the next step
+        bool speculative = !justTest && (bi->ccd || bj->ccd);
+        float margin = 0;
+        if (speculative) {
+            Math::Vec3 relativeVelocity;
+            bi->velocity.vsub(&bj->velocity, &relativeVelocity);
+            margin = relativeVelocity.length() * this->ccdTimeStep_(bi, bj);
+        }
+
+        bool treeI = bi->shapes.size() >= this->shapeTreeMinShapes;
+        bool treeJ = bj->shapes.size() >= this->shapeTreeMinShapes;
+        if (!treeI && !treeJ) {
+            for (int i = 0; i < bi->shapes.size(); i++) {
+                bi->quaternion.mult(&bi->shapeOrientations[i], qi);
+                bi->quaternion.vmult(&bi->shapeOffsets[i], xi);
+                xi->vadd(&bi->position, xi);
+
+                for (int j = 0; j < bj->shapes.size(); j++) {
+                    // Compute world transform of shapes
+                    bj->quaternion.mult(&bj->shapeOrientations[j], qj);
+                    bj->quaternion.vmult(&bj->shapeOffsets[j], xj);
+                    xj->vadd(&bj->position, xj);
+
+                    this->collideShapes_(bi->shapes[i], bj->shapes[j], xi, xj, qi, qj, bi, bj, world, justTest, speculative, margin);
+                }
+            }
+            continue;
+        }
+
+        // Query the tree of the body with the most shapes with the shapes of the other, in the local space of the tree body
+        bool treeIsJ = treeJ && (!treeI || bj->shapes.size() >= bi->shapes.size());
+        Objects::Body* treeBody = treeIsJ ? bj : bi;
+        Objects::Body* otherBody = treeIsJ ? bi : bj;
+        Math::Vec3* xTree = treeIsJ ? xj : xi;
+        Math::Vec3* xOther = treeIsJ ? xi : xj;
+        Math::Quaternion* qTree = treeIsJ ? qj : qi;
+        Math::Quaternion* qOther = treeIsJ ? qi : qj;
+        Math::Quaternion* treeQuatInv = &Narrowphase_collidePairs_treeQuatInv;
+        Math::Quaternion* localQuat = &Narrowphase_collidePairs_localQuat;
+        Math::Vec3* localPos = &Narrowphase_collidePairs_localPos;
+        Collision::AABB* localAABB = &Narrowphase_collidePairs_localAABB;
+        treeBody->quaternion.conjugate(treeQuatInv);
+
+        for (int o = 0; o < otherBody->shapes.size(); o++) {
+            Shapes::Shape* otherShape = otherBody->shapes[o];
+            otherBody->quaternion.mult(&otherBody->shapeOrientations[o], qOther);
+            otherBody->quaternion.vmult(&otherBody->shapeOffsets[o], xOther);
+            xOther->vadd(&otherBody->position, xOther);
+
+            treeQuatInv->mult(qOther, localQuat);
+            xOther->vsub(&treeBody->position, localPos);
+            treeQuatInv->vmult(localPos, localPos);
+            otherShape->calculateWorldAABB(localPos, localQuat, &localAABB->lowerBound, &localAABB->upperBound);
+            localAABB->lowerBound.x -= margin;
+            localAABB->lowerBound.y -= margin;
+            localAABB->lowerBound.z -= margin;
+            localAABB->upperBound.x += margin;
+            localAABB->upperBound.y += margin;
+            localAABB->upperBound.z += margin;
+
+            // In shape order, so the contacts do not depend on the shape of the tree
+            this->shapeTreeResult_.clear();
+            treeBody->shapeTree.aabbQuery(localAABB, &this->shapeTreeResult_, &this->shapeTreeStack_);
+            std::sort(this->shapeTreeResult_.begin(), this->shapeTreeResult_.end());
+
+            for (int t = 0; t < this->shapeTreeResult_.size(); t++) {
+                int index = this->shapeTreeResult_[t];
+                treeBody->quaternion.mult(&treeBody->shapeOrientations[index], qTree);
+                treeBody->quaternion.vmult(&treeBody->shapeOffsets[index], xTree);
+                xTree->vadd(&treeBody->position, xTree);
+
+                this->collideShapes_(
+                    bi->shapes[treeIsJ ? o : index],
+                    bj->shapes[treeIsJ ? index : o],
+                    xi, xj, qi, qj, bi, bj, world, justTest, speculative, margin);
+            }
+        }
+    }
+}
+
+void Narrowphase::collideShapes_(
+    Shapes::Shape* si,
+    Shapes::Shape* sj,
+    Math::Vec3* xi,
+    Math::Vec3* xj,
+    Math::Quaternion* qi,
+    Math::Quaternion* qj,
+    Objects::Body* bi,
+    Objects::Body* bj,
+    World* world,
+    bool justTest,
+    bool speculative,
+    float margin) {
+    if (!((si->collisionFilterMask & sj->collisionFilterGroup) && (sj->collisionFilterMask & si->collisionFilterGroup))) {
+        return;
+    }
+
+    if (xi->distanceTo(xj) > si->boundingSphereRadius + sj->boundingSphereRadius + margin) {
+        return;
+    }
+
+    // Contact materials between shapes and bodies are looked up by the World, which is not ported yet
+    this->currentContactMaterial = world != nullptr ? world->defaultContactMaterial : nullptr;
+
+    Collider collider = colliders[shapeTypeIndex(si)][shapeTypeIndex(sj)];
+    bool collided = collider != nullptr && collider(this, si, sj, xi, xj, qi, qj, bi, bj, justTest);
+    if (!collided && speculative) {
+        this->speculativeContact_(si, sj, xi, xj, qi, qj, bi, bj);
+    }
+}
+
+float Narrowphase::ccdTimeStep_(Objects::Body* bi, Objects::Body* bj) {
+    return std::max(bi->ccd ? bi->ccdTimeStep : 0.0f, bj->ccd ? bj->ccdTimeStep : 0.0f);
+}
+
+thread_local Cannon::Math::Quaternion speculativeContact_conjugate;
+thread_local Cannon::Math::Vec3 speculativeContact_direction;
+thread_local Cannon::Math::Vec3 speculativeContact_support;
+thread_local Cannon::Collision::GJKResult speculativeContact_result;
+bool Narrowphase::speculativeContact_(
+    Shapes::Shape* si,
+    Shapes::Shape* sj,
+    Math::Vec3* xi,
+    Math::Vec3* xj,
+    Math::Quaternion* qi,
+    Math::Quaternion* qj,
+    Objects::Body* bi,
+    Objects::Body* bj) {
+    // Closest points of the shapes, and the normal from si to sj
+    Collision::GJKResult* closest = &speculativeContact_result;
+    bool planeI = si->type == Shapes::ShapeTypes::PLANE;
+    bool planeJ = sj->type == Shapes::ShapeTypes::PLANE;
+    if ((planeI && sj->isConvex()) || (planeJ && si->isConvex())) {
+        Shapes::Shape* convexShape = planeI ? sj : si;
+        Math::Vec3* planePos = planeI ? xi : xj;
+        Math::Vec3* convexPos = planeI ? xj : xi;
+        Math::Quaternion* planeQuat = planeI ? qi : qj;
+        Math::Quaternion* convexQuat = planeI ? qj : qi;
+        Math::Vec3* planePoint = planeI ? &closest->pointA : &closest->pointB;
+        Math::Vec3* convexPoint = planeI ? &closest->pointB : &closest->pointA;
+
+        // The point of the convex shape deepest behind the plane
+        Math::Vec3* planeNormal = &speculativeContact_direction;
+        planeNormal->set(0, 0, 1);
+        planeQuat->vmult(planeNormal, planeNormal);
+        Math::Vec3* localDirection = &speculativeContact_support;
+        planeNormal->negate(localDirection);
+        convexQuat->conjugate(&speculativeContact_conjugate);
+        speculativeContact_conjugate.vmult(localDirection, localDirection);
+        convexShape->supportPoint(localDirection, convexPoint);
+        convexQuat->vmult(convexPoint, convexPoint);
+        convexPoint->vadd(convexPos, convexPoint);
+
+        convexPoint->vsub(planePos, planePoint);
+        closest->distance = planeNormal->dot(planePoint);
+        convexPoint->addScaledVector(-closest->distance, planeNormal, planePoint);
+        planeNormal->scale(planeI ? 1 : -1, &closest->normal);
+    } else if (si->isConvex() && sj->isConvex()) {
+        if (!this->gjk.distance(si, xi, qi, sj, xj, qj, closest)) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    // Only if the gap closes within the time step
+    Math::Vec3 relativeVelocity;
+    bi->velocity.vsub(&bj->velocity, &relativeVelocity);
+    float closingSpeed = relativeVelocity.dot(&closest->normal);
+    if (closest->distance <= 0 || closest->distance > closingSpeed * this->ccdTimeStep_(bi, bj)) {
+        return false;
+    }
+
+    // The contact keeps its gap, so the solver only removes the velocity that would close more than it
+    Equations::ContactEquation* r = this->createContactEquation(bi, bj, si, sj, si, sj);
+    r->speculative = true;
+    r->ni.copy(&closest->normal);
+    closest->pointA.vsub(&bi->position, &r->ri);
+    closest->pointB.vsub(&bj->position, &r->rj);
+
+    this->result->push_back(r);
+    return true;
+}
+
+bool Narrowphase::convexGJK(
+    Shapes::Shape* si,
+    Shapes::Shape* sj,
+    Math::Vec3* xi,
+    Math::Vec3* xj,
+    Math::Quaternion* qi,
+    Math::Quaternion* qj,
+    Objects::Body* bi,
+    Objects::Body* bj,
+    Shapes::Shape* rsi,
+    Shapes::Shape* rsj,
+    bool justTest) {
+    Collision::GJKResult gjkResult;
+    if (!this->gjk.penetration(si, xi, qi, sj, xj, qj, &gjkResult)) {
+        return false;
+    }
+    if (justTest) {
+        return true;
+    }
+
+    Equations::ContactEquation* r = this->createContactEquation(bi, bj, si, sj, rsi, rsj);
+    r->ni.copy(&gjkResult.normal);
+
+    // Deepest points, relative to the bodies
+    gjkResult.pointA.vsub(&bi->position, &r->ri);
+    gjkResult.pointB.vsub(&bj->position, &r->rj);
+
+    this->result->push_back(r);
+    return true;
+}
+
+bool Narrowphase::sphereSphere(
+    Shapes::Sphere* si,
+    Shapes::Sphere* sj,
+    Math::Vec3* xi,
+    Math::Vec3* xj,
+    Math::Quaternion* qi,
+    Math::Quaternion* qj,
+    Objects::Body* bi,
+    Objects::Body* bj,
+    Shapes::Shape* rsi,
+    Shapes::Shape* rsj,
+    bool justTest) {
+    float radiusSum = si->radius + sj->radius;
+    if (xi->distanceSquared(xj) > radiusSum * radiusSum) {
+        return false;
+    }
+    if (justTest) {
+        return true;
+    }
+
+    // We will have only one contact in this case
+    Equations::ContactEquation* r = this->createContactEquation(bi, bj, si, sj, rsi, rsj);
+
+    // Contact normal
+    xj->vsub(xi, &r->ni);
+    r->ni.normalize();
+
+    // Contact point locations
+    r->ni.scale(si->radius, &r->ri);
+    r->ni.scale(-sj->radius, &r->rj);
+
+    r->ri.vadd(xi, &r->ri);
+    r->ri.vsub(&bi->position, &r->ri);
+
+    r->rj.vadd(xj, &r->rj);
+    r->rj.vsub(&bj->position, &r->rj);
+
+    this->result->push_back(r);
+    return true;
+}
+
+thread_local Cannon::Math::Vec3 spherePlane_normal;
+thread_local Cannon::Math::Vec3 point_on_plane_to_sphere;
+thread_local Cannon::Math::Vec3 plane_to_sphere_ortho;
+bool Narrowphase::spherePlane(
+    Shapes::Sphere* si,
+    Shapes::Plane* sj,
+    Math::Vec3* xi,
+    Math::Vec3* xj,
+    Math::Quaternion* qi,
+    Math::Quaternion* qj,
+    Objects::Body* bi,
+    Objects::Body* bj,
+    Shapes::Shape* rsi,
+    Shapes::Shape* rsj,
+    bool justTest) {
+    // Contact normal, from the sphere into the plane
+    Math::Vec3* normal = &spherePlane_normal;
+    normal->set(0, 0, 1);
+    qj->vmult(normal, normal);
+    normal->negate(normal);
+    normal->normalize();
+
+    // Vector from the plane position to the sphere center
+    xi->vsub(xj, &point_on_plane_to_sphere);
+    if (-point_on_plane_to_sphere.dot(normal) > si->radius) {
+        return false;
+    }
+    if (justTest) {
+        return true;
+    }
+
+    Equations::ContactEquation* r = this->createContactEquation(bi, bj, si, sj, rsi, rsj);
+    r->ni.copy(normal);
+
+    // Vector from sphere center to contact point
+    normal->scale(si->radius, &r->ri);
+
+    // Project down sphere on plane
+    normal->scale(normal->dot(&point_on_plane_to_sphere), &plane_to_sphere_ortho);
+    point_on_plane_to_sphere.vsub(&plane_to_sphere_ortho, &r->rj);
+
+    // Make it relative to the body
+    r->ri.vadd(xi, &r->ri);
+    r->ri.vsub(&bi->position, &r->ri);
+    r->rj.vadd(xj, &r->rj);
+    r->rj.vsub(&bj->position, &r->rj);
+
+    this->result->push_back(r);
+    return true;
+}
+
+bool Narrowphase::planeBox(
+    Shapes::Plane* si,
+    Shapes::Box* sj,
+    Math::Vec3* xi,
+    Math::Vec3* xj,
+    Math::Quaternion* qi,
+    Math::Quaternion* qj,
+    Objects::Body* bi,
+    Objects::Body* bj,
+    Shapes::Shape* rsi,
+    Shapes::Shape* rsj,
+    bool justTest) {
+    return this->planeConvex(si, sj->convexPolyhedronRepresentation, xi, xj, qi, qj, bi, bj, si, sj, justTest);
+}
+
+thread_local Cannon::Math::Vec3 planeConvex_v;
+thread_local Cannon::Math::Vec3 planeConvex_normal;
+thread_local Cannon::Math::Vec3 planeConvex_relpos;
+thread_local Cannon::Math::Vec3 planeConvex_projected;
+bool Narrowphase::planeConvex(
+    Shapes::Plane* planeShape,
+    Shapes::ConvexPolyhedron* convexShape,
+    Math::Vec3* planePosition,
+    Math::Vec3* convexPosition,
+    Math::Quaternion* planeQuat,
+    Math::Quaternion* convexQuat,
+    Objects::Body* planeBody,
+    Objects::Body* convexBody,
+    Shapes::Shape* si,
+    Shapes::Shape* sj,
+    bool justTest) {
+    // Simply return the points behind the plane.
+    Math::Vec3* worldVertex = &planeConvex_v;
+    Math::Vec3* worldNormal = &planeConvex_normal;
+    worldNormal->set(0, 0, 1);
+    planeQuat->vmult(worldNormal, worldNormal); // Turn normal according to plane orientation
+
+    int numContacts = 0;
+    Math::Vec3* relpos = &planeConvex_relpos;
+    std::vector<Math::Vec3>* vertices = convexShape->vertices;
+    for (int i = 0; i != vertices->size(); i++) {
+        // Get world convex vertex
+        worldVertex->copy(&vertices->at(i));
+        convexQuat->vmult(worldVertex, worldVertex);
+        convexPosition->vadd(worldVertex, worldVertex);
+        worldVertex->vsub(planePosition, relpos);
+
+        float dot = worldNormal->dot(relpos);
+        if (dot > 0) {
+            continue;
+        }
+        if (justTest) {
+            return true;
+        }
+
+        // Material and collision response come from the original shapes, not the hull representations
+        Equations::ContactEquation* r = this->createContactEquation(planeBody, convexBody, si, sj, si, sj);
+
+        // Get vertex position projected on plane
+        Math::Vec3* projected = &planeConvex_projected;
+        worldNormal->scale(dot, projected);
+        worldVertex->vsub(projected, projected);
+        projected->vsub(planePosition, &r->ri); // From plane to vertex projected on plane
+
+        r->ni.copy(worldNormal); // Contact normal is the plane normal out from plane
+
+        // rj is now just the vector from the convex center to the vertex
+        worldVertex->vsub(convexPosition, &r->rj);
+
+        // Make it relative to the body
+        r->ri.vadd(planePosition, &r->ri);
+        r->ri.vsub(&planeBody->position, &r->ri);
+        r->rj.vadd(convexPosition, &r->rj);
+        r->rj.vsub(&convexBody->position, &r->rj);
+
+        this->result->push_back(r);
+        numContacts++;
+    }
+
+    return numContacts > 0;
+}
+
+thread_local Cannon::Math::Vec3 sphereSphereContact_normal;
+bool Narrowphase::sphereSphereContact_(
+    Math::Vec3* centerI,
+    float radiusI,
+    Math::Vec3* centerJ,
+    float radiusJ,
+    Math::Vec3* fallbackNormal,
+    Objects::Body* bi,
+    Objects::Body* bj,
+    Shapes::Shape* si,
+    Shapes::Shape* sj,
+    bool justTest) {
+    Math::Vec3* normal = &sphereSphereContact_normal;
+    centerJ->vsub(centerI, normal);
+    float distance = normal->length();
+    if (distance > radiusI + radiusJ) {
+        return false;
+    }
+    if (justTest) {
+        return true;
+    }
+
+    if (distance > 1e-6f) {
+        normal->scale(1 / distance, normal);
+    } else {
+        normal->copy(fallbackNormal);
+    }
+
+    Equations::ContactEquation* r = this->createContactEquation(bi, bj, si, sj, si, sj);
+    r->ni.copy(normal);
+    centerI->addScaledVector(radiusI, normal, &r->ri);
+    r->ri.vsub(&bi->position, &r->ri);
+    centerJ->addScaledVector(-radiusJ, normal, &r->rj);
+    r->rj.vsub(&bj->position, &r->rj);
+
+    this->result->push_back(r);
+    return true;
+}
+
+// Closest point to p on the segment ab. Returns its parameter along the segment.
+static float Narrowphase_closestOnSegment(Cannon::Math::Vec3* p, Cannon::Math::Vec3* a, Cannon::Math::Vec3* b, Cannon::Math::Vec3* target) {
+    Cannon::Math::Vec3 ab;
+    Cannon::Math::Vec3 ap;
+    b->vsub(a, &ab);
+    p->vsub(a, &ap);
+    float lengthSquared = ab.lengthSquared();
+    float t = lengthSquared > 0 ? std::max(0.0f, std::min(1.0f, ap.dot(&ab) / lengthSquared)) : 0;
+    a->addScaledVector(t, &ab, target);
+    return t;
+}
+
+// Some unit vector perpendicular to v
+static void Narrowphase_perpendicular(Cannon::Math::Vec3* v, Cannon::Math::Vec3* target) {
+    Cannon::Math::Vec3 other;
+    other.set(std::abs(v->x) < 0.9f * v->length() ? 1 : 0, std::abs(v->x) < 0.9f * v->length() ? 0 : 1, 0);
+    v->cross(&other, target);
+    if (target->normalize() == 0) {
+        target->set(1, 0, 0);
+    }
+}
+
+thread_local Cannon::Math::Vec3 sphereCapsule_a;
+thread_local Cannon::Math::Vec3 sphereCapsule_b;
+thread_local Cannon::Math::Vec3 sphereCapsule_closest;
+thread_local Cannon::Math::Vec3 sphereCapsule_fallback;
+bool Narrowphase::sphereCapsule(
+    Shapes::Sphere* si,
+    Shapes::Capsule* sj,
+    Math::Vec3* xi,
+    Math::Vec3* xj,
+    Math::Quaternion* qi,
+    Math::Quaternion* qj,
+    Objects::Body* bi,
+    Objects::Body* bj,
+    Shapes::Shape* rsi,
+    Shapes::Shape* rsj,
+    bool justTest) {
+    Math::Vec3* a = &sphereCapsule_a;
+    Math::Vec3* b = &sphereCapsule_b;
+    Math::Vec3* closest = &sphereCapsule_closest;
+    sj->getWorldEndpoints(xj, qj, a, b);
+    Narrowphase_closestOnSegment(xi, a, b, closest);
+
+    // A sphere centered on the segment is pushed out sideways
+    Math::Vec3* fallback = &sphereCapsule_fallback;
+    b->vsub(a, fallback);
+    Narrowphase_perpendicular(fallback, fallback);
+
+    return this->sphereSphereContact_(xi, si->radius, closest, sj->radius, fallback, bi, bj, rsi, rsj, justTest);
+}
+
+thread_local Cannon::Math::Vec3 planeCapsule_normal;
+thread_local Cannon::Math::Vec3 planeCapsule_relpos;
+thread_local std::array<Cannon::Math::Vec3, 2> planeCapsule_ends;
+bool Narrowphase::planeCapsule(
+    Shapes::Plane* si,
+    Shapes::Capsule* sj,
+    Math::Vec3* xi,
+    Math::Vec3* xj,
+    Math::Quaternion* qi,
+    Math::Quaternion* qj,
+    Objects::Body* bi,
+    Objects::Body* bj,
+    Shapes::Shape* rsi,
+    Shapes::Shape* rsj,
+    bool justTest) {
+    Math::Vec3* normal = &planeCapsule_normal;
+    normal->set(0, 0, 1);
+    qi->vmult(normal, normal);
+
+    std::array<Math::Vec3, 2>* ends = &planeCapsule_ends;
+    sj->getWorldEndpoints(xj, qj, &(*ends)[0], &(*ends)[1]);
+
+    // The end caps are spheres
+    int numContacts = 0;
+    Math::Vec3* relpos = &planeCapsule_relpos;
+    for (int i = 0; i < 2; i++) {
+        Math::Vec3* end = &(*ends)[i];
+        end->vsub(xi, relpos);
+        float height = normal->dot(relpos);
+        if (height > sj->radius) {
+            continue;
+        }
+        if (justTest) {
+            return true;
+        }
+
+        Equations::ContactEquation* r = this->createContactEquation(bi, bj, si, sj, rsi, rsj);
+        r->ni.copy(normal);
+
+        // The cap center projected on the plane, and the deepest point of the cap
+        end->addScaledVector(-height, normal, &r->ri);
+        r->ri.vsub(&bi->position, &r->ri);
+        end->addScaledVector(-sj->radius, normal, &r->rj);
+        r->rj.vsub(&bj->position, &r->rj);
+
+        this->result->push_back(r);
+        numContacts++;
+    }
+
+    return numContacts > 0;
+}
+
+thread_local Cannon::Math::Quaternion boxCapsule_conjugate;
+thread_local Cannon::Math::Vec3 boxCapsule_a;
+thread_local Cannon::Math::Vec3 boxCapsule_b;
+bool Narrowphase::boxCapsule(
+    Shapes::Box* si,
+    Shapes::Capsule* sj,
+    Math::Vec3* xi,
+    Math::Vec3* xj,
+    Math::Quaternion* qi,
+    Math::Quaternion* qj,
+    Objects::Body* bi,
+    Objects::Body* bj,
+    Shapes::Shape* rsi,
+    Shapes::Shape* rsj,
+    bool justTest) {
+    // The capsule segment in the frame of the box
+    Math::Vec3* a = &boxCapsule_a;
+    Math::Vec3* b = &boxCapsule_b;
+    Math::Quaternion* conjugate = &boxCapsule_conjugate;
+    sj->getWorldEndpoints(xj, qj, a, b);
+    qi->conjugate(conjugate);
+    a->vsub(xi, a);
+    conjugate->vmult(a, a);
+    b->vsub(xi, b);
+    conjugate->vmult(b, b);
+
+    float start[3] = { a->x, a->y, a->z };
+    float d[3] = { b->x - a->x, b->y - a->y, b->z - a->z };
+    float e[3] = { si->halfExtents->x, si->halfExtents->y, si->halfExtents->z };
+    float radius = sj->radius;
+
+    // The squared distance from the segment to the box is a quadratic between the points where the segment crosses the planes of the box faces
+    std::array<float, 8> breaks;
+    int numBreaks = 0;
+    breaks[numBreaks++] = 0;
+    breaks[numBreaks++] = 1;
+    for (int k = 0; k < 3; k++) {
+        if (d[k] == 0) {
+            continue;
+        }
+        for (int side = -1; side <= 1; side += 2) {
+            float t = (side * e[k] - start[k]) / d[k];
+            if (t > 0 && t < 1) {
+                breaks[numBreaks++] = t;
+            }
+        }
+    }
+
+    // Insertion sort, there are at most 8 of them
+    for (int i = 1; i < numBreaks; i++) {
+        float v = breaks[i];
+        int j;
+        for (j = i - 1; j >= 0; j--) {
+            if (breaks[j] <= v) {
+                break;
+            }
+            breaks[j + 1] = breaks[j];
+        }
+        breaks[j + 1] = v;
+    }
+
+    // Squared distances closer than this to the minimum count as the minimum, so a segment lying flat on a face touches along an interval
+    float tolerance = 1e-4f * radius * radius;
+    float best = MAX_FLOAT;
+    float t0 = 0;
+    float t1 = 0;
+    for (int i = 0; i + 1 < numBreaks; i++) {
+        float tl = breaks[i];
+        float tr = breaks[i + 1];
+        float tm = (tl + tr) / 2;
+        float A = 0;
+        float B = 0;
+        float C = 0;
+        for (int k = 0; k < 3; k++) {
+            float p = start[k] + d[k] * tm;
+            float c;
+            if (p < -e[k]) {
+                c = start[k] + e[k];
+            } else if (p > e[k]) {
+                c = start[k] - e[k];
+            } else {
+                continue;
+            }
+            A += d[k] * d[k];
+            B += 2 * c * d[k];
+            C += c * c;
+        }
+
+        float t = A > 0 ? std::max(tl, std::min(tr, -B / (2 * A))) : (B > 0 ? tl : tr);
+        float value = A * t * t + B * t + C;
+        float valueL = A * tl * tl + B * tl + C;
+        float valueR = A * tr * tr + B * tr + C;
+        bool flat = std::max(valueL, valueR) - value <= tolerance;
+        float pieceStart = flat ? tl : t;
+        float pieceEnd = flat ? tr : t;
+
+        if (value < best - tolerance) {
+            best = value;
+            t0 = pieceStart;
+            t1 = pieceEnd;
+        } else if (value <= best + tolerance) {
+            best = std::min(best, value);
+            t0 = std::min(t0, pieceStart);
+            t1 = std::max(t1, pieceEnd);
+        }
+    }
+
+    if (best > radius * radius) {
+        return false;
+    }
+
+    // The segment reaches into the box, so there is no closest point to push along
+    if (best <= 1e-6f * radius * radius) {
+        return this->convexGJK(si, sj, xi, xj, qi, qj, bi, bj, rsi, rsj, justTest);
+    }
+    if (justTest) {
+        return true;
+    }
+
+    // One contact, or one at each end of the touching interval
+    float length = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    int numTimes = (t1 - t0) * length > 0.1f * radius ? 2 : 1;
+    float times[2] = { numTimes == 2 ? t0 : (t0 + t1) / 2, t1 };
+    int numContacts = 0;
+    for (int i = 0; i < numTimes; i++) {
+        Math::Vec3 segmentPoint(start[0] + d[0] * times[i], start[1] + d[1] * times[i], start[2] + d[2] * times[i]);
+        Math::Vec3 boxPoint(
+            std::max(-e[0], std::min(e[0], segmentPoint.x)),
+            std::max(-e[1], std::min(e[1], segmentPoint.y)),
+            std::max(-e[2], std::min(e[2], segmentPoint.z)));
+        Math::Vec3 normal;
+        segmentPoint.vsub(&boxPoint, &normal);
+        float distance = normal.normalize();
+        if (distance > radius || distance == 0) {
+            continue;
+        }
+
+        // Back to world space
+        qi->vmult(&normal, &normal);
+        qi->vmult(&segmentPoint, &segmentPoint);
+        segmentPoint.vadd(xi, &segmentPoint);
+        qi->vmult(&boxPoint, &boxPoint);
+        boxPoint.vadd(xi, &boxPoint);
+
+        Equations::ContactEquation* r = this->createContactEquation(bi, bj, si, sj, rsi, rsj);
+        r->ni.copy(&normal);
+        boxPoint.vsub(&bi->position, &r->ri);
+        segmentPoint.addScaledVector(-radius, &normal, &r->rj);
+        r->rj.vsub(&bj->position, &r->rj);
+
+        this->result->push_back(r);
+        numContacts++;
+    }
+
+    return numContacts > 0;
+}
+
+thread_local Cannon::Math::Vec3 capsuleCapsule_p1;
+thread_local Cannon::Math::Vec3 capsuleCapsule_q1;
+thread_local Cannon::Math::Vec3 capsuleCapsule_p2;
+thread_local Cannon::Math::Vec3 capsuleCapsule_q2;
+thread_local Cannon::Math::Vec3 capsuleCapsule_c1;
+thread_local Cannon::Math::Vec3 capsuleCapsule_c2;
+thread_local Cannon::Math::Vec3 capsuleCapsule_fallback;
+bool Narrowphase::capsuleCapsule(
+    Shapes::Capsule* si,
+    Shapes::Capsule* sj,
+    Math::Vec3* xi,
+    Math::Vec3* xj,
+    Math::Quaternion* qi,
+    Math::Quaternion* qj,
+    Objects::Body* bi,
+    Objects::Body* bj,
+    Shapes::Shape* rsi,
+    Shapes::Shape* rsj,
+    bool justTest) {
+    Math::Vec3* p1 = &capsuleCapsule_p1;
+    Math::Vec3* q1 = &capsuleCapsule_q1;
+    Math::Vec3* p2 = &capsuleCapsule_p2;
+    Math::Vec3* q2 = &capsuleCapsule_q2;
+    Math::Vec3* c1 = &capsuleCapsule_c1;
+    Math::Vec3* c2 = &capsuleCapsule_c2;
+    si->getWorldEndpoints(xi, qi, p1, q1);
+    sj->getWorldEndpoints(xj, qj, p2, q2);
+
+    // Closest points of the segments, see Ericson, Real-Time Collision Detection 5.1.9
+    Math::Vec3 d1;
+    Math::Vec3 d2;
+    Math::Vec3 r;
+    q1->vsub(p1, &d1);
+    q2->vsub(p2, &d2);
+    p1->vsub(p2, &r);
+    float a = d1.dot(&d1);
+    float e = d2.dot(&d2);
+    float f = d2.dot(&r);
+    float b = d1.dot(&d2);
+    float denominator = a * e - b * b;
+    float epsilon = 1e-8f;
+
+    Math::Vec3* fallback = &capsuleCapsule_fallback;
+    Narrowphase_perpendicular(&d1, fallback);
+
+    // Parallel segments touch along the part where they overlap. Make a contact at each end of it.
+    if (a > epsilon && e > epsilon && denominator <= 1e-3f * a * e) {
+        Math::Vec3 offset;
+        p2->vsub(p1, &offset);
+        float s0 = std::max(0.0f, std::min(1.0f, offset.dot(&d1) / a));
+        q2->vsub(p1, &offset);
+        float s1 = std::max(0.0f, std::min(1.0f, offset.dot(&d1) / a));
+        if (std::abs(s1 - s0) * std::sqrt(a) > 0.1f * std::min(si->radius, sj->radius)) {
+            int numContacts = 0;
+            float ends[2] = { s0, s1 };
+            for (int i = 0; i < 2; i++) {
+                p1->addScaledVector(ends[i], &d1, c1);
+                Narrowphase_closestOnSegment(c1, p2, q2, c2);
+                if (this->sphereSphereContact_(c1, si->radius, c2, sj->radius, fallback, bi, bj, rsi, rsj, justTest)) {
+                    if (justTest) {
+                        return true;
+                    }
+                    numContacts++;
+                }
+            }
+            return numContacts > 0;
+        }
+    }
+
+    float s = 0;
+    float t = 0;
+    if (a <= epsilon && e <= epsilon) {
+        s = 0;
+        t = 0;
+    } else if (a <= epsilon) {
+        s = 0;
+        t = std::max(0.0f, std::min(1.0f, f / e));
+    } else {
+        float c = d1.dot(&r);
+        if (e <= epsilon) {
+            t = 0;
+            s = std::max(0.0f, std::min(1.0f, -c / a));
+        } else {
+            s = denominator > epsilon ? std::max(0.0f, std::min(1.0f, (b * f - c * e) / denominator)) : 0;
+            t = (b * s + f) / e;
+            if (t < 0) {
+                t = 0;
+                s = std::max(0.0f, std::min(1.0f, -c / a));
+            } else if (t > 1) {
+                t = 1;
+                s = std::max(0.0f, std::min(1.0f, (b - c) / a));
+            }
+        }
+    }
+
+    p1->addScaledVector(s, &d1, c1);
+    p2->addScaledVector(t, &d2, c2);
+    return this->sphereSphereContact_(c1, si->radius, c2, sj->radius, fallback, bi, bj, rsi, rsj, justTest);
+}
+
+thread_local Cannon::Math::Quaternion sphereCylinder_conjugate;
+thread_local Cannon::Math::Vec3 sphereCylinder_local;
+thread_local Cannon::Math::Vec3 sphereCylinder_closest;
+thread_local Cannon::Math::Vec3 sphereCylinder_normal;
+bool Narrowphase::sphereCylinder(
+    Shapes::Sphere* si,
+    Shapes::Cylinder* sj,
+    Math::Vec3* xi,
+    Math::Vec3* xj,
+    Math::Quaternion* qi,
+    Math::Quaternion* qj,
+    Objects::Body* bi,
+    Objects::Body* bj,
+    Shapes::Shape* rsi,
+    Shapes::Shape* rsj,
+    bool justTest) {
+    // Sphere center in the frame of the cylinder
+    Math::Vec3* local = &sphereCylinder_local;
+    Math::Quaternion* conjugate = &sphereCylinder_conjugate;
+    qj->conjugate(conjugate);
+    xi->vsub(xj, local);
+    conjugate->vmult(local, local);
+
+    float halfHeight = sj->height / 2;
+    float radius = sj->radius;
+    float radial = std::sqrt(local->x * local->x + local->y * local->y);
+    Math::Vec3* closest = &sphereCylinder_closest;
+    Math::Vec3* normal = &sphereCylinder_normal;
+
+    // Closest point of the cylinder, and the normal from the sphere towards it
+    bool inside = radial < radius && std::abs(local->z) < halfHeight;
+    if (!inside) {
+        float scale = radial > radius ? radius / radial : 1;
+        closest->set(local->x * scale, local->y * scale, std::max(-halfHeight, std::min(halfHeight, local->z)));
+        closest->vsub(local, normal);
+        float distance = normal->normalize();
+        if (distance > si->radius) {
+            return false;
+        }
+        inside = distance == 0;
+    }
+    if (inside) {
+        // Push out through the closest face
+        float sideDepth = radius - radial;
+        float topDepth = halfHeight - local->z;
+        float bottomDepth = local->z + halfHeight;
+        if (sideDepth < std::min(topDepth, bottomDepth) && radial > 0) {
+            normal->set(-local->x / radial, -local->y / radial, 0);
+            closest->set(local->x * radius / radial, local->y * radius / radial, local->z);
+        } else if (topDepth <= bottomDepth) {
+            normal->set(0, 0, -1);
+            closest->set(local->x, local->y, halfHeight);
+        } else {
+            normal->set(0, 0, 1);
+            closest->set(local->x, local->y, -halfHeight);
+        }
+    }
+    if (justTest) {
+        return true;
+    }
+
+    // Back to world space
+    qj->vmult(normal, normal);
+    qj->vmult(closest, closest);
+    closest->vadd(xj, closest);
+
+    Equations::ContactEquation* r = this->createContactEquation(bi, bj, si, sj, rsi, rsj);
+    r->ni.copy(normal);
+    xi->addScaledVector(si->radius, normal, &r->ri);
+    r->ri.vsub(&bi->position, &r->ri);
+    closest->vsub(&bj->position, &r->rj);
+
+    this->result->push_back(r);
+    return true;
+}
+
+thread_local Cannon::Math::Vec3 planeCylinder_normal;
+thread_local Cannon::Math::Vec3 planeCylinder_axis;
+thread_local std::array<Cannon::Math::Vec3, 4> planeCylinder_directions;
+bool Narrowphase::planeCylinder(
+    Shapes::Plane* si,
+    Shapes::Cylinder* sj,
+    Math::Vec3* xi,
+    Math::Vec3* xj,
+    Math::Quaternion* qi,
+    Math::Quaternion* qj,
+    Objects::Body* bi,
+    Objects::Body* bj,
+    Shapes::Shape* rsi,
+    Shapes::Shape* rsj,
+    bool justTest) {
+    Math::Vec3* normal = &planeCylinder_normal;
+    Math::Vec3* axis = &planeCylinder_axis;
+    normal->set(0, 0, 1);
+    qi->vmult(normal, normal);
+    axis->set(0, 0, 1);
+    qj->vmult(axis, axis);
+
+    // Directions in the caps: towards the plane first, then around the rim
+    std::array<Math::Vec3, 4>* directions = &planeCylinder_directions;
+    Math::Vec3* down = &(*directions)[0];
+    axis->scale(axis->dot(normal), down);
+    down->vsub(normal, down);
+    if (down->normalize() < 1e-6f) {
+        Narrowphase_perpendicular(axis, down);
+    }
+    axis->cross(down, &(*directions)[1]);
+    down->negate(&(*directions)[2]);
+    (*directions)[1].negate(&(*directions)[3]);
+
+    int numContacts = 0;
+    Math::Vec3 capCenter;
+    Math::Vec3 point;
+    Math::Vec3 relpos;
+    for (int side = -1; side <= 1; side += 2) {
+        xj->addScaledVector(side * sj->height / 2, axis, &capCenter);
+        for (int i = 0; i < 4; i++) {
+            capCenter.addScaledVector(sj->radius, &(*directions)[i], &point);
+            point.vsub(xi, &relpos);
+            float depth = normal->dot(&relpos);
+            if (depth > 0) {
+                continue;
+            }
+            if (justTest) {
+                return true;
+            }
+
+            Equations::ContactEquation* r = this->createContactEquation(bi, bj, si, sj, rsi, rsj);
+            r->ni.copy(normal);
+
+            // The rim point projected on the plane, and the rim point itself
+            point.addScaledVector(-depth, normal, &r->ri);
+            r->ri.vsub(&bi->position, &r->ri);
+            point.vsub(&bj->position, &r->rj);
+
+            this->result->push_back(r);
+            numContacts++;
+        }
+    }
+
+    return numContacts > 0;
+}
+
+bool Narrowphase::boxBox(
+    Shapes::Box* si,
+    Shapes::Box* sj,
+    Math::Vec3* xi,
+    Math::Vec3* xj,
+    Math::Quaternion* qi,
+    Math::Quaternion* qj,
+    Objects::Body* bi,
+    Objects::Body* bj,
+    Shapes::Shape* rsi,
+    Shapes::Shape* rsj,
+    bool justTest) {
+    Collision::BoxBoxResult* boxBoxResult = &this->boxBoxResult_;
+    if (!this->boxBoxCollider.collide(si->halfExtents, xi, qi, sj->halfExtents, xj, qj, boxBoxResult, justTest)) {
+        return false;
+    }
+    if (justTest) {
+        return true;
+    }
+
+    std::vector<int>* kept = &this->reducedContacts_;
+    kept->clear();
+    if (this->enableContactReduction && boxBoxResult->contacts.size() > Collision::ContactReduction::maxContacts) {
+        this->reductionPoints_.clear();
+        this->reductionDepths_.clear();
+        for (int j = 0; j != boxBoxResult->contacts.size(); j++) {
+            this->reductionPoints_.push_back(boxBoxResult->contacts[j].pointB);
+            this->reductionDepths_.push_back(boxBoxResult->contacts[j].depth);
+        }
+        Collision::ContactReduction::reduce(&this->reductionPoints_, &this->reductionDepths_, &boxBoxResult->normal, kept);
+    } else {
+        for (int j = 0; j != boxBoxResult->contacts.size(); j++) {
+            kept->push_back(j);
+        }
+    }
+
+    for (int k = 0; k != kept->size(); k++) {
+        Collision::BoxBoxContact* contact = &boxBoxResult->contacts[kept->at(k)];
+        Equations::ContactEquation* r = this->createContactEquation(bi, bj, si, sj, rsi, rsj);
+        r->ni.copy(&boxBoxResult->normal);
+
+        // Contact points are in world coordinates. Make relative to bodies
+        contact->pointA.vsub(&bi->position, &r->ri);
+        contact->pointB.vsub(&bj->position, &r->rj);
+
+        this->result->push_back(r);
+    }
+
+    return true;
+}
+
+bool Narrowphase::boxConvex(
+    Shapes::Box* si,
+    Shapes::ConvexPolyhedron* sj,
+    Math::Vec3* xi,
+    Math::Vec3* xj,
+    Math::Quaternion* qi,
+    Math::Quaternion* qj,
+    Objects::Body* bi,
+    Objects::Body* bj,
+    Shapes::Shape* rsi,
+    Shapes::Shape* rsj,
+    bool justTest) {
+    return this->convexConvex(
+        si->convexPolyhedronRepresentation,
+        sj,
+        xi, xj, qi, qj, bi, bj, si, sj, justTest, nullptr, nullptr);
+}
+
+thread_local Cannon::Math::Vec3 convexConvex_sepAxis;
+thread_local Cannon::Math::Vec3 convexConvex_q;
+bool Narrowphase::convexConvex(
+    Shapes::ConvexPolyhedron* si,
+    Shapes::ConvexPolyhedron* sj,
+    Math::Vec3* xi,
+    Math::Vec3* xj,
+    Math::Quaternion* qi,
+    Math::Quaternion* qj,
+    Objects::Body* bi,
+    Objects::Body* bj,
+    Shapes::Shape* rsi,
+    Shapes::Shape* rsj,
+    bool justTest,
+    std::vector<int>* faceListA,
+    std::vector<int>* faceListB) {
+    Math::Vec3* sepAxis = &convexConvex_sepAxis;
+
+    if (xi->distanceTo(xj) > si->boundingSphereRadius + sj->boundingSphereRadius) {
+        return false;
+    }
+
+    if (!si->findSeparatingAxis(sj, xi, qi, xj, qj, sepAxis, faceListA, faceListB, this->axisCache_)) {
+        return false;
+    }
+
+    std::vector<Shapes::PointObject> res;
+    Math::Vec3* q = &convexConvex_q;
+    si->clipAgainstHull(xi, qi, sj, xj, qj, sepAxis, -100, 100, &res);
+    if (justTest) {
+        return !res.empty();
+    }
+
+    std::vector<int>* kept = &this->reducedContacts_;
+    kept->clear();
+    if (this->enableContactReduction && res.size() > Collision::ContactReduction::maxContacts) {
+        this->reductionPoints_.clear();
+        this->reductionDepths_.clear();
+        for (int j = 0; j != res.size(); j++) {
+            this->reductionPoints_.push_back(res[j].point);
+            this->reductionDepths_.push_back(-res[j].depth);
+        }
+        Collision::ContactReduction::reduce(&this->reductionPoints_, &this->reductionDepths_, sepAxis, kept);
+    } else {
+        for (int j = 0; j != res.size(); j++) {
+            kept->push_back(j);
+        }
+    }
+
+    for (int k = 0; k != kept->size(); k++) {
+        int j = kept->at(k);
+
+        // Material and collision response come from the original shapes, not the hull representations
+        Equations::ContactEquation* r = this->createContactEquation(bi, bj, rsi, rsj, rsi, rsj);
+        Math::Vec3* ri = &r->ri;
+        Math::Vec3* rj = &r->rj;
+        sepAxis->negate(&r->ni);
+        res[j].normal.negate(q);
+        q->scale(res[j].depth, q);
+        res[j].point.vadd(q, ri);
+        rj->copy(&res[j].point);
+
+        // Contact points are in world coordinates. Make relative to bodies
+        ri->vsub(&bi->position, ri);
+        rj->vsub(&bj->position, rj);
+
+        this->result->push_back(r);
+    }
+
+    return !res.empty();
+}
+
+// Closest point to p on the triangle abc
+static void Narrowphase_closestOnTriangle(Cannon::Math::Vec3* p, Cannon::Math::Vec3* a, Cannon::Math::Vec3* b, Cannon::Math::Vec3* c, Cannon::Math::Vec3* target) {
+    Cannon::Math::Vec3 ab;
+    Cannon::Math::Vec3 ac;
+    Cannon::Math::Vec3 ap;
+    b->vsub(a, &ab);
+    c->vsub(a, &ac);
+    p->vsub(a, &ap);
+
+    // Voronoi regions of the vertices and edges, then the face
+    float d1 = ab.dot(&ap);
+    float d2 = ac.dot(&ap);
+    if (d1 <= 0 && d2 <= 0) {
+        target->copy(a);
+        return;
+    }
+
+    Cannon::Math::Vec3 bp;
+    p->vsub(b, &bp);
+    float d3 = ab.dot(&bp);
+    float d4 = ac.dot(&bp);
+    if (d3 >= 0 && d4 <= d3) {
+        target->copy(b);
+        return;
+    }
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+        a->addScaledVector(d1 / (d1 - d3), &ab, target);
+        return;
+    }
+
+    Cannon::Math::Vec3 cp;
+    p->vsub(c, &cp);
+    float d5 = ab.dot(&cp);
+    float d6 = ac.dot(&cp);
+    if (d6 >= 0 && d5 <= d6) {
+        target->copy(c);
+        return;
+    }
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+        a->addScaledVector(d2 / (d2 - d6), &ac, target);
+        return;
+    }
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+        Cannon::Math::Vec3 bc;
+        c->vsub(b, &bc);
+        b->addScaledVector((d4 - d3) / ((d4 - d3) + (d5 - d6)), &bc, target);
+        return;
+    }
+
+    float denominator = 1 / (va + vb + vc);
+    a->addScaledVector(vb * denominator, &ab, target);
+    target->addScaledVector(vc * denominator, &ac, target);
+}
+
+thread_local Cannon::Math::Quaternion sphereTrimesh_conjugate;
+thread_local Cannon::Math::Vec3 sphereTrimesh_localCenter;
+thread_local std::array<Cannon::Math::Vec3, 3> sphereTrimesh_triangle;
+thread_local Cannon::Math::Vec3 sphereTrimesh_closest;
+thread_local Cannon::Math::Vec3 sphereTrimesh_worldClosest;
+thread_local Cannon::Math::Vec3 sphereTrimesh_fallback;
+bool Narrowphase::sphereTrimesh(
+    Shapes::Sphere* sphereShape,
+    Shapes::Trimesh* trimeshShape,
+    Math::Vec3* spherePos,
+    Math::Vec3* trimeshPos,
+    Math::Quaternion* sphereQuat,
+    Math::Quaternion* trimeshQuat,
+    Objects::Body* sphereBody,
+    Objects::Body* trimeshBody,
+    Shapes::Shape* rsi,
+    Shapes::Shape* rsj,
+    bool justTest) {
+    // Sphere center in the local space of the trimesh
+    Math::Vec3* localCenter = &sphereTrimesh_localCenter;
+    spherePos->vsub(trimeshPos, localCenter);
+    trimeshQuat->conjugate(&sphereTrimesh_conjugate);
+    sphereTrimesh_conjugate.vmult(localCenter, localCenter);
+
+    float radius = sphereShape->radius;
+    Collision::AABB aabb;
+    aabb.lowerBound.set(localCenter->x - radius, localCenter->y - radius, localCenter->z - radius);
+    aabb.upperBound.set(localCenter->x + radius, localCenter->y + radius, localCenter->z + radius);
+
+    std::vector<Math::Vec3>* points = &this->trimeshContactPoints_;
+    points->clear();
+    bool found = false;
+    trimeshShape->trianglesInAABB(&aabb, [&](int triangle) {
+        if (found && justTest) {
+            return;
+        }
+
+        std::array<Math::Vec3, 3>* v = &sphereTrimesh_triangle;
+        Math::Vec3* closest = &sphereTrimesh_closest;
+        trimeshShape->getTriangleVertices(triangle, &v->at(0), &v->at(1), &v->at(2));
+        Narrowphase_closestOnTriangle(localCenter, &v->at(0), &v->at(1), &v->at(2), closest);
+        if (localCenter->distanceSquared(closest) > radius * radius) {
+            return;
+        }
+
+        // Neighbouring triangles share the closest point when it is on their common edge or vertex
+        for (int i = 0; i < points->size(); i++) {
+            if (points->at(i).almostEquals(closest, 1e-6)) {
+                return;
+            }
+        }
+        points->push_back(*closest);
+
+        // A center on the triangle is pushed out of the front face, which is counter clockwise
+        Math::Vec3* fallback = &sphereTrimesh_fallback;
+        Math::Vec3 ab;
+        Math::Vec3 ac;
+        v->at(1).vsub(&v->at(0), &ab);
+        v->at(2).vsub(&v->at(0), &ac);
+        ac.cross(&ab, fallback);
+        fallback->normalize();
+        trimeshQuat->vmult(fallback, fallback);
+
+        Math::Vec3* worldClosest = &sphereTrimesh_worldClosest;
+        trimeshQuat->vmult(closest, worldClosest);
+        worldClosest->vadd(trimeshPos, worldClosest);
+        if (this->sphereSphereContact_(spherePos, radius, worldClosest, 0, fallback, sphereBody, trimeshBody, rsi, rsj, justTest)) {
+            found = true;
+        }
+    });
+
+    return found;
+}
+
+thread_local Cannon::Math::Vec3 updateTriangleHull_edge;
+void Narrowphase::updateTriangleHull_(Shapes::Trimesh* mesh, int triangle, Math::Vec3* xj, Math::Quaternion* qj, Math::Vec3* position) {
+    // The vertices are kept around the centroid, so the bounding sphere and the direction between the hulls stay tight
+    Shapes::ConvexPolyhedron* hull = &this->triangleHull_;
+    std::vector<Math::Vec3>* v = hull->vertices;
+    mesh->getTriangleVertices(triangle, &v->at(0), &v->at(1), &v->at(2));
+    Math::Vec3* centroid = position;
+    v->at(0).vadd(&v->at(1), centroid);
+    centroid->vadd(&v->at(2), centroid);
+    centroid->scale(1.0f / 3.0f, centroid);
+    for (int k = 0; k < 3; k++) {
+        v->at(k).vsub(centroid, &v->at(k));
+    }
+    qj->vmult(centroid, position);
+    position->vadd(xj, position);
+
+    // Same as computeNormals and computeEdges, without their allocations. All three edges are open
+    hull->faceNormals.resize(1);
+    Shapes::ConvexPolyhedron::computeNormal(&v->at(0), &v->at(1), &v->at(2), &hull->faceNormals[0]);
+    hull->faceNormals[0].negate(&hull->faceNormals[0]);
+    hull->uniqueEdges.resize(3);
+    hull->uniqueEdgeFaces.resize(3);
+    Math::Vec3* edge = &updateTriangleHull_edge;
+    for (int k = 0; k < 3; k++) {
+        v->at(k).vsub(&v->at((k + 1) % 3), edge);
+        edge->normalize();
+        hull->uniqueEdges[k].copy(edge);
+        hull->uniqueEdgeFaces[k].assign(1, { 0, -1 });
+    }
+    hull->updateBoundingSphereRadius();
+}
+
+thread_local Cannon::Math::Quaternion convexTrimesh_conjugate;
+thread_local Cannon::Math::Quaternion convexTrimesh_localQuat;
+thread_local Cannon::Math::Vec3 convexTrimesh_localPos;
+thread_local Cannon::Math::Vec3 convexTrimesh_trianglePos;
+thread_local Cannon::Collision::GJKResult convexTrimesh_result;
+bool Narrowphase::convexTrimesh(
+    Shapes::Shape* si,
+    Shapes::Trimesh* sj,
+    Math::Vec3* xi,
+    Math::Vec3* xj,
+    Math::Quaternion* qi,
+    Math::Quaternion* qj,
+    Objects::Body* bi,
+    Objects::Body* bj,
+    Shapes::Shape* rsi,
+    Shapes::Shape* rsj,
+    bool justTest) {
+    // AABB of the convex shape in the local space of the trimesh
+    Math::Quaternion* conjugate = &convexTrimesh_conjugate;
+    Math::Vec3* localPos = &convexTrimesh_localPos;
+    Math::Quaternion* localQuat = &convexTrimesh_localQuat;
+    qj->conjugate(conjugate);
+    xi->vsub(xj, localPos);
+    conjugate->vmult(localPos, localPos);
+    conjugate->mult(qi, localQuat);
+    Collision::AABB aabb;
+    si->calculateWorldAABB(localPos, localQuat, &aabb.lowerBound, &aabb.upperBound);
+
+    // Polyhedra are clipped against each triangle for a full face manifold, round shapes get one contact from GJK and EPA
+    Shapes::ConvexPolyhedron* hull = nullptr;
+    if (si->type == Shapes::ShapeTypes::BOX) {
+        hull = ((Shapes::Box*)si)->convexPolyhedronRepresentation;
+    } else if (si->type == Shapes::ShapeTypes::CONVEXPOLYHEDRON) {
+        hull = (Shapes::ConvexPolyhedron*)si;
+    }
+
+    // The triangle hull is refilled for every triangle, so its separating axes can not be cached
+    Collision::SeparatingAxisCache* axisCache = this->axisCache_;
+    this->axisCache_ = nullptr;
+
+    Math::Vec3* trianglePos = &convexTrimesh_trianglePos;
+    Collision::GJKResult* gjkResult = &convexTrimesh_result;
+    bool found = false;
+    sj->trianglesInAABB(&aabb, [&](int t) {
+        if (found && justTest) {
+            return;
+        }
+
+        this->updateTriangleHull_(sj, t, xj, qj, trianglePos);
+
+        if (hull != nullptr) {
+            if (this->convexConvex(hull, &this->triangleHull_, xi, trianglePos, qi, qj, bi, bj, rsi, rsj, justTest, nullptr, nullptr)) {
+                found = true;
+            }
+            return;
+        }
+
+        if (!this->gjk.penetration(si, xi, qi, &this->triangleHull_, trianglePos, qj, gjkResult)) {
+            return;
+        }
+        found = true;
+        if (justTest) {
+            return;
+        }
+
+        Equations::ContactEquation* r = this->createContactEquation(bi, bj, si, sj, rsi, rsj);
+        r->ni.copy(&gjkResult->normal);
+        gjkResult->pointA.vsub(&bi->position, &r->ri);
+        gjkResult->pointB.vsub(&bj->position, &r->rj);
+        this->result->push_back(r);
+    });
+
+    this->axisCache_ = axisCache;
+    return found;
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include "collision/AABBArray.h"
+#include "collision/Broadphase.h"
+#include "objects/Body.h"
+#include "shapes/Sphere.h"
+#include "test/test_helpers.h"
+
+using namespace Cannon;
+
+TEST(AABBArray, SetFromBodies) {
+    std::unique_ptr<Collision::AABBArray> aabbs(new Collision::AABBArray());
+    std::vector<Objects::Body*> bodies;
+    bodies.push_back(createSphereBody(1, 2, 3, 0.5));
+    bodies.push_back(createSphereBody(-1, 0, 0, 1));
+    aabbs->setFromBodies(&bodies);
+
+    EXPECT_EQ(aabbs->size(), 2);
+    EXPECT_EQ(aabbs->lowerX[0], 0.5);
+    EXPECT_EQ(aabbs->upperZ[0], 3.5);
+    EXPECT_EQ(aabbs->lowerX[1], -2);
+    EXPECT_EQ(aabbs->boundingRadius[1], 1);
+    EXPECT_EQ(aabbs->collisionFilterMask[0], -1);
+    EXPECT_EQ(aabbs->inactive[0], 0);
+    EXPECT_EQ(aabbs->lowerX.size() % 8, 0);
+}
+
+TEST(AABBArray, OverlapBatch) {
+    std::unique_ptr<Collision::AABBArray> aabbs(new Collision::AABBArray());
+    std::vector<Objects::Body*> bodies;
+
+    std::srand(5);
+    for (int i = 0; i < 103; i++) {
+        bodies.push_back(createSphereBody(
+            (std::rand() % 1000) / 200.0f,
+            (std::rand() % 1000) / 200.0f,
+            (std::rand() % 1000) / 200.0f,
+            0.5));
+    }
+    aabbs->setFromBodies(&bodies);
+
+    // Compare to the scalar tests, with all possible start offsets
+    for (int i = 0; i < 8; i++) {
+        for (int start = 0; start < 9; start++) {
+            std::vector<int> boxes;
+            std::vector<int> spheres;
+            aabbs->overlapBatch(i, start, bodies.size(), &boxes);
+            aabbs->sphereBatch(i, start, bodies.size(), &spheres);
+
+            std::vector<int> expectedBoxes;
+            std::vector<int> expectedSpheres;
+            for (int j = start; j < bodies.size(); j++) {
+                if (bodies[i]->aabb.overlaps(&bodies[j]->aabb)) {
+                    expectedBoxes.push_back(j);
+                }
+                Math::Vec3 d;
+                bodies[i]->position.vsub(&bodies[j]->position, &d);
+                if (d.lengthSquared() < 1) {
+                    expectedSpheres.push_back(j);
+                }
+            }
+            EXPECT_EQ(boxes, expectedBoxes);
+            EXPECT_EQ(spheres, expectedSpheres);
+        }
+    }
+}
+
+TEST(AABBArray, Filter) {
+    std::unique_ptr<Collision::AABBArray> aabbs(new Collision::AABBArray());
+    std::vector<Objects::Body*> bodies;
+    for (int i = 0; i < 4; i++) {
+        bodies.push_back(createSphereBody(0, 0, 0, 0.5));
+    }
+    bodies[1]->collisionFilterGroup = 2;
+    bodies[1]->collisionFilterMask = 2;
+    bodies[2]->type = Objects::BodyType::STATIC;
+    bodies[3]->type = Objects::BodyType::STATIC;
+    aabbs->setFromBodies(&bodies);
+
+    std::vector<int> result;
+    aabbs->overlapBatch(0, 1, 4, &result);
+    EXPECT_EQ(result, std::vector<int>({ 2, 3 }));
+
+    result.clear();
+    aabbs->overlapBatch(2, 3, 4, &result);
+    EXPECT_TRUE(result.empty());
+}
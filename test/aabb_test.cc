@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include "collision/AABB.h"
+#include "collision/Ray.h"
+#include "math/Vec3.h"
+#include "math/Quaternion.h"
+#include "math/Transform.h"
+
+using namespace Cannon;
+
+TEST(AABB, Construct) {
+    std::unique_ptr<Collision::AABB> aabb(new Collision::AABB());
+
+    EXPECT_TRUE(aabb->lowerBound.isZero());
+    EXPECT_TRUE(aabb->upperBound.isZero());
+}
+
+TEST(AABB, Copy) {
+    std::unique_ptr<Collision::AABB> a(new Collision::AABB());
+    std::unique_ptr<Collision::AABB> b(new Collision::AABB());
+    a->upperBound.set(1, 2, 3);
+    b->copy(a.get());
+
+    EXPECT_TRUE(a->lowerBound.almostEquals(&b->lowerBound, 0.00001));
+    EXPECT_TRUE(a->upperBound.almostEquals(&b->upperBound, 0.00001));
+}
+
+TEST(AABB, Clone) {
+    std::unique_ptr<Collision::AABB> a(new Collision::AABB(Math::Vec3(-1, -2, -3), Math::Vec3(1, 2, 3)));
+    Collision::AABB b = a->clone();
+
+    EXPECT_TRUE(a->lowerBound.almostEquals(&b.lowerBound, 0.00001));
+    EXPECT_TRUE(a->upperBound.almostEquals(&b.upperBound, 0.00001));
+}
+
+TEST(AABB, Extend) {
+    std::unique_ptr<Collision::AABB> a(new Collision::AABB(Math::Vec3(-1, -1, -1), Math::Vec3(1, 1, 1)));
+    std::unique_ptr<Collision::AABB> b(new Collision::AABB(Math::Vec3(-2, -2, -2), Math::Vec3(2, 2, 2)));
+    a->extend(b.get());
+    EXPECT_TRUE(a->lowerBound.almostEquals(&b->lowerBound, 0.00001));
+    EXPECT_TRUE(a->upperBound.almostEquals(&b->upperBound, 0.00001));
+
+    a.reset(new Collision::AABB(Math::Vec3(-2, -1, -1), Math::Vec3(2, 1, 1)));
+    b.reset(new Collision::AABB(Math::Vec3(-1, -1, -1), Math::Vec3(1, 1, 1)));
+    a->extend(b.get());
+    EXPECT_EQ(a->lowerBound.x, -2);
+    EXPECT_EQ(a->upperBound.x, 2);
+
+    a.reset(new Collision::AABB(Math::Vec3(-2, -1, -1), Math::Vec3(2, 1, 1)));
+    b.reset(new Collision::AABB(Math::Vec3(-1, -3, -1), Math::Vec3(1, 3, 1)));
+    a->extend(b.get());
+    EXPECT_EQ(a->lowerBound.y, -3);
+    EXPECT_EQ(a->upperBound.y, 3);
+}
+
+TEST(AABB, Overlaps) {
+    std::unique_ptr<Collision::AABB> a(new Collision::AABB());
+    std::unique_ptr<Collision::AABB> b(new Collision::AABB());
+
+    // Same aabb
+    a->lowerBound.set(-1, -1, 0);
+    a->upperBound.set(1, 1, 0);
+    b->lowerBound.set(-1, -1, 0);
+    b->upperBound.set(1, 1, 0);
+    EXPECT_TRUE(a->overlaps(b.get()));
+
+    // Corner overlaps
+    b->lowerBound.set(1, 1, 0);
+    b->upperBound.set(2, 2, 0);
+    EXPECT_TRUE(a->overlaps(b.get()));
+
+    // Separate
+    b->lowerBound.set(1.1, 1.1, 0);
+    EXPECT_FALSE(a->overlaps(b.get()));
+
+    // fully inside
+    b->lowerBound.set(-0.5, -0.5, 0);
+    b->upperBound.set(0.5, 0.5, 0);
+    EXPECT_TRUE(a->overlaps(b.get()));
+    b->lowerBound.set(-1.5, -1.5, 0);
+    b->upperBound.set(1.5, 1.5, 0);
+    EXPECT_TRUE(a->overlaps(b.get()));
+
+    // Translated
+    b->lowerBound.set(-3, -0.5, 0);
+    b->upperBound.set(-2, 0.5, 0);
+    EXPECT_FALSE(a->overlaps(b.get()));
+}
+
+TEST(AABB, Contains) {
+    std::unique_ptr<Collision::AABB> a(new Collision::AABB());
+    std::unique_ptr<Collision::AABB> b(new Collision::AABB());
+
+    a->lowerBound.set(-1, -1, -1);
+    a->upperBound.set(1, 1, 1);
+    b->lowerBound.set(-1, -1, -1);
+    b->upperBound.set(1, 1, 1);
+    EXPECT_TRUE(a->contains(b.get()));
+
+    a->lowerBound.set(-2, -2, -2);
+    a->upperBound.set(2, 2, 2);
+    EXPECT_TRUE(a->contains(b.get()));
+
+    b->lowerBound.set(-3, -3, -3);
+    b->upperBound.set(3, 3, 3);
+    EXPECT_FALSE(a->contains(b.get()));
+
+    a->lowerBound.set(0, 0, 0);
+    a->upperBound.set(2, 2, 2);
+    b->lowerBound.set(-1, -1, -1);
+    b->upperBound.set(1, 1, 1);
+    EXPECT_FALSE(a->contains(b.get()));
+}
+
+TEST(AABB, SetFromPoints) {
+    std::unique_ptr<Collision::AABB> aabb(new Collision::AABB());
+    std::unique_ptr<std::vector<Math::Vec3>> points(new std::vector<Math::Vec3>{
+        Math::Vec3(7, 0, 1),
+        Math::Vec3(2, -1, 5),
+        Math::Vec3(-1, -7, 0)
+    });
+    std::unique_ptr<Math::Vec3> position(new Math::Vec3(1, 2, 3));
+    std::unique_ptr<Math::Quaternion> quaternion(new Math::Quaternion());
+    quaternion->setFromAxisAngle(new Math::Vec3(1, 0, 0), M_PI / 2);
+    float skinSize = 1;
+
+    aabb->setFromPoints(points.get(), nullptr, nullptr, 0);
+    EXPECT_EQ(aabb->lowerBound.x, -1);
+    EXPECT_EQ(aabb->lowerBound.y, -7);
+    EXPECT_EQ(aabb->lowerBound.z, 0);
+    EXPECT_EQ(aabb->upperBound.x, 7);
+    EXPECT_EQ(aabb->upperBound.y, 0);
+    EXPECT_EQ(aabb->upperBound.z, 5);
+
+    aabb->setFromPoints(points.get(), position.get(), nullptr, 0);
+    EXPECT_EQ(aabb->lowerBound.x, 0);
+    EXPECT_EQ(aabb->lowerBound.y, -5);
+    EXPECT_EQ(aabb->upperBound.z, 8);
+
+    aabb->setFromPoints(points.get(), position.get(), quaternion.get(), skinSize);
+    EXPECT_NEAR(aabb->lowerBound.x, -1, 0.0001);
+    EXPECT_NEAR(aabb->lowerBound.y, -4, 0.0001);
+    EXPECT_NEAR(aabb->lowerBound.z, -5, 0.0001);
+    EXPECT_NEAR(aabb->upperBound.x, 9, 0.0001);
+    EXPECT_NEAR(aabb->upperBound.y, 3, 0.0001);
+    EXPECT_NEAR(aabb->upperBound.z, 4, 0.0001);
+}
+
+TEST(AABB, ToLocalFrame) {
+    std::unique_ptr<Collision::AABB> worldAABB(new Collision::AABB());
+    std::unique_ptr<Collision::AABB> localAABB(new Collision::AABB());
+    std::unique_ptr<Math::Transform> frame(new Math::Transform());
+
+    worldAABB->lowerBound.set(-1, -1, -1);
+    worldAABB->upperBound.set(1, 1, 1);
+
+    // No transform - should stay the same
+    worldAABB->toLocalFrame(frame.get(), localAABB.get());
+    EXPECT_TRUE(localAABB->lowerBound.almostEquals(&worldAABB->lowerBound, 0.00001));
+    EXPECT_TRUE(localAABB->upperBound.almostEquals(&worldAABB->upperBound, 0.00001));
+}
+
+TEST(AABB, ToWorldFrame) {
+    std::unique_ptr<Collision::AABB> localAABB(new Collision::AABB());
+    std::unique_ptr<Collision::AABB> worldAABB(new Collision::AABB());
+    std::unique_ptr<Math::Transform> frame(new Math::Transform());
+
+    localAABB->lowerBound.set(-1, -1, -1);
+    localAABB->upperBound.set(1, 1, 1);
+
+    // No transform - should stay the same
+    localAABB->toWorldFrame(frame.get(), worldAABB.get());
+    EXPECT_TRUE(localAABB->lowerBound.almostEquals(&worldAABB->lowerBound, 0.00001));
+    EXPECT_TRUE(localAABB->upperBound.almostEquals(&worldAABB->upperBound, 0.00001));
+}
+
+TEST(AABB, OverlapsRay) {
+    std::unique_ptr<Collision::AABB> aabb(new Collision::AABB(Math::Vec3(-1, -1, -1), Math::Vec3(1, 1, 1)));
+
+    std::unique_ptr<Collision::Ray> hit(new Collision::Ray(Math::Vec3(-5, 0.5, 0.5), Math::Vec3(5, 0.5, 0.5)));
+    EXPECT_TRUE(aabb->overlapsRay(hit.get()));
+
+    std::unique_ptr<Collision::Ray> miss(new Collision::Ray(Math::Vec3(-5, 2, 0), Math::Vec3(5, 2, 0)));
+    EXPECT_FALSE(aabb->overlapsRay(miss.get()));
+
+    std::unique_ptr<Collision::Ray> behind(new Collision::Ray(Math::Vec3(5, 0, 0), Math::Vec3(10, 0, 0)));
+    EXPECT_FALSE(aabb->overlapsRay(behind.get()));
+}
+
+TEST(AABB, OverlapsSegment) {
+    Collision::AABB a(Math::Vec3(-1, -1, -1), Math::Vec3(1, 1, 1));
+    Math::Vec3 from(-5, 0, 0);
+    Math::Vec3 to(5, 0.5, 0);
+    EXPECT_TRUE(a.overlapsSegment(&from, &to));
+
+    // Stops short of the box
+    to.set(-2, 0, 0);
+    EXPECT_FALSE(a.overlapsSegment(&from, &to));
+
+    // Parallel to the x slab, outside of it
+    from.set(2, -5, 0);
+    to.set(2, 5, 0);
+    EXPECT_FALSE(a.overlapsSegment(&from, &to));
+}
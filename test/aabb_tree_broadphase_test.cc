@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include "collision/AABBTreeBroadphase.h"
+#include "collision/AABB.h"
+#include "objects/Body.h"
+#include "shapes/Sphere.h"
+#include "math/Vec3.h"
+#include "test/test_helpers.h"
+
+using namespace Cannon;
+
+TEST(AABBTreeBroadphase, CollisionPairs) {
+    std::unique_ptr<Collision::AABBTreeBroadphase> bp(new Collision::AABBTreeBroadphase());
+    std::vector<Objects::Body*> p1;
+    std::vector<Objects::Body*> p2;
+
+    Objects::Body* a = createSphereBody(0, 0, 0);
+    Objects::Body* b = createSphereBody(0.9, 0, 0);
+    Objects::Body* c = createSphereBody(5, 0, 0);
+    bp->addBody(a);
+    bp->addBody(b);
+    bp->addBody(c);
+
+    bp->collisionPairs(nullptr, &p1, &p2);
+    EXPECT_EQ(p1.size(), 1);
+
+    // Move c onto b, its leaf is reinserted on the next step
+    c->position.set(1.5, 0, 0);
+    c->aabbNeedsUpdate = true;
+    bp->dirty = true;
+    p1.clear();
+    p2.clear();
+    bp->collisionPairs(nullptr, &p1, &p2);
+    EXPECT_EQ(p1.size(), 2);
+
+    bp->removeBody(b);
+    p1.clear();
+    p2.clear();
+    bp->collisionPairs(nullptr, &p1, &p2);
+    EXPECT_EQ(p1.size(), 0);
+    EXPECT_EQ(bp->bodies.size(), 2);
+}
+
+TEST(AABBTreeBroadphase, CollisionPairsMatchBruteForce) {
+    std::unique_ptr<Collision::AABBTreeBroadphase> bp(new Collision::AABBTreeBroadphase());
+    bp->useBoundingBoxes = true;
+    std::vector<Objects::Body*> bodies;
+
+    std::srand(1);
+    for (int i = 0; i < 200; i++) {
+        Objects::Body* body = createSphereBody(
+            (std::rand() % 1000) / 100.0f,
+            (std::rand() % 1000) / 100.0f,
+            (std::rand() % 100) / 100.0f);
+        bodies.push_back(body);
+        bp->addBody(body);
+    }
+
+    for (int step = 0; step < 3; step++) {
+        std::vector<Objects::Body*> p1;
+        std::vector<Objects::Body*> p2;
+        bp->dirty = true;
+        bp->collisionPairs(nullptr, &p1, &p2);
+
+        std::vector<Objects::Body*> q1;
+        std::vector<Objects::Body*> q2;
+        for (int i = 0; i < bodies.size(); i++) {
+            for (int j = i + 1; j < bodies.size(); j++) {
+                bp->intersectionTest(bodies[i], bodies[j], &q1, &q2);
+            }
+        }
+        EXPECT_EQ(p1.size(), q1.size());
+
+        // Move everything a little
+        for (int i = 0; i < bodies.size(); i++) {
+            bodies[i]->position.x += ((std::rand() % 100) - 50) / 500.0f;
+            bodies[i]->aabbNeedsUpdate = true;
+        }
+    }
+}
+
+TEST(AABBTreeBroadphase, StaticTree) {
+    std::unique_ptr<Collision::AABBTreeBroadphase> bp(new Collision::AABBTreeBroadphase());
+    std::vector<Objects::Body*> p1;
+    std::vector<Objects::Body*> p2;
+
+    // A row of overlapping static bodies
+    for (int i = 0; i < 10; i++) {
+        Objects::Body* body = new Objects::Body(0);
+        body->addShape(new Shapes::Sphere(0.5), nullptr, nullptr);
+        body->position.set(i * 0.8, 0, 0);
+        body->aabbNeedsUpdate = true;
+        bp->addBody(body);
+    }
+    Objects::Body* dynamic = createSphereBody(0, 0.9, 0);
+    bp->addBody(dynamic);
+
+    EXPECT_EQ(bp->staticTree.getHeight(), 4);
+    EXPECT_EQ(bp->dynamicTree.getHeight(), 0);
+
+    bp->collisionPairs(nullptr, &p1, &p2);
+    EXPECT_EQ(p1.size(), 1);
+
+    // A sleeping body moves to the static tree
+    dynamic->sleepState = Objects::BodyState::SLEEPING;
+    bp->dirty = true;
+    p1.clear();
+    p2.clear();
+    bp->collisionPairs(nullptr, &p1, &p2);
+    EXPECT_EQ(p1.size(), 0);
+    EXPECT_EQ(bp->dynamicTree.root, -1);
+
+    dynamic->sleepState = Objects::BodyState::AWAKE;
+    bp->dirty = true;
+    p1.clear();
+    p2.clear();
+    bp->collisionPairs(nullptr, &p1, &p2);
+    EXPECT_EQ(p1.size(), 1);
+}
+
+TEST(AABBTreeBroadphase, AabbQuery) {
+    std::unique_ptr<Collision::AABBTreeBroadphase> bp(new Collision::AABBTreeBroadphase());
+    bp->addBody(createSphereBody(0, 0, 0));
+    bp->addBody(createSphereBody(3, 0, 0));
+    bp->addBody(createSphereBody(6, 0, 0));
+
+    std::unique_ptr<Collision::AABB> aabb(new Collision::AABB(Math::Vec3(-1, -1, -1), Math::Vec3(1, 1, 1)));
+    std::vector<Objects::Body*> result;
+    bp->aabbQuery(nullptr, aabb.get(), &result);
+    EXPECT_EQ(result.size(), 1);
+
+    aabb->upperBound.set(4, 1, 1);
+    result.clear();
+    bp->aabbQuery(nullptr, aabb.get(), &result);
+    EXPECT_EQ(result.size(), 2);
+}
+
+TEST(AABBTreeBroadphase, RayQuery) {
+    std::unique_ptr<Collision::AABBTreeBroadphase> bp(new Collision::AABBTreeBroadphase());
+    Objects::Body* a = createSphereBody(0, 0, 0);
+    bp->addBody(a);
+    bp->addBody(createSphereBody(3, 3, 0));
+
+    Math::Vec3 from(-5, 0, 0);
+    Math::Vec3 to(5, 0, 0);
+    std::vector<Objects::Body*> result;
+    bp->rayQuery(&from, &to, &result);
+    EXPECT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0], a);
+
+    // Inside the fat AABB of the second body, but not its AABB
+    from.set(-5, 3.55, 0);
+    to.set(5, 3.55, 0);
+    result.clear();
+    bp->rayQuery(&from, &to, &result);
+    EXPECT_EQ(result.size(), 0);
+}
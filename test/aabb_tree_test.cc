@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include "utils/AABBTree.h"
+#include "collision/AABB.h"
+#include "math/Vec3.h"
+
+using namespace Cannon;
+
+static Collision::AABB boxAt(float x, float y, float z, float halfExtent) {
+    return Collision::AABB(
+        Math::Vec3(x - halfExtent, y - halfExtent, z - halfExtent),
+        Math::Vec3(x + halfExtent, y + halfExtent, z + halfExtent));
+}
+
+TEST(AABBTree, CreateProxy) {
+    std::unique_ptr<Utils::AABBTree> tree(new Utils::AABBTree());
+    EXPECT_EQ(tree->getHeight(), 0);
+
+    Collision::AABB aabb = boxAt(0, 0, 0, 1);
+    int proxyId = tree->createProxy(&aabb, 7);
+
+    EXPECT_EQ(tree->getUserData(proxyId), 7);
+    EXPECT_NEAR(tree->getFatAABB(proxyId)->lowerBound.x, -1.1, 0.0001);
+    EXPECT_NEAR(tree->getFatAABB(proxyId)->upperBound.x, 1.1, 0.0001);
+}
+
+TEST(AABBTree, MoveProxy) {
+    std::unique_ptr<Utils::AABBTree> tree(new Utils::AABBTree());
+    Collision::AABB aabb = boxAt(0, 0, 0, 1);
+    int proxyId = tree->createProxy(&aabb, 0);
+
+    // Still inside the fat AABB
+    aabb = boxAt(0.05, 0, 0, 1);
+    EXPECT_FALSE(tree->moveProxy(proxyId, &aabb));
+
+    aabb = boxAt(0.5, 0, 0, 1);
+    EXPECT_TRUE(tree->moveProxy(proxyId, &aabb));
+    EXPECT_NEAR(tree->getFatAABB(proxyId)->upperBound.x, 1.6, 0.0001);
+}
+
+TEST(AABBTree, Balanced) {
+    std::unique_ptr<Utils::AABBTree> tree(new Utils::AABBTree());
+
+    // Sorted insertion would give a list without rotations
+    for (int i = 0; i < 1024; i++) {
+        Collision::AABB aabb = boxAt(i * 3, 0, 0, 1);
+        tree->createProxy(&aabb, i);
+    }
+
+    EXPECT_LE(tree->getHeight(), 20);
+}
+
+TEST(AABBTree, AabbQuery) {
+    std::unique_ptr<Utils::AABBTree> tree(new Utils::AABBTree());
+    std::vector<int> proxies;
+    for (int i = 0; i < 10; i++) {
+        Collision::AABB aabb = boxAt(i * 3, 0, 0, 1);
+        proxies.push_back(tree->createProxy(&aabb, i));
+    }
+
+    Collision::AABB query = boxAt(6, 0, 0, 2.5);
+    std::vector<int> result;
+    tree->aabbQuery(&query, &result);
+    std::sort(result.begin(), result.end());
+    EXPECT_EQ(result, std::vector<int>({ 1, 2, 3 }));
+
+    tree->destroyProxy(proxies[2]);
+    result.clear();
+    tree->aabbQuery(&query, &result);
+    std::sort(result.begin(), result.end());
+    EXPECT_EQ(result, std::vector<int>({ 1, 3 }));
+}
+
+TEST(AABBTree, RayQuery) {
+    std::unique_ptr<Utils::AABBTree> tree(new Utils::AABBTree());
+    for (int i = 0; i < 10; i++) {
+        Collision::AABB aabb = boxAt(i * 3, 0, 0, 1);
+        tree->createProxy(&aabb, i);
+    }
+
+    Math::Vec3 from(-5, 0, 0);
+    Math::Vec3 to(7, 0, 0);
+    std::vector<int> result;
+    tree->rayQuery(&from, &to, &result);
+    std::sort(result.begin(), result.end());
+    EXPECT_EQ(result, std::vector<int>({ 0, 1, 2 }));
+
+    from.set(6, -5, 0);
+    to.set(6, 5, 0);
+    result.clear();
+    tree->rayQuery(&from, &to, &result);
+    EXPECT_EQ(result, std::vector<int>({ 2 }));
+
+    from.set(6, 5, 0);
+    to.set(6, 3, 0);
+    result.clear();
+    tree->rayQuery(&from, &to, &result);
+    EXPECT_TRUE(result.empty());
+}
+
+TEST(AABBTree, QueryPairsMatchBruteForce) {
+    std::unique_ptr<Utils::AABBTree> tree(new Utils::AABBTree());
+    std::vector<Collision::AABB> boxes;
+
+    std::srand(2);
+    for (int i = 0; i < 300; i++) {
+        boxes.push_back(boxAt(
+            (std::rand() % 1000) / 50.0f,
+            (std::rand() % 1000) / 50.0f,
+            (std::rand() % 1000) / 50.0f,
+            0.5));
+        tree->createProxy(&boxes[i], i);
+    }
+
+    std::vector<int> pairs1;
+    std::vector<int> pairs2;
+    tree->queryPairs(&pairs1, &pairs2);
+
+    std::vector<std::pair<int, int>> treePairs;
+    for (int i = 0; i < pairs1.size(); i++) {
+        treePairs.push_back(std::make_pair(std::min(pairs1[i], pairs2[i]), std::max(pairs1[i], pairs2[i])));
+    }
+    std::sort(treePairs.begin(), treePairs.end());
+
+    std::vector<std::pair<int, int>> bruteForcePairs;
+    for (int i = 0; i < boxes.size(); i++) {
+        for (int j = i + 1; j < boxes.size(); j++) {
+            // Compare the fat AABBs
+            Collision::AABB a = boxes[i];
+            Collision::AABB b = boxes[j];
+            a.lowerBound.set(a.lowerBound.x - 0.1, a.lowerBound.y - 0.1, a.lowerBound.z - 0.1);
+            a.upperBound.set(a.upperBound.x + 0.1, a.upperBound.y + 0.1, a.upperBound.z + 0.1);
+            b.lowerBound.set(b.lowerBound.x - 0.1, b.lowerBound.y - 0.1, b.lowerBound.z - 0.1);
+            b.upperBound.set(b.upperBound.x + 0.1, b.upperBound.y + 0.1, b.upperBound.z + 0.1);
+            if (a.overlaps(&b)) {
+                bruteForcePairs.push_back(std::make_pair(i, j));
+            }
+        }
+    }
+
+    EXPECT_GT(bruteForcePairs.size(), 0);
+    EXPECT_EQ(treePairs, bruteForcePairs);
+}
+
+TEST(AABBTree, QueryTree) {
+    std::unique_ptr<Utils::AABBTree> a(new Utils::AABBTree());
+    std::unique_ptr<Utils::AABBTree> b(new Utils::AABBTree());
+    for (int i = 0; i < 10; i++) {
+        Collision::AABB aabb = boxAt(i * 3, 0, 0, 1);
+        a->createProxy(&aabb, i);
+    }
+    Collision::AABB aabb = boxAt(6, 0, 0, 2);
+    b->createProxy(&aabb, 100);
+    aabb = boxAt(6, 10, 0, 1);
+    b->createProxy(&aabb, 101);
+
+    std::vector<int> pairs1;
+    std::vector<int> pairs2;
+    a->queryTree(b.get(), &pairs1, &pairs2);
+    std::sort(pairs1.begin(), pairs1.end());
+    EXPECT_EQ(pairs1, std::vector<int>({ 1, 2, 3 }));
+    EXPECT_EQ(pairs2, std::vector<int>({ 100, 100, 100 }));
+}
+
+TEST(AABBTree, SplitQuery) {
+    std::unique_ptr<Utils::AABBTree> a(new Utils::AABBTree());
+    std::unique_ptr<Utils::AABBTree> b(new Utils::AABBTree());
+    std::srand(3);
+    for (int i = 0; i < 200; i++) {
+        Collision::AABB aabb = boxAt((std::rand() % 1000) / 50.0f, (std::rand() % 1000) / 50.0f, 0, 0.5);
+        a->createProxy(&aabb, i);
+        aabb = boxAt((std::rand() % 1000) / 50.0f, (std::rand() % 1000) / 50.0f, 0, 0.5);
+        b->createProxy(&aabb, i);
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        Utils::AABBTree* other = pass == 0 ? a.get() : b.get();
+        std::vector<int> pairs1;
+        std::vector<int> pairs2;
+        if (pass == 0) {
+            a->queryPairs(&pairs1, &pairs2);
+        } else {
+            a->queryTree(other, &pairs1, &pairs2);
+        }
+        std::vector<std::pair<int, int>> expected;
+        for (int i = 0; i < pairs1.size(); i++) {
+            expected.push_back(std::make_pair(pairs1[i], pairs2[i]));
+        }
+        std::sort(expected.begin(), expected.end());
+        EXPECT_GT(expected.size(), 0);
+
+        std::vector<int> nodePairs;
+        a->splitQuery(other, 16, &nodePairs);
+        EXPECT_GE(nodePairs.size() / 2, 16);
+
+        std::vector<int> stack;
+        pairs1.clear();
+        pairs2.clear();
+        for (int i = 0; i < nodePairs.size(); i += 2) {
+            a->queryNodes(other, nodePairs[i], nodePairs[i + 1], &pairs1, &pairs2, &stack);
+        }
+        std::vector<std::pair<int, int>> split;
+        for (int i = 0; i < pairs1.size(); i++) {
+            split.push_back(std::make_pair(pairs1[i], pairs2[i]));
+        }
+        std::sort(split.begin(), split.end());
+        EXPECT_EQ(split, expected);
+    }
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include "collision/BoxBox.h"
+#include "math/Quaternion.h"
+
+using namespace Cannon;
+
+TEST(BoxBox, FaceFace) {
+    // A small box resting on a bigger one, slightly sunk in
+    Collision::BoxBox boxBox;
+    Collision::BoxBoxResult result;
+    Math::Vec3 halfExtentsA(1, 1, 1);
+    Math::Vec3 halfExtentsB(0.5, 0.5, 0.5);
+    Math::Vec3 posA(0, 0, 0);
+    Math::Vec3 posB(0.1, 1.45, 0);
+    Math::Quaternion qa;
+    Math::Quaternion qb;
+
+    EXPECT_TRUE(boxBox.collide(&halfExtentsA, &posA, &qa, &halfExtentsB, &posB, &qb, &result, false));
+    EXPECT_NEAR(result.normal.y, 1, 1e-5);
+    EXPECT_NEAR(result.depth, 0.05, 1e-5);
+
+    // One contact per corner of the bottom face of the small box
+    ASSERT_EQ(result.contacts.size(), 4);
+    for (int i = 0; i < result.contacts.size(); i++) {
+        Collision::BoxBoxContact* contact = &result.contacts[i];
+        EXPECT_NEAR(contact->depth, 0.05, 1e-5);
+        EXPECT_NEAR(contact->pointA.y, 1, 1e-5);
+        EXPECT_NEAR(contact->pointB.y, 0.95, 1e-5);
+        EXPECT_NEAR(std::abs(contact->pointB.x - 0.1), 0.5, 1e-5);
+        EXPECT_NEAR(std::abs(contact->pointB.z), 0.5, 1e-5);
+    }
+
+    // Testing only skips the contacts
+    EXPECT_TRUE(boxBox.collide(&halfExtentsA, &posA, &qa, &halfExtentsB, &posB, &qb, &result, true));
+    EXPECT_EQ(result.contacts.size(), 0);
+
+    // Swapping the boxes flips the normal
+    EXPECT_TRUE(boxBox.collide(&halfExtentsB, &posB, &qb, &halfExtentsA, &posA, &qa, &result, false));
+    EXPECT_NEAR(result.normal.y, -1, 1e-5);
+    EXPECT_EQ(result.contacts.size(), 4);
+}
+
+TEST(BoxBox, Clipped) {
+    // A box turned 45 degrees around the normal on top of an equal box. The incident face is clipped to an octagon.
+    Collision::BoxBox boxBox;
+    Collision::BoxBoxResult result;
+    Math::Vec3 halfExtents(1, 1, 1);
+    Math::Vec3 posA(0, 0, 0);
+    Math::Vec3 posB(0, 1.9, 0);
+    Math::Vec3 axis(0, 1, 0);
+    Math::Quaternion qa;
+    Math::Quaternion qb;
+    qb.setFromAxisAngle(&axis, M_PI / 4);
+
+    EXPECT_TRUE(boxBox.collide(&halfExtents, &posA, &qa, &halfExtents, &posB, &qb, &result, false));
+    EXPECT_NEAR(result.normal.y, 1, 1e-5);
+    ASSERT_EQ(result.contacts.size(), 8);
+    for (int i = 0; i < result.contacts.size(); i++) {
+        EXPECT_NEAR(result.contacts[i].depth, 0.1, 1e-5);
+        EXPECT_LE(std::abs(result.contacts[i].pointA.x), 1 + 1e-5);
+        EXPECT_LE(std::abs(result.contacts[i].pointA.z), 1 + 1e-5);
+    }
+}
+
+TEST(BoxBox, EdgeEdge) {
+    // Crossed boxes touching along their edges
+    Collision::BoxBox boxBox;
+    Collision::BoxBoxResult result;
+    Math::Vec3 halfExtents(1, 1, 1);
+    Math::Vec3 posA(0, 0, 0);
+    Math::Vec3 posB(0, 2 * std::sqrt(2) - 0.1, 0);
+    Math::Vec3 axisA(0, 0, 1);
+    Math::Vec3 axisB(1, 0, 0);
+    Math::Quaternion qa;
+    Math::Quaternion qb;
+    qa.setFromAxisAngle(&axisA, M_PI / 4);
+    qb.setFromAxisAngle(&axisB, M_PI / 4);
+
+    EXPECT_TRUE(boxBox.collide(&halfExtents, &posA, &qa, &halfExtents, &posB, &qb, &result, false));
+    EXPECT_GE(result.axis, 6);
+    EXPECT_NEAR(result.normal.y, 1, 1e-4);
+    EXPECT_NEAR(result.depth, 0.1, 1e-4);
+    ASSERT_EQ(result.contacts.size(), 1);
+    Math::Vec3 expectedA(0, std::sqrt(2), 0);
+    Math::Vec3 expectedB(0, std::sqrt(2) - 0.1, 0);
+    EXPECT_TRUE(result.contacts[0].pointA.almostEquals(&expectedA, 1e-4));
+    EXPECT_TRUE(result.contacts[0].pointB.almostEquals(&expectedB, 1e-4));
+
+    // Moved apart, only an edge axis separates them
+    posB.set(0, 2 * std::sqrt(2) + 0.1, 0);
+    EXPECT_FALSE(boxBox.collide(&halfExtents, &posA, &qa, &halfExtents, &posB, &qb, &result, false));
+}
+
+TEST(BoxBox, Separated) {
+    Collision::BoxBox boxBox;
+    Collision::BoxBoxResult result;
+    Math::Vec3 halfExtents(0.5, 0.5, 0.5);
+    Math::Vec3 posA(0, 0, 0);
+    Math::Vec3 posB(1.01, 0, 0);
+    Math::Quaternion q;
+
+    EXPECT_FALSE(boxBox.collide(&halfExtents, &posA, &q, &halfExtents, &posB, &q, &result, false));
+    EXPECT_EQ(result.contacts.size(), 0);
+}
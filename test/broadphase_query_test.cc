@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include "collision/BroadphaseQuery.h"
+#include "collision/AABBTreeBroadphase.h"
+#include "objects/Body.h"
+#include "shapes/Sphere.h"
+#include "test/test_helpers.h"
+
+using namespace Cannon;
+
+static std::vector<Objects::Body*> addQueryBodies(Collision::Broadphase* bp, int count) {
+    std::vector<Objects::Body*> bodies;
+    std::srand(21);
+    for (int i = 0; i < count; i++) {
+        Objects::Body* body = createSphereBody((std::rand() % 2000) / 100.0f, (std::rand() % 2000) / 100.0f, (std::rand() % 2000) / 100.0f, 0.25);
+        bp->addBody(body);
+        bodies.push_back(body);
+    }
+    return bodies;
+}
+
+static std::vector<int> queryIds(std::vector<Objects::Body*>* results, std::vector<int>* offsets, int query) {
+    std::vector<int> ids;
+    for (int i = offsets->at(query); i < offsets->at(query + 1); i++) {
+        ids.push_back(results->at(i)->id);
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+TEST(BroadphaseQuery, Overlaps) {
+    Collision::AABB box(Math::Vec3(0, 0, 0), Math::Vec3(1, 1, 1));
+    Collision::BroadphaseQuery query;
+
+    Math::Vec3 center(2, 0.5, 0.5);
+    query.setSphere(&center, 0.9);
+    query.updateBounds();
+    EXPECT_FALSE(query.overlaps(&box));
+    query.setSphere(&center, 1.1);
+    query.updateBounds();
+    EXPECT_TRUE(query.overlaps(&box));
+
+    // A thin box rotated by 45 degrees around z, next to the corner of the AABB
+    Math::Quaternion q;
+    Math::Vec3 axis(0, 0, 1);
+    q.setFromAxisAngle(&axis, -M_PI / 4);
+    Math::Vec3 halfExtents(1, 0.1, 0.5);
+    Math::Vec3 boxCenter(1.5, 1.5, 0.5);
+    query.setBox(&boxCenter, &halfExtents, &q);
+    query.updateBounds();
+    EXPECT_TRUE(query.aabb.overlaps(&box));
+    EXPECT_FALSE(query.overlaps(&box));
+
+    boxCenter.set(1.2, 1.2, 0.5);
+    query.setBox(&boxCenter, &halfExtents, &q);
+    query.updateBounds();
+    EXPECT_FALSE(query.overlaps(&box));
+    boxCenter.set(1, 0.9, 0.5);
+    query.setBox(&boxCenter, &halfExtents, &q);
+    query.updateBounds();
+    EXPECT_TRUE(query.overlaps(&box));
+}
+
+TEST(BroadphaseQuery, Batch) {
+    std::unique_ptr<Collision::AABBTreeBroadphase> bp(new Collision::AABBTreeBroadphase());
+    std::vector<Objects::Body*> bodies = addQueryBodies(bp.get(), 500);
+
+    std::vector<Collision::BroadphaseQuery> queries(4);
+    Collision::AABB aabb(Math::Vec3(2, 2, 2), Math::Vec3(8, 6, 9));
+    Math::Vec3 center(10, 10, 10);
+    Math::Vec3 halfExtents(5, 1, 3);
+    Math::Quaternion q;
+    q.setFromEuler(0.3, 0.5, 0.7);
+    queries[0].setAABB(&aabb);
+    queries[1].setSphere(&center, 4);
+    queries[2].setBox(&center, &halfExtents, &q);
+    queries[3].setNearest(&center, 10, 100);
+
+    std::vector<Objects::Body*> results;
+    std::vector<int> offsets;
+    bp->queryBatch(nullptr, &queries, &results, &offsets);
+    ASSERT_EQ(offsets.size(), 5);
+    EXPECT_EQ(offsets[0], 0);
+    EXPECT_EQ(offsets[4], results.size());
+
+    // Brute force
+    std::vector<int> expected[3];
+    std::vector<std::pair<float, int>> distances;
+    for (int i = 0; i < bodies.size(); i++) {
+        for (int k = 0; k < 3; k++) {
+            if (queries[k].overlaps(&bodies[i]->aabb)) {
+                expected[k].push_back(bodies[i]->id);
+            }
+        }
+        distances.push_back(std::make_pair(Collision::BroadphaseQuery::distanceSquared(&center, &bodies[i]->aabb), bodies[i]->id));
+    }
+    for (int k = 0; k < 3; k++) {
+        std::sort(expected[k].begin(), expected[k].end());
+        EXPECT_GT(expected[k].size(), 0);
+        EXPECT_EQ(queryIds(&results, &offsets, k), expected[k]);
+    }
+
+    // The nearest bodies come sorted by distance
+    std::sort(distances.begin(), distances.end());
+    ASSERT_EQ(offsets[4] - offsets[3], 10);
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(results[offsets[3] + i]->id, distances[i].second);
+    }
+
+    // Reusing the buffers gives the same result
+    std::vector<Objects::Body*> first = results;
+    bp->queryBatch(nullptr, &queries, &results, &offsets);
+    EXPECT_EQ(results, first);
+}
+
+TEST(BroadphaseQuery, NearestMaxDistance) {
+    std::unique_ptr<Collision::AABBTreeBroadphase> bp(new Collision::AABBTreeBroadphase());
+    addQueryBodies(bp.get(), 100);
+
+    std::vector<Collision::BroadphaseQuery> queries(2);
+    Math::Vec3 far(100, 100, 100);
+    Math::Vec3 center(10, 10, 10);
+    queries[0].setNearest(&far, 3, 10);
+    queries[1].setNearest(&center, 1000, 50);
+
+    std::vector<Objects::Body*> results;
+    std::vector<int> offsets;
+    bp->queryBatch(nullptr, &queries, &results, &offsets);
+    EXPECT_EQ(offsets[1], 0);
+    EXPECT_EQ(offsets[2], 100);
+}
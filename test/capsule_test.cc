@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include "shapes/Capsule.h"
+#include "math/Vec3.h"
+
+using namespace Cannon;
+
+TEST(Capsule, ThrowOnWrongSize) {
+    bool error = false;
+    try {
+        std::unique_ptr<Shapes::Capsule> capsule(new Shapes::Capsule(-1, 1));
+    } catch (const std::exception& e) {
+        error = true;
+    }
+    EXPECT_TRUE(error);
+}
+
+TEST(Capsule, CalculateWorldAABB) {
+    Shapes::Capsule capsule(0.5, 2);
+    EXPECT_FLOAT_EQ(capsule.boundingSphereRadius, 1.5);
+
+    // Lying along X
+    Math::Vec3 pos(1, 0, 0);
+    Math::Vec3 axis(0, 1, 0);
+    Math::Quaternion quat;
+    quat.setFromAxisAngle(&axis, M_PI / 2);
+    Math::Vec3 min;
+    Math::Vec3 max;
+    capsule.calculateWorldAABB(&pos, &quat, &min, &max);
+    EXPECT_NEAR(min.x, -0.5, 1e-5);
+    EXPECT_NEAR(max.x, 2.5, 1e-5);
+    EXPECT_NEAR(min.y, -0.5, 1e-5);
+    EXPECT_NEAR(max.z, 0.5, 1e-5);
+}
+
+TEST(Capsule, SupportPoint) {
+    Shapes::Capsule capsule(0.5, 2);
+    Math::Vec3 direction(1, 0, 1);
+    Math::Vec3 support;
+    capsule.supportPoint(&direction, &support);
+    EXPECT_NEAR(support.x, 0.5 / std::sqrt(2), 1e-5);
+    EXPECT_NEAR(support.z, 1 + 0.5 / std::sqrt(2), 1e-5);
+
+    direction.set(0, 0, -3);
+    capsule.supportPoint(&direction, &support);
+    EXPECT_NEAR(support.z, -1.5, 1e-5);
+}
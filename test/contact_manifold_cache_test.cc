@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include "collision/ContactManifoldCache.h"
+#include "equations/ContactEquation.h"
+#include "objects/Body.h"
+#include "shapes/Sphere.h"
+#include "solver/GSSolver.h"
+
+using namespace Cannon;
+
+static Objects::Body* createManifoldBody(float mass, float x, float y, float z) {
+    Objects::Body* body = new Objects::Body(mass);
+    body->addShape(new Shapes::Sphere(0.5), nullptr, nullptr);
+    body->position.set(x, y, z);
+    return body;
+}
+
+static Equations::ContactEquation* createManifoldContact(Objects::Body* bi, Objects::Body* bj, float x, float z) {
+    Equations::ContactEquation* c = new Equations::ContactEquation(bi, bj);
+    c->si = bi->shapes[0];
+    c->sj = bj->shapes[0];
+    c->ni.set(0, 1, 0);
+    c->ri.set(x, 0.5, z);
+    c->rj.set(x, -0.5, z);
+    return c;
+}
+
+TEST(ContactManifoldCache, WarmStart) {
+    Collision::ContactManifoldCache cache;
+    Objects::Body* a = createManifoldBody(1, 0, 0, 0);
+    Objects::Body* b = createManifoldBody(1, 0, 1, 0);
+
+    std::vector<Equations::ContactEquation*> equations;
+    equations.push_back(createManifoldContact(a, b, 0.1, 0));
+    equations.push_back(createManifoldContact(a, b, -0.1, 0));
+    cache.warmStart(&equations);
+    EXPECT_EQ(equations[0]->lambda, 0);
+    equations[0]->lambda = 1;
+    equations[1]->lambda = 2;
+    cache.update(&equations);
+    EXPECT_EQ(cache.manifolds.size(), 1);
+    EXPECT_EQ(cache.getManifold(b, b->shapes[0], a, a->shapes[0])->points.size(), 2);
+
+    // Same points with the bodies swapped, in the other order
+    std::vector<Equations::ContactEquation*> swapped;
+    Equations::ContactEquation* c = createManifoldContact(b, a, -0.1, 0);
+    c->ri.set(-0.1, -0.5, 0);
+    c->rj.set(-0.1, 0.5, 0);
+    swapped.push_back(c);
+    c = createManifoldContact(b, a, 0.1, 0);
+    c->ri.set(0.1, -0.5, 0);
+    c->rj.set(0.1, 0.5, 0);
+    swapped.push_back(c);
+    cache.warmStart(&swapped);
+    EXPECT_EQ(swapped[0]->lambda, 2);
+    EXPECT_EQ(swapped[1]->lambda, 1);
+
+    // A point that moved too far is not matched
+    std::vector<Equations::ContactEquation*> moved;
+    moved.push_back(createManifoldContact(a, b, 0.3, 0));
+    cache.warmStart(&moved);
+    EXPECT_EQ(moved[0]->lambda, 0);
+}
+
+TEST(ContactManifoldCache, Rotation) {
+    Collision::ContactManifoldCache cache;
+    Objects::Body* a = createManifoldBody(1, 0, 0, 0);
+    Objects::Body* b = createManifoldBody(1, 0, 1, 0);
+
+    std::vector<Equations::ContactEquation*> equations;
+    equations.push_back(createManifoldContact(a, b, 0.2, 0));
+    equations[0]->lambda = 3;
+    cache.update(&equations);
+
+    // Rotating both bodies rotates the world offsets, but not the local points
+    Math::Vec3 axis(0, 1, 0);
+    a->quaternion.setFromAxisAngle(&axis, M_PI / 2);
+    b->quaternion.setFromAxisAngle(&axis, M_PI / 2);
+    std::vector<Equations::ContactEquation*> rotated;
+    rotated.push_back(createManifoldContact(a, b, 0, -0.2));
+    cache.warmStart(&rotated);
+    EXPECT_EQ(rotated[0]->lambda, 3);
+
+    std::vector<Equations::ContactEquation*> unrotated;
+    unrotated.push_back(createManifoldContact(a, b, 0.2, 0));
+    cache.warmStart(&unrotated);
+    EXPECT_EQ(unrotated[0]->lambda, 0);
+}
+
+TEST(ContactManifoldCache, RemoveStale) {
+    Collision::ContactManifoldCache cache;
+    Objects::Body* a = createManifoldBody(1, 0, 0, 0);
+    Objects::Body* b = createManifoldBody(1, 0, 1, 0);
+    Objects::Body* c = createManifoldBody(1, 0, -1, 0);
+
+    std::vector<Equations::ContactEquation*> equations;
+    equations.push_back(createManifoldContact(a, b, 0, 0));
+    equations.push_back(createManifoldContact(c, a, 0, 0));
+    cache.update(&equations);
+    EXPECT_EQ(cache.manifolds.size(), 2);
+
+    equations.erase(equations.begin());
+    cache.update(&equations);
+    EXPECT_EQ(cache.manifolds.size(), 1);
+    EXPECT_EQ(cache.getManifold(a, a->shapes[0], b, b->shapes[0]), nullptr);
+    EXPECT_NE(cache.getManifold(a, a->shapes[0], c, c->shapes[0]), nullptr);
+
+    equations.clear();
+    cache.update(&equations);
+    EXPECT_EQ(cache.manifolds.size(), 0);
+}
+
+TEST(ContactManifoldCache, SolverWarmStart) {
+    // A sphere resting on a static one, pushed down by gravity every step
+    Objects::Body* ground = createManifoldBody(0, 0, 0, 0);
+    Objects::Body* sphere = createManifoldBody(1, 0, 1, 0);
+    std::vector<Objects::Body*> bodies = {ground, sphere};
+    double dt = 1.0 / 60.0;
+
+    Collision::ContactManifoldCache cache;
+    Solver::GSSolver solver;
+    solver.iterations = 100;
+    solver.tolerance = 1e-4;
+    solver.warmStartFactor = 1;
+
+    int coldIterations = 0;
+    int warmIterations = 0;
+    for (int step = 0; step != 3; step++) {
+        sphere->velocity.set(0, -9.82 * dt, 0);
+        std::vector<Equations::ContactEquation*> equations;
+        equations.push_back(createManifoldContact(ground, sphere, 0, 0));
+        cache.warmStart(&equations);
+
+        solver.equations.clear();
+        solver.equations.push_back(equations[0]);
+        int iterations = solver.solveBodies(dt, &bodies);
+        if (step == 0) {
+            coldIterations = iterations;
+        } else {
+            warmIterations = iterations;
+            EXPECT_GT(equations[0]->lambda, 0);
+        }
+        EXPECT_NEAR(sphere->velocity.y, 0, 0.05);
+        cache.update(&equations);
+    }
+    EXPECT_LT(warmIterations, coldIterations);
+}
@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include "collision/ContactReduction.h"
+
+using namespace Cannon;
+
+TEST(ContactReduction, Few) {
+    std::vector<Math::Vec3> points = { Math::Vec3(0, 0, 0), Math::Vec3(1, 0, 0), Math::Vec3(0, 1, 0) };
+    std::vector<float> depths = { 0.1, 0.2, 0.3 };
+    Math::Vec3 normal(0, 0, 1);
+    std::vector<int> kept;
+    Collision::ContactReduction::reduce(&points, &depths, &normal, &kept);
+    EXPECT_EQ(kept, std::vector<int>({ 0, 1, 2 }));
+}
+
+TEST(ContactReduction, Octagon) {
+    // The corners of an octagon, with one deeper corner and a point in the middle
+    std::vector<Math::Vec3> points;
+    std::vector<float> depths;
+    for (int i = 0; i < 8; i++) {
+        float angle = i * M_PI / 4;
+        points.push_back(Math::Vec3(std::cos(angle), std::sin(angle), 0));
+        depths.push_back(i == 3 ? 0.2 : 0.1);
+    }
+    points.push_back(Math::Vec3(0, 0, 0));
+    depths.push_back(0.1);
+    Math::Vec3 normal(0, 0, 1);
+    std::vector<int> kept;
+    Collision::ContactReduction::reduce(&points, &depths, &normal, &kept);
+
+    ASSERT_EQ(kept.size(), 4);
+    EXPECT_EQ(kept[0], 3);
+
+    // Then the opposite corner, and a square spanning the octagon
+    EXPECT_EQ(kept[1], 7);
+    std::vector<int> sorted = kept;
+    std::sort(sorted.begin(), sorted.end());
+    EXPECT_EQ(sorted[0] % 2, 1);
+    EXPECT_EQ(sorted, std::vector<int>({ 1, 3, 5, 7 }));
+}
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 
 #include <cmath>
+#include <random>
+#include "collision/GJK.h"
+#include "utils/ThreadPool.h"
 #include "shapes/Box.h"
 #include "shapes/ConvexPolyhedron.h"
 #include "math/Vec3.h"
@@ -22,6 +25,31 @@ Shapes::ConvexPolyhedron* createBoxHull() {
     return createBoxHull(0.5);
 }
 
+Shapes::ConvexPolyhedron* createPrismHull(int n) {
+    std::vector<Math::Vec3>* vertices = new std::vector<Math::Vec3>();
+    for (int i = 0; i < n; i++) {
+        float angle = 2 * M_PI * i / n;
+        vertices->push_back(Math::Vec3(std::cos(angle), std::sin(angle), -0.5));
+    }
+    for (int i = 0; i < n; i++) {
+        float angle = 2 * M_PI * i / n;
+        vertices->push_back(Math::Vec3(std::cos(angle), std::sin(angle), 0.5));
+    }
+
+    std::vector<std::vector<int>>* faces = new std::vector<std::vector<int>>();
+    std::vector<int> bottom;
+    std::vector<int> top;
+    for (int i = 0; i < n; i++) {
+        bottom.push_back(n - 1 - i);
+        top.push_back(n + i);
+        faces->push_back({i, (i + 1) % n, n + (i + 1) % n, n + i});
+    }
+    faces->push_back(bottom);
+    faces->push_back(top);
+
+    return new Shapes::ConvexPolyhedron(vertices, faces);
+}
+
 TEST(ConvexPolyhedron, CalculateWorldAABB) {
     Shapes::ConvexPolyhedron* poly = createPolyBox(1, 1, 1);
 
@@ -244,3 +272,168 @@ TEST(ConvexPolyhedron, Project) {
     EXPECT_TRUE(std::abs(result->at(0) - 1.5) < 0.01);
     EXPECT_TRUE(std::abs(result->at(1) - 0.5) < 0.01);
 }
+
+TEST(ConvexPolyhedron, ComputeEdges) {
+    Shapes::ConvexPolyhedron* hull = createBoxHull();
+
+    // Each edge direction of a box is shared by four edges, with a face on each side
+    ASSERT_EQ(hull->uniqueEdges.size(), 3);
+    ASSERT_EQ(hull->uniqueEdgeFaces.size(), 3);
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(hull->uniqueEdgeFaces[i].size(), 4);
+        for (int j = 0; j < 4; j++) {
+            EXPECT_NE(hull->uniqueEdgeFaces[i][j][0], -1);
+            EXPECT_NE(hull->uniqueEdgeFaces[i][j][1], -1);
+            EXPECT_NE(hull->uniqueEdgeFaces[i][j][0], hull->uniqueEdgeFaces[i][j][1]);
+        }
+    }
+}
+
+TEST(ConvexPolyhedron, IsMinkowskiFace) {
+    Math::Vec3 a(1, 0, 0);
+    Math::Vec3 b(0, 1, 0);
+    Math::Vec3 c(1, 1, 1);
+    Math::Vec3 d(1, 1, -1);
+    c.normalize();
+    d.normalize();
+    EXPECT_TRUE(Shapes::ConvexPolyhedron::isMinkowskiFace(&a, &b, &c, &d));
+
+    // The arcs are on opposite sides of the sphere
+    c.negate(&c);
+    d.negate(&d);
+    EXPECT_FALSE(Shapes::ConvexPolyhedron::isMinkowskiFace(&a, &b, &c, &d));
+}
+
+TEST(ConvexPolyhedron, FindSepAxisEdges) {
+    // Pruned edge pairs must not change the result, so compare against GJK and EPA
+    Shapes::ConvexPolyhedron* hullA = createPrismHull(7);
+    Shapes::ConvexPolyhedron* hullB = createPrismHull(5);
+    Collision::GJK gjk;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1, 1);
+
+    int overlapping = 0;
+    for (int i = 0; i < 200; i++) {
+        Math::Vec3 posA(0, 0, 0);
+        Math::Vec3 posB(dist(rng) * 2, dist(rng) * 2, dist(rng) * 2);
+        Math::Quaternion quatA(dist(rng), dist(rng), dist(rng), dist(rng));
+        Math::Quaternion quatB(dist(rng), dist(rng), dist(rng), dist(rng));
+        quatA.normalize();
+        quatB.normalize();
+
+        Math::Vec3 axis;
+        bool found = hullA->findSeparatingAxis(hullB, &posA, &quatA, &posB, &quatB, &axis);
+        Collision::GJKResult result;
+        bool penetrating = gjk.penetration(hullA, &posA, &quatA, hullB, &posB, &quatB, &result);
+        if (std::abs(result.distance) < 1e-3 && std::abs(result.depth) < 1e-3) {
+            // Touching, either answer is fine
+            continue;
+        }
+        ASSERT_EQ(found, penetrating);
+
+        if (found) {
+            overlapping++;
+            Shapes::DepthOrBool d = hullA->testSepAxis(&axis, hullB, &posA, &quatA, &posB, &quatB);
+            EXPECT_NEAR(d.depth, result.depth, 1e-3);
+        }
+    }
+    EXPECT_GT(overlapping, 0);
+}
+
+TEST(ConvexPolyhedron, GetExtremeVertex) {
+    Shapes::ConvexPolyhedron* hull = createPrismHull(40);
+    ASSERT_EQ(hull->vertexNeighbors.size(), 80);
+    EXPECT_EQ(hull->vertexNeighbors[0].size(), 3);
+
+    // The walk ends at the furthest vertex from any start
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1, 1);
+    for (int i = 0; i < 50; i++) {
+        Math::Vec3 direction(dist(rng), dist(rng), dist(rng));
+        float max = -MAX_FLOAT;
+        for (int j = 0; j < hull->vertices->size(); j++) {
+            max = std::max(max, hull->vertices->at(j).dot(&direction));
+        }
+        int vertex = hull->getExtremeVertex(&direction, i);
+        EXPECT_FLOAT_EQ(hull->vertices->at(vertex).dot(&direction), max);
+    }
+}
+
+TEST(ConvexPolyhedron, ProjectHillClimbing) {
+    Shapes::ConvexPolyhedron* hull = createPrismHull(40);
+    Shapes::ConvexPolyhedron* scanned = createPrismHull(40);
+    scanned->hillClimbingThreshold = 1000;
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> dist(-1, 1);
+    int vertexHints[2] = { 0, 0 };
+    for (int i = 0; i < 50; i++) {
+        Math::Vec3 axis(dist(rng), dist(rng), dist(rng));
+        axis.normalize();
+        Math::Vec3 pos(dist(rng), dist(rng), dist(rng));
+        Math::Quaternion quat(dist(rng), dist(rng), dist(rng), dist(rng));
+        quat.normalize();
+
+        std::array<float, 2> result;
+        std::array<float, 2> expected;
+        Shapes::ConvexPolyhedron::project(hull, &axis, &pos, &quat, &result);
+        Shapes::ConvexPolyhedron::project(scanned, &axis, &pos, &quat, &expected);
+        EXPECT_NEAR(result[0], expected[0], 1e-5);
+        EXPECT_NEAR(result[1], expected[1], 1e-5);
+
+        // Starting from the vertices of the last axis gives the same result
+        Shapes::ConvexPolyhedron::project(hull, &axis, &pos, &quat, &result, vertexHints);
+        EXPECT_NEAR(result[0], expected[0], 1e-5);
+        EXPECT_NEAR(result[1], expected[1], 1e-5);
+    }
+}
+
+TEST(ConvexPolyhedron, ParallelCollision) {
+    // The same hulls tested against each other on several threads give the same results as on one
+    Shapes::ConvexPolyhedron* hullA = createPrismHull(40);
+    Shapes::ConvexPolyhedron* hullB = createPrismHull(6);
+
+    int count = 256;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> dist(-1, 1);
+    std::vector<Math::Vec3> positions;
+    std::vector<Math::Quaternion> quaternions;
+    for (int i = 0; i < count; i++) {
+        positions.push_back(Math::Vec3(dist(rng), dist(rng), dist(rng)));
+        Math::Quaternion q(dist(rng), dist(rng), dist(rng), dist(rng));
+        q.normalize();
+        quaternions.push_back(q);
+    }
+
+    auto collide = [&](int i, Math::Vec3* axis, std::vector<Shapes::PointObject>* points) {
+        Math::Vec3 posA;
+        Math::Quaternion quatA;
+        if (hullA->findSeparatingAxis(hullB, &posA, &quatA, &positions[i], &quaternions[i], axis)) {
+            hullA->clipAgainstHull(&posA, &quatA, hullB, &positions[i], &quaternions[i], axis, -100, 100, points);
+        }
+    };
+
+    std::vector<Math::Vec3> expectedAxes(count);
+    std::vector<std::vector<Shapes::PointObject>> expectedPoints(count);
+    for (int i = 0; i < count; i++) {
+        collide(i, &expectedAxes[i], &expectedPoints[i]);
+    }
+
+    std::vector<Math::Vec3> axes(count);
+    std::vector<std::vector<Shapes::PointObject>> points(count);
+    Utils::ThreadPool pool(4);
+    pool.run(count, [&](int task, int thread) {
+        collide(task, &axes[task], &points[task]);
+    });
+
+    for (int i = 0; i < count; i++) {
+        EXPECT_NEAR(axes[i].x, expectedAxes[i].x, 1e-5);
+        EXPECT_NEAR(axes[i].y, expectedAxes[i].y, 1e-5);
+        EXPECT_NEAR(axes[i].z, expectedAxes[i].z, 1e-5);
+        ASSERT_EQ(points[i].size(), expectedPoints[i].size());
+        for (int j = 0; j < points[i].size(); j++) {
+            EXPECT_NEAR(points[i][j].depth, expectedPoints[i][j].depth, 1e-5);
+            EXPECT_TRUE(points[i][j].point.almostEquals(&expectedPoints[i][j].point, 1e-5));
+        }
+    }
+}
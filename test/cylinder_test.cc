@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include "shapes/Cylinder.h"
+#include "math/Vec3.h"
+
+using namespace Cannon;
+
+TEST(Cylinder, CalculateWorldAABB) {
+    Shapes::Cylinder cylinder(1, 4);
+    EXPECT_FLOAT_EQ(cylinder.boundingSphereRadius, std::sqrt(5));
+
+    Math::Vec3 pos(0, 0, 0);
+    Math::Quaternion quat;
+    Math::Vec3 min;
+    Math::Vec3 max;
+    cylinder.calculateWorldAABB(&pos, &quat, &min, &max);
+    EXPECT_NEAR(min.x, -1, 1e-5);
+    EXPECT_NEAR(max.y, 1, 1e-5);
+    EXPECT_NEAR(max.z, 2, 1e-5);
+
+    // Lying along Y. Round off in the axis is magnified by the square root, but only ever grows the box.
+    Math::Vec3 axis(1, 0, 0);
+    quat.setFromAxisAngle(&axis, M_PI / 2);
+    cylinder.calculateWorldAABB(&pos, &quat, &min, &max);
+    EXPECT_NEAR(max.x, 1, 1e-3);
+    EXPECT_NEAR(max.y, 2, 1e-3);
+    EXPECT_NEAR(max.z, 1, 1e-3);
+    EXPECT_GE(max.y, 2);
+}
+
+TEST(Cylinder, SupportPoint) {
+    Shapes::Cylinder cylinder(1, 4);
+    Math::Vec3 direction(3, 4, -1);
+    Math::Vec3 support;
+    cylinder.supportPoint(&direction, &support);
+    EXPECT_NEAR(support.x, 0.6, 1e-5);
+    EXPECT_NEAR(support.y, 0.8, 1e-5);
+    EXPECT_NEAR(support.z, -2, 1e-5);
+}
+
+TEST(Cylinder, Volume) {
+    Shapes::Cylinder cylinder(1, 2);
+    EXPECT_NEAR(cylinder.volume(), 2 * M_PI, 1e-5);
+
+    Math::Vec3 inertia;
+    cylinder.calculateLocalInertia(12, &inertia);
+    EXPECT_NEAR(inertia.x, 7, 1e-5);
+    EXPECT_NEAR(inertia.z, 6, 1e-5);
+}
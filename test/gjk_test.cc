@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include "collision/GJK.h"
+#include "shapes/Box.h"
+#include "shapes/Sphere.h"
+#include "shapes/ConvexPolyhedron.h"
+
+using namespace Cannon;
+
+static Shapes::ConvexPolyhedron* createGJKTetrahedron(float size) {
+    std::vector<Math::Vec3>* vertices = new std::vector<Math::Vec3>({
+        Math::Vec3(0, 0, 0),
+        Math::Vec3(size, 0, 0),
+        Math::Vec3(0, size, 0),
+        Math::Vec3(0, 0, size)
+    });
+    std::vector<std::vector<int>>* faces = new std::vector<std::vector<int>>({
+        {0, 2, 1},
+        {0, 3, 2},
+        {0, 1, 3},
+        {1, 2, 3}
+    });
+    return new Shapes::ConvexPolyhedron(vertices, faces);
+}
+
+TEST(GJK, SphereSphere) {
+    Collision::GJK gjk;
+    Collision::GJKResult result;
+    Shapes::Sphere a(1);
+    Shapes::Sphere b(0.5);
+    Math::Vec3 posA(0, 0, 0);
+    Math::Vec3 posB(3, 0, 0);
+    Math::Quaternion q;
+
+    EXPECT_TRUE(gjk.distance(&a, &posA, &q, &b, &posB, &q, &result));
+    EXPECT_NEAR(result.distance, 1.5, 1e-3);
+    EXPECT_NEAR(result.normal.x, 1, 1e-3);
+    EXPECT_NEAR(result.pointA.x, 1, 1e-3);
+    EXPECT_NEAR(result.pointB.x, 2.5, 1e-3);
+
+    posB.set(0, 1.2, 0);
+    EXPECT_FALSE(gjk.distance(&a, &posA, &q, &b, &posB, &q, &result));
+    EXPECT_TRUE(result.intersecting);
+
+    EXPECT_TRUE(gjk.penetration(&a, &posA, &q, &b, &posB, &q, &result));
+    EXPECT_NEAR(result.depth, 0.3, 0.02);
+    EXPECT_NEAR(result.normal.y, 1, 0.02);
+}
+
+TEST(GJK, BoxBox) {
+    Collision::GJK gjk;
+    Collision::GJKResult result;
+    Shapes::Box a(new Math::Vec3(1, 1, 1));
+    Shapes::Box b(new Math::Vec3(0.5, 0.5, 0.5));
+    Math::Vec3 posA(0, 0, 0);
+    Math::Vec3 posB(0, 0, 2);
+    Math::Quaternion qa;
+    Math::Quaternion qb;
+
+    // Rotated 45 degrees around z, so the edge of b points at a
+    Math::Vec3 axis(0, 0, 1);
+    qb.setFromAxisAngle(&axis, M_PI / 4);
+    posB.set(2.5, 0, 0);
+    EXPECT_TRUE(gjk.distance(&a, &posA, &qa, &b, &posB, &qb, &result));
+    EXPECT_NEAR(result.distance, 1.5 - 0.5 * std::sqrt(2), 1e-4);
+    EXPECT_NEAR(result.pointA.x, 1, 1e-4);
+    EXPECT_NEAR(result.pointB.y, 0, 1e-4);
+
+    // Face to face overlap of 0.25 along x
+    qb.set(0, 0, 0, 1);
+    posB.set(1.25, 0.2, 0.1);
+    EXPECT_TRUE(gjk.penetration(&a, &posA, &qa, &b, &posB, &qb, &result));
+    EXPECT_NEAR(result.depth, 0.25, 1e-3);
+    EXPECT_NEAR(result.normal.x, 1, 1e-3);
+    EXPECT_NEAR(result.pointA.x - result.pointB.x, 0.25, 1e-3);
+
+    // Same boxes, swapped
+    posA.set(1.25, 0.2, 0.1);
+    posB.set(0, 0, 0);
+    EXPECT_TRUE(gjk.penetration(&b, &posA, &qb, &a, &posB, &qa, &result));
+    EXPECT_NEAR(result.depth, 0.25, 1e-3);
+    EXPECT_NEAR(result.normal.x, -1, 1e-3);
+}
+
+TEST(GJK, ConvexPolyhedron) {
+    Collision::GJK gjk;
+    Collision::GJKResult result;
+    std::unique_ptr<Shapes::ConvexPolyhedron> tetra(createGJKTetrahedron(1));
+    Shapes::Box box(new Math::Vec3(0.5, 0.5, 0.5));
+    Math::Quaternion q;
+
+    // The slanted face of the tetrahedron, x + y + z = 1, faces the box corner
+    Math::Vec3 tetraPos(0, 0, 0);
+    Math::Vec3 boxPos(1, 1, 1);
+    EXPECT_TRUE(gjk.distance(tetra.get(), &tetraPos, &q, &box, &boxPos, &q, &result));
+    EXPECT_NEAR(result.distance, 0.5 / std::sqrt(3), 1e-4);
+    EXPECT_NEAR(result.normal.x, 1 / std::sqrt(3), 1e-4);
+
+    boxPos.set(0.6, 0.6, 0.6);
+    EXPECT_TRUE(gjk.penetration(tetra.get(), &tetraPos, &q, &box, &boxPos, &q, &result));
+    EXPECT_NEAR(result.depth, 0.7 / std::sqrt(3), 1e-3);
+    EXPECT_NEAR(result.normal.y, 1 / std::sqrt(3), 1e-3);
+}
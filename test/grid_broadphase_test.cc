@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include "collision/GridBroadphase.h"
+#include "collision/AABB.h"
+#include "objects/Body.h"
+#include "shapes/Sphere.h"
+#include "shapes/Plane.h"
+#include "math/Vec3.h"
+#include "test/test_helpers.h"
+
+using namespace Cannon;
+
+static std::unique_ptr<Collision::GridBroadphase> createGrid() {
+    Math::Vec3 aabbMin(0, 0, 0);
+    Math::Vec3 aabbMax(10, 10, 10);
+    return std::unique_ptr<Collision::GridBroadphase>(new Collision::GridBroadphase(&aabbMin, &aabbMax, 10, 10, 10));
+}
+
+TEST(GridBroadphase, Construct) {
+    std::unique_ptr<Collision::GridBroadphase> bp(new Collision::GridBroadphase());
+    EXPECT_EQ(bp->aabbMin.x, -100);
+    EXPECT_EQ(bp->aabbMax.x, 100);
+    EXPECT_EQ(bp->nx, 10);
+}
+
+TEST(GridBroadphase, CollisionPairs) {
+    std::unique_ptr<Collision::GridBroadphase> bp = createGrid();
+    std::vector<Objects::Body*> p1;
+    std::vector<Objects::Body*> p2;
+
+    // Overlapping in several cells, but reported once
+    bp->addBody(createSphereBody(1, 1, 1, 0.5));
+    bp->addBody(createSphereBody(1.9, 1, 1, 0.5));
+    bp->addBody(createSphereBody(5, 5, 5, 0.5));
+    bp->collisionPairs(nullptr, &p1, &p2);
+    EXPECT_EQ(p1.size(), 1);
+
+    // Outside the grid region
+    bp->addBody(createSphereBody(-50, 0, 0, 0.5));
+    bp->addBody(createSphereBody(-50.5, 0, 0, 0.5));
+    p1.clear();
+    p2.clear();
+    bp->collisionPairs(nullptr, &p1, &p2);
+    EXPECT_EQ(p1.size(), 2);
+}
+
+TEST(GridBroadphase, SecondLevel) {
+    std::unique_ptr<Collision::GridBroadphase> bp = createGrid();
+    std::vector<Objects::Body*> p1;
+    std::vector<Objects::Body*> p2;
+
+    bp->addBody(createSphereBody(5, 5, 5, 3));
+    bp->addBody(createSphereBody(5.5, 5.5, 7.5, 0.4));
+    bp->addBody(createSphereBody(5.5, 5.5, 9.5, 0.4));
+    bp->collisionPairs(nullptr, &p1, &p2);
+
+    EXPECT_EQ(p1.size(), 1);
+    EXPECT_EQ(bp->level1.entryBody.size(), 2);
+}
+
+TEST(GridBroadphase, Plane) {
+    std::unique_ptr<Collision::GridBroadphase> bp = createGrid();
+    std::vector<Objects::Body*> p1;
+    std::vector<Objects::Body*> p2;
+
+    Objects::Body* ground = new Objects::Body(0);
+    ground->addShape(new Shapes::Plane(), nullptr, nullptr);
+    bp->addBody(ground);
+    bp->addBody(createSphereBody(1, 1, 0.4, 0.5));
+    bp->addBody(createSphereBody(5, 5, 5, 0.5));
+    bp->useBoundingBoxes = true;
+    bp->collisionPairs(nullptr, &p1, &p2);
+
+    EXPECT_EQ(bp->globalBodies.size(), 1);
+    EXPECT_EQ(p1.size(), 1);
+}
+
+TEST(GridBroadphase, CollisionPairsMatchBruteForce) {
+    std::unique_ptr<Collision::GridBroadphase> bp = createGrid();
+    bp->useBoundingBoxes = true;
+    std::vector<Objects::Body*> bodies;
+
+    std::srand(3);
+    for (int i = 0; i < 300; i++) {
+        float radius = i % 20 == 0 ? 2.5 : 0.4;
+        Objects::Body* body = createSphereBody(
+            (std::rand() % 1000) / 100.0f,
+            (std::rand() % 1000) / 100.0f,
+            (std::rand() % 1000) / 100.0f,
+            radius);
+        bodies.push_back(body);
+        bp->addBody(body);
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        bp->useSecondLevel = pass == 0;
+
+        std::vector<Objects::Body*> p1;
+        std::vector<Objects::Body*> p2;
+        bp->collisionPairs(nullptr, &p1, &p2);
+
+        std::vector<Objects::Body*> q1;
+        std::vector<Objects::Body*> q2;
+        for (int i = 0; i < bodies.size(); i++) {
+            for (int j = i + 1; j < bodies.size(); j++) {
+                bp->intersectionTest(bodies[i], bodies[j], &q1, &q2);
+            }
+        }
+        EXPECT_EQ(p1.size(), q1.size());
+    }
+}
+
+TEST(GridBroadphase, AabbQuery) {
+    std::unique_ptr<Collision::GridBroadphase> bp = createGrid();
+    bp->addBody(createSphereBody(0, 0, 0, 0.5));
+    bp->addBody(createSphereBody(3, 0, 0, 0.5));
+    bp->addBody(createSphereBody(6, 0, 0, 0.5));
+    bp->addBody(createSphereBody(6, 0, 0, 3));
+
+    std::unique_ptr<Collision::AABB> aabb(new Collision::AABB(Math::Vec3(-1, -1, -1), Math::Vec3(1, 1, 1)));
+    std::vector<Objects::Body*> result;
+    bp->aabbQuery(nullptr, aabb.get(), &result);
+    EXPECT_EQ(result.size(), 1);
+
+    aabb->upperBound.set(4, 1, 1);
+    result.clear();
+    bp->aabbQuery(nullptr, aabb.get(), &result);
+    EXPECT_EQ(result.size(), 3);
+
+    aabb->upperBound.set(1000, 1000, 1000);
+    result.clear();
+    bp->aabbQuery(nullptr, aabb.get(), &result);
+    EXPECT_EQ(result.size(), 4);
+}
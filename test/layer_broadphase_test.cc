@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include "collision/LayerBroadphase.h"
+#include "collision/AABB.h"
+#include "objects/Body.h"
+#include "shapes/Sphere.h"
+#include "test/test_helpers.h"
+
+using namespace Cannon;
+
+static Objects::Body* createLayerBody(float x, float y, float z, int group, int mask) {
+    Objects::Body* body = createSphereBody(x, y, z);
+    body->collisionFilterGroup = group;
+    body->collisionFilterMask = mask;
+    return body;
+}
+
+static std::vector<std::pair<int, int>> sortedPairIds(std::vector<Objects::Body*>* p1, std::vector<Objects::Body*>* p2) {
+    std::vector<std::pair<int, int>> ids;
+    for (int i = 0; i < p1->size(); i++) {
+        ids.push_back(std::make_pair(std::min(p1->at(i)->id, p2->at(i)->id), std::max(p1->at(i)->id, p2->at(i)->id)));
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+TEST(LayerBroadphase, Layers) {
+    std::unique_ptr<Collision::LayerBroadphase> bp(new Collision::LayerBroadphase());
+    bp->addBody(createLayerBody(0, 0, 0, 1, -1));
+    bp->addBody(createLayerBody(0.5, 0, 0, 1, -1));
+    bp->addBody(createLayerBody(0, 0.5, 0, 2, 1));
+    bp->addBody(createLayerBody(0, 0, 0.5, 4, 4));
+    EXPECT_EQ(bp->layers.size(), 3);
+    EXPECT_EQ(bp->layers[0]->bodyCount, 2);
+
+    EXPECT_TRUE(Collision::LayerBroadphase::layersCollide(bp->layers[0], bp->layers[1]));
+    EXPECT_FALSE(Collision::LayerBroadphase::layersCollide(bp->layers[1], bp->layers[1]));
+    EXPECT_FALSE(Collision::LayerBroadphase::layersCollide(bp->layers[0], bp->layers[2]));
+    EXPECT_TRUE(Collision::LayerBroadphase::layersCollide(bp->layers[2], bp->layers[2]));
+
+    // Group 4 is on its own, and group 2 only collides with group 1
+    std::vector<Objects::Body*> p1;
+    std::vector<Objects::Body*> p2;
+    bp->collisionPairs(nullptr, &p1, &p2);
+    EXPECT_EQ(p1.size(), 3);
+}
+
+TEST(LayerBroadphase, SameAsFilter) {
+    std::unique_ptr<Collision::LayerBroadphase> bp(new Collision::LayerBroadphase());
+    std::vector<Objects::Body*> bodies;
+    int groups[4] = { 1, 2, 4, 8 };
+    int masks[4] = { -1, 1 | 4, 2, 8 };
+
+    std::srand(4);
+    for (int i = 0; i < 200; i++) {
+        int layer = std::rand() % 4;
+        Objects::Body* body = createLayerBody(
+            (std::rand() % 1000) / 100.0f,
+            (std::rand() % 1000) / 100.0f,
+            (std::rand() % 1000) / 100.0f,
+            groups[layer],
+            masks[layer]);
+        if (i % 7 == 0) {
+            body->type = Objects::BodyType::STATIC;
+        }
+        bodies.push_back(body);
+        bp->addBody(body);
+    }
+
+    for (int step = 0; step < 2; step++) {
+        std::vector<Objects::Body*> p1;
+        std::vector<Objects::Body*> p2;
+        bp->collisionPairs(nullptr, &p1, &p2);
+
+        // Brute force with the per pair filter
+        std::vector<Objects::Body*> e1;
+        std::vector<Objects::Body*> e2;
+        for (int i = 0; i < bodies.size(); i++) {
+            for (int j = i + 1; j < bodies.size(); j++) {
+                if (bp->needBroadphaseCollision(bodies[i], bodies[j])) {
+                    bp->intersectionTest(bodies[i], bodies[j], &e1, &e2);
+                }
+            }
+        }
+        EXPECT_GT(e1.size(), 0);
+        EXPECT_EQ(sortedPairIds(&p1, &p2), sortedPairIds(&e1, &e2));
+
+        // Change the filters of some bodies, they should move to other layers
+        for (int i = 0; i < bodies.size(); i += 5) {
+            bodies[i]->collisionFilterGroup = 2;
+            bodies[i]->collisionFilterMask = 1 | 4;
+        }
+        bp->dirty = true;
+    }
+}
+
+TEST(LayerBroadphase, RemoveBody) {
+    std::unique_ptr<Collision::LayerBroadphase> bp(new Collision::LayerBroadphase());
+    Objects::Body* a = createLayerBody(0, 0, 0, 1, -1);
+    Objects::Body* b = createLayerBody(0.5, 0, 0, 2, -1);
+    Objects::Body* c = createLayerBody(1, 0, 0, 1, -1);
+    bp->addBody(a);
+    bp->addBody(b);
+    bp->addBody(c);
+    bp->removeBody(a);
+    EXPECT_EQ(bp->bodies.size(), 2);
+    EXPECT_EQ(bp->layers[0]->bodyCount, 1);
+
+    std::vector<Objects::Body*> p1;
+    std::vector<Objects::Body*> p2;
+    bp->collisionPairs(nullptr, &p1, &p2);
+    EXPECT_EQ(p1.size(), 1);
+
+    Collision::AABB query(Math::Vec3(0.9, -1, -1), Math::Vec3(2, 1, 1));
+    std::vector<Objects::Body*> result;
+    bp->aabbQuery(nullptr, &query, &result);
+    EXPECT_EQ(result.size(), 2);
+}
+
+TEST(LayerBroadphase, RayQuery) {
+    std::unique_ptr<Collision::LayerBroadphase> bp(new Collision::LayerBroadphase());
+    Objects::Body* a = createLayerBody(0, 0, 0, 1, -1);
+    bp->addBody(a);
+    bp->addBody(createLayerBody(3, 3, 0, 2, -1));
+
+    Math::Vec3 from(-5, 0, 0);
+    Math::Vec3 to(5, 0, 0);
+    std::vector<Objects::Body*> result;
+    bp->rayQuery(&from, &to, &result);
+    EXPECT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0], a);
+
+    // Inside the fat AABB of the second body, but not its AABB
+    from.set(-5, 3.55, 0);
+    to.set(5, 3.55, 0);
+    result.clear();
+    bp->rayQuery(&from, &to, &result);
+    EXPECT_EQ(result.size(), 0);
+}
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include "utils/LinearBVH.h"
+#include "utils/AABBTree.h"
+#include "utils/ThreadPool.h"
+#include "collision/AABB.h"
+#include "collision/AABBTreeBroadphase.h"
+#include "objects/Body.h"
+#include "shapes/Sphere.h"
+#include "math/Vec3.h"
+
+using namespace Cannon;
+
+static std::vector<Collision::AABB> randomBoxes(int count, float size) {
+    std::srand(3);
+    std::vector<Collision::AABB> boxes;
+    for (int i = 0; i < count; i++) {
+        float x = (std::rand() % 10000) / 100.0f;
+        float y = (std::rand() % 10000) / 100.0f;
+        float z = (std::rand() % 10000) / 100.0f;
+        boxes.push_back(Collision::AABB(Math::Vec3(x - size, y - size, z - size), Math::Vec3(x + size, y + size, z + size)));
+    }
+    return boxes;
+}
+
+TEST(LinearBVH, MortonCode) {
+    EXPECT_EQ(Utils::LinearBVH::mortonCode30(0, 0, 0), 0);
+    EXPECT_EQ(Utils::LinearBVH::mortonCode30(1, 1, 1), (1ULL << 30) - 1);
+    EXPECT_EQ(Utils::LinearBVH::mortonCode30(0, 0, 1.0f / 1024), 1);
+    EXPECT_EQ(Utils::LinearBVH::mortonCode30(0, 1.0f / 1024, 0), 2);
+    EXPECT_EQ(Utils::LinearBVH::mortonCode30(1.0f / 1024, 0, 0), 4);
+    EXPECT_EQ(Utils::LinearBVH::mortonCode63(1, 1, 1), (1ULL << 63) - 1);
+    EXPECT_EQ(Utils::LinearBVH::expandBits21(3), 9);
+}
+
+TEST(LinearBVH, Build) {
+    std::vector<Collision::AABB> boxes = randomBoxes(1000, 1);
+    std::unique_ptr<Utils::LinearBVH> bvh(new Utils::LinearBVH());
+    bvh->build(&boxes);
+
+    // Every primitive is in exactly one leaf, and every node contains its children
+    std::vector<int> sorted = bvh->primitives;
+    std::sort(sorted.begin(), sorted.end());
+    for (int i = 0; i < sorted.size(); i++) {
+        EXPECT_EQ(sorted[i], i);
+    }
+    int leafPrimitives = 0;
+    for (int i = 0; i < bvh->nodes.size(); i++) {
+        Utils::LinearBVHNode* node = &bvh->nodes[i];
+        if (node->count > 0) {
+            EXPECT_LE(node->count, bvh->maxLeafSize);
+            leafPrimitives += node->count;
+            continue;
+        }
+        Utils::LinearBVHNode* children[2] = { &bvh->nodes[i + 1], &bvh->nodes[node->offset] };
+        for (int c = 0; c < 2; c++) {
+            for (int k = 0; k < 3; k++) {
+                EXPECT_LE(node->lowerBound[k], children[c]->lowerBound[k]);
+                EXPECT_GE(node->upperBound[k], children[c]->upperBound[k]);
+            }
+        }
+    }
+    EXPECT_EQ(leafPrimitives, 1000);
+}
+
+TEST(LinearBVH, AABBQuery) {
+    std::vector<Collision::AABB> boxes = randomBoxes(1000, 1);
+    std::unique_ptr<Utils::LinearBVH> bvh(new Utils::LinearBVH());
+    bvh->maxLeafSize = 1;
+    bvh->build(&boxes);
+
+    Collision::AABB query(Math::Vec3(20, 20, 20), Math::Vec3(40, 40, 40));
+    std::vector<int> result;
+    bvh->aabbQuery(&query, &result);
+    std::sort(result.begin(), result.end());
+
+    std::vector<int> expected;
+    for (int i = 0; i < boxes.size(); i++) {
+        if (boxes[i].overlaps(&query)) {
+            expected.push_back(i);
+        }
+    }
+    EXPECT_GT(expected.size(), 0);
+    EXPECT_EQ(result, expected);
+
+    Math::Vec3 from(-1, 50, 50);
+    Math::Vec3 to(101, 50, 50);
+    result.clear();
+    bvh->rayQuery(&from, &to, &result);
+    for (int i = 0; i < result.size(); i++) {
+        EXPECT_LE(boxes[result[i]].lowerBound.y, 50);
+        EXPECT_GE(boxes[result[i]].upperBound.y, 50);
+    }
+}
+
+TEST(LinearBVH, ParallelSort) {
+    std::vector<Collision::AABB> boxes = randomBoxes(20000, 0.1);
+    std::unique_ptr<Utils::LinearBVH> bvh(new Utils::LinearBVH());
+    bvh->useLongCodes = true;
+    bvh->build(&boxes);
+    std::vector<int> expected = bvh->primitives;
+    int nodeCount = bvh->nodes.size();
+
+    Utils::ThreadPool pool(4);
+    bvh->threadPool = &pool;
+    bvh->build(&boxes);
+    EXPECT_EQ(bvh->primitives, expected);
+    EXPECT_EQ(bvh->nodes.size(), nodeCount);
+}
+
+TEST(LinearBVH, CreateProxies) {
+    std::vector<Collision::AABB> boxes = randomBoxes(500, 1);
+    std::vector<Collision::AABB*> aabbs;
+    std::vector<int> userData;
+    for (int i = 0; i < boxes.size(); i++) {
+        aabbs.push_back(&boxes[i]);
+        userData.push_back(i + 1000);
+    }
+
+    std::unique_ptr<Utils::AABBTree> tree(new Utils::AABBTree());
+    Collision::AABB first = boxes[0];
+    tree->createProxy(&first, 7);
+
+    std::vector<int> proxyIds;
+    tree->createProxies(&aabbs, &userData, &proxyIds);
+    ASSERT_EQ(proxyIds.size(), 500);
+    for (int i = 0; i < proxyIds.size(); i++) {
+        EXPECT_EQ(tree->getUserData(proxyIds[i]), i + 1000);
+    }
+
+    // The bulk built leaves can be moved and destroyed like the others
+    Collision::AABB moved(Math::Vec3(200, 200, 200), Math::Vec3(201, 201, 201));
+    tree->moveProxy(proxyIds[10], &moved);
+    tree->destroyProxy(proxyIds[20]);
+
+    Collision::AABB query(Math::Vec3(150, 150, 150), Math::Vec3(300, 300, 300));
+    std::vector<int> result;
+    tree->aabbQuery(&query, &result);
+    EXPECT_EQ(result, std::vector<int>({ 1010 }));
+
+    result.clear();
+    Collision::AABB all(Math::Vec3(-10, -10, -10), Math::Vec3(300, 300, 300));
+    tree->aabbQuery(&all, &result);
+    EXPECT_EQ(result.size(), 500);
+}
+
+TEST(LinearBVH, AddBodies) {
+    std::srand(9);
+    std::vector<Objects::Body*> bodies;
+    for (int i = 0; i < 200; i++) {
+        Objects::Body* body = new Objects::Body(i % 4 == 0 ? 0 : 1);
+        body->addShape(new Shapes::Sphere(0.5), nullptr, nullptr);
+        body->position.set((std::rand() % 1000) / 100.0f, (std::rand() % 1000) / 100.0f, (std::rand() % 1000) / 100.0f);
+        body->aabbNeedsUpdate = true;
+        bodies.push_back(body);
+    }
+
+    std::unique_ptr<Collision::AABBTreeBroadphase> single(new Collision::AABBTreeBroadphase());
+    std::unique_ptr<Collision::AABBTreeBroadphase> bulk(new Collision::AABBTreeBroadphase());
+    for (int i = 0; i < bodies.size(); i++) {
+        single->addBody(bodies[i]);
+    }
+    bulk->addBodies(&bodies);
+
+    std::vector<std::pair<int, int>> pairs[2];
+    Collision::AABBTreeBroadphase* broadphases[2] = { single.get(), bulk.get() };
+    for (int b = 0; b < 2; b++) {
+        std::vector<Objects::Body*> p1;
+        std::vector<Objects::Body*> p2;
+        broadphases[b]->collisionPairs(nullptr, &p1, &p2);
+        for (int i = 0; i < p1.size(); i++) {
+            pairs[b].push_back(std::make_pair(std::min(p1[i]->id, p2[i]->id), std::max(p1[i]->id, p2[i]->id)));
+        }
+        std::sort(pairs[b].begin(), pairs[b].end());
+    }
+    EXPECT_GT(pairs[0].size(), 0);
+    EXPECT_EQ(pairs[0], pairs[1]);
+}
@@ -0,0 +1,693 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include "objects/Body.h"
+#include "shapes/Box.h"
+#include "shapes/Capsule.h"
+#include "shapes/Cylinder.h"
+#include "shapes/Plane.h"
+#include "shapes/Sphere.h"
+#include "shapes/Trimesh.h"
+#include "solver/GSSolver.h"
+#include "utils/ThreadPool.h"
+#include "world/Narrowphase.h"
+
+using namespace Cannon;
+
+static Objects::Body* createNarrowphaseBox(float halfExtent, float x, float y, float z) {
+    Objects::Body* body = new Objects::Body(1);
+    body->addShape(new Shapes::Box(new Math::Vec3(halfExtent, halfExtent, halfExtent)), nullptr, nullptr);
+    body->position.set(x, y, z);
+    return body;
+}
+
+TEST(Narrowphase, ConvexGJK) {
+    Objects::Body* a = new Objects::Body(1);
+    a->addShape(new Shapes::Box(new Math::Vec3(1, 1, 1)), nullptr, nullptr);
+    Objects::Body* b = new Objects::Body(1);
+    b->addShape(new Shapes::Sphere(0.5), nullptr, nullptr);
+    b->position.set(0, 1.4, 0);
+    Objects::Body* c = new Objects::Body(1);
+    c->addShape(new Shapes::Sphere(0.5), nullptr, nullptr);
+    c->position.set(0, -3, 0);
+
+    World::Narrowphase narrowphase(nullptr);
+    std::vector<Objects::Body*> p1 = {b, a};
+    std::vector<Objects::Body*> p2 = {a, c};
+    std::vector<Equations::ContactEquation*> result;
+    std::vector<Equations::ContactEquation*> oldcontacts;
+    std::vector<Equations::FrictionEquation*> frictionResult;
+    std::vector<Equations::FrictionEquation*> frictionPool;
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+
+    // The sphere has the lower type, so it becomes body i
+    ASSERT_EQ(result.size(), 1);
+    Equations::ContactEquation* contact = result[0];
+    EXPECT_EQ(contact->bi, b);
+    EXPECT_EQ(contact->bj, a);
+    EXPECT_EQ(contact->si, b->shapes[0]);
+    EXPECT_NEAR(contact->ni.y, -1, 1e-3);
+    EXPECT_NEAR(contact->ri.y, -0.5, 1e-2);
+    EXPECT_NEAR(contact->rj.y, 1, 1e-3);
+
+    // Contacts are reused from the pool
+    oldcontacts.push_back(contact);
+    result.clear();
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0], contact);
+    EXPECT_EQ(oldcontacts.size(), 0);
+}
+
+TEST(Narrowphase, BoxBox) {
+    // A box resting on a bigger one, slightly sunk in
+    Objects::Body* a = createNarrowphaseBox(1, 0, 0, 0);
+    Objects::Body* b = createNarrowphaseBox(0.5, 0.1, 1.45, 0);
+
+    World::Narrowphase narrowphase(nullptr);
+    std::vector<Objects::Body*> p1 = {a};
+    std::vector<Objects::Body*> p2 = {b};
+    std::vector<Equations::ContactEquation*> result;
+    std::vector<Equations::ContactEquation*> oldcontacts;
+    std::vector<Equations::FrictionEquation*> frictionResult;
+    std::vector<Equations::FrictionEquation*> frictionPool;
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+
+    // One contact per corner of the bottom face of the small box
+    ASSERT_EQ(result.size(), 4);
+    for (int i = 0; i < result.size(); i++) {
+        Equations::ContactEquation* c = result[i];
+        // Same shape types keep the pair in order of the second body
+        EXPECT_EQ(c->bi, b);
+        EXPECT_EQ(c->si, b->shapes[0]);
+        EXPECT_NEAR(c->ni.y, -1, 1e-4);
+        EXPECT_NEAR(c->ri.y, -0.5, 1e-4);
+        EXPECT_NEAR(c->rj.y, 1, 1e-4);
+        EXPECT_NEAR(std::abs(c->ri.x), 0.5, 1e-4);
+        EXPECT_NEAR(std::abs(c->ri.z), 0.5, 1e-4);
+    }
+
+    // Separated boxes make no contacts
+    b->position.set(0, 1.6, 0);
+    result.clear();
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+    EXPECT_EQ(result.size(), 0);
+}
+
+TEST(Narrowphase, ContactReduction) {
+    // A box turned around the normal on an equal box clips to an octagon
+    Objects::Body* a = createNarrowphaseBox(0.5, 0, 0, 0);
+    Objects::Body* b = createNarrowphaseBox(0.5, 0, 0.95, 0);
+    Math::Vec3 axis(0, 1, 0);
+    b->quaternion.setFromAxisAngle(&axis, M_PI / 4);
+
+    World::Narrowphase narrowphase(nullptr);
+    std::vector<Objects::Body*> p1 = {a};
+    std::vector<Objects::Body*> p2 = {b};
+    std::vector<Equations::ContactEquation*> result;
+    std::vector<Equations::ContactEquation*> oldcontacts;
+    std::vector<Equations::FrictionEquation*> frictionResult;
+    std::vector<Equations::FrictionEquation*> frictionPool;
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+    EXPECT_EQ(result.size(), 8);
+
+    narrowphase.enableContactReduction = true;
+    oldcontacts = result;
+    result.clear();
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+    ASSERT_EQ(result.size(), 4);
+    for (int i = 0; i < result.size(); i++) {
+        EXPECT_NEAR(result[i]->ni.y, -1, 1e-4);
+    }
+}
+
+TEST(Narrowphase, Parallel) {
+    // Columns of boxes sunk into each other, with a sphere on top of each,
+    // and floors of 3 x 3 boxes found through their shape trees, with a box on the middle one
+    std::vector<Objects::Body*> p1;
+    std::vector<Objects::Body*> p2;
+    for (int i = 0; i < 20; i++) {
+        Objects::Body* below = nullptr;
+        for (int j = 0; j < 4; j++) {
+            Objects::Body* box = createNarrowphaseBox(0.5, i * 3 + 0.1 * j, j * 0.95, 0);
+            if (below != nullptr) {
+                p1.push_back(below);
+                p2.push_back(box);
+            }
+            below = box;
+        }
+        Objects::Body* sphere = new Objects::Body(1);
+        sphere->addShape(new Shapes::Sphere(0.5), nullptr, nullptr);
+        sphere->position.set(i * 3, 3.35, 0);
+        p1.push_back(below);
+        p2.push_back(sphere);
+
+        Objects::Body* floor = new Objects::Body(0);
+        for (int x = -1; x <= 1; x++) {
+            for (int z = -1; z <= 1; z++) {
+                floor->addShape(new Shapes::Box(new Math::Vec3(0.45, 0.45, 0.45)), new Math::Vec3(x, 0, z), nullptr);
+            }
+        }
+        floor->position.set(i * 4, -10, 0);
+        p1.push_back(floor);
+        p2.push_back(createNarrowphaseBox(0.3, i * 4, -9.3, 0));
+    }
+
+    World::Narrowphase serial(nullptr);
+    std::vector<Equations::ContactEquation*> expected;
+    std::vector<Equations::ContactEquation*> oldcontacts;
+    std::vector<Equations::FrictionEquation*> frictionResult;
+    std::vector<Equations::FrictionEquation*> frictionPool;
+    serial.getContacts(&p1, &p2, nullptr, &expected, &oldcontacts, &frictionResult, &frictionPool);
+    ASSERT_EQ(expected.size(), 20 * (3 * 4 + 1 + 4));
+    EXPECT_FALSE(p1.back()->shapeTreeNeedsUpdate);
+
+    Utils::ThreadPool pool(4);
+    World::Narrowphase narrowphase(nullptr);
+    narrowphase.threadPool = &pool;
+    narrowphase.pairsPerTask = 3;
+
+    // Reuse half of the equations, the threads make the rest
+    std::vector<Equations::ContactEquation*> result;
+    for (int i = 0; i < expected.size() / 2; i++) {
+        oldcontacts.push_back(new Equations::ContactEquation(nullptr, nullptr));
+    }
+    std::vector<Equations::ContactEquation*> reusable = oldcontacts;
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+
+    // Each reusable equation is either used or given back
+    int used = 0;
+    for (int i = 0; i < reusable.size(); i++) {
+        used += std::count(result.begin(), result.end(), reusable[i]);
+    }
+    EXPECT_EQ(used + oldcontacts.size(), reusable.size());
+
+    // Same contacts in the same order
+    ASSERT_EQ(result.size(), expected.size());
+    for (int i = 0; i < result.size(); i++) {
+        EXPECT_EQ(result[i]->bi, expected[i]->bi);
+        EXPECT_EQ(result[i]->bj, expected[i]->bj);
+        EXPECT_EQ(result[i]->si, expected[i]->si);
+        EXPECT_TRUE(result[i]->ni.almostEquals(&expected[i]->ni, 1e-5));
+        EXPECT_TRUE(result[i]->ri.almostEquals(&expected[i]->ri, 1e-5));
+        EXPECT_TRUE(result[i]->rj.almostEquals(&expected[i]->rj, 1e-5));
+    }
+
+    // Numbered in result order, whichever thread made or reused them
+    for (int i = 0; i < result.size(); i++) {
+        EXPECT_EQ(expected[i]->id, expected[0]->id + i);
+        EXPECT_EQ(result[i]->id, result[0]->id + i);
+    }
+    EXPECT_EQ(Equations::Equation::idCounter, result.back()->id + 1);
+}
+
+TEST(Narrowphase, ParallelAxisCache) {
+    // Rows of boxes next to convex hulls, every other pair separated
+    std::vector<Objects::Body*> p1;
+    std::vector<Objects::Body*> p2;
+    for (int i = 0; i < 40; i++) {
+        Objects::Body* box = createNarrowphaseBox(0.5, i * 3, 0, 0);
+        Objects::Body* hull = new Objects::Body(1);
+        hull->addShape((new Shapes::Box(new Math::Vec3(0.5, 0.5, 0.5)))->convexPolyhedronRepresentation, nullptr, nullptr);
+        hull->position.set(i * 3 + (i % 2 == 0 ? 1.2 : 0.9), 0, 0);
+        p1.push_back(box);
+        p2.push_back(hull);
+    }
+    std::vector<Equations::ContactEquation*> result;
+    std::vector<Equations::ContactEquation*> oldcontacts;
+    std::vector<Equations::FrictionEquation*> frictionResult;
+    std::vector<Equations::FrictionEquation*> frictionPool;
+
+    World::Narrowphase serial(nullptr);
+    serial.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+    EXPECT_EQ(serial.separatingAxisCache.size(), 20);
+
+    // The threads share the cache of the narrowphase
+    Utils::ThreadPool pool(4);
+    World::Narrowphase narrowphase(nullptr);
+    narrowphase.threadPool = &pool;
+    narrowphase.pairsPerTask = 3;
+    result.clear();
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+    EXPECT_EQ(narrowphase.separatingAxisCache.size(), 20);
+
+    // A new pair moves the others to other tasks, and the cached axes are still found
+    p1.insert(p1.begin(), createNarrowphaseBox(0.5, -10, 0, 0));
+    p2.insert(p2.begin(), createNarrowphaseBox(0.5, -10, 0.9, 0));
+    result.clear();
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+    EXPECT_EQ(narrowphase.separatingAxisCache.size(), 20);
+    EXPECT_EQ(result.size() > 0, true);
+
+    // Pairs that were not tested are dropped
+    p1.resize(11);
+    p2.resize(11);
+    result.clear();
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+    EXPECT_EQ(narrowphase.separatingAxisCache.size(), 5);
+}
+
+TEST(Narrowphase, Dispatch) {
+    // A sphere and a box sunk into a plane, and two spheres touching each other
+    Objects::Body* ground = new Objects::Body(0);
+    ground->addShape(new Shapes::Plane(), nullptr, nullptr);
+    Objects::Body* a = new Objects::Body(1);
+    a->addShape(new Shapes::Sphere(0.5), nullptr, nullptr);
+    a->position.set(0, 0, 0.4);
+    Objects::Body* b = createNarrowphaseBox(0.5, 3, 0, 0.45);
+    Objects::Body* c = new Objects::Body(1);
+    c->addShape(new Shapes::Sphere(0.5), nullptr, nullptr);
+    c->position.set(0.9, 0, 0.4);
+
+    World::Narrowphase narrowphase(nullptr);
+    std::vector<Objects::Body*> p1 = {ground, b, a};
+    std::vector<Objects::Body*> p2 = {a, ground, c};
+    std::vector<Equations::ContactEquation*> result;
+    std::vector<Equations::ContactEquation*> oldcontacts;
+    std::vector<Equations::FrictionEquation*> frictionResult;
+    std::vector<Equations::FrictionEquation*> frictionPool;
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+    ASSERT_EQ(result.size(), 1 + 4 + 1);
+
+    // The sphere has the lower type, so it becomes body i
+    EXPECT_EQ(result[0]->bi, a);
+    EXPECT_EQ(result[0]->bj, ground);
+    EXPECT_NEAR(result[0]->ni.z, -1, 1e-5);
+    EXPECT_NEAR(result[0]->ri.z, -0.5, 1e-5);
+    EXPECT_NEAR(result[0]->rj.z, 0, 1e-5);
+
+    // One contact per corner of the bottom face of the box, from the plane
+    for (int i = 1; i < 5; i++) {
+        EXPECT_EQ(result[i]->bi, ground);
+        EXPECT_EQ(result[i]->bj, b);
+        EXPECT_EQ(result[i]->sj, b->shapes[0]);
+        EXPECT_NEAR(result[i]->ni.z, 1, 1e-5);
+        EXPECT_NEAR(result[i]->ri.z, 0, 1e-5);
+        EXPECT_NEAR(result[i]->rj.z, -0.5, 1e-5);
+    }
+
+    // Spheres of the same type swap, like other pairs of equal types
+    EXPECT_EQ(result[5]->bi, c);
+    EXPECT_NEAR(result[5]->ni.x, -1, 1e-5);
+    EXPECT_NEAR(result[5]->ri.x, -0.5, 1e-5);
+    EXPECT_NEAR(result[5]->rj.x, 0.5, 1e-5);
+}
+
+TEST(Narrowphase, Speculative) {
+    // A fast sphere heading for a thin wall, and one falling onto a plane
+    Objects::Body* sphere = new Objects::Body(1);
+    sphere->addShape(new Shapes::Sphere(0.1), nullptr, nullptr);
+    sphere->velocity.set(120, 0, 0);
+    Objects::Body* wall = new Objects::Body(0);
+    wall->addShape(new Shapes::Box(new Math::Vec3(0.05, 1, 1)), nullptr, nullptr);
+    wall->position.set(1.5, 0, 0);
+    Objects::Body* ground = new Objects::Body(0);
+    ground->addShape(new Shapes::Plane(), nullptr, nullptr);
+    Objects::Body* falling = new Objects::Body(1);
+    falling->addShape(new Shapes::Sphere(0.5), nullptr, nullptr);
+    falling->position.set(10, 0, 1);
+    falling->velocity.set(0, 0, -60);
+
+    World::Narrowphase narrowphase(nullptr);
+    std::vector<Objects::Body*> p1 = {sphere, ground};
+    std::vector<Objects::Body*> p2 = {wall, falling};
+    std::vector<Equations::ContactEquation*> result;
+    std::vector<Equations::ContactEquation*> oldcontacts;
+    std::vector<Equations::FrictionEquation*> frictionResult;
+    std::vector<Equations::FrictionEquation*> frictionPool;
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+    EXPECT_EQ(result.size(), 0);
+
+    // The AABB of a fast body covers the next step
+    sphere->ccd = true;
+    falling->ccd = true;
+    sphere->computeAABB();
+    EXPECT_NEAR(sphere->aabb.lowerBound.x, -0.1, 1e-5);
+    EXPECT_NEAR(sphere->aabb.upperBound.x, 2.1, 1e-5);
+
+    // Contacts keep the gap between the shapes
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_EQ(result[0]->bi, sphere);
+    EXPECT_EQ(result[0]->bj, wall);
+    EXPECT_NEAR(result[0]->ni.x, 1, 1e-3);
+    EXPECT_NEAR(result[0]->ri.x, 0.1, 1e-3);
+    EXPECT_NEAR(result[0]->rj.x, -0.05, 1e-3);
+    EXPECT_EQ(result[1]->bi, ground);
+    EXPECT_EQ(result[1]->bj, falling);
+    EXPECT_NEAR(result[1]->ni.z, 1, 1e-5);
+    EXPECT_NEAR(result[1]->ri.x, 10, 1e-5);
+    EXPECT_NEAR(result[1]->ri.z, 0, 1e-5);
+    EXPECT_NEAR(result[1]->rj.z, -0.5, 1e-5);
+    EXPECT_TRUE(result[1]->speculative);
+
+    // Closing at twice the gap per step, the solver lets the sphere reach the plane in one step, and no further
+    Solver::GSSolver solver;
+    solver.addEquation(result[1]);
+    std::vector<Objects::Body*> bodies = {ground, falling};
+    solver.solveBodies(1.0 / 60, &bodies);
+    EXPECT_NEAR(falling->velocity.z / 60, -0.5, 1e-3);
+
+    // Not when moving away, or too slow to reach it within the step
+    sphere->velocity.set(-120, 0, 0);
+    falling->velocity.set(0, 0, -20);
+    oldcontacts = result;
+    result.clear();
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+    EXPECT_EQ(result.size(), 0);
+}
+
+static std::vector<Equations::ContactEquation*> collideNarrowphasePair(World::Narrowphase* narrowphase, Objects::Body* a, Objects::Body* b) {
+    std::vector<Objects::Body*> p1 = {a};
+    std::vector<Objects::Body*> p2 = {b};
+    std::vector<Equations::ContactEquation*> result;
+    std::vector<Equations::ContactEquation*> oldcontacts;
+    std::vector<Equations::FrictionEquation*> frictionResult;
+    std::vector<Equations::FrictionEquation*> frictionPool;
+    narrowphase->getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+    return result;
+}
+
+TEST(Narrowphase, Capsule) {
+    // A capsule lying along X, sunk 0.1 into a plane
+    Objects::Body* ground = new Objects::Body(0);
+    ground->addShape(new Shapes::Plane(), nullptr, nullptr);
+    Objects::Body* capsule = new Objects::Body(1);
+    capsule->addShape(new Shapes::Capsule(0.5, 2), nullptr, nullptr);
+    Math::Vec3 axis(0, 1, 0);
+    capsule->quaternion.setFromAxisAngle(&axis, M_PI / 2);
+    capsule->position.set(0, 0, 0.4);
+
+    World::Narrowphase narrowphase(nullptr);
+    std::vector<Equations::ContactEquation*> result = collideNarrowphasePair(&narrowphase, ground, capsule);
+    ASSERT_EQ(result.size(), 2);
+    for (int i = 0; i < 2; i++) {
+        EXPECT_EQ(result[i]->bi, ground);
+        EXPECT_NEAR(result[i]->ni.z, 1, 1e-5);
+        EXPECT_NEAR(std::abs(result[i]->rj.x), 1, 1e-5);
+        EXPECT_NEAR(result[i]->rj.z, -0.5, 1e-5);
+        EXPECT_NEAR(result[i]->ri.z, 0, 1e-5);
+    }
+
+    // A sphere against the side of the capsule
+    Objects::Body* sphere = new Objects::Body(1);
+    sphere->addShape(new Shapes::Sphere(0.5), nullptr, nullptr);
+    sphere->position.set(0.3, 0, 1.3);
+    result = collideNarrowphasePair(&narrowphase, capsule, sphere);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0]->bi, sphere);
+    EXPECT_NEAR(result[0]->ni.z, -1, 1e-5);
+    EXPECT_NEAR(result[0]->ri.z, -0.5, 1e-5);
+    EXPECT_NEAR(result[0]->rj.x, 0.3, 1e-5);
+    EXPECT_NEAR(result[0]->rj.z, 0.5, 1e-5);
+
+    // A crossed capsule on top touches at one point, a parallel one along the overlap
+    Objects::Body* crossed = new Objects::Body(1);
+    crossed->addShape(new Shapes::Capsule(0.5, 2), nullptr, nullptr);
+    Math::Vec3 xAxis(1, 0, 0);
+    crossed->quaternion.setFromAxisAngle(&xAxis, M_PI / 2);
+    crossed->position.set(0, 0, 1.3);
+    result = collideNarrowphasePair(&narrowphase, capsule, crossed);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_NEAR(std::abs(result[0]->ni.z), 1, 1e-5);
+
+    crossed->quaternion.copy(&capsule->quaternion);
+    crossed->position.set(1, 0, 1.3);
+    result = collideNarrowphasePair(&narrowphase, capsule, crossed);
+    ASSERT_EQ(result.size(), 2);
+
+    // A capsule lying on a box touches at both ends, one standing on it at its end
+    Objects::Body* box = createNarrowphaseBox(2, 0, 0, -2);
+    result = collideNarrowphasePair(&narrowphase, box, capsule);
+    ASSERT_EQ(result.size(), 2);
+    for (int i = 0; i < 2; i++) {
+        EXPECT_EQ(result[i]->bi, box);
+        EXPECT_NEAR(result[i]->ni.z, 1, 1e-5);
+        EXPECT_NEAR(result[i]->ri.z, 2, 1e-5);
+        EXPECT_NEAR(std::abs(result[i]->rj.x), 1, 1e-5);
+        EXPECT_NEAR(result[i]->rj.z, -0.5, 1e-5);
+    }
+
+    capsule->quaternion.set(0, 0, 0, 1);
+    capsule->position.set(0.5, 0.5, 1.4);
+    result = collideNarrowphasePair(&narrowphase, box, capsule);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_NEAR(result[0]->ni.z, 1, 1e-5);
+    EXPECT_NEAR(result[0]->rj.z, -1.5, 1e-5);
+
+    // Separated
+    capsule->position.set(0.5, 0.5, 2);
+    EXPECT_EQ(collideNarrowphasePair(&narrowphase, box, capsule).size(), 0);
+}
+
+TEST(Narrowphase, Cylinder) {
+    // A cylinder standing on a plane touches on its bottom rim
+    Objects::Body* ground = new Objects::Body(0);
+    ground->addShape(new Shapes::Plane(), nullptr, nullptr);
+    Objects::Body* cylinder = new Objects::Body(1);
+    cylinder->addShape(new Shapes::Cylinder(1, 2), nullptr, nullptr);
+    cylinder->position.set(0, 0, 0.95);
+
+    World::Narrowphase narrowphase(nullptr);
+    std::vector<Equations::ContactEquation*> result = collideNarrowphasePair(&narrowphase, ground, cylinder);
+    ASSERT_EQ(result.size(), 4);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_NEAR(result[i]->ni.z, 1, 1e-5);
+        EXPECT_NEAR(result[i]->rj.z, -1, 1e-5);
+        EXPECT_NEAR(result[i]->ri.z, 0, 1e-5);
+        EXPECT_NEAR(result[i]->rj.x * result[i]->rj.x + result[i]->rj.y * result[i]->rj.y, 1, 1e-4);
+    }
+
+    // Lying on its side, it touches along a line
+    Math::Vec3 axis(1, 0, 0);
+    cylinder->quaternion.setFromAxisAngle(&axis, M_PI / 2);
+    result = collideNarrowphasePair(&narrowphase, ground, cylinder);
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_NEAR(std::abs(result[0]->rj.y), 1, 1e-5);
+    EXPECT_NEAR(result[0]->rj.z, -1, 1e-5);
+
+    // A sphere against the round side and against a cap
+    Objects::Body* sphere = new Objects::Body(1);
+    sphere->addShape(new Shapes::Sphere(0.5), nullptr, nullptr);
+    sphere->position.set(0, 0.2, 2.4);
+    result = collideNarrowphasePair(&narrowphase, cylinder, sphere);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0]->bi, sphere);
+    EXPECT_NEAR(result[0]->ni.z, -1, 1e-5);
+    EXPECT_NEAR(result[0]->rj.z, 1, 1e-5);
+    EXPECT_NEAR(result[0]->rj.y, 0.2, 1e-5);
+
+    sphere->position.set(0, 1.3, 0.95);
+    result = collideNarrowphasePair(&narrowphase, cylinder, sphere);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_NEAR(result[0]->ni.y, -1, 1e-5);
+    EXPECT_NEAR(result[0]->rj.y, 1, 1e-5);
+
+    // Boxes collide with it through GJK
+    Objects::Body* box = createNarrowphaseBox(0.5, 0, 0, 2.4);
+    result = collideNarrowphasePair(&narrowphase, box, cylinder);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_NEAR(std::abs(result[0]->ni.z), 1, 1e-3);
+}
+
+TEST(Narrowphase, ShapeTree) {
+    // A turned building of 64 boxes, with a body of 10 spheres and a single sphere against it
+    Objects::Body* building = new Objects::Body(0);
+    for (int x = 0; x < 4; x++) {
+        for (int y = 0; y < 4; y++) {
+            for (int z = 0; z < 4; z++) {
+                building->addShape(new Shapes::Box(new Math::Vec3(0.45, 0.45, 0.45)), new Math::Vec3(x, y, z), nullptr);
+            }
+        }
+    }
+    Math::Vec3 axis(0, 0, 1);
+    building->quaternion.setFromAxisAngle(&axis, M_PI / 6);
+    building->position.set(1, 2, 0);
+
+    Objects::Body* chain = new Objects::Body(1);
+    for (int i = 0; i < 10; i++) {
+        chain->addShape(new Shapes::Sphere(0.3), new Math::Vec3(0.5 * i, 0, 0), nullptr);
+    }
+    chain->position.set(0.5, 3.2, 3.6);
+
+    Objects::Body* sphere = new Objects::Body(1);
+    sphere->addShape(new Shapes::Sphere(0.5), nullptr, nullptr);
+    sphere->position.set(1.2, 2.3, -0.8);
+
+    std::vector<Objects::Body*> p1 = {chain, building};
+    std::vector<Objects::Body*> p2 = {building, sphere};
+    std::vector<Equations::ContactEquation*> oldcontacts;
+    std::vector<Equations::FrictionEquation*> frictionResult;
+    std::vector<Equations::FrictionEquation*> frictionPool;
+
+    World::Narrowphase allPairs(nullptr);
+    allPairs.shapeTreeMinShapes = 1000;
+    std::vector<Equations::ContactEquation*> expected;
+    allPairs.getContacts(&p1, &p2, nullptr, &expected, &oldcontacts, &frictionResult, &frictionPool);
+    EXPECT_TRUE(building->shapeTreeNeedsUpdate);
+
+    World::Narrowphase narrowphase(nullptr);
+    std::vector<Equations::ContactEquation*> result;
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+    EXPECT_FALSE(building->shapeTreeNeedsUpdate);
+    EXPECT_FALSE(chain->shapeTreeNeedsUpdate);
+    EXPECT_GT(building->shapeTree.getHeight(), 0);
+
+    // Same contacts as testing every shape against every shape
+    ASSERT_GT(expected.size(), 1);
+    ASSERT_EQ(result.size(), expected.size());
+    for (int i = 0; i < expected.size(); i++) {
+        bool found = false;
+        for (int j = 0; j < result.size() && !found; j++) {
+            found = result[j]->bi == expected[i]->bi &&
+                result[j]->bj == expected[i]->bj &&
+                result[j]->ri.almostEquals(&expected[i]->ri, 1e-5) &&
+                result[j]->rj.almostEquals(&expected[i]->rj, 1e-5) &&
+                result[j]->ni.almostEquals(&expected[i]->ni, 1e-5);
+        }
+        EXPECT_TRUE(found);
+    }
+
+    // Adding a shape rebuilds the tree on the next step
+    building->addShape(new Shapes::Sphere(0.5), new Math::Vec3(0, 0, -1), nullptr);
+    EXPECT_TRUE(building->shapeTreeNeedsUpdate);
+    result.clear();
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+    EXPECT_FALSE(building->shapeTreeNeedsUpdate);
+    EXPECT_GT(result.size(), expected.size());
+}
+
+TEST(Narrowphase, Trimesh) {
+    // The unit square at z = 0, as two triangles facing up
+    std::vector<float> vertices = { -1, -1, 0, 1, -1, 0, 1, 1, 0, -1, 1, 0 };
+    std::vector<int> indices = { 0, 1, 2, 0, 2, 3 };
+    Objects::Body* ground = new Objects::Body(0);
+    ground->addShape(new Shapes::Trimesh(&vertices, &indices), nullptr, nullptr);
+    World::Narrowphase narrowphase(nullptr);
+
+    // A sphere over the shared edge makes one contact
+    Objects::Body* sphere = new Objects::Body(1);
+    sphere->addShape(new Shapes::Sphere(0.5), nullptr, nullptr);
+    sphere->position.set(0.2, 0.2, 0.4);
+    std::vector<Equations::ContactEquation*> result = collideNarrowphasePair(&narrowphase, ground, sphere);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0]->bi, sphere);
+    EXPECT_NEAR(result[0]->ni.z, -1, 1e-5);
+    EXPECT_NEAR(result[0]->ri.z, -0.5, 1e-5);
+    EXPECT_NEAR(result[0]->rj.x, 0.2, 1e-5);
+    EXPECT_NEAR(result[0]->rj.z, 0, 1e-5);
+
+    // Centered on the mesh, it is pushed up out of the front face
+    sphere->position.set(0.6, -0.4, 0);
+    result = collideNarrowphasePair(&narrowphase, ground, sphere);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_NEAR(result[0]->ni.z, -1, 1e-5);
+
+    sphere->position.set(0.2, 0.2, 0.6);
+    EXPECT_EQ(collideNarrowphasePair(&narrowphase, ground, sphere).size(), 0);
+
+    // Boxes are clipped against each triangle under them, one contact per corner of the clipped face
+    Objects::Body* box = createNarrowphaseBox(0.25, 0.5, -0.5, 0.2);
+    result = collideNarrowphasePair(&narrowphase, ground, box);
+    ASSERT_EQ(result.size(), 4);
+    for (int i = 0; i < result.size(); i++) {
+        EXPECT_EQ(result[i]->bi, box);
+        EXPECT_NEAR(result[i]->ni.z, -1, 1e-3);
+        EXPECT_NEAR(result[i]->ri.z, -0.25, 1e-3);
+        EXPECT_NEAR(result[i]->rj.z, 0, 1e-3);
+        EXPECT_NEAR(std::abs(result[i]->rj.x - 0.5), 0.25, 1e-3);
+        EXPECT_NEAR(std::abs(result[i]->rj.y + 0.5), 0.25, 1e-3);
+    }
+
+    // Over the shared edge, the triangles clip the face to a pentagon and a triangle
+    box->position.set(0.1, 0, 0.2);
+    result = collideNarrowphasePair(&narrowphase, ground, box);
+    EXPECT_EQ(result.size(), 5 + 3);
+    for (int i = 0; i < result.size(); i++) {
+        EXPECT_NEAR(result[i]->ni.z, -1, 1e-3);
+    }
+
+    // Turned on its edge, only the bottom edge touches
+    Math::Vec3 edgeAxis(1, 0, 0);
+    box->quaternion.setFromAxisAngle(&edgeAxis, M_PI / 4);
+    box->position.set(0.5, -0.5, 0.3);
+    result = collideNarrowphasePair(&narrowphase, ground, box);
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_NEAR(result[0]->ni.z, -1, 1e-3);
+    box->quaternion.set(0, 0, 0, 1);
+    box->position.set(0.5, -0.5, 0.3);
+    EXPECT_EQ(collideNarrowphasePair(&narrowphase, ground, box).size(), 0);
+
+    // Capsules have a higher shape type than trimeshes
+    Objects::Body* capsule = new Objects::Body(1);
+    capsule->addShape(new Shapes::Capsule(0.25, 1), nullptr, nullptr);
+    capsule->position.set(0.5, -0.5, 0.7);
+    result = collideNarrowphasePair(&narrowphase, capsule, ground);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0]->bi, capsule);
+    EXPECT_NEAR(result[0]->ni.z, -1, 1e-3);
+    EXPECT_NEAR(result[0]->ri.z, -0.75, 1e-3);
+}
+
+TEST(Narrowphase, ParallelTrimesh) {
+    // A grid of triangles with capsules, cylinders and boxes lying on it
+    std::vector<float> vertices;
+    std::vector<int> indices;
+    for (int y = 0; y <= 10; y++) {
+        for (int x = 0; x <= 10; x++) {
+            vertices.insert(vertices.end(), { (float)x, (float)y, 0 });
+        }
+    }
+    for (int y = 0; y < 10; y++) {
+        for (int x = 0; x < 10; x++) {
+            int a = y * 11 + x;
+            indices.insert(indices.end(), { a, a + 1, a + 12, a, a + 12, a + 11 });
+        }
+    }
+    Objects::Body* ground = new Objects::Body(0);
+    ground->addShape(new Shapes::Trimesh(&vertices, &indices), nullptr, nullptr);
+
+    std::vector<Objects::Body*> p1;
+    std::vector<Objects::Body*> p2;
+    for (int i = 0; i < 40; i++) {
+        Objects::Body* body = new Objects::Body(1);
+        if (i % 3 == 0) {
+            body->addShape(new Shapes::Capsule(0.25, 1), nullptr, nullptr);
+        } else if (i % 3 == 1) {
+            body->addShape(new Shapes::Cylinder(0.25, 1), nullptr, nullptr);
+        } else {
+            body->addShape(new Shapes::Box(new Math::Vec3(0.25, 0.5, 0.25)), nullptr, nullptr);
+        }
+        Math::Vec3 axis(1, 0, 0);
+        body->quaternion.setFromAxisAngle(&axis, M_PI / 2);
+        body->position.set(1 + (i % 8) * 1.1, 1 + (i / 8) * 1.7, 0.2);
+        p1.push_back(body);
+        p2.push_back(ground);
+    }
+
+    World::Narrowphase serial(nullptr);
+    std::vector<Equations::ContactEquation*> expected;
+    std::vector<Equations::ContactEquation*> oldcontacts;
+    std::vector<Equations::FrictionEquation*> frictionResult;
+    std::vector<Equations::FrictionEquation*> frictionPool;
+    serial.getContacts(&p1, &p2, nullptr, &expected, &oldcontacts, &frictionResult, &frictionPool);
+    ASSERT_GE(expected.size(), 40);
+
+    Utils::ThreadPool pool(4);
+    World::Narrowphase narrowphase(nullptr);
+    narrowphase.threadPool = &pool;
+    narrowphase.pairsPerTask = 2;
+    std::vector<Equations::ContactEquation*> result;
+    narrowphase.getContacts(&p1, &p2, nullptr, &result, &oldcontacts, &frictionResult, &frictionPool);
+
+    ASSERT_EQ(result.size(), expected.size());
+    for (int i = 0; i < result.size(); i++) {
+        EXPECT_EQ(result[i]->bi, expected[i]->bi);
+        EXPECT_EQ(result[i]->bj, expected[i]->bj);
+        EXPECT_TRUE(result[i]->ni.almostEquals(&expected[i]->ni, 1e-5));
+        EXPECT_TRUE(result[i]->ri.almostEquals(&expected[i]->ri, 1e-5));
+        EXPECT_TRUE(result[i]->rj.almostEquals(&expected[i]->rj, 1e-5));
+    }
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include "collision/PairCache.h"
+#include "collision/AABBTreeBroadphase.h"
+#include "collision/SAPBroadphase.h"
+#include "objects/Body.h"
+#include "shapes/Sphere.h"
+#include "test/test_helpers.h"
+
+using namespace Cannon;
+
+TEST(PairCache, Deltas) {
+    std::unique_ptr<Collision::PairCache> cache(new Collision::PairCache());
+    Objects::Body* a = createSphereBody(0, 0, 0);
+    Objects::Body* b = createSphereBody(0, 0, 0);
+    Objects::Body* c = createSphereBody(0, 0, 0);
+
+    cache->beginUpdate();
+    EXPECT_TRUE(cache->addPair(b, a));
+    EXPECT_TRUE(cache->addPair(a, c));
+    EXPECT_FALSE(cache->addPair(a, b));
+    cache->endUpdate();
+    EXPECT_EQ(cache->pairs1.size(), 2);
+    EXPECT_EQ(cache->added1.size(), 2);
+    EXPECT_EQ(cache->removed1.size(), 0);
+    EXPECT_EQ(cache->added1[0], a);
+    EXPECT_EQ(cache->added2[0], b);
+
+    // Same pairs again: no deltas
+    cache->beginUpdate();
+    cache->addPair(a, b);
+    cache->addPair(c, a);
+    cache->endUpdate();
+    EXPECT_EQ(cache->added1.size(), 0);
+    EXPECT_EQ(cache->removed1.size(), 0);
+
+    cache->beginUpdate();
+    cache->addPair(a, c);
+    cache->addPair(b, c);
+    cache->endUpdate();
+    EXPECT_EQ(cache->pairs1.size(), 2);
+    EXPECT_EQ(cache->added1.size(), 1);
+    EXPECT_EQ(cache->removed1.size(), 1);
+    EXPECT_EQ(cache->removed1[0], a);
+    EXPECT_EQ(cache->removed2[0], b);
+    EXPECT_TRUE(cache->has(c, b));
+    EXPECT_FALSE(cache->has(a, b));
+}
+
+TEST(PairCache, BroadphaseUpdatePairs) {
+    std::unique_ptr<Collision::AABBTreeBroadphase> tree(new Collision::AABBTreeBroadphase());
+    std::unique_ptr<Collision::SAPBroadphase> sap(new Collision::SAPBroadphase());
+    std::vector<Objects::Body*> bodies;
+
+    std::srand(4);
+    for (int i = 0; i < 100; i++) {
+        Objects::Body* body = createSphereBody(
+            (std::rand() % 1000) / 100.0f,
+            (std::rand() % 1000) / 100.0f,
+            0);
+        bodies.push_back(body);
+        tree->addBody(body);
+        sap->addBody(body);
+    }
+
+    for (int step = 0; step < 5; step++) {
+        tree->dirty = true;
+        sap->dirty = true;
+        tree->updatePairs(nullptr);
+        sap->updatePairs(nullptr);
+
+        std::vector<Objects::Body*> p1;
+        std::vector<Objects::Body*> p2;
+        sap->collisionPairs(nullptr, &p1, &p2);
+
+        EXPECT_EQ(tree->pairCache.pairs1.size(), p1.size());
+        EXPECT_EQ(sap->pairCache.pairs1.size(), p1.size());
+        EXPECT_EQ(tree->pairCache.added1.size(), sap->pairCache.added1.size());
+        EXPECT_EQ(tree->pairCache.removed1.size(), sap->pairCache.removed1.size());
+        for (int i = 0; i < p1.size(); i++) {
+            EXPECT_TRUE(tree->pairCache.has(p1[i], p2[i]));
+        }
+
+        for (int i = 0; i < bodies.size(); i++) {
+            bodies[i]->position.x += ((std::rand() % 100) - 50) / 200.0f;
+            bodies[i]->aabbNeedsUpdate = true;
+        }
+    }
+}
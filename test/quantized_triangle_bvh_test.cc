@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include "utils/QuantizedTriangleBVH.h"
+#include "utils/TriangleBVH.h"
+#include "shapes/Trimesh.h"
+#include "collision/AABB.h"
+#include "math/Vec3.h"
+
+using namespace Cannon;
+
+// A bumpy grid of size x size quads, two triangles each, far from the origin
+static void createOffsetGrid(int size, float offset, std::vector<float>* vertices, std::vector<int>* indices) {
+    std::srand(7);
+    for (int y = 0; y <= size; y++) {
+        for (int x = 0; x <= size; x++) {
+            vertices->push_back(offset + x * 0.37f);
+            vertices->push_back(offset + y * 0.37f);
+            vertices->push_back((std::rand() % 1000) / 1000.0f);
+        }
+    }
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int a = y * (size + 1) + x;
+            int b = a + 1;
+            int c = a + size + 1;
+            int d = c + 1;
+            indices->insert(indices->end(), { a, b, d, a, d, c });
+        }
+    }
+}
+
+static std::vector<int> sortedUnique(std::vector<int> list) {
+    std::sort(list.begin(), list.end());
+    list.erase(std::unique(list.begin(), list.end()), list.end());
+    return list;
+}
+
+TEST(QuantizedTriangleBVH, Build) {
+    std::vector<float> vertices;
+    std::vector<int> indices;
+    createOffsetGrid(40, 100, &vertices, &indices);
+    Utils::TriangleBVH source;
+    source.build(&vertices, &indices);
+    Utils::QuantizedTriangleBVH bvh;
+    bvh.build(&source);
+
+    EXPECT_EQ(sizeof(Utils::QuantizedBVHNode), 16);
+    ASSERT_EQ(bvh.nodes.size(), source.nodes.size());
+
+    // The same leaves, each with a base and the offsets of its triangles from it
+    int leaves = 0;
+    for (int i = 0; i < source.nodes.size(); i++) {
+        if (source.nodes[i].count == 0) {
+            continue;
+        }
+        leaves++;
+        std::vector<int> expected(source.triangles.begin() + source.nodes[i].offset, source.triangles.begin() + source.nodes[i].offset + source.nodes[i].count);
+        std::vector<int> result;
+        Utils::QuantizedBVHNode* node = &bvh.nodes[i];
+        int base = bvh.triangles[node->offset] | (bvh.triangles[node->offset + 1] << 16);
+        for (int j = 0; j < node->count; j++) {
+            result.push_back(base + bvh.triangles[node->offset + 2 + j]);
+        }
+        EXPECT_EQ(sortedUnique(result), sortedUnique(expected));
+    }
+    EXPECT_EQ(bvh.triangles.size(), source.triangles.size() + 2 * leaves);
+
+    // Half the memory of the full precision hierarchy, but for the bases of the leaves
+    int size = bvh.nodes.size() * sizeof(Utils::QuantizedBVHNode) + bvh.triangles.size() * sizeof(unsigned short);
+    int sourceSize = source.nodes.size() * sizeof(Utils::LinearBVHNode) + source.triangles.size() * sizeof(int);
+    EXPECT_EQ(size * 2, sourceSize + leaves * 8);
+
+    EXPECT_EQ(bvh.lowerBound.x, source.nodes[0].lowerBound[0]);
+    EXPECT_EQ(bvh.upperBound.z, source.nodes[0].upperBound[2]);
+
+    bvh.reset();
+    EXPECT_EQ(bvh.nodes.size(), 0);
+    EXPECT_EQ(bvh.triangles.size(), 0);
+}
+
+TEST(QuantizedTriangleBVH, LargeMesh) {
+    // Over 65536 triangles, with the first one repeated at the end so that a leaf spans the whole mesh
+    std::vector<float> vertices;
+    std::vector<int> indices;
+    createOffsetGrid(190, 0, &vertices, &indices);
+    indices.insert(indices.end(), { indices[0], indices[1], indices[2] });
+    int last = indices.size() / 3 - 1;
+    ASSERT_GT(last, 65536);
+    Utils::TriangleBVH source;
+    source.build(&vertices, &indices);
+    Utils::QuantizedTriangleBVH bvh;
+    bvh.build(&source);
+
+    // The leaf is split until its triangles are within 16 bits of each other, still two bytes per triangle besides the bases
+    EXPECT_GT(bvh.nodes.size(), source.nodes.size());
+    EXPECT_LT(bvh.triangles.size(), source.triangles.size() * 2);
+
+    Collision::AABB query(Math::Vec3(-0.1, -0.1, -1), Math::Vec3(0.3, 0.3, 2));
+    std::vector<int> expected;
+    std::vector<int> result;
+    source.aabbQuery(&query, &expected);
+    bvh.aabbQuery(&query, &result);
+    std::vector<int> r = sortedUnique(result);
+    std::vector<int> e = sortedUnique(expected);
+    EXPECT_TRUE(std::includes(r.begin(), r.end(), e.begin(), e.end()));
+    EXPECT_TRUE(std::binary_search(r.begin(), r.end(), 0));
+    EXPECT_TRUE(std::binary_search(r.begin(), r.end(), last));
+
+    query = Collision::AABB(Math::Vec3(60, 60, -1), Math::Vec3(60.5, 60.5, 2));
+    expected.clear();
+    result.clear();
+    source.aabbQuery(&query, &expected);
+    bvh.aabbQuery(&query, &result);
+    r = sortedUnique(result);
+    e = sortedUnique(expected);
+    ASSERT_GT(e.size(), 0);
+    EXPECT_TRUE(std::includes(r.begin(), r.end(), e.begin(), e.end()));
+}
+
+TEST(QuantizedTriangleBVH, Dequantize) {
+    EXPECT_EQ(Utils::QuantizedTriangleBVH::dequantize(-3.7f, 12.1f, 0), -3.7f);
+    EXPECT_EQ(Utils::QuantizedTriangleBVH::dequantize(-3.7f, 12.1f, 65535), 12.1f);
+    EXPECT_NEAR(Utils::QuantizedTriangleBVH::dequantize(0, 2, 32768), 1, 1e-4);
+}
+
+TEST(QuantizedTriangleBVH, SplitLeaves) {
+    std::vector<float> vertices;
+    std::vector<int> indices;
+    createOffsetGrid(10, 0, &vertices, &indices);
+    Utils::TriangleBVH source;
+    source.maxLeafSize = 100;
+    source.build(&vertices, &indices);
+    Utils::QuantizedTriangleBVH bvh;
+    bvh.build(&source);
+
+    // 200 triangles in leaves of at most 31
+    int leafTriangles = 0;
+    for (int i = 0; i < bvh.nodes.size(); i++) {
+        Utils::QuantizedBVHNode* node = &bvh.nodes[i];
+        EXPECT_LE(node->count, Utils::QuantizedTriangleBVH::maxLeafCount);
+        leafTriangles += node->count;
+    }
+    EXPECT_EQ(leafTriangles, indices.size() / 3);
+    EXPECT_GT(bvh.nodes.size(), source.nodes.size());
+
+    Collision::AABB query(Math::Vec3(-1, -1, -1), Math::Vec3(100, 100, 100));
+    std::vector<int> result;
+    bvh.aabbQuery(&query, &result);
+    EXPECT_EQ(result.size(), indices.size() / 3);
+    EXPECT_EQ(sortedUnique(result).size(), indices.size() / 3);
+}
+
+TEST(QuantizedTriangleBVH, Queries) {
+    std::vector<float> vertices;
+    std::vector<int> indices;
+    createOffsetGrid(40, 100, &vertices, &indices);
+    Utils::TriangleBVH source;
+    source.build(&vertices, &indices);
+    Utils::QuantizedTriangleBVH bvh;
+    bvh.build(&source);
+
+    // Never fewer triangles than the full precision hierarchy, at most a few more
+    std::srand(11);
+    for (int i = 0; i < 50; i++) {
+        float x = 101 + (std::rand() % 1000) / 1000.0f * 12;
+        float y = 101 + (std::rand() % 1000) / 1000.0f * 12;
+        float z = (std::rand() % 1000) / 1000.0f;
+        Collision::AABB query(Math::Vec3(x, y, z), Math::Vec3(x + 0.3f, y + 0.2f, z + 0.1f));
+        std::vector<int> expected;
+        std::vector<int> result;
+        source.aabbQuery(&query, &expected);
+        bvh.aabbQuery(&query, &result);
+        std::vector<int> r = sortedUnique(result);
+        std::vector<int> e = sortedUnique(expected);
+        EXPECT_TRUE(std::includes(r.begin(), r.end(), e.begin(), e.end()));
+        EXPECT_LE(r.size(), e.size() + 16);
+
+        Math::Vec3 from(x, y, 5);
+        Math::Vec3 to(x + 0.5f, y - 0.3f, -5);
+        expected.clear();
+        result.clear();
+        source.rayQuery(&from, &to, [&](int t) {
+            expected.push_back(t);
+        });
+        bvh.rayQuery(&from, &to, [&](int t) {
+            result.push_back(t);
+        });
+        r = sortedUnique(result);
+        e = sortedUnique(expected);
+        EXPECT_GT(e.size(), 0);
+        EXPECT_TRUE(std::includes(r.begin(), r.end(), e.begin(), e.end()));
+    }
+}
+
+TEST(QuantizedTriangleBVH, Trimesh) {
+    std::vector<float> vertices;
+    std::vector<int> indices;
+    createOffsetGrid(20, 0, &vertices, &indices);
+    Shapes::Trimesh mesh(&vertices, &indices);
+
+    Collision::AABB query(Math::Vec3(2.1, 3.3, 0), Math::Vec3(2.9, 4.1, 1));
+    std::vector<int> expected;
+    mesh.getTrianglesInAABB(&query, &expected);
+    ASSERT_GT(expected.size(), 0);
+
+    mesh.useCompressedTree = true;
+    mesh.updateTree();
+    EXPECT_EQ(mesh.tree.nodes.size(), 0);
+    EXPECT_GT(mesh.compressedTree.nodes.size(), 0);
+
+    std::vector<int> result;
+    mesh.getTrianglesInAABB(&query, &result);
+    std::vector<int> r = sortedUnique(result);
+    std::vector<int> e = sortedUnique(expected);
+    EXPECT_TRUE(std::includes(r.begin(), r.end(), e.begin(), e.end()));
+
+    mesh.useCompressedTree = false;
+    mesh.updateTree();
+    EXPECT_EQ(mesh.compressedTree.nodes.size(), 0);
+    result.clear();
+    mesh.getTrianglesInAABB(&query, &result);
+    EXPECT_EQ(result, expected);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include "collision/SAPBroadphase.h"
+#include "collision/AABB.h"
+#include "objects/Body.h"
+#include "shapes/Sphere.h"
+#include "math/Vec3.h"
+#include "test/test_helpers.h"
+
+using namespace Cannon;
+
+TEST(SAPBroadphase, SortList) {
+    std::unique_ptr<Collision::SAPBroadphase> bp(new Collision::SAPBroadphase());
+    bp->addBody(createSphereBody(10, 0, 0));
+    bp->addBody(createSphereBody(-10, 0, 0));
+    bp->addBody(createSphereBody(0, 0, 0));
+
+    bp->sortList();
+
+    EXPECT_EQ(bp->axisIndex, 0);
+    EXPECT_EQ(bp->axisList[0]->position.x, -10);
+    EXPECT_EQ(bp->axisList[1]->position.x, 0);
+    EXPECT_EQ(bp->axisList[2]->position.x, 10);
+}
+
+TEST(SAPBroadphase, AutoDetectAxis) {
+    std::unique_ptr<Collision::SAPBroadphase> bp(new Collision::SAPBroadphase());
+    bp->addBody(createSphereBody(0, 0, -10));
+    bp->addBody(createSphereBody(0, 1, 0));
+    bp->addBody(createSphereBody(1, 0, 10));
+
+    bp->autoDetectAxis();
+    EXPECT_EQ(bp->axisIndex, 2);
+}
+
+TEST(SAPBroadphase, CollisionPairs) {
+    std::unique_ptr<Collision::SAPBroadphase> bp(new Collision::SAPBroadphase());
+    std::vector<Objects::Body*> p1;
+    std::vector<Objects::Body*> p2;
+
+    Objects::Body* a = createSphereBody(0, 0, 0);
+    Objects::Body* b = createSphereBody(0.9, 0, 0);
+    Objects::Body* c = createSphereBody(5, 0, 0);
+    bp->addBody(a);
+    bp->addBody(b);
+    bp->addBody(c);
+
+    bp->collisionPairs(nullptr, &p1, &p2);
+    EXPECT_EQ(p1.size(), 1);
+
+    // Move c onto b, the list is re-sorted on the next step
+    c->position.set(1.5, 0, 0);
+    c->aabbNeedsUpdate = true;
+    bp->dirty = true;
+    p1.clear();
+    p2.clear();
+    bp->collisionPairs(nullptr, &p1, &p2);
+    EXPECT_EQ(p1.size(), 2);
+
+    bp->removeBody(b);
+    p1.clear();
+    p2.clear();
+    bp->collisionPairs(nullptr, &p1, &p2);
+    EXPECT_EQ(p1.size(), 0);
+}
+
+TEST(SAPBroadphase, CollisionPairsMatchBruteForce) {
+    std::unique_ptr<Collision::SAPBroadphase> bp(new Collision::SAPBroadphase());
+    bp->useBoundingBoxes = true;
+    std::vector<Objects::Body*> bodies;
+
+    std::srand(1);
+    for (int i = 0; i < 200; i++) {
+        Objects::Body* body = createSphereBody(
+            (std::rand() % 1000) / 100.0f,
+            (std::rand() % 1000) / 100.0f,
+            (std::rand() % 100) / 100.0f);
+        bodies.push_back(body);
+        bp->addBody(body);
+    }
+
+    for (int step = 0; step < 3; step++) {
+        std::vector<Objects::Body*> p1;
+        std::vector<Objects::Body*> p2;
+        bp->dirty = true;
+        bp->collisionPairs(nullptr, &p1, &p2);
+
+        std::vector<Objects::Body*> q1;
+        std::vector<Objects::Body*> q2;
+        for (int i = 0; i < bodies.size(); i++) {
+            for (int j = i + 1; j < bodies.size(); j++) {
+                bp->intersectionTest(bodies[i], bodies[j], &q1, &q2);
+            }
+        }
+        EXPECT_EQ(p1.size(), q1.size());
+
+        // Move everything a little
+        for (int i = 0; i < bodies.size(); i++) {
+            bodies[i]->position.x += ((std::rand() % 100) - 50) / 500.0f;
+            bodies[i]->aabbNeedsUpdate = true;
+        }
+    }
+}
+
+TEST(SAPBroadphase, AabbQuery) {
+    std::unique_ptr<Collision::SAPBroadphase> bp(new Collision::SAPBroadphase());
+    bp->addBody(createSphereBody(0, 0, 0));
+    bp->addBody(createSphereBody(3, 0, 0));
+    bp->addBody(createSphereBody(6, 0, 0));
+
+    std::unique_ptr<Collision::AABB> aabb(new Collision::AABB(Math::Vec3(-1, -1, -1), Math::Vec3(1, 1, 1)));
+    std::vector<Objects::Body*> result;
+    bp->aabbQuery(nullptr, aabb.get(), &result);
+    EXPECT_EQ(result.size(), 1);
+
+    aabb->upperBound.set(4, 1, 1);
+    result.clear();
+    bp->aabbQuery(nullptr, aabb.get(), &result);
+    EXPECT_EQ(result.size(), 2);
+}
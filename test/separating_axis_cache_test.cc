@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include "collision/SeparatingAxisCache.h"
+#include "shapes/Box.h"
+#include "shapes/ConvexPolyhedron.h"
+
+using namespace Cannon;
+
+TEST(SeparatingAxisCache, FindSeparatingAxis) {
+    Collision::SeparatingAxisCache cache;
+    Shapes::Box boxA(new Math::Vec3(0.5, 0.5, 0.5));
+    Shapes::Box boxB(new Math::Vec3(0.5, 0.5, 0.5));
+    Shapes::ConvexPolyhedron* hullA = boxA.convexPolyhedronRepresentation;
+    Shapes::ConvexPolyhedron* hullB = boxB.convexPolyhedronRepresentation;
+    Math::Vec3 posA(0, 0, 0);
+    Math::Vec3 posB(2, 2, 0);
+    Math::Quaternion quatA;
+    Math::Quaternion quatB;
+    Math::Vec3 axis;
+
+    // Separated along both x and y. The full test finds y first.
+    EXPECT_FALSE(hullA->findSeparatingAxis(hullB, &posA, &quatA, &posB, &quatB, &axis, nullptr, nullptr, &cache));
+    EXPECT_EQ(cache.size(), 1);
+    EXPECT_NEAR(std::abs(axis.y), 1, 1e-5);
+
+    // The cached axis is tried first, even if another one would be found first
+    Math::Vec3 x(1, 0, 0);
+    cache.setAxis(hullA, &quatA, hullB, &quatB, &x);
+    EXPECT_FALSE(hullB->findSeparatingAxis(hullA, &posB, &quatB, &posA, &quatA, &axis, nullptr, nullptr, &cache));
+    EXPECT_NEAR(axis.x, 1, 1e-5);
+
+    // Overlapping pairs are removed
+    posB.set(0.5, 0.5, 0);
+    EXPECT_TRUE(hullA->findSeparatingAxis(hullB, &posA, &quatA, &posB, &quatB, &axis, nullptr, nullptr, &cache));
+    EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(SeparatingAxisCache, LocalFrame) {
+    Collision::SeparatingAxisCache cache;
+    Shapes::Box boxA(new Math::Vec3(0.5, 0.5, 0.5));
+    Shapes::Box boxB(new Math::Vec3(0.5, 0.5, 0.5));
+    Math::Quaternion quatA;
+    Math::Quaternion quatB;
+    Math::Vec3 axis(1, 0, 0);
+    cache.setAxis(&boxA, &quatA, &boxB, &quatB, &axis);
+
+    // The axis turns with the first shape
+    Math::Vec3 z(0, 0, 1);
+    quatA.setFromAxisAngle(&z, M_PI / 2);
+    EXPECT_TRUE(cache.getAxis(&boxB, &quatB, &boxA, &quatA, &axis));
+    EXPECT_NEAR(axis.x, 0, 1e-5);
+    EXPECT_NEAR(axis.y, 1, 1e-5);
+}
+
+TEST(SeparatingAxisCache, Update) {
+    Collision::SeparatingAxisCache cache;
+    Shapes::Box boxA(new Math::Vec3(0.5, 0.5, 0.5));
+    Shapes::Box boxB(new Math::Vec3(0.5, 0.5, 0.5));
+    Shapes::Box boxC(new Math::Vec3(0.5, 0.5, 0.5));
+    Math::Quaternion q;
+    Math::Vec3 axis(1, 0, 0);
+
+    cache.update();
+    cache.setAxis(&boxA, &q, &boxB, &q, &axis);
+    cache.setAxis(&boxA, &q, &boxC, &q, &axis);
+    cache.update();
+    EXPECT_EQ(cache.size(), 2);
+
+    // Only the pair that was used survives the next update
+    EXPECT_TRUE(cache.getAxis(&boxB, &q, &boxA, &q, &axis));
+    cache.update();
+    EXPECT_EQ(cache.size(), 1);
+    EXPECT_FALSE(cache.getAxis(&boxA, &q, &boxC, &q, &axis));
+}
+
+TEST(SeparatingAxisCache, Source) {
+    Collision::SeparatingAxisCache cache;
+    Collision::SeparatingAxisCache buffer;
+    Shapes::Box boxA(new Math::Vec3(0.5, 0.5, 0.5));
+    Shapes::Box boxB(new Math::Vec3(0.5, 0.5, 0.5));
+    Shapes::Box boxC(new Math::Vec3(0.5, 0.5, 0.5));
+    Math::Quaternion q;
+    Math::Vec3 x(1, 0, 0);
+    Math::Vec3 y(0, 1, 0);
+    Math::Vec3 axis;
+
+    cache.update();
+    cache.setAxis(&boxA, &q, &boxB, &q, &x);
+    cache.setAxis(&boxA, &q, &boxC, &q, &x);
+    cache.update();
+
+    // Reads come from the source, changes wait for the flush
+    buffer.setSource(&cache);
+    EXPECT_TRUE(buffer.getAxis(&boxA, &q, &boxB, &q, &axis));
+    EXPECT_NEAR(axis.x, 1, 1e-5);
+    buffer.setAxis(&boxB, &q, &boxC, &q, &y);
+    buffer.removeAxis(&boxA, &boxB);
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_TRUE(cache.getAxis(&boxA, &q, &boxB, &q, &axis));
+
+    buffer.flush();
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_FALSE(cache.getAxis(&boxA, &q, &boxB, &q, &axis));
+    EXPECT_TRUE(cache.getAxis(&boxC, &q, &boxB, &q, &axis));
+    EXPECT_NEAR(axis.y, 1, 1e-5);
+
+    // The pair that was neither used nor set is dropped on the next update
+    cache.update();
+    EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(SeparatingAxisCache, VertexHints) {
+    Collision::SeparatingAxisCache cache;
+    Shapes::Box boxA(new Math::Vec3(0.5, 0.5, 0.5));
+    Shapes::Box boxB(new Math::Vec3(0.5, 0.5, 0.5));
+    Math::Quaternion q;
+    Math::Vec3 x(1, 0, 0);
+    Math::Vec3 axis;
+
+    std::array<int, 4> hints = {{ 1, 2, 3, 4 }};
+    cache.setAxis(&boxA, &q, &boxB, &q, &x, &hints);
+
+    // The hints of each shape follow it, whatever the order of the pair
+    std::array<int, 4> result;
+    EXPECT_TRUE(cache.getAxis(&boxA, &q, &boxB, &q, &axis, &result));
+    EXPECT_EQ(result, hints);
+    EXPECT_TRUE(cache.getAxis(&boxB, &q, &boxA, &q, &axis, &result));
+    EXPECT_EQ(result, (std::array<int, 4>{{ 3, 4, 1, 2 }}));
+}
@@ -0,0 +1,16 @@
+#ifndef TestHelpers_h
+#define TestHelpers_h
+
+#include "objects/Body.h"
+#include "shapes/Sphere.h"
+
+// A body of mass 1 with one sphere, its AABB is computed on the next step
+inline Cannon::Objects::Body* createSphereBody(float x, float y, float z, float radius = 0.5) {
+    Cannon::Objects::Body* body = new Cannon::Objects::Body(1);
+    body->addShape(new Cannon::Shapes::Sphere(radius), nullptr, nullptr);
+    body->position.set(x, y, z);
+    body->aabbNeedsUpdate = true;
+    return body;
+}
+
+#endif
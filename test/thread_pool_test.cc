@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include "utils/ThreadPool.h"
+#include "collision/SAPBroadphase.h"
+#include "collision/AABBTreeBroadphase.h"
+#include "objects/Body.h"
+#include "shapes/Sphere.h"
+#include "test/test_helpers.h"
+
+using namespace Cannon;
+
+static void addRandomBodies(Collision::Broadphase* bp, int count) {
+    std::srand(11);
+    for (int i = 0; i < count; i++) {
+        Objects::Body* body = createSphereBody(
+            (std::rand() % 1000) / 100.0f,
+            (std::rand() % 1000) / 100.0f,
+            (std::rand() % 1000) / 100.0f);
+        if (i % 10 == 0) {
+            body->type = Objects::BodyType::STATIC;
+        }
+        bp->addBody(body);
+    }
+}
+
+static std::vector<std::pair<int, int>> pairIds(std::vector<Objects::Body*>* p1, std::vector<Objects::Body*>* p2) {
+    std::vector<std::pair<int, int>> ids;
+    for (int i = 0; i < p1->size(); i++) {
+        ids.push_back(std::make_pair(p1->at(i)->id, p2->at(i)->id));
+    }
+    return ids;
+}
+
+TEST(ThreadPool, Run) {
+    for (int threads = 1; threads <= 4; threads++) {
+        Utils::ThreadPool pool(threads);
+        EXPECT_EQ(pool.size(), threads);
+
+        // Run several times to reuse the workers
+        for (int k = 0; k < 5; k++) {
+            std::vector<int> done(100, 0);
+            std::atomic<int> badThread(0);
+            pool.run(100, [&](int task, int thread) {
+                done[task]++;
+                if (thread < 0 || thread >= threads) {
+                    badThread++;
+                }
+            });
+            EXPECT_EQ(std::count(done.begin(), done.end(), 1), 100);
+            EXPECT_EQ(badThread.load(), 0);
+        }
+    }
+}
+
+TEST(ThreadPool, SAPBroadphaseDeterministic) {
+    std::unique_ptr<Collision::SAPBroadphase> bp(new Collision::SAPBroadphase());
+    addRandomBodies(bp.get(), 300);
+    bp->bodiesPerTask = 16;
+
+    std::vector<Objects::Body*> p1;
+    std::vector<Objects::Body*> p2;
+    bp->collisionPairs(nullptr, &p1, &p2);
+    std::vector<std::pair<int, int>> expected = pairIds(&p1, &p2);
+    EXPECT_GT(expected.size(), 0);
+
+    for (int threads = 1; threads <= 4; threads++) {
+        Utils::ThreadPool pool(threads);
+        bp->threadPool = &pool;
+        p1.clear();
+        p2.clear();
+        bp->collisionPairs(nullptr, &p1, &p2);
+        EXPECT_EQ(pairIds(&p1, &p2), expected);
+        bp->threadPool = nullptr;
+    }
+}
+
+TEST(ThreadPool, AABBTreeBroadphaseDeterministic) {
+    std::unique_ptr<Collision::AABBTreeBroadphase> bp(new Collision::AABBTreeBroadphase());
+    addRandomBodies(bp.get(), 300);
+    bp->bodiesPerTask = 16;
+
+    std::vector<Objects::Body*> p1;
+    std::vector<Objects::Body*> p2;
+    bp->collisionPairs(nullptr, &p1, &p2);
+    std::vector<std::pair<int, int>> expected = pairIds(&p1, &p2);
+    EXPECT_GT(expected.size(), 0);
+
+    // Same pairs in the same order with any pool
+    for (int threads : { 1, 4 }) {
+        Utils::ThreadPool pool(threads);
+        bp->threadPool = &pool;
+        p1.clear();
+        p2.clear();
+        bp->collisionPairs(nullptr, &p1, &p2);
+        EXPECT_EQ(pairIds(&p1, &p2), expected);
+        bp->threadPool = nullptr;
+    }
+
+    // Sorted by body id, lower id first
+    for (int i = 0; i < expected.size(); i++) {
+        EXPECT_LT(expected[i].first, expected[i].second);
+    }
+    EXPECT_TRUE(std::is_sorted(expected.begin(), expected.end()));
+
+    // Without duplicates
+    EXPECT_EQ(std::unique(expected.begin(), expected.end()), expected.end());
+
+    // The pair cache sees them in the same order too
+    bp->updatePairs(nullptr);
+    std::vector<std::pair<int, int>> cached = pairIds(&bp->pairCache.added1, &bp->pairCache.added2);
+    Utils::ThreadPool pool(4);
+    bp->threadPool = &pool;
+    bp->pairCache.reset();
+    bp->updatePairs(nullptr);
+    EXPECT_EQ(pairIds(&bp->pairCache.added1, &bp->pairCache.added2), cached);
+    bp->threadPool = nullptr;
+}
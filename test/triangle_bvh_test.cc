@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include "utils/TriangleBVH.h"
+#include "collision/AABB.h"
+#include "math/Vec3.h"
+
+using namespace Cannon;
+
+// A bumpy grid of size x size quads, two triangles each
+static void createBumpyGrid(int size, std::vector<float>* vertices, std::vector<int>* indices) {
+    std::srand(5);
+    for (int y = 0; y <= size; y++) {
+        for (int x = 0; x <= size; x++) {
+            vertices->push_back(x);
+            vertices->push_back(y);
+            vertices->push_back((std::rand() % 1000) / 1000.0f);
+        }
+    }
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int a = y * (size + 1) + x;
+            int b = a + 1;
+            int c = a + size + 1;
+            int d = c + 1;
+            indices->insert(indices->end(), { a, b, d, a, d, c });
+        }
+    }
+}
+
+static Collision::AABB triangleAABB(std::vector<float>* vertices, std::vector<int>* indices, int t) {
+    Collision::AABB aabb;
+    for (int v = 0; v < 3; v++) {
+        int i = indices->at(t * 3 + v) * 3;
+        Math::Vec3 p(vertices->at(i), vertices->at(i + 1), vertices->at(i + 2));
+        if (v == 0) {
+            aabb.lowerBound.copy(&p);
+            aabb.upperBound.copy(&p);
+        } else {
+            aabb.lowerBound.set(std::min(aabb.lowerBound.x, p.x), std::min(aabb.lowerBound.y, p.y), std::min(aabb.lowerBound.z, p.z));
+            aabb.upperBound.set(std::max(aabb.upperBound.x, p.x), std::max(aabb.upperBound.y, p.y), std::max(aabb.upperBound.z, p.z));
+        }
+    }
+    return aabb;
+}
+
+TEST(TriangleBVH, Build) {
+    std::vector<float> vertices;
+    std::vector<int> indices;
+    createBumpyGrid(32, &vertices, &indices);
+    Utils::TriangleBVH bvh;
+    bvh.build(&vertices, &indices);
+
+    // Every triangle is in exactly one leaf, and every node contains its children
+    int N = indices.size() / 3;
+    std::vector<int> sorted = bvh.triangles;
+    std::sort(sorted.begin(), sorted.end());
+    ASSERT_EQ(sorted.size(), N);
+    for (int i = 0; i < N; i++) {
+        EXPECT_EQ(sorted[i], i);
+    }
+    int leafTriangles = 0;
+    for (int i = 0; i < bvh.nodes.size(); i++) {
+        Utils::LinearBVHNode* node = &bvh.nodes[i];
+        if (node->count > 0) {
+            EXPECT_LE(node->count, bvh.maxLeafSize);
+            leafTriangles += node->count;
+            for (int j = node->offset; j < node->offset + node->count; j++) {
+                Collision::AABB aabb = triangleAABB(&vertices, &indices, bvh.triangles[j]);
+                EXPECT_LE(node->lowerBound[2], aabb.lowerBound.z);
+                EXPECT_GE(node->upperBound[2], aabb.upperBound.z);
+            }
+            continue;
+        }
+        Utils::LinearBVHNode* children[2] = { &bvh.nodes[i + 1], &bvh.nodes[node->offset] };
+        for (int c = 0; c < 2; c++) {
+            for (int k = 0; k < 3; k++) {
+                EXPECT_LE(node->lowerBound[k], children[c]->lowerBound[k]);
+                EXPECT_GE(node->upperBound[k], children[c]->upperBound[k]);
+            }
+        }
+    }
+    EXPECT_EQ(leafTriangles, N);
+
+    // SAH splits a regular grid about evenly
+    EXPECT_LE(bvh.getDepth(), 16);
+
+    bvh.reset();
+    EXPECT_EQ(bvh.getDepth(), 0);
+}
+
+TEST(TriangleBVH, AABBQuery) {
+    std::vector<float> vertices;
+    std::vector<int> indices;
+    createBumpyGrid(20, &vertices, &indices);
+    Utils::TriangleBVH bvh;
+    bvh.build(&vertices, &indices);
+
+    Collision::AABB query(Math::Vec3(3.5, 4.2, 0.2), Math::Vec3(6.1, 5.3, 0.4));
+    std::vector<int> result;
+    bvh.aabbQuery(&query, &result);
+
+    // All triangles that overlap are found
+    int overlapping = 0;
+    for (int t = 0; t < indices.size() / 3; t++) {
+        Collision::AABB aabb = triangleAABB(&vertices, &indices, t);
+        if (aabb.overlaps(&query)) {
+            overlapping++;
+            EXPECT_NE(std::find(result.begin(), result.end(), t), result.end());
+        }
+    }
+    EXPECT_GT(overlapping, 0);
+    EXPECT_LT(result.size(), indices.size() / 3);
+
+    // The visitor sees the same triangles
+    int visited = 0;
+    bvh.aabbQuery(&query, [&](int t) {
+        EXPECT_EQ(result[visited], t);
+        visited++;
+    });
+    EXPECT_EQ(visited, result.size());
+}
+
+TEST(TriangleBVH, RayQuery) {
+    std::vector<float> vertices;
+    std::vector<int> indices;
+    createBumpyGrid(20, &vertices, &indices);
+    Utils::TriangleBVH bvh;
+    bvh.build(&vertices, &indices);
+
+    // A vertical segment only passes the triangles of one quad
+    Math::Vec3 from(7.3, 2.6, 5);
+    Math::Vec3 to(7.3, 2.6, -5);
+    std::vector<int> result;
+    bvh.rayQuery(&from, &to, [&](int t) {
+        result.push_back(t);
+    });
+    int quad = 2 * (2 * 20 + 7);
+    EXPECT_NE(std::find(result.begin(), result.end(), quad), result.end());
+    EXPECT_NE(std::find(result.begin(), result.end(), quad + 1), result.end());
+    EXPECT_LE(result.size(), 4 * bvh.maxLeafSize);
+
+    // Above the mesh
+    from.set(7.3, 2.6, 5);
+    to.set(8.3, 2.6, 5);
+    result.clear();
+    bvh.rayQuery(&from, &to, [&](int t) {
+        result.push_back(t);
+    });
+    EXPECT_EQ(result.size(), 0);
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include "shapes/Trimesh.h"
+#include "collision/AABB.h"
+
+using namespace Cannon;
+
+TEST(Trimesh, Torus) {
+    Shapes::Trimesh* torus = Shapes::Trimesh::createTorus(1, 0.5, 8, 6, M_PI * 2);
+    EXPECT_EQ(torus->vertices.size(), 9 * 7 * 3);
+    EXPECT_EQ(torus->indices.size(), 8 * 6 * 6);
+    EXPECT_EQ(torus->normals.size(), torus->indices.size());
+    EXPECT_NEAR(torus->boundingSphereRadius, 1.5, 1e-5);
+    EXPECT_NEAR(torus->aabb.upperBound.x, 1.5, 1e-5);
+    EXPECT_NEAR(torus->aabb.upperBound.z, 0.5, 1e-2);
+
+    // Each edge once, lower vertex first
+    for (int i = 0; i < torus->edges.size() / 2; i++) {
+        EXPECT_LT(torus->edges[i * 2], torus->edges[i * 2 + 1]);
+    }
+
+    // The normals have unit length
+    Math::Vec3 normal;
+    for (int i = 0; i < torus->indices.size() / 3; i++) {
+        torus->getNormal(i, &normal);
+        EXPECT_NEAR(normal.length(), 1, 1e-4);
+    }
+    delete torus;
+}
+
+TEST(Trimesh, GetTrianglesInAABB) {
+    // Two triangles making the unit square on the XY plane, and one far away
+    std::vector<float> vertices = { 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 10, 10, 0, 11, 10, 0, 10, 11, 0 };
+    std::vector<int> indices = { 0, 1, 2, 0, 2, 3, 4, 5, 6 };
+    Shapes::Trimesh mesh(&vertices, &indices);
+    EXPECT_EQ(mesh.edges.size(), 2 * 8);
+
+    Collision::AABB aabb(Math::Vec3(0.2, 0.2, -0.1), Math::Vec3(0.4, 0.4, 0.1));
+    std::vector<int> result;
+    mesh.getTrianglesInAABB(&aabb, &result);
+    std::sort(result.begin(), result.end());
+    ASSERT_GE(result.size(), 2);
+    EXPECT_EQ(result[0], 0);
+    EXPECT_EQ(result[1], 1);
+
+    // The query box is in scaled space
+    Math::Vec3 scale(2, 2, 1);
+    mesh.setScale(&scale);
+    EXPECT_NEAR(mesh.aabb.upperBound.x, 22, 1e-5);
+    aabb.lowerBound.set(20.5, 20.5, -0.1);
+    aabb.upperBound.set(21, 21, 0.1);
+    result.clear();
+    mesh.getTrianglesInAABB(&aabb, &result);
+    EXPECT_NE(std::find(result.begin(), result.end(), 2), result.end());
+
+    // Nothing is allocated by the visitor query
+    int count = 0;
+    mesh.trianglesInAABB(&aabb, [&](int t) {
+        count++;
+    });
+    EXPECT_EQ(count, result.size());
+
+    // So is the segment
+    Math::Vec3 from(21, 21, 1);
+    Math::Vec3 to(21, 21, -1);
+    bool found = false;
+    mesh.trianglesOnSegment(&from, &to, [&](int t) {
+        found = found || t == 2;
+    });
+    EXPECT_TRUE(found);
+}
+
+TEST(Trimesh, CalculateWorldAABB) {
+    std::vector<float> vertices = { 0, 0, 0, 2, 0, 0, 0, 1, 0 };
+    std::vector<int> indices = { 0, 1, 2 };
+    Shapes::Trimesh mesh(&vertices, &indices);
+
+    Math::Vec3 pos(1, 1, 1);
+    Math::Vec3 axis(0, 0, 1);
+    Math::Quaternion quat;
+    quat.setFromAxisAngle(&axis, M_PI / 2);
+    Math::Vec3 min;
+    Math::Vec3 max;
+    mesh.calculateWorldAABB(&pos, &quat, &min, &max);
+    EXPECT_NEAR(min.x, 0, 1e-5);
+    EXPECT_NEAR(max.x, 1, 1e-5);
+    EXPECT_NEAR(min.y, 1, 1e-5);
+    EXPECT_NEAR(max.y, 3, 1e-5);
+    EXPECT_NEAR(min.z, 1, 1e-5);
+    EXPECT_NEAR(max.z, 1, 1e-5);
+}